@@ -75,6 +75,10 @@ typedef struct adapter_callbacks {
                                            neu_json_type_e t, neu_type_e type,
                                            neu_json_value_u value,
                                            int64_t          error);
+            // as write_response, with the tags that failed
+            // (neu_resp_write_tag_error_t), which are copied
+            void (*write_tags_response)(neu_adapter_t *adapter, void *req,
+                                        int error, UT_array *tags);
         } driver;
     };
 } adapter_callbacks_t;
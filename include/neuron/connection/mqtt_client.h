@@ -58,6 +58,11 @@ typedef struct {
     char *tracestate;
 } trace_w3c_t;
 
+typedef struct {
+    const char *name;
+    const char *value;
+} neu_mqtt_user_prop_t;
+
 /**
  * Check that `topic_filter` is a valid MQTT topic filter.
  */
@@ -76,6 +81,12 @@ typedef void (*neu_mqtt_client_connection_cb_t)(void *data);
 typedef void (*neu_mqtt_client_publish_cb_t)(int errcode, neu_mqtt_qos_e qos,
                                              char *topic, uint8_t *payload,
                                              uint32_t len, void *data);
+// publish callback of neu_mqtt_client_publish_with_props, which has no use for
+// the payload as the client copies it
+typedef void (*neu_mqtt_client_publish_done_cb_t)(int            errcode,
+                                                  neu_mqtt_qos_e qos,
+                                                  char *topic, uint32_t len,
+                                                  void *data);
 typedef void (*neu_mqtt_client_subscribe_cb_t)(neu_mqtt_qos_e qos,
                                                const char *   topic,
                                                const uint8_t *payload,
@@ -129,6 +140,10 @@ int neu_mqtt_client_close(neu_mqtt_client_t *client);
  * `errcode` is zero if delivery was successful and nonzero otherwise, and
  * the other arguments are exactly the same what you pass into this function.
  * You may set `cb` to NULL if you do not care about the result.
+ *
+ * The payload is copied into the message before this function returns, so
+ * the caller may free or reuse it right away, while `topic` should stay valid
+ * until the callback.
  */
 int neu_mqtt_client_publish(neu_mqtt_client_t *client, neu_mqtt_qos_e qos,
                             char *topic, uint8_t *payload, uint32_t len,
@@ -141,6 +156,19 @@ int neu_mqtt_client_publish_with_trace(neu_mqtt_client_t *client,
                                        neu_mqtt_client_publish_cb_t cb,
                                        const char *traceparent);
 
+/** Publish like neu_mqtt_client_publish, attaching the `n_prop` user
+ * properties `props` to the message. The properties are only sent with
+ * MQTT v5, and are ignored with older versions. The callback is invoked as
+ * `cb(errcode, qos, topic, len, data)`, without the payload.
+ */
+int neu_mqtt_client_publish_with_props(neu_mqtt_client_t *client,
+                                       neu_mqtt_qos_e qos, char *topic,
+                                       uint8_t *payload, uint32_t len,
+                                       void *                            data,
+                                       neu_mqtt_client_publish_done_cb_t cb,
+                                       const neu_mqtt_user_prop_t *      props,
+                                       size_t                            n_prop);
+
 /** Subscribe to `topic` with service quality `qos`.
  *
  * This function tries to send a `SUBSCRIBE` packet with the given `qos` and
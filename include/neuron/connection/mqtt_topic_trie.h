@@ -0,0 +1,74 @@
+/**
+ * NEURON IIoT System for Industry 4.0
+ * Copyright (C) 2020-2022 EMQ Technologies Co., Ltd All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ **/
+
+#ifndef NEURON_MQTT_TOPIC_TRIE_H
+#define NEURON_MQTT_TOPIC_TRIE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Topic filters indexed level by level, so that matching a topic name costs
+ * one hash lookup per level plus the `+` and `#` branches along its path,
+ * whatever the number of filters. A node is shared by every filter going
+ * through it and freed with the last of them.
+ */
+typedef struct neu_mqtt_topic_trie_s neu_mqtt_topic_trie_t;
+
+neu_mqtt_topic_trie_t *neu_mqtt_topic_trie_new(void);
+void                   neu_mqtt_topic_trie_free(neu_mqtt_topic_trie_t *trie);
+
+// number of filters
+size_t neu_mqtt_topic_trie_count(neu_mqtt_topic_trie_t *trie);
+
+/** Set the `data` of a valid `topic_filter`.
+ *
+ * Returns the data previously set for the same filter, which is replaced,
+ * or NULL. `data` should not be NULL. On allocation failure, returns `data`
+ * itself and the trie is left unchanged.
+ */
+void *neu_mqtt_topic_trie_add(neu_mqtt_topic_trie_t *trie,
+                              const char *topic_filter, void *data);
+
+// remove `topic_filter`, returns its data or NULL if not found
+void *neu_mqtt_topic_trie_del(neu_mqtt_topic_trie_t *trie,
+                              const char *           topic_filter);
+
+// data of `topic_filter` itself, or NULL
+void *neu_mqtt_topic_trie_get(neu_mqtt_topic_trie_t *trie,
+                              const char *           topic_filter);
+
+/** Find the data of a filter matching `topic_name`.
+ *
+ * At every level a literal match is preferred over `+`, which is preferred
+ * over `#`, so an exact filter always wins. Returns NULL if none matches.
+ */
+void *neu_mqtt_topic_trie_match(neu_mqtt_topic_trie_t *trie,
+                                const char *           topic_name,
+                                uint32_t               topic_name_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -251,6 +251,20 @@ ssize_t neu_conn_udp_sendto(neu_conn_t *conn, uint8_t *buf, ssize_t len,
  * received, less than or equal to 0 fails.
  */
 ssize_t neu_conn_recv(neu_conn_t *conn, uint8_t *buf, ssize_t len);
+
+/**
+ * @brief Receive the data already available on a tcp client or tty
+ * connection, waiting at most timeout milliseconds for it to arrive.
+ *
+ * @param[in] conn
+ * @param[in] buf The received data is stored in buf.
+ * @param[in] len Length of buf.
+ * @param[in] timeout Milliseconds to wait for readable data.
+ * @return The number of bytes received, 0 when nothing arrived in time, less
+ * than 0 when the connection fails.
+ */
+ssize_t neu_conn_recv_wait(neu_conn_t *conn, uint8_t *buf, ssize_t len,
+                           int timeout);
 ssize_t neu_conn_udp_recvfrom(neu_conn_t *conn, uint8_t *buf, ssize_t len,
                               void *src);
 
@@ -167,6 +167,9 @@ void *neu_json_array();
 
 int neu_json_type_transfer(neu_json_type_e type);
 
+/* Rounding applied to a float tag value without precision and bias */
+double neu_json_format_float(float value);
+
 int   neu_json_decode_by_json(void *json, int size, neu_json_elem_t *ele);
 int   neu_json_decode(char *buf, int size, neu_json_elem_t *ele);
 int   neu_json_decode_array_size_by_json(void *json, char *child);
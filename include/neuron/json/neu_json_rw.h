@@ -37,6 +37,8 @@ typedef struct {
     char *   group;
     char *   node;
     uint64_t timestamp;
+    uint64_t seq;      // delta upload sequence number, 0 if not in delta mode
+    bool     keyframe; // a delta upload carrying all tags
 } neu_json_read_periodic_t;
 
 typedef struct {
@@ -62,6 +64,9 @@ typedef struct {
 } neu_json_read_resp_t;
 
 int neu_json_encode_read_resp(void *json_object, void *param);
+// a single tag object of neu_json_encode_read_resp, param is
+// neu_json_read_resp_tag_t
+int neu_json_encode_read_resp_tag(void *json_object, void *param);
 int neu_json_encode_read_resp1(void *json_object, void *param); // values
 int neu_json_encode_read_resp2(void *json_object, void *param); // tags
 int neu_json_encode_read_resp_ecp(void *json_object, void *param);
@@ -174,6 +179,27 @@ typedef struct {
     bool  is_error;
 } neu_json_read_paginate_req_t;
 
+// POST /api/v2/read/groups, every group is read as by neu_json_read_req_t
+typedef struct {
+    int64_t              timeout; // milliseconds, 0 if not given
+    int                  n_group;
+    neu_json_read_req_t *groups;
+} neu_json_read_groups_req_t;
+
+int  neu_json_decode_read_groups_req(char *                       buf,
+                                     neu_json_read_groups_req_t **result);
+void neu_json_decode_read_groups_req_free(neu_json_read_groups_req_t *req);
+
+// a group object of the response, with the tags of `resp` unless `error`
+typedef struct {
+    char *               node;
+    char *               group;
+    int64_t              error;
+    neu_json_read_resp_t resp;
+} neu_json_read_groups_resp_group_t;
+
+int neu_json_encode_read_groups_resp_group(void *json_object, void *param);
+
 int  neu_json_decode_read_paginate_req(char *                         buf,
                                        neu_json_read_paginate_req_t **result);
 void neu_json_decode_read_paginate_req_free(neu_json_read_paginate_req_t *req);
@@ -206,6 +232,9 @@ void neu_json_decode_test_read_tag_req_free(neu_json_test_read_tag_req_t *req);
 
 int neu_json_encode_test_read_tag_resp(void *json_object, void *param);
 
+// neu_resp_write_tags_t, the error and the errors of the failed tags by name
+int neu_json_encode_write_tags_resp(void *json_object, void *param);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,57 @@
+/**
+ * NEURON IIoT System for Industry 4.0
+ * Copyright (C) 2020-2022 EMQ Technologies Co., Ltd All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ **/
+
+#ifndef _NEU_JSON_API_NEU_JSON_STREAM_H_
+#define _NEU_JSON_API_NEU_JSON_STREAM_H_
+
+#include "utils/utarray.h"
+
+#include "json/neu_json_rw.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Streaming encoders for the periodic upload payloads.
+ *
+ * They write the periodic header and the tags (neu_resp_tag_value_meta_t)
+ * straight into one growing buffer, and produce the same bytes as
+ * neu_json_encode_with_mqtt with neu_json_encode_read_periodic_resp and
+ * neu_json_encode_read_resp1 (values), neu_json_encode_read_resp2 (tags) or
+ * neu_json_encode_read_resp_ecp (ecp).
+ *
+ * Return 0 on success, with the payload in `result` to be freed by the caller.
+ * Return -1 when a tag can only be encoded by the jansson encoders, i.e. a
+ * custom json value or a meta that repeats a key of the tag object. The ecp
+ * encoder returns -2 when there is no valid tag, as
+ * neu_json_encode_with_mqtt_ecp.
+ */
+int neu_json_stream_encode_values(neu_json_read_periodic_t *header,
+                                  UT_array *tags, char **result);
+int neu_json_stream_encode_tags(neu_json_read_periodic_t *header,
+                                UT_array *tags, char **result);
+int neu_json_stream_encode_ecp(neu_json_read_periodic_t *header,
+                               UT_array *tags, char **result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
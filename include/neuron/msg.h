@@ -128,6 +128,8 @@ typedef enum neu_reqresp_type {
 
     NEU_REQ_DRIVER_ACTION,
     NEU_RESP_DRIVER_ACTION,
+
+    NEU_RESP_WRITE_TAGS,
 } neu_reqresp_type_e;
 
 static const char *neu_reqresp_type_string_t[] = {
@@ -216,6 +218,8 @@ static const char *neu_reqresp_type_string_t[] = {
 
     [NEU_REQ_DRIVER_ACTION]  = "NEU_REQ_DRIVER_ACTION",
     [NEU_RESP_DRIVER_ACTION] = "NEU_RESP_DRIVER_ACTION",
+
+    [NEU_RESP_WRITE_TAGS] = "NEU_RESP_WRITE_TAGS",
 };
 
 inline static const char *neu_reqresp_type_string(neu_reqresp_type_e type)
@@ -744,6 +748,30 @@ static inline void neu_req_write_tags_fini(neu_req_write_tags_t *req)
     free(req->tags);
 }
 
+typedef struct neu_resp_write_tag_error {
+    char tag[NEU_TAG_NAME_LEN];
+    int  error;
+} neu_resp_write_tag_error_t;
+
+static inline UT_icd *neu_resp_write_tag_error_icd()
+{
+    static UT_icd icd = { sizeof(neu_resp_write_tag_error_t), NULL, NULL,
+                          NULL };
+    return &icd;
+}
+
+// the response of a write of several tags of which some failed, `error`
+// comes first and is the error of the whole write as in neu_resp_error_t
+typedef struct neu_resp_write_tags {
+    int       error;
+    UT_array *tags; // neu_resp_write_tag_error_t, the failed tags
+} neu_resp_write_tags_t;
+
+static inline void neu_resp_write_tags_fini(neu_resp_write_tags_t *resp)
+{
+    utarray_free(resp->tags);
+}
+
 typedef struct {
     char *group;
 
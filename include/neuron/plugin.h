@@ -134,6 +134,9 @@ typedef struct neu_plugin_module {
     const char *                  single_name;
     neu_event_timer_type_e        timer_type;
     neu_tag_cache_type_e          cache_type;
+    // apps whose request handles NEU_REQRESP_TRANS_DATA from several threads
+    // at once, data of a group is still handled by a single thread
+    bool                          trans_data_reentrant;
 } neu_plugin_module_t;
 
 inline static neu_plugin_common_t *
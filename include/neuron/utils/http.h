@@ -20,6 +20,9 @@
 #ifndef _NEU_HTTP_H_
 #define _NEU_HTTP_H_
 
+#include <stdbool.h>
+#include <stdio.h>
+
 #include <nng/nng.h>
 
 #include "adapter.h"
@@ -83,6 +86,67 @@ int         neu_http_internal_error(nng_aio *aio, char *content);
 int neu_http_response_file(nng_aio *aio, void *data, size_t len,
                            const char *disposition);
 
+#define NEU_HTTP_GZIP_LEVEL 6
+#define NEU_HTTP_GZIP_MIN_SIZE 1024
+
+// Response bodies of at least `min_size` bytes are gzip encoded at zlib
+// compression `level` for the clients that accept it, 0 disables it. Both
+// normal and chunked responses are compressed.
+void neu_http_set_gzip(int level, size_t min_size);
+
+// Conditional GET. Answers 304 Not Modified and returns true if `etag`, an
+// entity tag, weakly matches the If-None-Match header of the request.
+// Otherwise the 200 OK response to the request carries it as its ETag.
+bool neu_http_check_etag(nng_aio *aio, const char *etag);
+
+/*
+ * Outputs of the request aio. Output 0 is the response that nng sends once
+ * the request is finished. The others belong to these functions, and are NULL
+ * when a request arrives and when it is finished:
+ *
+ * NEU_HTTP_ETAG_OUTPUT holds a copy of the entity tag of neu_http_check_etag,
+ * a malloc'd string. The response, or the head of a chunked response, sets it
+ * as the ETag header and frees it, so a request that checked an entity tag
+ * must be answered through these functions.
+ *
+ * NEU_HTTP_ADMIT_OUTPUT holds the admission ticket of the request, from the
+ * admission by utils/http_handler.c to neu_http_finish.
+ */
+#define NEU_HTTP_ETAG_OUTPUT 1
+#define NEU_HTTP_ADMIT_OUTPUT 2
+
+/*
+ * Chunked responses, for large bodies written as they are encoded.
+ *
+ * The handler writes the body piece by piece and ends with
+ * neu_http_chunked_end, which sends 200 OK. A body that does not fit in 64 KiB
+ * is sent with Transfer-Encoding: chunked: every 64 KiB is queued as a chunk.
+ * Once NEU_HTTP_CHUNKED_QUEUE chunks are queued, a write waits for the client
+ * to take one, for up to 10 seconds. The request is finished when the last
+ * chunk is written. A failed write fails the following writes and the end.
+ *
+ * neu_http_chunked_abort drops the writer on error. It returns false if nothing
+ * is sent yet, and the handler responds as usual; otherwise the connection is
+ * closed in the middle of the body and the request is done.
+ */
+typedef struct neu_http_chunked neu_http_chunked_t;
+
+#define NEU_HTTP_CHUNKED_QUEUE 4
+
+neu_http_chunked_t *neu_http_chunked_new(nng_aio *aio, const char *type);
+
+int neu_http_chunked_write(neu_http_chunked_t *c, const void *data,
+                           size_t len);
+int neu_http_chunked_puts(neu_http_chunked_t *c, const char *str);
+
+// a stdio stream writing into c, to be closed before the end
+FILE *neu_http_chunked_stream(neu_http_chunked_t *c);
+int   neu_http_chunked_end(neu_http_chunked_t *c);
+bool  neu_http_chunked_abort(neu_http_chunked_t *c);
+
+// the most bytes queued by a chunked response so far
+size_t neu_http_chunked_peak(void);
+
 int neu_http_post_otel_trace(uint8_t *data, int len);
 
 #ifdef __cplusplus
@@ -20,6 +20,7 @@
 #ifndef _NEU_HTTP_HANDLER_H_
 #define _NEU_HTTP_HANDLER_H_
 
+#include <stdio.h>
 #include <stdlib.h>
 
 #include <nng/nng.h>
@@ -28,6 +29,10 @@
 #include "utils/neu_jwt.h"
 #include "json/neu_json_error.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 #define NEU_PROCESS_HTTP_REQUEST(aio, req_type, decode_fun, func)            \
     {                                                                        \
         char *    req_data      = NULL;                                      \
@@ -110,6 +115,31 @@ enum neu_http_handler_type {
     NEU_HTTP_HANDLER_REDIRECT,
 };
 
+/*
+ * Admission control of the function handlers. Every class runs a limited
+ * number of requests at a time, from the call of the handler until its
+ * response is sent, and queues a limited number of the others in the order of
+ * arrival. A request that finds the queue of its class full is answered 429
+ * Too Many Requests, with Retry-After. A request still running after the run
+ * timeout, whose reply may never come, gives its place to the next one and is
+ * finished as usual if it is answered later.
+ */
+enum neu_http_class {
+    NEU_HTTP_CLASS_NORMAL = 0x0,
+    NEU_HTTP_CLASS_LIGHT, // status, metrics, ping
+    NEU_HTTP_CLASS_HEAVY, // import, export, bulk reads
+    NEU_HTTP_CLASS_MAX,
+};
+
+// requests handled at a time and requests waiting, of every class
+#define NEU_HTTP_NORMAL_LIMIT 16
+#define NEU_HTTP_NORMAL_QUEUE 64
+#define NEU_HTTP_LIGHT_LIMIT 16
+#define NEU_HTTP_LIGHT_QUEUE 64
+#define NEU_HTTP_HEAVY_LIMIT 2
+#define NEU_HTTP_HEAVY_QUEUE 8
+#define NEU_HTTP_RUN_TIMEOUT_MS 120000
+
 struct neu_http_handler {
     enum neu_http_method       method;
     char *                     url;
@@ -119,10 +149,26 @@ struct neu_http_handler {
         char *path;
         char *dst_url;
     } value;
+    enum neu_http_class cls;
 };
 
 int  neu_http_add_handler(nng_http_server *              server,
                           const struct neu_http_handler *http_handler);
 void neu_http_handle_cors(nng_aio *aio);
 
+// Sends the response, output 0 of the aio, and frees the place of the request
+// in its class. Handlers complete their requests with it.
+void neu_http_finish(nng_aio *aio);
+
+// Running and queued requests, rejections and latencies of every class, in the
+// Prometheus text format.
+void neu_http_class_metrics(FILE *stream);
+
+// Sets the run timeout of the requests admitted from now on.
+void neu_http_set_run_timeout(nng_duration ms);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif
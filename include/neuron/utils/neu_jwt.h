@@ -31,6 +31,10 @@ int  neu_jwt_validate(char *b_token);
 void neu_jwt_destroy();
 void neu_jwt_decode_user_after_valid(char *bearer, char *user);
 
+// Drops the tokens validated before, which neu_jwt_validate accepts without
+// verifying the signature again until they expire, or the key files change.
+void neu_jwt_cache_clear();
+
 #ifdef __cplusplus
 }
 #endif
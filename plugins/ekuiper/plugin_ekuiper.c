@@ -335,6 +335,15 @@ static int ekuiper_plugin_request(neu_plugin_t *      plugin,
     }
 
     switch (header->type) {
+    case NEU_RESP_WRITE_TAGS:
+        utarray_foreach(((neu_resp_write_tags_t *) data)->tags,
+                        neu_resp_write_tag_error_t *, tag)
+        {
+            plog_warn(plugin, "write tag %s fail, error: %d", tag->tag,
+                      tag->error);
+        }
+        // its leading error is read as a neu_resp_error_t
+        // fall through
     case NEU_RESP_ERROR: {
         neu_resp_error_t *error = (neu_resp_error_t *) data;
         plog_debug(plugin, "receive resp errcode: %d", error->error);
@@ -434,14 +443,15 @@ static const neu_plugin_intf_funs_t plugin_intf_funs = {
 };
 
 const neu_plugin_module_t neu_plugin_module = {
-    .version         = NEURON_PLUGIN_VER_1_0,
-    .schema          = "ekuiper",
-    .module_name     = "eKuiper",
-    .module_descr    = "LF Edge eKuiper integration plugin",
-    .module_descr_zh = "LF Edge eKuiper 一体化插件",
-    .intf_funs       = &plugin_intf_funs,
-    .kind            = NEU_PLUGIN_KIND_SYSTEM,
-    .type            = NEU_NA_TYPE_APP,
-    .display         = true,
-    .single          = false,
+    .version              = NEURON_PLUGIN_VER_1_0,
+    .schema               = "ekuiper",
+    .module_name          = "eKuiper",
+    .module_descr         = "LF Edge eKuiper integration plugin",
+    .module_descr_zh      = "LF Edge eKuiper 一体化插件",
+    .intf_funs            = &plugin_intf_funs,
+    .kind                 = NEU_PLUGIN_KIND_SYSTEM,
+    .type                 = NEU_NA_TYPE_APP,
+    .display              = true,
+    .single               = false,
+    .trans_data_reentrant = true,
 };
@@ -18,12 +18,13 @@
  **/
 #include <assert.h>
 #include <netinet/in.h>
+#include <string.h>
 
 #include <neuron.h>
 
 #include "modbus.h"
 
-static uint16_t calcrc(uint8_t *buf, int len)
+static uint16_t calcrc(const uint8_t *buf, int len)
 {
     const uint16_t table[256] = {
         0x0000, 0xC0C1, 0xC181, 0x0140, 0xC301, 0x03C0, 0x0280, 0xC241, 0xC601,
@@ -236,6 +237,50 @@ int modbus_crc_unwrap(neu_protocol_unpack_buf_t *buf,
     return sizeof(struct modbus_crc);
 }
 
+int modbus_rtu_frame_check(const uint8_t *buf, uint16_t len)
+{
+    uint16_t size = 0;
+    uint16_t crc  = 0;
+
+    if (len < sizeof(struct modbus_code)) {
+        return 0;
+    }
+
+    if (buf[1] & 0x80) {
+        // slave id, function, exception code, crc
+        size = sizeof(struct modbus_code) + 1 + sizeof(struct modbus_crc);
+    } else {
+        switch (buf[1]) {
+        case MODBUS_READ_COIL:
+        case MODBUS_READ_INPUT:
+        case MODBUS_READ_HOLD_REG:
+        case MODBUS_READ_INPUT_REG:
+            if (len < sizeof(struct modbus_code) + 1) {
+                return 0;
+            }
+            size = sizeof(struct modbus_code) + 1 + buf[2] +
+                sizeof(struct modbus_crc);
+            break;
+        case MODBUS_WRITE_S_COIL:
+        case MODBUS_WRITE_S_HOLD_REG:
+        case MODBUS_WRITE_M_HOLD_REG:
+        case MODBUS_WRITE_M_COIL:
+            size = sizeof(struct modbus_code) + sizeof(struct modbus_address) +
+                sizeof(struct modbus_crc);
+            break;
+        default:
+            return -1;
+        }
+    }
+
+    if (len < size) {
+        return 0;
+    }
+
+    memcpy(&crc, buf + size - sizeof(struct modbus_crc), sizeof(crc));
+    return crc == calcrc(buf, size - sizeof(struct modbus_crc)) ? size : -1;
+}
+
 const char *modbus_area_to_str(modbus_area_e area)
 {
     switch (area) {
@@ -127,6 +127,16 @@ void modbus_crc_wrap(neu_protocol_pack_buf_t *buf);
 int  modbus_crc_unwrap(neu_protocol_unpack_buf_t *buf,
                        struct modbus_crc *        out_crc);
 
+/**
+ * @brief Check a modbus rtu response received so far.
+ *
+ * @param[in] buf Bytes received since the request was sent.
+ * @param[in] len Number of bytes in buf.
+ * @return The frame length once a whole frame with a valid crc is in buf, 0
+ * when more bytes are needed, -1 when buf can not be a valid response.
+ */
+int modbus_rtu_frame_check(const uint8_t *buf, uint16_t len);
+
 const char *modbus_area_to_str(modbus_area_e area);
 
 #endif
\ No newline at end of file
@@ -308,46 +308,40 @@ modbus_write_cmd_sort_t *modbus_write_tags_sort(UT_array *       tags,
             *(modbus_point_write_t **) utarray_front(result->sorts[i].tags);
         struct modbus_sort_ctx *ctx = result->sorts[i].info.context;
 
-        int num_tags              = utarray_len(result->sorts[i].tags);
-        sort_result->cmd[i].bytes = calloc(num_tags, sizeof(neu_value_u));
-        int      n_byte = 0, n_byte_tag = 0;
-        uint8_t *data_bit = calloc((num_tags + 7) / 8, sizeof(uint8_t));
-        int      k        = 0;
+        uint16_t n_register = ctx->end - ctx->start;
+        bool     coil       = tag->point.area == MODBUS_AREA_COIL;
+        uint16_t n_byte     = coil ? (n_register + 7) / 8 : n_register * 2;
+        uint8_t *bytes      = calloc(n_byte, sizeof(uint8_t));
+
+        // every tag lands at its own address offset, so overlapping tags
+        // and multi-register values keep their place in the frame
         utarray_foreach(result->sorts[i].tags, modbus_point_write_t **, tag_s)
         {
-            if ((*tag_s)->point.area == MODBUS_AREA_COIL) {
-                n_byte_tag =
-                    cal_n_byte((*tag_s)->point.type, &(*tag_s)->value,
-                               (*tag_s)->point.option, endianess, true);
-                data_bit[k / 8] += ((*tag_s)->value.i8) << k % 8;
-                n_byte += n_byte_tag;
-                k++;
+            uint16_t offset = (*tag_s)->point.start_address - ctx->start;
+
+            if (coil) {
+                cal_n_byte((*tag_s)->point.type, &(*tag_s)->value,
+                           (*tag_s)->point.option, endianess, true);
+                if ((*tag_s)->value.i8) {
+                    bytes[offset / 8] |= 1 << offset % 8;
+                }
             } else {
-                n_byte_tag =
+                int n_byte_tag =
                     cal_n_byte((*tag_s)->point.type, &(*tag_s)->value,
                                (*tag_s)->point.option, endianess,
                                (*tag_s)->point.option.value32.is_default);
-                memcpy(sort_result->cmd[i].bytes +
-                           2 *
-                               ((*tag_s)->point.start_address -
-                                tag->point.start_address),
-                       &((*tag_s)->value), n_byte_tag);
-                n_byte += n_byte_tag;
+                memcpy(bytes + 2 * offset, &((*tag_s)->value), n_byte_tag);
             }
         }
-        if ((*(modbus_point_write_t **) utarray_front(result->sorts[i].tags))
-                ->point.area == MODBUS_AREA_COIL) {
-            memcpy(sort_result->cmd[i].bytes, data_bit, (k + 7) / 8);
-        }
 
         sort_result->cmd[i].tags     = utarray_clone(result->sorts[i].tags);
         sort_result->cmd[i].slave_id = tag->point.slave_id;
         sort_result->cmd[i].area     = tag->point.area;
         sort_result->cmd[i].start_address = tag->point.start_address;
-        sort_result->cmd[i].n_register    = ctx->end - ctx->start;
+        sort_result->cmd[i].n_register    = n_register;
         sort_result->cmd[i].n_byte        = n_byte;
+        sort_result->cmd[i].bytes         = bytes;
 
-        free(data_bit);
         free(result->sorts[i].info.context);
     }
 
@@ -512,29 +506,27 @@ static bool tag_sort_write(neu_tag_sort_t *sort, void *tag,
         return false;
     }
 
+    uint16_t end = ctx->end;
+    if (t2->point.start_address + t2->point.n_register > end) {
+        end = t2->point.start_address + t2->point.n_register;
+    }
+
     switch (t1->point.area) {
     case MODBUS_AREA_COIL:
     case MODBUS_AREA_INPUT:
-        if ((ctx->end - ctx->start) / 8 >= modbus_read_max_byte - 1) {
+        if (end - ctx->start > MODBUS_MAX_WRITE_COILS) {
             return false;
         }
         break;
     case MODBUS_AREA_INPUT_REGISTER:
-    case MODBUS_AREA_HOLD_REGISTER: {
-        uint16_t now_bytes = (ctx->end - ctx->start) * 2;
-        uint16_t add_now   = now_bytes + t2->point.n_register * 2;
-        if (add_now >= modbus_read_max_byte) {
+    case MODBUS_AREA_HOLD_REGISTER:
+        if (end - ctx->start > MODBUS_MAX_WRITE_REGISTERS) {
             return false;
         }
-
         break;
     }
-    }
-
-    if (t2->point.start_address + t2->point.n_register > ctx->end) {
-        ctx->end = t2->point.start_address + t2->point.n_register;
-    }
 
+    ctx->end = end;
     return true;
 }
 
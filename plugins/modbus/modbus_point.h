@@ -65,6 +65,10 @@ typedef struct modbus_read_cmd_sort {
     modbus_read_cmd_t *cmd;
 } modbus_read_cmd_sort_t;
 
+/* FC16 and FC15 request limits, a write PDU is at most 253 bytes */
+#define MODBUS_MAX_WRITE_REGISTERS 123
+#define MODBUS_MAX_WRITE_COILS 1968
+
 typedef struct modbus_write_cmd {
     uint8_t       slave_id;
     modbus_area_e area;
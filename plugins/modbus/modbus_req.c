@@ -16,6 +16,9 @@
  * along with this program; if not, write to the Free Software Foundation,
  * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
  **/
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
 #include <time.h>
 
 #include "modbus_point.h"
@@ -40,13 +43,369 @@ struct modbus_write_tags_data {
     modbus_write_cmd_sort_t *cmd_sort;
 };
 
+struct modbus_inflight {
+    uint16_t cmd_idx;
+    uint16_t seq;
+    uint16_t response_size;
+    uint64_t read_tms;
+};
+
+// lane of the connection pool served by the calling thread, NULL when the
+// node polls over its single connection
+static __thread modbus_lane_t *current_lane = NULL;
+
 static void plugin_group_free(neu_plugin_group_t *pgp);
 static int  process_protocol_buf(neu_plugin_t *plugin, uint8_t slave_id,
                                  uint16_t response_size);
+static int  process_received_data(neu_plugin_t *plugin, uint8_t *recv_buf,
+                                  ssize_t recv_size, uint16_t expected_size,
+                                  uint8_t slave_id);
+static int  valid_modbus_tcp_response(neu_plugin_t *plugin, uint8_t *recv_buf,
+                                      uint16_t response_size);
 static int  process_protocol_buf_test(neu_plugin_t *plugin, void *req,
                                       modbus_point_t *point,
                                       uint16_t        response_size);
 
+static inline neu_conn_t *req_conn(neu_plugin_t *plugin)
+{
+    return current_lane != NULL ? current_lane->conn : plugin->conn;
+}
+
+static inline modbus_stack_t *req_stack(neu_plugin_t *plugin)
+{
+    return current_lane != NULL ? current_lane->stack : plugin->stack;
+}
+
+static void req_disconnect(neu_plugin_t *plugin)
+{
+    if (!plugin->is_server) {
+        neu_conn_disconnect(req_conn(plugin));
+    } else if (plugin->client_fd > 0) {
+        neu_conn_tcp_server_close_client(plugin->conn, plugin->client_fd);
+    }
+}
+
+static inline void req_set_cmd_idx(neu_plugin_t *plugin, uint16_t cmd_idx)
+{
+    if (current_lane != NULL) {
+        current_lane->cmd_idx = cmd_idx;
+    } else {
+        plugin->cmd_idx = cmd_idx;
+    }
+}
+
+static void interval_sleep(uint16_t interval)
+{
+    if (interval > 0) {
+        struct timespec t1 = { .tv_sec  = interval / 1000,
+                               .tv_nsec = 1000 * 1000 * (interval % 1000) };
+        struct timespec t2 = { 0 };
+        nanosleep(&t1, &t2);
+    }
+}
+
+struct modbus_client {
+    int             fd;
+    char            peer[INET6_ADDRSTRLEN];
+    int64_t         accept_ms;
+    neu_event_io_t *io;
+
+    // framing buffer, filled by the event loop and drained by the poller
+    uint8_t  buf[1024];
+    uint16_t len;
+
+    UT_hash_handle hh;
+};
+
+static void client_peer(int fd, char *peer, socklen_t size)
+{
+    struct sockaddr_storage addr     = { 0 };
+    socklen_t               addr_len = sizeof(addr);
+
+    if (getpeername(fd, (struct sockaddr *) &addr, &addr_len) != 0) {
+        snprintf(peer, size, "unknown");
+        return;
+    }
+
+    if (addr.ss_family == AF_INET) {
+        inet_ntop(AF_INET, &((struct sockaddr_in *) &addr)->sin_addr, peer,
+                  size);
+    } else {
+        struct in6_addr *a6 = &((struct sockaddr_in6 *) &addr)->sin6_addr;
+        if (IN6_IS_ADDR_V4MAPPED(a6)) {
+            inet_ntop(AF_INET, &a6->s6_addr[12], peer, size);
+        } else {
+            inet_ntop(AF_INET6, a6, peer, size);
+        }
+    }
+}
+
+static void client_free(neu_plugin_t *plugin, struct modbus_client *client)
+{
+    for (int i = 0; i < MAX_SLAVES; i++) {
+        if (plugin->unit_client[i] == client->fd) {
+            plugin->unit_client[i] = 0;
+        }
+    }
+
+    neu_event_del_io(plugin->events, client->io);
+    HASH_DEL(plugin->clients, client);
+    plugin->n_client -= 1;
+    free(client);
+}
+
+static void clients_link_state(neu_plugin_t *plugin)
+{
+    plugin->common.link_state = plugin->n_client > 0
+        ? NEU_NODE_LINK_STATE_CONNECTED
+        : NEU_NODE_LINK_STATE_DISCONNECTED;
+}
+
+static void clients_drop(neu_plugin_t *plugin, int fd)
+{
+    struct modbus_client *client = NULL;
+
+    pthread_mutex_lock(&plugin->clients_mtx);
+    HASH_FIND_INT(plugin->clients, &fd, client);
+    if (client != NULL) {
+        plog_notice(plugin, "client %s leave, fd: %d", client->peer, fd);
+        client_free(plugin, client);
+    }
+    clients_link_state(plugin);
+    pthread_cond_broadcast(&plugin->clients_cond);
+    pthread_mutex_unlock(&plugin->clients_mtx);
+}
+
+static void clients_drop_all(neu_plugin_t *plugin)
+{
+    struct modbus_client *client = NULL;
+    struct modbus_client *tmp    = NULL;
+
+    pthread_mutex_lock(&plugin->clients_mtx);
+    HASH_ITER(hh, plugin->clients, client, tmp) { client_free(plugin, client); }
+    clients_link_state(plugin);
+    pthread_cond_broadcast(&plugin->clients_cond);
+    pthread_mutex_unlock(&plugin->clients_mtx);
+}
+
+static int client_io_callback(enum neu_event_io_type type, int fd,
+                              void *usr_data)
+{
+    neu_plugin_t *plugin = (neu_plugin_t *) usr_data;
+
+    switch (type) {
+    case NEU_EVENT_IO_READ: {
+        struct modbus_client *client    = NULL;
+        uint8_t               buf[1024] = { 0 };
+
+        ssize_t ret =
+            neu_conn_tcp_server_recv(plugin->conn, fd, buf, sizeof(buf));
+        if (ret <= 0) {
+            neu_conn_tcp_server_close_client(plugin->conn, fd);
+            break;
+        }
+
+        pthread_mutex_lock(&plugin->clients_mtx);
+        HASH_FIND_INT(plugin->clients, &fd, client);
+        if (client != NULL) {
+            if (client->len + ret > (ssize_t) sizeof(client->buf)) {
+                plog_warn(plugin, "client %s buffer overflow, drop %hu bytes",
+                          client->peer, client->len);
+                client->len = 0;
+            }
+            memcpy(client->buf + client->len, buf, ret);
+            client->len += ret;
+            pthread_cond_broadcast(&plugin->clients_cond);
+        }
+        pthread_mutex_unlock(&plugin->clients_mtx);
+        break;
+    }
+    case NEU_EVENT_IO_CLOSED:
+    case NEU_EVENT_IO_HUP:
+        plog_notice(plugin, "client recv: %d, conn closed, fd: %d", type, fd);
+        neu_conn_tcp_server_close_client(plugin->conn, fd);
+        break;
+    }
+
+    return 0;
+}
+
+static void clients_add(neu_plugin_t *plugin, int fd)
+{
+    struct modbus_client *client = NULL;
+    struct modbus_client *tmp    = NULL;
+    int                   oldest = 0;
+    int64_t               ts     = 0;
+
+    pthread_mutex_lock(&plugin->clients_mtx);
+    if (plugin->n_client >= plugin->max_clients) {
+        HASH_ITER(hh, plugin->clients, client, tmp)
+        {
+            if (oldest == 0 || client->accept_ms < ts) {
+                oldest = client->fd;
+                ts     = client->accept_ms;
+            }
+        }
+    }
+    pthread_mutex_unlock(&plugin->clients_mtx);
+
+    if (oldest > 0) {
+        // a device that dials in again usually left a dead connection behind
+        plog_warn(plugin, "max clients: %hu, replace old client %d with %d",
+                  plugin->max_clients, oldest, fd);
+        neu_conn_tcp_server_close_client(plugin->conn, oldest);
+    }
+
+    client            = calloc(1, sizeof(struct modbus_client));
+    client->fd        = fd;
+    client->accept_ms = neu_time_ms();
+    client_peer(fd, client->peer, sizeof(client->peer));
+
+    neu_event_io_param_t param = {
+        .cb       = client_io_callback,
+        .fd       = fd,
+        .usr_data = (void *) plugin,
+    };
+
+    pthread_mutex_lock(&plugin->clients_mtx);
+    client->io = neu_event_add_io(plugin->events, param);
+    HASH_ADD_INT(plugin->clients, fd, client);
+    plugin->n_client += 1;
+    clients_link_state(plugin);
+    pthread_mutex_unlock(&plugin->clients_mtx);
+
+    plog_notice(plugin, "client %s join, fd: %d, clients: %hu", client->peer,
+                fd, plugin->n_client);
+}
+
+/*
+ * Pick the dial-in device a request goes to. Devices are either matched by
+ * peer address against the group name, or by the unit id they answered
+ * before. Unknown unit ids are tried on the clients in turn.
+ */
+static void clients_select(neu_plugin_t *plugin, const char *group,
+                           uint8_t slave_id)
+{
+    struct modbus_client *client = NULL;
+    struct modbus_client *tmp    = NULL;
+    int                   fd     = -1;
+
+    pthread_mutex_lock(&plugin->clients_mtx);
+    if (plugin->client_identify == MODBUS_CLIENT_BY_PEER && group != NULL) {
+        HASH_ITER(hh, plugin->clients, client, tmp)
+        {
+            if (strcmp(client->peer, group) == 0) {
+                fd = client->fd;
+                break;
+            }
+        }
+    } else if (plugin->n_client == 1) {
+        fd = plugin->clients->fd;
+    } else if (plugin->n_client > 1) {
+        HASH_FIND_INT(plugin->clients, &plugin->unit_client[slave_id], client);
+        if (client != NULL) {
+            fd = client->fd;
+        } else {
+            uint16_t i = 0;
+            uint16_t n = plugin->probe_index++ % plugin->n_client;
+
+            HASH_ITER(hh, plugin->clients, client, tmp)
+            {
+                if (i++ == n) {
+                    fd = client->fd;
+                    break;
+                }
+            }
+        }
+    }
+    pthread_mutex_unlock(&plugin->clients_mtx);
+
+    plugin->client_fd = fd;
+}
+
+static void clients_learn(neu_plugin_t *plugin, uint8_t slave_id)
+{
+    if (plugin->client_identify == MODBUS_CLIENT_BY_UNIT_ID &&
+        plugin->client_fd > 0) {
+        pthread_mutex_lock(&plugin->clients_mtx);
+        plugin->unit_client[slave_id] = plugin->client_fd;
+        pthread_mutex_unlock(&plugin->clients_mtx);
+    }
+}
+
+static void clients_clear(neu_plugin_t *plugin)
+{
+    struct modbus_client *client = NULL;
+
+    pthread_mutex_lock(&plugin->clients_mtx);
+    HASH_FIND_INT(plugin->clients, &plugin->client_fd, client);
+    if (client != NULL) {
+        client->len = 0;
+    }
+    pthread_mutex_unlock(&plugin->clients_mtx);
+}
+
+static ssize_t clients_recv(neu_plugin_t *plugin, uint8_t *buffer,
+                            size_t size, size_t need, uint32_t timeout)
+{
+    struct modbus_client *client   = NULL;
+    ssize_t               ret      = -1;
+    struct timespec       deadline = { 0 };
+
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += timeout / 1000;
+    deadline.tv_nsec += (timeout % 1000) * 1000 * 1000;
+    if (deadline.tv_nsec >= 1000 * 1000 * 1000) {
+        deadline.tv_sec += 1;
+        deadline.tv_nsec -= 1000 * 1000 * 1000;
+    }
+
+    pthread_mutex_lock(&plugin->clients_mtx);
+    while (true) {
+        HASH_FIND_INT(plugin->clients, &plugin->client_fd, client);
+        if (client == NULL) {
+            break;
+        }
+
+        if (client->len >= need ||
+            pthread_cond_timedwait(&plugin->clients_cond, &plugin->clients_mtx,
+                                   &deadline) != 0) {
+            HASH_FIND_INT(plugin->clients, &plugin->client_fd, client);
+            ret = client != NULL ? 0 : -1;
+            if (client != NULL && client->len > 0) {
+                ret = client->len < size ? client->len : (ssize_t) size;
+                memcpy(buffer, client->buf, ret);
+                memmove(client->buf, client->buf + ret, client->len - ret);
+                client->len -= ret;
+            }
+            break;
+        }
+    }
+    pthread_mutex_unlock(&plugin->clients_mtx);
+
+    return ret;
+}
+
+void modbus_clients_init(neu_plugin_t *plugin)
+{
+    pthread_condattr_t attr;
+
+    plugin->max_clients     = 1;
+    plugin->client_identify = MODBUS_CLIENT_BY_UNIT_ID;
+    pthread_mutex_init(&plugin->clients_mtx, NULL);
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&plugin->clients_cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+void modbus_clients_uninit(neu_plugin_t *plugin)
+{
+    clients_drop_all(plugin);
+    pthread_cond_destroy(&plugin->clients_cond);
+    pthread_mutex_destroy(&plugin->clients_mtx);
+}
+
 void modbus_conn_connected(void *data, int fd)
 {
     struct neu_plugin *plugin = (struct neu_plugin *) data;
@@ -58,7 +417,11 @@ void modbus_conn_connected(void *data, int fd)
 void modbus_conn_disconnected(void *data, int fd)
 {
     struct neu_plugin *plugin = (struct neu_plugin *) data;
-    (void) fd;
+
+    if (plugin->is_server) {
+        clients_drop(plugin, fd);
+        return;
+    }
 
     plugin->common.link_state = NEU_NODE_LINK_STATE_DISCONNECTED;
 }
@@ -81,6 +444,7 @@ void modbus_tcp_server_stop(void *data, int fd)
     (void) fd;
 
     neu_event_del_io(plugin->events, plugin->tcp_server_io);
+    clients_drop_all(plugin);
 }
 
 int modbus_tcp_server_io_callback(enum neu_event_io_type type, int fd,
@@ -92,7 +456,7 @@ int modbus_tcp_server_io_callback(enum neu_event_io_type type, int fd,
     case NEU_EVENT_IO_READ: {
         int client_fd = neu_conn_tcp_server_accept(plugin->conn);
         if (client_fd > 0) {
-            plugin->client_fd = client_fd;
+            clients_add(plugin, client_fd);
         }
 
         break;
@@ -101,6 +465,7 @@ int modbus_tcp_server_io_callback(enum neu_event_io_type type, int fd,
     case NEU_EVENT_IO_HUP:
         plog_warn(plugin, "tcp server recv: %d, conn closed, fd: %d", type, fd);
         neu_event_del_io(plugin->events, plugin->tcp_server_io);
+        clients_drop_all(plugin);
         neu_conn_disconnect(plugin->conn);
         break;
     }
@@ -110,16 +475,44 @@ int modbus_tcp_server_io_callback(enum neu_event_io_type type, int fd,
 
 int modbus_send_msg(void *ctx, uint16_t n_byte, uint8_t *bytes)
 {
-    neu_plugin_t *plugin = (neu_plugin_t *) ctx;
-    int           ret    = 0;
+    neu_plugin_t * plugin = (neu_plugin_t *) ctx;
+    modbus_lane_t *lane   = current_lane;
+    int            ret    = 0;
 
-    neu_conn_clear_recv_buffer(plugin->conn);
+    // responses of pipelined requests are still pending in the buffer
+    if (lane == NULL || lane->n_inflight == 0) {
+        neu_conn_clear_recv_buffer(req_conn(plugin));
+    }
 
     plog_send_protocol(plugin, bytes, n_byte);
 
+    if (plugin->frame_gap_us > 0) {
+        // keep the t3.5 silence after the last frame seen on the line
+        int64_t idle_us = (neu_time_ns() - plugin->last_frame_ns) / 1000;
+        if (idle_us >= 0 && idle_us < plugin->frame_gap_us) {
+            struct timespec t = {
+                .tv_sec  = 0,
+                .tv_nsec = (plugin->frame_gap_us - idle_us) * 1000,
+            };
+            nanosleep(&t, NULL);
+        }
+    }
+
     if (plugin->is_server) {
+        // sending with no client picked still restarts a stopped listener
+        clients_clear(plugin);
         ret = neu_conn_tcp_server_send(plugin->conn, plugin->client_fd, bytes,
                                        n_byte);
+    } else if (lane != NULL && lane->index > 0) {
+        // pool connections follow the address currently used by lane 0
+        if (plugin->backup && neu_conn_is_connected(lane->conn) == false &&
+            lane->current_backup != plugin->current_backup) {
+            lane->current_backup = plugin->current_backup;
+            lane->conn           = neu_conn_reconfig(
+                lane->conn,
+                lane->current_backup ? &plugin->param_backup : &plugin->param);
+        }
+        ret = neu_conn_send(lane->conn, bytes, n_byte);
     } else {
         if (plugin->backup && neu_conn_is_connected(plugin->conn) == false) {
             if (plugin->current_backup == false && plugin->first_attempt_done) {
@@ -129,6 +522,9 @@ int modbus_send_msg(void *ctx, uint16_t n_byte, uint8_t *bytes)
                 plugin->current_backup = true;
                 plugin->conn =
                     neu_conn_reconfig(plugin->conn, &plugin->param_backup);
+                if (lane != NULL) {
+                    lane->conn = plugin->conn;
+                }
             } else {
                 plog_notice(plugin, "switch to original ip:port %s:%hu",
                             plugin->param.params.tcp_client.ip,
@@ -136,6 +532,9 @@ int modbus_send_msg(void *ctx, uint16_t n_byte, uint8_t *bytes)
                 plugin->current_backup = false;
                 plugin->conn = neu_conn_reconfig(plugin->conn, &plugin->param);
                 plugin->first_attempt_done = true;
+                if (lane != NULL) {
+                    lane->conn = plugin->conn;
+                }
             }
         }
         ret = neu_conn_send(plugin->conn, bytes, n_byte);
@@ -148,15 +547,12 @@ int modbus_stack_read_retry(neu_plugin_t *plugin, struct modbus_group_data *gd,
                             uint16_t i, uint16_t j, uint16_t *response_size,
                             uint64_t *read_tms)
 {
-    struct timespec t3 = { .tv_sec = plugin->retry_interval / 1000,
-                           .tv_nsec =
-                               1000 * 1000 * (plugin->retry_interval % 1000) };
-    struct timespec t4 = { 0 };
-    nanosleep(&t3, &t4);
+    interval_sleep(plugin->retry_interval);
     plog_notice(plugin, "Resend read req. Times:%hu", j + 1);
     *read_tms = neu_time_ms();
     return modbus_stack_read(
-        plugin->stack, gd->cmd_sort->cmd[i].slave_id, gd->cmd_sort->cmd[i].area,
+        req_stack(plugin), gd->cmd_sort->cmd[i].slave_id,
+        gd->cmd_sort->cmd[i].area,
         gd->cmd_sort->cmd[i].start_address, gd->cmd_sort->cmd[i].n_register,
         response_size, false);
 }
@@ -184,7 +580,7 @@ void finalize_modbus_read_result(neu_plugin_t *            plugin,
         handle_modbus_error(plugin, gd, cmd_index, NEU_ERR_PLUGIN_DISCONNECTED,
                             "send message failed");
         *rtt = NEU_METRIC_LAST_RTT_MS_MAX;
-        neu_conn_disconnect(plugin->conn);
+        req_disconnect(plugin);
     } else if (ret_buf <= 0) {
         switch (ret_buf) {
         case 0:
@@ -199,7 +595,7 @@ void finalize_modbus_read_result(neu_plugin_t *            plugin,
                                 NEU_ERR_PLUGIN_PROTOCOL_DECODE_FAILURE,
                                 "modbus message error");
             *rtt = NEU_METRIC_LAST_RTT_MS_MAX;
-            neu_conn_disconnect(plugin->conn);
+            req_disconnect(plugin);
             break;
         case -2:
             handle_modbus_error(plugin, gd, cmd_index,
@@ -223,8 +619,13 @@ void check_modbus_read_result(neu_plugin_t *            plugin,
     uint16_t response_size = 0;
     uint64_t read_tms      = neu_time_ms();
 
+    if (plugin->is_server) {
+        clients_select(plugin, gd->group,
+                       gd->cmd_sort->cmd[cmd_index].slave_id);
+    }
+
     int ret_r = modbus_stack_read(
-        plugin->stack, gd->cmd_sort->cmd[cmd_index].slave_id,
+        req_stack(plugin), gd->cmd_sort->cmd[cmd_index].slave_id,
         gd->cmd_sort->cmd[cmd_index].area,
         gd->cmd_sort->cmd[cmd_index].start_address,
         gd->cmd_sort->cmd[cmd_index].n_register, &response_size, false);
@@ -260,6 +661,11 @@ void update_metrics_after_read(neu_plugin_t *plugin, int64_t rtt,
                                neu_conn_state_t *  state)
 {
     *state = neu_conn_state(plugin->conn);
+    for (uint16_t i = 1; plugin->lanes != NULL && i < plugin->n_lane; i++) {
+        neu_conn_state_t s = neu_conn_state(plugin->lanes[i].conn);
+        state->send_bytes += s.send_bytes;
+        state->recv_bytes += s.recv_bytes;
+    }
     neu_adapter_update_metric_cb_t update_metric =
         plugin->common.adapter_callbacks->update_metric;
     struct modbus_group_data *gd =
@@ -308,6 +714,401 @@ void set_skip_timer(uint8_t slave_id, uint32_t degrade_time)
     pthread_detach(timer_thread);
 }
 
+static void degrade_check(neu_plugin_t *plugin, uint8_t slave_id,
+                          bool *slave_err, bool *slave_err_record)
+{
+    if (plugin->degradation) {
+        if (slave_err[slave_id]) {
+            failed_cycles[slave_id]++;
+            slave_err_record[slave_id] = true;
+        }
+
+        if (failed_cycles[slave_id] >= plugin->degrade_cycle) {
+            skip[slave_id] = true;
+            plog_warn(plugin, "Skip slave %hhu", slave_id);
+            set_skip_timer(slave_id, plugin->degrade_time);
+        }
+    }
+}
+
+/*
+ * Read the commands whose slave is assigned to `lane`, one request at a time.
+ * Without a connection pool there is a single lane holding every slave.
+ */
+static void read_cmds(neu_plugin_t *plugin, struct modbus_group_data *gd,
+                      uint16_t lane, uint16_t n_lane, int64_t *rtt)
+{
+    bool slave_err_record[MAX_SLAVES] = { false };
+
+    for (uint16_t i = 0; i < gd->cmd_sort->n_cmd; i++) {
+        bool    slave_err[MAX_SLAVES] = { false };
+        uint8_t slave_id              = gd->cmd_sort->cmd[i].slave_id;
+
+        if (slave_id % n_lane != lane) {
+            continue;
+        }
+
+        req_set_cmd_idx(plugin, i);
+
+        if (slave_err_record[slave_id] == true) {
+            continue;
+        }
+
+        if (plugin->degradation == false || skip[slave_id] == false) {
+            check_modbus_read_result(plugin, gd, i, rtt, slave_err);
+        } else {
+            continue;
+        }
+
+        degrade_check(plugin, slave_id, slave_err, slave_err_record);
+        interval_sleep(plugin->interval);
+    }
+}
+
+static void fail_inflight(neu_plugin_t *plugin, struct modbus_group_data *gd,
+                          modbus_lane_t *lane, struct modbus_inflight *inflight,
+                          uint16_t n_inflight, int ret_r, int ret_buf,
+                          bool *slave_err_record)
+{
+    for (uint16_t k = 0; k < n_inflight; k++) {
+        bool    slave_err[MAX_SLAVES] = { false };
+        uint8_t slave_id = gd->cmd_sort->cmd[inflight[k].cmd_idx].slave_id;
+
+        lane->cmd_idx = inflight[k].cmd_idx;
+        finalize_modbus_read_result(plugin, gd, inflight[k].cmd_idx, ret_r,
+                                    ret_buf, inflight[k].read_tms, &lane->rtt,
+                                    slave_err);
+        degrade_check(plugin, slave_id, slave_err, slave_err_record);
+    }
+
+    lane->n_inflight = 0;
+}
+
+/*
+ * Keep up to `max_inflight` requests outstanding on the lane connection and
+ * match responses by transaction id. Requests of one slave are still sent in
+ * command order. Failed requests are reported without retry.
+ */
+static void read_cmds_pipelined(neu_plugin_t *            plugin,
+                                struct modbus_group_data *gd,
+                                modbus_lane_t *           lane)
+{
+    bool                    slave_err_record[MAX_SLAVES] = { false };
+    uint8_t                 recv_buf[512]                = { 0 };
+    uint16_t                n_inflight                   = 0;
+    uint16_t                i                            = 0;
+    struct modbus_inflight *inflight =
+        calloc(plugin->max_inflight, sizeof(struct modbus_inflight));
+
+    while (i < gd->cmd_sort->n_cmd || n_inflight > 0) {
+        while (i < gd->cmd_sort->n_cmd && n_inflight < plugin->max_inflight) {
+            modbus_read_cmd_t *cmd           = &gd->cmd_sort->cmd[i];
+            uint16_t           response_size = 0;
+            uint64_t           read_tms      = neu_time_ms();
+
+            if (cmd->slave_id % plugin->n_lane != lane->index ||
+                slave_err_record[cmd->slave_id] ||
+                (plugin->degradation && skip[cmd->slave_id])) {
+                i++;
+                continue;
+            }
+
+            lane->cmd_idx = i;
+            int ret_r =
+                modbus_stack_read(lane->stack, cmd->slave_id, cmd->area,
+                                  cmd->start_address, cmd->n_register,
+                                  &response_size, false);
+            if (ret_r <= 0) {
+                // connection is gone, outstanding responses are lost too
+                inflight[n_inflight].cmd_idx  = i;
+                inflight[n_inflight].read_tms = read_tms;
+                fail_inflight(plugin, gd, lane, inflight, n_inflight + 1,
+                              ret_r, 0, slave_err_record);
+                n_inflight = 0;
+            } else {
+                inflight[n_inflight].cmd_idx = i;
+                inflight[n_inflight].seq =
+                    modbus_stack_last_read_seq(lane->stack);
+                inflight[n_inflight].response_size = response_size;
+                inflight[n_inflight].read_tms      = read_tms;
+                n_inflight += 1;
+                lane->n_inflight = n_inflight;
+            }
+
+            i++;
+            interval_sleep(plugin->interval);
+        }
+
+        if (n_inflight == 0) {
+            continue;
+        }
+
+        int total_recv =
+            valid_modbus_tcp_response(plugin, recv_buf, sizeof(recv_buf));
+        if (total_recv <= 0) {
+            fail_inflight(plugin, gd, lane, inflight, n_inflight, 1, total_recv,
+                          slave_err_record);
+            n_inflight = 0;
+            continue;
+        }
+
+        struct modbus_header *header = (struct modbus_header *) recv_buf;
+        uint16_t              seq    = ntohs(header->seq);
+        uint16_t              k      = 0;
+
+        for (k = 0; k < n_inflight; k++) {
+            if (inflight[k].seq == seq) {
+                break;
+            }
+        }
+
+        if (k == n_inflight) {
+            plog_warn(plugin, "unexpected transaction id: %hu", seq);
+            fail_inflight(plugin, gd, lane, inflight, n_inflight, 1, -1,
+                          slave_err_record);
+            n_inflight = 0;
+            continue;
+        }
+
+        struct modbus_inflight done = inflight[k];
+        bool                   slave_err[MAX_SLAVES] = { false };
+        uint8_t slave_id = gd->cmd_sort->cmd[done.cmd_idx].slave_id;
+
+        inflight[k]      = inflight[n_inflight - 1];
+        n_inflight       = n_inflight - 1;
+        lane->n_inflight = n_inflight;
+        lane->cmd_idx    = done.cmd_idx;
+
+        int ret_buf = process_received_data(plugin, recv_buf, total_recv,
+                                            done.response_size, slave_id);
+        finalize_modbus_read_result(plugin, gd, done.cmd_idx, 1, ret_buf,
+                                    done.read_tms, &lane->rtt, slave_err);
+        degrade_check(plugin, slave_id, slave_err, slave_err_record);
+
+        if (ret_buf == -1) {
+            // the connection was dropped on the decode error, the requests
+            // sent were answered on a desynchronised stream
+            fail_inflight(plugin, gd, lane, inflight, n_inflight, 1, -1,
+                          slave_err_record);
+            n_inflight = 0;
+        }
+    }
+
+    lane->n_inflight = 0;
+    free(inflight);
+}
+
+static void *lane_read_cmds(void *arg)
+{
+    modbus_lane_t *           lane   = (modbus_lane_t *) arg;
+    neu_plugin_t *            plugin = lane->plugin;
+    struct modbus_group_data *gd =
+        (struct modbus_group_data *) lane->group_data;
+
+    current_lane = lane;
+    if (plugin->max_inflight > 1) {
+        read_cmds_pipelined(plugin, gd, lane);
+    } else {
+        read_cmds(plugin, gd, lane->index, plugin->n_lane, &lane->rtt);
+    }
+    current_lane = NULL;
+
+    return NULL;
+}
+
+static void *lane_worker(void *arg)
+{
+    modbus_lane_t *lane   = (modbus_lane_t *) arg;
+    neu_plugin_t * plugin = lane->plugin;
+    uint32_t       tick   = 0; // pool_tick is 0 until the workers are up
+
+    pthread_mutex_lock(&plugin->pool_mtx);
+    while (true) {
+        while (!plugin->pool_quit && tick == plugin->pool_tick) {
+            pthread_cond_wait(&plugin->pool_cond, &plugin->pool_mtx);
+        }
+        if (plugin->pool_quit) {
+            break;
+        }
+        tick = plugin->pool_tick;
+        pthread_mutex_unlock(&plugin->pool_mtx);
+
+        lane_read_cmds(lane);
+
+        pthread_mutex_lock(&plugin->pool_mtx);
+        plugin->pool_busy -= 1;
+        if (plugin->pool_busy == 0) {
+            pthread_cond_signal(&plugin->pool_done_cond);
+        }
+    }
+    pthread_mutex_unlock(&plugin->pool_mtx);
+
+    return NULL;
+}
+
+/*
+ * Slaves are spread over the pool by slave id, so different slaves are read
+ * concurrently while the commands of one slave keep their order. Lane 0 runs
+ * on the calling thread, the others on their workers.
+ */
+static int64_t read_cmds_by_pool(neu_plugin_t *            plugin,
+                                 struct modbus_group_data *gd)
+{
+    int64_t rtt = NEU_METRIC_LAST_RTT_MS_MAX;
+
+    plugin->lanes[0].conn = plugin->conn;
+    for (uint16_t i = 0; i < plugin->n_lane; i++) {
+        plugin->lanes[i].group_data = gd;
+        plugin->lanes[i].rtt        = NEU_METRIC_LAST_RTT_MS_MAX;
+    }
+
+    pthread_mutex_lock(&plugin->pool_mtx);
+    plugin->pool_busy = 0;
+    for (uint16_t i = 1; i < plugin->n_lane; i++) {
+        plugin->pool_busy += plugin->lanes[i].started ? 1 : 0;
+    }
+    plugin->pool_tick += 1;
+    pthread_cond_broadcast(&plugin->pool_cond);
+    pthread_mutex_unlock(&plugin->pool_mtx);
+
+    lane_read_cmds(&plugin->lanes[0]);
+    for (uint16_t i = 1; i < plugin->n_lane; i++) {
+        if (!plugin->lanes[i].started) {
+            lane_read_cmds(&plugin->lanes[i]);
+        }
+    }
+
+    pthread_mutex_lock(&plugin->pool_mtx);
+    while (plugin->pool_busy > 0) {
+        pthread_cond_wait(&plugin->pool_done_cond, &plugin->pool_mtx);
+    }
+    pthread_mutex_unlock(&plugin->pool_mtx);
+
+    for (uint16_t i = 0; i < plugin->n_lane; i++) {
+        if (plugin->lanes[i].rtt == NEU_METRIC_LAST_RTT_MS_MAX) {
+            continue;
+        }
+        if (rtt == NEU_METRIC_LAST_RTT_MS_MAX || plugin->lanes[i].rtt > rtt) {
+            rtt = plugin->lanes[i].rtt;
+        }
+    }
+
+    return rtt;
+}
+
+static void lane_conn_connected(void *data, int fd)
+{
+    plog_notice((neu_plugin_t *) data, "pool connection connected, fd: %d",
+                fd);
+}
+
+static void lane_conn_disconnected(void *data, int fd)
+{
+    plog_notice((neu_plugin_t *) data, "pool connection disconnected, fd: %d",
+                fd);
+}
+
+int modbus_conn_pool_setup(neu_plugin_t *plugin, uint16_t n_lane,
+                           uint16_t max_inflight)
+{
+    modbus_conn_pool_free(plugin);
+
+    if (n_lane == 0) {
+        n_lane = 1;
+    } else if (n_lane > MODBUS_MAX_LANE) {
+        n_lane = MODBUS_MAX_LANE;
+    }
+    if (max_inflight == 0) {
+        max_inflight = 1;
+    }
+
+    plugin->n_lane       = n_lane;
+    plugin->max_inflight = max_inflight;
+    modbus_stack_set_window(plugin->stack, max_inflight);
+
+    if (n_lane == 1 && max_inflight == 1) {
+        return 0;
+    }
+
+    plugin->lanes     = calloc(n_lane, sizeof(modbus_lane_t));
+    plugin->pool_tick = 0;
+    plugin->pool_busy = 0;
+    plugin->pool_quit = false;
+    pthread_mutex_init(&plugin->pool_mtx, NULL);
+    pthread_cond_init(&plugin->pool_cond, NULL);
+    pthread_cond_init(&plugin->pool_done_cond, NULL);
+    for (uint16_t i = 0; i < n_lane; i++) {
+        modbus_lane_t *lane = &plugin->lanes[i];
+
+        lane->plugin = plugin;
+        lane->index  = i;
+        if (i == 0) {
+            lane->conn  = plugin->conn;
+            lane->stack = plugin->stack;
+            continue;
+        }
+
+        lane->current_backup = plugin->current_backup;
+        lane->conn           = neu_conn_new(
+            plugin->current_backup ? &plugin->param_backup : &plugin->param,
+            (void *) plugin, lane_conn_connected, lane_conn_disconnected);
+        lane->stack = modbus_stack_create((void *) plugin, MODBUS_PROTOCOL_TCP,
+                                          modbus_send_msg, modbus_value_handle,
+                                          modbus_write_resp);
+        modbus_stack_set_window(lane->stack, max_inflight);
+
+        lane->started =
+            pthread_create(&lane->thread, NULL, lane_worker, lane) == 0;
+        if (!lane->started) {
+            plog_warn(plugin, "start lane %hu thread fail, read inline", i);
+        }
+    }
+
+    plog_notice(plugin, "connection pool: %hu connections, max inflight: %hu",
+                n_lane, max_inflight);
+    return 0;
+}
+
+void modbus_conn_pool_free(neu_plugin_t *plugin)
+{
+    if (plugin->lanes == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&plugin->pool_mtx);
+    plugin->pool_quit = true;
+    pthread_cond_broadcast(&plugin->pool_cond);
+    pthread_mutex_unlock(&plugin->pool_mtx);
+
+    for (uint16_t i = 1; i < plugin->n_lane; i++) {
+        if (plugin->lanes[i].started) {
+            pthread_join(plugin->lanes[i].thread, NULL);
+        }
+        neu_conn_destory(plugin->lanes[i].conn);
+        modbus_stack_destroy(plugin->lanes[i].stack);
+    }
+
+    pthread_cond_destroy(&plugin->pool_done_cond);
+    pthread_cond_destroy(&plugin->pool_cond);
+    pthread_mutex_destroy(&plugin->pool_mtx);
+    free(plugin->lanes);
+    plugin->lanes = NULL;
+}
+
+void modbus_conn_pool_start(neu_plugin_t *plugin)
+{
+    for (uint16_t i = 1; plugin->lanes != NULL && i < plugin->n_lane; i++) {
+        neu_conn_start(plugin->lanes[i].conn);
+    }
+}
+
+void modbus_conn_pool_stop(neu_plugin_t *plugin)
+{
+    for (uint16_t i = 1; plugin->lanes != NULL && i < plugin->n_lane; i++) {
+        neu_conn_stop(plugin->lanes[i].conn);
+    }
+}
+
 int modbus_group_timer(neu_plugin_t *plugin, neu_plugin_group_t *group,
                        uint16_t max_byte)
 {
@@ -347,43 +1148,17 @@ int modbus_group_timer(neu_plugin_t *plugin, neu_plugin_group_t *group,
     gd                        = (struct modbus_group_data *) group->user_data;
     plugin->plugin_group_data = gd;
 
-    bool slave_err_record[MAX_SLAVES] = { false };
-
-    for (uint16_t i = 0; i < gd->cmd_sort->n_cmd; i++) {
-        bool    slave_err[MAX_SLAVES] = { false };
-        uint8_t slave_id              = gd->cmd_sort->cmd[i].slave_id;
-        plugin->cmd_idx               = i;
-
-        if (slave_err_record[slave_id] == true) {
-            continue;
-        }
-
-        if (plugin->degradation == false || skip[slave_id] == false) {
-            check_modbus_read_result(plugin, gd, i, &rtt, slave_err);
-        } else {
-            continue;
-        }
-
-        if (plugin->degradation) {
-            if (slave_err[slave_id]) {
-                failed_cycles[slave_id]++;
-                slave_err_record[slave_id] = true;
-            }
-
-            if (failed_cycles[slave_id] >= plugin->degrade_cycle) {
-                skip[slave_id] = true;
-                plog_warn(plugin, "Skip slave %hhu", slave_id);
-                set_skip_timer(slave_id, plugin->degrade_time);
-            }
-        }
-
-        if (plugin->interval > 0) {
-            struct timespec t1 = { .tv_sec  = plugin->interval / 1000,
-                                   .tv_nsec = 1000 * 1000 *
-                                       (plugin->interval % 1000) };
-            struct timespec t2 = { 0 };
-            nanosleep(&t1, &t2);
-        }
+    if (plugin->n_lane > 1 && plugin->lanes != NULL) {
+        rtt = read_cmds_by_pool(plugin, gd);
+    } else if (plugin->lanes != NULL) {
+        rtt = NEU_METRIC_LAST_RTT_MS_MAX;
+        plugin->lanes[0].conn       = plugin->conn;
+        plugin->lanes[0].group_data = gd;
+        plugin->lanes[0].rtt        = rtt;
+        lane_read_cmds(&plugin->lanes[0]);
+        rtt = plugin->lanes[0].rtt;
+    } else {
+        read_cmds(plugin, gd, 0, 1, &rtt);
     }
 
     update_metrics_after_read(plugin, rtt, group, &state);
@@ -393,11 +1168,20 @@ int modbus_group_timer(neu_plugin_t *plugin, neu_plugin_group_t *group,
 int modbus_value_handle(void *ctx, uint8_t slave_id, uint16_t n_byte,
                         uint8_t *bytes, int error, void *trace)
 {
-    neu_plugin_t *            plugin = (neu_plugin_t *) ctx;
-    struct modbus_group_data *gd =
-        (struct modbus_group_data *) plugin->plugin_group_data;
-    uint16_t start_address = gd->cmd_sort->cmd[plugin->cmd_idx].start_address;
-    uint16_t n_register    = gd->cmd_sort->cmd[plugin->cmd_idx].n_register;
+    neu_plugin_t *            plugin  = (neu_plugin_t *) ctx;
+    struct modbus_group_data *gd      = NULL;
+    uint16_t                  cmd_idx = 0;
+
+    if (current_lane != NULL) {
+        gd      = (struct modbus_group_data *) current_lane->group_data;
+        cmd_idx = current_lane->cmd_idx;
+    } else {
+        gd      = (struct modbus_group_data *) plugin->plugin_group_data;
+        cmd_idx = plugin->cmd_idx;
+    }
+
+    uint16_t start_address = gd->cmd_sort->cmd[cmd_idx].start_address;
+    uint16_t n_register    = gd->cmd_sort->cmd[cmd_idx].n_register;
 
     if (error == NEU_ERR_PLUGIN_DISCONNECTED) {
         neu_dvalue_t dvalue = { 0 };
@@ -408,8 +1192,8 @@ int modbus_value_handle(void *ctx, uint8_t slave_id, uint16_t n_byte,
             plugin->common.adapter, gd->group, NULL, dvalue);
         return 0;
     } else if (error != NEU_ERR_SUCCESS) {
-        utarray_foreach(gd->cmd_sort->cmd[plugin->cmd_idx].tags,
-                        modbus_point_t **, p_tag)
+        utarray_foreach(gd->cmd_sort->cmd[cmd_idx].tags, modbus_point_t **,
+                        p_tag)
         {
             neu_dvalue_t dvalue = { 0 };
             dvalue.type         = NEU_TYPE_ERROR;
@@ -420,8 +1204,7 @@ int modbus_value_handle(void *ctx, uint8_t slave_id, uint16_t n_byte,
         return 0;
     }
 
-    utarray_foreach(gd->cmd_sort->cmd[plugin->cmd_idx].tags, modbus_point_t **,
-                    p_tag)
+    utarray_foreach(gd->cmd_sort->cmd[cmd_idx].tags, modbus_point_t **, p_tag)
     {
         neu_dvalue_t dvalue = { 0 };
 
@@ -675,6 +1458,10 @@ int modbus_test_read_tag(neu_plugin_t *plugin, void *req, neu_datatag_t tag)
         return 0;
     }
 
+    if (plugin->is_server) {
+        clients_select(plugin, NULL, point.slave_id);
+    }
+
     uint16_t response_size = 0;
     int      ret = modbus_stack_read(plugin->stack, point.slave_id, point.area,
                                 point.start_address, point.n_register,
@@ -760,11 +1547,34 @@ static uint8_t convert_value(neu_plugin_t *plugin, neu_value_u *value,
     return n_byte;
 }
 
+static const char *write_req_group(void *req)
+{
+    neu_reqresp_head_t *head = (neu_reqresp_head_t *) req;
+
+    switch (head->type) {
+    case NEU_REQ_WRITE_TAG:
+        return ((neu_req_write_tag_t *) &head[1])->group;
+    case NEU_REQ_WRITE_TAGS:
+        return ((neu_req_write_tags_t *) &head[1])->group;
+    case NEU_REQ_WRITE_GTAGS: {
+        neu_req_write_gtags_t *cmd = (neu_req_write_gtags_t *) &head[1];
+        return cmd->n_group > 0 ? cmd->groups[0].group : NULL;
+    }
+    default:
+        return NULL;
+    }
+}
+
 static int write_modbus_point(neu_plugin_t *plugin, void *req,
                               modbus_point_t *point, neu_value_u value,
                               uint8_t n_byte)
 {
     uint16_t response_size = 0;
+
+    if (plugin->is_server) {
+        clients_select(plugin, write_req_group(req), point->slave_id);
+    }
+
     int      ret           = modbus_stack_write(
         plugin->stack, req, point->slave_id, point->area, point->start_address,
         point->n_register, value.bytes.bytes, n_byte, &response_size, true);
@@ -781,16 +1591,94 @@ static int write_modbus_points(neu_plugin_t *      plugin,
 {
     uint16_t response_size = 0;
 
+    if (plugin->is_server) {
+        clients_select(plugin, write_req_group(req), write_cmd->slave_id);
+    }
+
     int ret = modbus_stack_write(plugin->stack, req, write_cmd->slave_id,
                                  write_cmd->area, write_cmd->start_address,
                                  write_cmd->n_register, write_cmd->bytes,
                                  write_cmd->n_byte, &response_size, false);
+    if (ret <= 0) {
+        return NEU_ERR_PLUGIN_DISCONNECTED;
+    }
 
-    if (ret > 0) {
-        process_protocol_buf(plugin, write_cmd->slave_id, response_size);
+    ret = process_protocol_buf(plugin, write_cmd->slave_id, response_size);
+    switch (ret) {
+    case 0:
+        plog_warn(plugin, "write req not responded, %hhu!%hu, n: %hu",
+                  write_cmd->slave_id, write_cmd->start_address,
+                  write_cmd->n_register);
+        return NEU_ERR_PLUGIN_DEVICE_NOT_RESPONSE;
+    case -1:
+        // the stream is out of step after an undecodable response
+        plog_warn(plugin, "write resp undecodable, %hhu!%hu, n: %hu",
+                  write_cmd->slave_id, write_cmd->start_address,
+                  write_cmd->n_register);
+        req_disconnect(plugin);
+        return NEU_ERR_PLUGIN_DISCONNECTED;
+    case -2:
+        plog_warn(plugin, "write req rejected by device, %hhu!%hu, n: %hu",
+                  write_cmd->slave_id, write_cmd->start_address,
+                  write_cmd->n_register);
+        return NEU_ERR_PLUGIN_WRITE_FAILURE;
+    default:
+        return ret < 0 ? NEU_ERR_PLUGIN_DISCONNECTED : NEU_ERR_SUCCESS;
     }
+}
 
-    return ret;
+static void write_tag_error(UT_array *errors, modbus_point_t *point, int error)
+{
+    neu_resp_write_tag_error_t e = { .error = error };
+
+    strncpy(e.tag, point->name, sizeof(e.tag) - 1);
+    utarray_push_back(errors, &e);
+}
+
+/*
+ * The device rejected a merged FC16/FC15 request. Write the tags of the
+ * command one at a time, so the accepted tags still reach the device and the
+ * rejected ones are reported by name in `errors`.
+ */
+static int write_modbus_points_split(neu_plugin_t *      plugin,
+                                     modbus_write_cmd_t *write_cmd, void *req,
+                                     UT_array *errors)
+{
+    int error = NEU_ERR_SUCCESS;
+
+    utarray_foreach(write_cmd->tags, modbus_point_write_t **, tag)
+    {
+        modbus_point_t *   point  = &(*tag)->point;
+        uint16_t           offset = point->start_address;
+        uint8_t            bit    = 0;
+        modbus_write_cmd_t cmd    = {
+            .slave_id      = write_cmd->slave_id,
+            .area          = write_cmd->area,
+            .start_address = point->start_address,
+            .n_register    = point->n_register,
+        };
+
+        offset -= write_cmd->start_address;
+        if (write_cmd->area == MODBUS_AREA_COIL) {
+            bit        = (write_cmd->bytes[offset / 8] >> offset % 8) & 0x1;
+            cmd.n_byte = sizeof(bit);
+            cmd.bytes  = &bit;
+        } else {
+            cmd.n_byte = point->n_register * 2;
+            cmd.bytes  = write_cmd->bytes + 2 * offset;
+        }
+
+        int ret = write_modbus_points(plugin, &cmd, req);
+        if (ret != NEU_ERR_SUCCESS) {
+            plog_warn(plugin, "write tag %s fail, error: %d", point->name, ret);
+            write_tag_error(errors, point, ret);
+            error = ret;
+        }
+
+        interval_sleep(plugin->interval);
+    }
+
+    return error;
 }
 
 int modbus_write_tag(neu_plugin_t *plugin, void *req, neu_datatag_t *tag,
@@ -806,11 +1694,13 @@ int modbus_write_tag(neu_plugin_t *plugin, void *req, neu_datatag_t *tag,
 
 int modbus_write_tags(neu_plugin_t *plugin, void *req, UT_array *tags)
 {
-    struct modbus_write_tags_data *gtags = NULL;
-    int                            ret   = 0;
-    int                            rv    = 0;
+    struct modbus_write_tags_data *gtags  = NULL;
+    UT_array *                     errors = NULL;
+    int                            ret    = 0;
+    int                            error  = NEU_ERR_SUCCESS;
 
     gtags = calloc(1, sizeof(struct modbus_write_tags_data));
+    utarray_new(errors, neu_resp_write_tag_error_icd());
 
     utarray_new(gtags->tags, &ut_ptr_icd);
     utarray_foreach(tags, neu_plugin_tag_value_t *, tag)
@@ -822,27 +1712,30 @@ int modbus_write_tags(neu_plugin_t *plugin, void *req, UT_array *tags)
         utarray_push_back(gtags->tags, &p);
     }
     gtags->cmd_sort = modbus_write_tags_sort(gtags->tags, plugin->endianess);
+    plog_debug(plugin, "write %u tags with %hu requests",
+               utarray_len(gtags->tags), gtags->cmd_sort->n_cmd);
     for (uint16_t i = 0; i < gtags->cmd_sort->n_cmd; i++) {
-        ret = write_modbus_points(plugin, &gtags->cmd_sort->cmd[i], req);
-        if (ret <= 0) {
-            rv = 1;
+        modbus_write_cmd_t *cmd = &gtags->cmd_sort->cmd[i];
+
+        ret = write_modbus_points(plugin, cmd, req);
+        interval_sleep(plugin->interval);
+
+        if (ret == NEU_ERR_PLUGIN_WRITE_FAILURE && utarray_len(cmd->tags) > 1) {
+            ret = write_modbus_points_split(plugin, cmd, req, errors);
+        } else if (ret != NEU_ERR_SUCCESS) {
+            utarray_foreach(cmd->tags, modbus_point_write_t **, tag)
+            {
+                write_tag_error(errors, &(*tag)->point, ret);
+            }
         }
-        if (plugin->interval > 0) {
-            struct timespec t1 = { .tv_sec  = plugin->interval / 1000,
-                                   .tv_nsec = 1000 * 1000 *
-                                       (plugin->interval % 1000) };
-            struct timespec t2 = { 0 };
-            nanosleep(&t1, &t2);
+        if (ret != NEU_ERR_SUCCESS) {
+            error = ret;
         }
     }
 
-    if (rv == 0) {
-        plugin->common.adapter_callbacks->driver.write_response(
-            plugin->common.adapter, req, NEU_ERR_SUCCESS);
-    } else {
-        plugin->common.adapter_callbacks->driver.write_response(
-            plugin->common.adapter, req, NEU_ERR_PLUGIN_DISCONNECTED);
-    }
+    plugin->common.adapter_callbacks->driver.write_tags_response(
+        plugin->common.adapter, req, error, errors);
+    utarray_free(errors);
 
     for (uint16_t i = 0; i < gtags->cmd_sort->n_cmd; i++) {
         utarray_free(gtags->cmd_sort->cmd[i].tags);
@@ -853,7 +1746,7 @@ int modbus_write_tags(neu_plugin_t *plugin, void *req, UT_array *tags)
     utarray_foreach(gtags->tags, modbus_point_write_t **, tag) { free(*tag); }
     utarray_free(gtags->tags);
     free(gtags);
-    return ret;
+    return error;
 }
 
 int modbus_write_resp(void *ctx, void *req, int error)
@@ -882,13 +1775,66 @@ static void plugin_group_free(neu_plugin_group_t *pgp)
 static ssize_t recv_data(neu_plugin_t *plugin, uint8_t *buffer, size_t size)
 {
     if (plugin->is_server) {
-        return neu_conn_tcp_server_recv(plugin->conn, plugin->client_fd, buffer,
-                                        size);
+        return clients_recv(plugin, buffer, size, size, plugin->timeout);
+    } else {
+        return neu_conn_recv(req_conn(plugin), buffer, size);
+    }
+}
+
+static ssize_t recv_data_wait(neu_plugin_t *plugin, uint8_t *buffer,
+                              size_t size, uint32_t timeout)
+{
+    if (plugin->is_server) {
+        return clients_recv(plugin, buffer, size, 1, timeout);
     } else {
-        return neu_conn_recv(plugin->conn, buffer, size);
+        return neu_conn_recv_wait(req_conn(plugin), buffer, size, timeout);
     }
 }
 
+/*
+ * Collect a modbus rtu response as its bytes arrive. It ends as soon as a
+ * whole frame with a valid crc is in, so exception responses shorter than
+ * `size` return at once. Bytes that can not form a valid response end it
+ * after a t3.5 silence on serial lines instead of the full timeout.
+ */
+static ssize_t recv_rtu_frame(neu_plugin_t *plugin, uint8_t *buf,
+                              uint16_t size)
+{
+    int64_t  deadline = neu_time_ms() + plugin->timeout;
+    uint32_t gap_ms   = (plugin->frame_gap_us + 999) / 1000;
+    uint16_t len      = 0;
+    int      check    = 0;
+
+    while (len < size) {
+        int64_t  now  = neu_time_ms();
+        uint32_t wait = deadline > now ? deadline - now : 0;
+
+        if (check < 0 && gap_ms > 0) {
+            wait = gap_ms;
+        }
+
+        ssize_t ret = recv_data_wait(plugin, buf + len, size - len, wait);
+        if (ret < 0) {
+            return len > 0 ? len : -1;
+        }
+        if (ret == 0) {
+            break;
+        }
+
+        len += ret;
+        check = modbus_rtu_frame_check(buf, len);
+        if (check > 0) {
+            break;
+        }
+    }
+
+    if (len > 0) {
+        plugin->last_frame_ns = neu_time_ns();
+    }
+
+    return len;
+}
+
 static int process_received_data(neu_plugin_t *plugin, uint8_t *recv_buf,
                                  ssize_t recv_size, uint16_t expected_size,
                                  uint8_t slave_id)
@@ -898,11 +1844,17 @@ static int process_received_data(neu_plugin_t *plugin, uint8_t *recv_buf,
     }
     neu_protocol_unpack_buf_t pbuf = { 0 };
     neu_protocol_unpack_buf_init(&pbuf, recv_buf, recv_size);
-    int ret = modbus_stack_recv(plugin->stack, slave_id, &pbuf);
+    int ret = modbus_stack_recv(req_stack(plugin), slave_id, &pbuf);
     if (ret == MODBUS_DEVICE_ERR) {
         return -2;
     }
-    return recv_size == expected_size ? ret : -1;
+    if (recv_size != expected_size) {
+        return -1;
+    }
+    if (ret > 0 && plugin->is_server) {
+        clients_learn(plugin, slave_id);
+    }
+    return ret;
 }
 
 static int process_received_data_test(neu_plugin_t *plugin, uint8_t *recv_buf,
@@ -973,10 +1925,17 @@ static int process_modbus_tcp_test(neu_plugin_t *plugin, uint8_t *recv_buf,
 static int process_modbus_rtu(neu_plugin_t *plugin, uint8_t *recv_buf,
                               uint16_t response_size, uint8_t slave_id)
 {
-    ssize_t ret = recv_data(plugin, recv_buf, response_size);
+    ssize_t ret = recv_rtu_frame(plugin, recv_buf, response_size);
     if (ret == 0 || ret == -1) {
         return 0;
     }
+
+    if (modbus_rtu_frame_check(recv_buf, ret) != ret) {
+        plog_recv_protocol(plugin, recv_buf, ret);
+        plog_warn(plugin, "invalid modbus rtu frame, len: %zd", ret);
+        return -1;
+    }
+
     return process_received_data(plugin, recv_buf, ret, response_size,
                                  slave_id);
 }
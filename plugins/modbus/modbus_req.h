@@ -19,10 +19,38 @@
 #ifndef _NEU_M_PLUGIN_MODBUS_REQ_H_
 #define _NEU_M_PLUGIN_MODBUS_REQ_H_
 
+#include <pthread.h>
+
 #include <neuron.h>
 
 #include "modbus_stack.h"
 
+#define MODBUS_MAX_LANE 16
+#define MODBUS_MAX_CLIENT 1024
+
+typedef enum modbus_client_identify {
+    MODBUS_CLIENT_BY_UNIT_ID = 0,
+    MODBUS_CLIENT_BY_PEER    = 1,
+} modbus_client_identify_e;
+
+struct modbus_client;
+
+typedef struct modbus_lane {
+    neu_plugin_t *  plugin;
+    uint16_t        index;
+    neu_conn_t *    conn;
+    modbus_stack_t *stack;
+    bool            current_backup;
+
+    void *   group_data;
+    uint16_t cmd_idx;
+    uint16_t n_inflight;
+    int64_t  rtt;
+
+    pthread_t thread;
+    bool      started;
+} modbus_lane_t;
+
 struct neu_plugin {
     neu_plugin_common_t common;
 
@@ -44,6 +72,8 @@ struct neu_plugin {
 
     uint16_t interval;
     uint16_t retry_interval;
+    uint32_t frame_gap_us;
+    int64_t  last_frame_ns;
     uint16_t max_retries;
     uint16_t check_header;
     bool     degradation;
@@ -55,6 +85,30 @@ struct neu_plugin {
     bool             first_attempt_done;
     neu_conn_param_t param;
     neu_conn_param_t param_backup;
+
+    // connection pool, lane 0 always shares conn and stack above
+    uint16_t       n_lane;
+    uint16_t       max_inflight;
+    modbus_lane_t *lanes;
+
+    // the other lanes run on workers woken once per read tick
+    pthread_mutex_t pool_mtx;
+    pthread_cond_t  pool_cond;
+    pthread_cond_t  pool_done_cond;
+    uint32_t        pool_tick;
+    uint16_t        pool_busy;
+    bool            pool_quit;
+
+    // dial-in devices in server mode, the node event loop fills their buffers
+    uint16_t                 max_clients;
+    modbus_client_identify_e client_identify;
+    uint32_t                 timeout;
+    struct modbus_client *   clients;
+    uint16_t                 n_client;
+    int                      unit_client[256];
+    uint16_t                 probe_index;
+    pthread_mutex_t          clients_mtx;
+    pthread_cond_t           clients_cond;
 };
 
 void modbus_conn_connected(void *data, int fd);
@@ -64,6 +118,15 @@ void modbus_tcp_server_stop(void *data, int fd);
 int  modbus_tcp_server_io_callback(enum neu_event_io_type type, int fd,
                                    void *usr_data);
 
+void modbus_clients_init(neu_plugin_t *plugin);
+void modbus_clients_uninit(neu_plugin_t *plugin);
+
+int  modbus_conn_pool_setup(neu_plugin_t *plugin, uint16_t n_lane,
+                           uint16_t max_inflight);
+void modbus_conn_pool_free(neu_plugin_t *plugin);
+void modbus_conn_pool_start(neu_plugin_t *plugin);
+void modbus_conn_pool_stop(neu_plugin_t *plugin);
+
 int modbus_group_timer(neu_plugin_t *plugin, neu_plugin_group_t *group,
                        uint16_t max_byte);
 int modbus_send_msg(void *ctx, uint16_t n_byte, uint8_t *bytes);
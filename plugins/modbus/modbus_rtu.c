@@ -82,6 +82,24 @@ const neu_plugin_module_t neu_plugin_module = {
     .single    = false,
 };
 
+/*
+ * t3.5 of a character of 11 bits, the modbus serial line specification fixes
+ * it to 1750us above 19200 baud.
+ */
+static uint32_t frame_gap_us(int64_t baud)
+{
+    // in the order of neu_conn_tty_baud_e
+    static const uint32_t rates[] = { 115200, 57600, 38400, 19200, 9600,
+                                      4800,   2400,  1800,  1200,  600,
+                                      300,    200,   150 };
+
+    if (baud < 0 || baud > NEU_CONN_TTY_BAUD_150 || rates[baud] > 19200) {
+        return 1750;
+    }
+
+    return 3.5 * 11 * 1000 * 1000 / rates[baud] + 1;
+}
+
 static neu_plugin_t *driver_open(void)
 {
     neu_plugin_t *plugin = calloc(1, sizeof(neu_plugin_t));
@@ -106,6 +124,7 @@ static int driver_init(neu_plugin_t *plugin, bool load)
     plugin->stack    = modbus_stack_create((void *) plugin, MODBUS_PROTOCOL_RTU,
                                         modbus_send_msg, modbus_value_handle,
                                         modbus_write_resp);
+    modbus_clients_init(plugin);
 
     plog_notice(plugin, "%s init success", plugin->common.name);
     return 0;
@@ -122,6 +141,7 @@ static int driver_uninit(neu_plugin_t *plugin)
         modbus_stack_destroy(plugin->stack);
     }
 
+    modbus_clients_uninit(plugin);
     neu_event_close(plugin->events);
 
     plog_notice(plugin, "%s uninit success", plugin->common.name);
@@ -240,6 +260,7 @@ static int driver_config(neu_plugin_t *plugin, const char *config)
     }
 
     param.log              = plugin->common.log;
+    plugin->timeout        = timeout.v.val_int;
     plugin->max_retries    = max_retries.v.val_int;
     plugin->retry_interval = retry_interval.v.val_int;
     plugin->degradation    = degradation.v.val_int;
@@ -258,21 +279,23 @@ static int driver_config(neu_plugin_t *plugin, const char *config)
         param.params.tty_client.stop    = stop.v.val_int;
         param.params.tty_client.timeout = timeout.v.val_int;
 
-        plugin->is_serial = true;
+        plugin->is_serial    = true;
+        plugin->frame_gap_us = frame_gap_us(baud.v.val_int);
         plog_notice(plugin,
                     "config: device: %s, baud: %" PRId64 ", data: %" PRId64
                     ", parity: %" PRId64 ", stop: %" PRId64 "",
                     device.v.val_str, baud.v.val_int, data.v.val_int,
                     parity.v.val_int, stop.v.val_int);
     } else {
+        plugin->frame_gap_us = 0;
         if (mode.v.val_int == 1) {
             param.type                           = NEU_CONN_TCP_SERVER;
             param.params.tcp_server.ip           = host.v.val_str;
             param.params.tcp_server.port         = port.v.val_int;
             param.params.tcp_server.start_listen = modbus_tcp_server_listen;
             param.params.tcp_server.stop_listen  = modbus_tcp_server_stop;
-            param.params.tcp_server.timeout      = timeout.v.val_int;
-            param.params.tcp_server.max_link     = 1;
+            param.params.tcp_server.timeout      = 0;
+            param.params.tcp_server.max_link     = plugin->max_clients + 1;
             plugin->is_server                    = true;
         }
         if (mode.v.val_int == 0) {
@@ -34,6 +34,7 @@ struct modbus_stack {
     modbus_protocol_e protocol;
     uint16_t          read_seq;
     uint16_t          write_seq;
+    uint16_t          window;
 
     uint8_t *buf;
     uint16_t buf_size;
@@ -53,8 +54,10 @@ modbus_stack_t *modbus_stack_create(void *ctx, modbus_protocol_e protocol,
     stack->value_fn   = value_fn;
     stack->write_resp = write_resp;
     stack->protocol   = protocol;
+    stack->window     = 1;
 
-    stack->buf_size = 256;
+    // mbap header and the largest pdu
+    stack->buf_size = 7 + 253;
     stack->buf      = calloc(stack->buf_size, 1);
 
     return stack;
@@ -66,6 +69,12 @@ void modbus_stack_destroy(modbus_stack_t *stack)
     free(stack);
 }
 
+static inline bool seq_in_window(uint16_t seq, uint16_t next_seq,
+                                 uint16_t window)
+{
+    return (uint16_t)(next_seq - seq - 1) < window;
+}
+
 int modbus_stack_recv(modbus_stack_t *stack, uint8_t slave_id,
                       neu_protocol_unpack_buf_t *buf)
 {
@@ -84,8 +93,9 @@ int modbus_stack_recv(modbus_stack_t *stack, uint8_t slave_id,
         }
 
         neu_plugin_t *plugin = (neu_plugin_t *) stack->ctx;
-        if (plugin->check_header && header.seq + 1 != stack->read_seq &&
-            header.seq + 1 != stack->write_seq) {
+        if (plugin->check_header &&
+            !seq_in_window(header.seq, stack->read_seq, stack->window) &&
+            !seq_in_window(header.seq, stack->write_seq, stack->window)) {
             return -1;
         }
     }
@@ -415,9 +425,8 @@ int modbus_stack_write(modbus_stack_t *stack, void *req, uint8_t slave_id,
 
     switch (area) {
     case MODBUS_AREA_COIL:
-        if (n_byte > 1) {
-            n_reg = n_byte;
-            modbus_data_wrap(&pbuf, (n_byte + 7) / 8, bytes, m_action);
+        if (n_reg > 1) {
+            modbus_data_wrap(&pbuf, (n_reg + 7) / 8, bytes, m_action);
             modbus_address_wrap(&pbuf, start_address, n_reg, m_action);
             modbus_code_wrap(&pbuf, slave_id, MODBUS_WRITE_M_COIL);
             break;
@@ -474,6 +483,16 @@ int modbus_stack_write(modbus_stack_t *stack, void *req, uint8_t slave_id,
     return ret;
 }
 
+void modbus_stack_set_window(modbus_stack_t *stack, uint16_t window)
+{
+    stack->window = window > 0 ? window : 1;
+}
+
+uint16_t modbus_stack_last_read_seq(modbus_stack_t *stack)
+{
+    return stack->read_seq - 1;
+}
+
 bool modbus_stack_is_rtu(modbus_stack_t *stack)
 {
     return stack->protocol == MODBUS_PROTOCOL_RTU;
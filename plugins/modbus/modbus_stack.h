@@ -59,4 +59,11 @@ int  modbus_stack_write(modbus_stack_t *stack, void *req, uint8_t slave_id,
                         uint16_t *response_size, bool response);
 bool modbus_stack_is_rtu(modbus_stack_t *stack);
 
+/**
+ * @brief Accept responses whose transaction id lies within the last `window`
+ * requests sent, used when several requests are pipelined on one connection.
+ */
+void     modbus_stack_set_window(modbus_stack_t *stack, uint16_t window);
+uint16_t modbus_stack_last_read_seq(modbus_stack_t *stack);
+
 #endif
\ No newline at end of file
@@ -109,6 +109,7 @@ static int driver_init(neu_plugin_t *plugin, bool load)
     plugin->stack    = modbus_stack_create((void *) plugin, MODBUS_PROTOCOL_TCP,
                                         modbus_send_msg, modbus_value_handle,
                                         modbus_write_resp);
+    modbus_clients_init(plugin);
 
     plog_notice(plugin, "%s init success", plugin->common.name);
     return 0;
@@ -117,6 +118,7 @@ static int driver_init(neu_plugin_t *plugin, bool load)
 static int driver_uninit(neu_plugin_t *plugin)
 {
     plog_notice(plugin, "%s uninit start", plugin->common.name);
+    modbus_conn_pool_free(plugin);
     if (plugin->conn != NULL) {
         neu_conn_destory(plugin->conn);
     }
@@ -136,6 +138,7 @@ static int driver_uninit(neu_plugin_t *plugin)
         }
     }
 
+    modbus_clients_uninit(plugin);
     neu_event_close(plugin->events);
 
     plog_notice(plugin, "%s uninit success", plugin->common.name);
@@ -146,6 +149,7 @@ static int driver_uninit(neu_plugin_t *plugin)
 static int driver_start(neu_plugin_t *plugin)
 {
     neu_conn_start(plugin->conn);
+    modbus_conn_pool_start(plugin);
     plog_notice(plugin, "%s start success", plugin->common.name);
     return 0;
 }
@@ -153,6 +157,7 @@ static int driver_start(neu_plugin_t *plugin)
 static int driver_stop(neu_plugin_t *plugin)
 {
     neu_conn_stop(plugin->conn);
+    modbus_conn_pool_stop(plugin);
     plog_notice(plugin, "%s stop success", plugin->common.name);
     return 0;
 }
@@ -193,6 +198,15 @@ static int driver_config(neu_plugin_t *plugin, const char *config)
     neu_conn_param_t param_backup = { 0 };
     bool             backup       = false;
 
+    neu_json_elem_t connection_pool = { .name = "connection_pool",
+                                        .t    = NEU_JSON_INT };
+    neu_json_elem_t max_inflight    = { .name = "max_inflight",
+                                     .t    = NEU_JSON_INT };
+    neu_json_elem_t max_clients     = { .name = "max_clients",
+                                    .t    = NEU_JSON_INT };
+    neu_json_elem_t client_identify = { .name = "client_identify",
+                                        .t    = NEU_JSON_INT };
+
     ret = neu_parse_param((char *) config, &err_param, 5, &port, &host, &mode,
                           &timeout, &interval);
 
@@ -255,6 +269,63 @@ static int driver_config(neu_plugin_t *plugin, const char *config)
         backup = true;
     }
 
+    ret = neu_parse_param((char *) config, &err_param, 1, &connection_pool);
+    if (ret != 0) {
+        free(err_param);
+        connection_pool.v.val_int = 1;
+    }
+
+    ret = neu_parse_param((char *) config, &err_param, 1, &max_inflight);
+    if (ret != 0) {
+        free(err_param);
+        max_inflight.v.val_int = 1;
+    }
+
+    ret = neu_parse_param((char *) config, &err_param, 1, &max_clients);
+    if (ret != 0) {
+        free(err_param);
+        max_clients.v.val_int = 1;
+    }
+
+    ret = neu_parse_param((char *) config, &err_param, 1, &client_identify);
+    if (ret != 0) {
+        free(err_param);
+        client_identify.v.val_int = MODBUS_CLIENT_BY_UNIT_ID;
+    }
+
+    if (max_clients.v.val_int < 1 ||
+        max_clients.v.val_int > MODBUS_MAX_CLIENT ||
+        (client_identify.v.val_int != MODBUS_CLIENT_BY_UNIT_ID &&
+         client_identify.v.val_int != MODBUS_CLIENT_BY_PEER)) {
+        plog_error(plugin,
+                   "config: %s, invalid max_clients: %" PRId64
+                   " or client_identify: %" PRId64,
+                   config, max_clients.v.val_int, client_identify.v.val_int);
+        if (host.v.val_str != NULL) {
+            free(host.v.val_str);
+        }
+        if (backup_ip.v.val_str != NULL) {
+            free(backup_ip.v.val_str);
+        }
+        return -1;
+    }
+
+    if (connection_pool.v.val_int < 1 ||
+        connection_pool.v.val_int > MODBUS_MAX_LANE ||
+        max_inflight.v.val_int < 1 || max_inflight.v.val_int > 16) {
+        plog_error(plugin,
+                   "config: %s, invalid connection_pool: %" PRId64
+                   " or max_inflight: %" PRId64,
+                   config, connection_pool.v.val_int, max_inflight.v.val_int);
+        if (host.v.val_str != NULL) {
+            free(host.v.val_str);
+        }
+        if (backup_ip.v.val_str != NULL) {
+            free(backup_ip.v.val_str);
+        }
+        return -1;
+    }
+
     param.log              = plugin->common.log;
     param_backup.log       = plugin->common.log;
     plugin->interval       = interval.v.val_int;
@@ -267,14 +338,19 @@ static int driver_config(neu_plugin_t *plugin, const char *config)
     plugin->endianess      = endianess.v.val_int;
     plugin->address_base   = address_base.v.val_int;
 
+    plugin->timeout         = timeout.v.val_int;
+    plugin->max_clients     = max_clients.v.val_int;
+    plugin->client_identify = client_identify.v.val_int;
+
     if (mode.v.val_int == 1) {
+        // client sockets are read by the event loop, never block on them
         param.type                           = NEU_CONN_TCP_SERVER;
         param.params.tcp_server.ip           = host.v.val_str;
         param.params.tcp_server.port         = port.v.val_int;
         param.params.tcp_server.start_listen = modbus_tcp_server_listen;
         param.params.tcp_server.stop_listen  = modbus_tcp_server_stop;
-        param.params.tcp_server.timeout      = timeout.v.val_int;
-        param.params.tcp_server.max_link     = 1;
+        param.params.tcp_server.timeout      = 0;
+        param.params.tcp_server.max_link     = plugin->max_clients + 1;
         plugin->is_server                    = true;
         backup                               = false;
 
@@ -329,6 +405,14 @@ static int driver_config(neu_plugin_t *plugin, const char *config)
                          modbus_conn_disconnected);
     }
 
+    // the pool only applies to client mode, a server has a single peer
+    if (plugin->is_server) {
+        modbus_conn_pool_setup(plugin, 1, 1);
+    } else {
+        modbus_conn_pool_setup(plugin, connection_pool.v.val_int,
+                               max_inflight.v.val_int);
+    }
+
     if (host.v.val_str != NULL) {
         free(host.v.val_str);
         host.v.val_str = NULL;
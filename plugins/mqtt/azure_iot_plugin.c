@@ -329,7 +329,15 @@ static int azure_plugin_request(neu_plugin_t *plugin, neu_reqresp_head_t *head,
     }
 
     switch (head->type) {
-    case NEU_RESP_ERROR:
+    case NEU_RESP_ERROR: {
+        neu_resp_write_tags_t resp = {
+            .error = ((neu_resp_error_t *) data)->error,
+        };
+        error =
+            handle_write_response(plugin, head->ctx, &resp, NULL, NULL, NULL);
+        break;
+    }
+    case NEU_RESP_WRITE_TAGS:
         error =
             handle_write_response(plugin, head->ctx, data, NULL, NULL, NULL);
         break;
@@ -0,0 +1,205 @@
+/**
+ * NEURON IIoT System for Industry 4.0
+ * Copyright (C) 2020-2022 EMQ Technologies Co., Ltd All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ **/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "mqtt_batch.h"
+
+// bytes reserved in front of the first report
+static size_t header_len(mqtt_upload_format_e format)
+{
+    switch (format) {
+    case MQTT_UPLOAD_FORMAT_MSGPACK:
+        return 5; // 0xdd and a big endian uint32 count
+    case MQTT_UPLOAD_FORMAT_PROTOBUF:
+        return 0;
+    default:
+        return 1; // '['
+    }
+}
+
+// bytes written in front of a report
+static size_t member_len(mqtt_upload_format_e format, size_t count,
+                         size_t len)
+{
+    size_t n = 0;
+
+    switch (format) {
+    case MQTT_UPLOAD_FORMAT_MSGPACK:
+        return 0;
+    case MQTT_UPLOAD_FORMAT_PROTOBUF:
+        // field 1, length delimited
+        n = 2;
+        while (len >= 0x80) {
+            len >>= 7;
+            n += 1;
+        }
+        return n;
+    default:
+        return count > 0 ? 1 : 0; // ','
+    }
+}
+
+// bytes written after the last report
+static size_t trailer_len(mqtt_upload_format_e format)
+{
+    return mqtt_upload_format_is_binary(format) ? 0 : 1; // ']'
+}
+
+static int reserve(mqtt_batch_t *batch, size_t n)
+{
+    size_t cap = batch->cap > 0 ? batch->cap : 256;
+    char * buf = NULL;
+
+    if (batch->len + n <= batch->cap) {
+        return 0;
+    }
+
+    while (cap < batch->len + n) {
+        cap *= 2;
+    }
+
+    buf = realloc(batch->buf, cap);
+    if (NULL == buf) {
+        return -1;
+    }
+
+    batch->buf = buf;
+    batch->cap = cap;
+    return 0;
+}
+
+mqtt_batch_t *mqtt_batch_get(mqtt_batch_t **tbl, const char *topic)
+{
+    mqtt_batch_t *batch = NULL;
+
+    HASH_FIND_STR(*tbl, topic, batch);
+    if (batch) {
+        return batch;
+    }
+
+    batch = calloc(1, sizeof(*batch));
+    if (NULL == batch) {
+        return NULL;
+    }
+
+    batch->topic = strdup(topic);
+    if (NULL == batch->topic) {
+        free(batch);
+        return NULL;
+    }
+
+    HASH_ADD_KEYPTR(hh, *tbl, batch->topic, strlen(batch->topic), batch);
+    return batch;
+}
+
+void mqtt_batch_tbl_free(mqtt_batch_t *tbl)
+{
+    mqtt_batch_t *batch = NULL, *tmp = NULL;
+
+    HASH_ITER(hh, tbl, batch, tmp)
+    {
+        HASH_DEL(tbl, batch);
+        free(batch->topic);
+        free(batch->buf);
+        free(batch);
+    }
+}
+
+size_t mqtt_batch_size(const mqtt_batch_t *batch)
+{
+    return batch->len + trailer_len(batch->format);
+}
+
+size_t mqtt_batch_size_with(const mqtt_batch_t *batch, size_t len)
+{
+    return batch->len + member_len(batch->format, batch->count, len) + len +
+        trailer_len(batch->format);
+}
+
+int mqtt_batch_add(mqtt_batch_t *batch, mqtt_upload_format_e format,
+                   const char *payload, size_t len, int64_t now)
+{
+    size_t n = 0;
+
+    if (0 == batch->count) {
+        batch->format = format;
+        batch->len    = header_len(format);
+        batch->ts     = now;
+    }
+
+    // room for the trailer too, so that take never reallocates
+    n = member_len(format, batch->count, len) + len + trailer_len(format);
+    if (0 != reserve(batch, n)) {
+        if (0 == batch->count) {
+            batch->len = 0;
+        }
+        return -1;
+    }
+
+    if (MQTT_UPLOAD_FORMAT_PROTOBUF == format) {
+        size_t v = len;
+
+        batch->buf[batch->len++] = 0x0a;
+        while (v >= 0x80) {
+            batch->buf[batch->len++] = (char) (v | 0x80);
+            v >>= 7;
+        }
+        batch->buf[batch->len++] = (char) v;
+    } else if (!mqtt_upload_format_is_binary(format)) {
+        if (0 == batch->count) {
+            batch->buf[0] = '[';
+        } else {
+            batch->buf[batch->len++] = ',';
+        }
+    }
+
+    memcpy(batch->buf + batch->len, payload, len);
+    batch->len += len;
+    batch->count += 1;
+    return 0;
+}
+
+char *mqtt_batch_take(mqtt_batch_t *batch, size_t *len)
+{
+    char *buf = batch->buf;
+
+    if (0 == batch->count) {
+        return NULL;
+    }
+
+    if (MQTT_UPLOAD_FORMAT_MSGPACK == batch->format) {
+        buf[0] = (char) 0xdd;
+        buf[1] = (char) (batch->count >> 24);
+        buf[2] = (char) (batch->count >> 16);
+        buf[3] = (char) (batch->count >> 8);
+        buf[4] = (char) batch->count;
+    } else if (!mqtt_upload_format_is_binary(batch->format)) {
+        buf[batch->len++] = ']';
+    }
+
+    *len = batch->len;
+
+    batch->buf   = NULL;
+    batch->len   = 0;
+    batch->cap   = 0;
+    batch->count = 0;
+    return buf;
+}
@@ -0,0 +1,98 @@
+/**
+ * NEURON IIoT System for Industry 4.0
+ * Copyright (C) 2020-2022 EMQ Technologies Co., Ltd All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ **/
+
+#ifndef NEURON_PLUGIN_MQTT_BATCH_H
+#define NEURON_PLUGIN_MQTT_BATCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "utils/uthash.h"
+
+#include "mqtt_config.h"
+
+// last number of reports in a batch
+#define NEU_METRIC_BATCH_SIZE "batch_size"
+#define NEU_METRIC_BATCH_SIZE_TYPE NEU_METRIC_TYPE_GAUAGE
+#define NEU_METRIC_BATCH_SIZE_HELP "Number of reports in the last batch sent"
+
+// number of batches flushed for reaching the max bytes
+#define NEU_METRIC_BATCH_FLUSH_BYTES "batch_flush_bytes_total"
+#define NEU_METRIC_BATCH_FLUSH_BYTES_TYPE NEU_METRIC_TYPE_COUNTER
+#define NEU_METRIC_BATCH_FLUSH_BYTES_HELP \
+    "Total number of batches flushed for reaching the max bytes"
+
+// number of batches flushed for reaching the max count
+#define NEU_METRIC_BATCH_FLUSH_COUNT "batch_flush_count_total"
+#define NEU_METRIC_BATCH_FLUSH_COUNT_TYPE NEU_METRIC_TYPE_COUNTER
+#define NEU_METRIC_BATCH_FLUSH_COUNT_HELP \
+    "Total number of batches flushed for reaching the max count"
+
+// number of batches flushed for reaching the max delay
+#define NEU_METRIC_BATCH_FLUSH_DELAY "batch_flush_delay_total"
+#define NEU_METRIC_BATCH_FLUSH_DELAY_TYPE NEU_METRIC_TYPE_COUNTER
+#define NEU_METRIC_BATCH_FLUSH_DELAY_HELP \
+    "Total number of batches flushed for reaching the max delay"
+
+/*
+ * Reports bound for the same topic, kept in their envelope form so that a
+ * flush hands the buffer over to publish without copying. Every report keeps
+ * its own node, group and timestamp inside the envelope:
+ *
+ *   JSON formats: [report, report, ...]
+ *   MessagePack : array 32 of report maps
+ *   Protobuf    : message Batch of plugins/mqtt/neuron_upload.proto
+ */
+typedef struct mqtt_batch_s {
+    char *               topic;
+    mqtt_upload_format_e format;
+    char *               buf;
+    size_t               len;
+    size_t               cap;
+    size_t               count;
+    int64_t              ts; // time of the first report, in milliseconds
+
+    UT_hash_handle hh;
+} mqtt_batch_t;
+
+// find the batch of `topic`, create an empty one if none
+mqtt_batch_t *mqtt_batch_get(mqtt_batch_t **tbl, const char *topic);
+void          mqtt_batch_tbl_free(mqtt_batch_t *tbl);
+
+// envelope length of a non empty batch, as is or after appending a report of
+// `len` bytes
+size_t mqtt_batch_size(const mqtt_batch_t *batch);
+size_t mqtt_batch_size_with(const mqtt_batch_t *batch, size_t len);
+
+// append a report, the format is fixed by the first report of the batch
+int mqtt_batch_add(mqtt_batch_t *batch, mqtt_upload_format_e format,
+                   const char *payload, size_t len, int64_t now);
+
+// return the malloc'ed envelope and its length, and empty the batch
+char *mqtt_batch_take(mqtt_batch_t *batch, size_t *len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
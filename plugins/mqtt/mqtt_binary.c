@@ -0,0 +1,766 @@
+/**
+ * NEURON IIoT System for Industry 4.0
+ * Copyright (C) 2020-2022 EMQ Technologies Co., Ltd All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ **/
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <jansson.h>
+
+#include "errcodes.h"
+#include "msg.h"
+
+#include "mqtt_binary.h"
+#include "neuron_upload.pb-c.h"
+
+typedef struct {
+    uint8_t *data;
+    size_t   len;
+    size_t   size;
+    bool     error;
+} binary_buf_t;
+
+static void buf_init(binary_buf_t *b, size_t size)
+{
+    b->data  = malloc(size);
+    b->len   = 0;
+    b->size  = size;
+    b->error = b->data == NULL;
+}
+
+static int buf_reserve(binary_buf_t *b, size_t n)
+{
+    if (b->error) {
+        return -1;
+    }
+
+    if (b->len + n > b->size) {
+        size_t   size = b->size * 2;
+        uint8_t *data = NULL;
+
+        while (b->len + n > size) {
+            size *= 2;
+        }
+
+        data = realloc(b->data, size);
+        if (data == NULL) {
+            b->error = true;
+            return -1;
+        }
+
+        b->data = data;
+        b->size = size;
+    }
+
+    return 0;
+}
+
+static void buf_put(binary_buf_t *b, const void *data, size_t n)
+{
+    if (n > 0 && buf_reserve(b, n) == 0) {
+        memcpy(b->data + b->len, data, n);
+        b->len += n;
+    }
+}
+
+static void buf_byte(binary_buf_t *b, uint8_t c)
+{
+    if (buf_reserve(b, 1) == 0) {
+        b->data[b->len++] = c;
+    }
+}
+
+static char *buf_finish(binary_buf_t *b, size_t *len)
+{
+    if (b->error) {
+        free(b->data);
+        return NULL;
+    }
+
+    *len = b->len;
+    return (char *) b->data;
+}
+
+static size_t tag_n_meta(const neu_resp_tag_value_meta_t *tag)
+{
+    size_t n = 0;
+
+    while (n < NEU_TAG_META_SIZE && tag->metas[n].name[0] != '\0') {
+        n++;
+    }
+
+    return n;
+}
+
+// the type a value is sent with, pointers are sent as string or bytes
+static neu_type_e value_type(const neu_dvalue_t *value)
+{
+    if (value->type == NEU_TYPE_PTR) {
+        return value->value.ptr.type == NEU_TYPE_BYTES ? NEU_TYPE_BYTES
+                                                       : NEU_TYPE_STRING;
+    }
+
+    return value->type;
+}
+
+// an expired float tag is reported as an error, as the json formats do
+static neu_type_e tag_type(const neu_dvalue_t *value)
+{
+    if ((value->type == NEU_TYPE_FLOAT && isnan(value->value.f32)) ||
+        (value->type == NEU_TYPE_DOUBLE && isnan(value->value.d64))) {
+        return NEU_TYPE_ERROR;
+    }
+
+    return value_type(value);
+}
+
+static int32_t tag_error(const neu_dvalue_t *value)
+{
+    return value->type == NEU_TYPE_ERROR ? value->value.i32
+                                         : NEU_ERR_PLUGIN_TAG_VALUE_EXPIRED;
+}
+
+/*
+ * MessagePack
+ */
+
+static void mp_be(binary_buf_t *b, uint8_t prefix, uint64_t v, int n)
+{
+    uint8_t tmp[9] = { prefix };
+
+    for (int i = 0; i < n; i++) {
+        tmp[n - i] = (uint8_t)(v >> (8 * i));
+    }
+
+    buf_put(b, tmp, n + 1);
+}
+
+static void mp_uint(binary_buf_t *b, uint64_t v)
+{
+    if (v < 0x80) {
+        buf_byte(b, (uint8_t) v);
+    } else if (v <= UINT8_MAX) {
+        mp_be(b, 0xcc, v, 1);
+    } else if (v <= UINT16_MAX) {
+        mp_be(b, 0xcd, v, 2);
+    } else if (v <= UINT32_MAX) {
+        mp_be(b, 0xce, v, 4);
+    } else {
+        mp_be(b, 0xcf, v, 8);
+    }
+}
+
+static void mp_int(binary_buf_t *b, int64_t v)
+{
+    if (v >= 0) {
+        mp_uint(b, (uint64_t) v);
+    } else if (v >= -32) {
+        buf_byte(b, (uint8_t) v);
+    } else if (v >= INT8_MIN) {
+        mp_be(b, 0xd0, (uint64_t) v, 1);
+    } else if (v >= INT16_MIN) {
+        mp_be(b, 0xd1, (uint64_t) v, 2);
+    } else if (v >= INT32_MIN) {
+        mp_be(b, 0xd2, (uint64_t) v, 4);
+    } else {
+        mp_be(b, 0xd3, (uint64_t) v, 8);
+    }
+}
+
+static void mp_float(binary_buf_t *b, float v)
+{
+    uint32_t u = 0;
+
+    memcpy(&u, &v, sizeof(u));
+    mp_be(b, 0xca, u, 4);
+}
+
+static void mp_double(binary_buf_t *b, double v)
+{
+    uint64_t u = 0;
+
+    memcpy(&u, &v, sizeof(u));
+    mp_be(b, 0xcb, u, 8);
+}
+
+static void mp_bool(binary_buf_t *b, bool v)
+{
+    buf_byte(b, v ? 0xc3 : 0xc2);
+}
+
+static void mp_nil(binary_buf_t *b)
+{
+    buf_byte(b, 0xc0);
+}
+
+static void mp_str(binary_buf_t *b, const char *str, size_t n)
+{
+    if (n <= 31) {
+        buf_byte(b, 0xa0 | (uint8_t) n);
+    } else if (n <= UINT8_MAX) {
+        mp_be(b, 0xd9, n, 1);
+    } else if (n <= UINT16_MAX) {
+        mp_be(b, 0xda, n, 2);
+    } else {
+        mp_be(b, 0xdb, n, 4);
+    }
+
+    buf_put(b, str, n);
+}
+
+static void mp_cstr(binary_buf_t *b, const char *str)
+{
+    mp_str(b, str, strlen(str));
+}
+
+static void mp_bin(binary_buf_t *b, const uint8_t *bytes, size_t n)
+{
+    if (n <= UINT8_MAX) {
+        mp_be(b, 0xc4, n, 1);
+    } else if (n <= UINT16_MAX) {
+        mp_be(b, 0xc5, n, 2);
+    } else {
+        mp_be(b, 0xc6, n, 4);
+    }
+
+    buf_put(b, bytes, n);
+}
+
+static void mp_array(binary_buf_t *b, size_t n)
+{
+    if (n <= 15) {
+        buf_byte(b, 0x90 | (uint8_t) n);
+    } else if (n <= UINT16_MAX) {
+        mp_be(b, 0xdc, n, 2);
+    } else {
+        mp_be(b, 0xdd, n, 4);
+    }
+}
+
+static void mp_map(binary_buf_t *b, size_t n)
+{
+    if (n <= 15) {
+        buf_byte(b, 0x80 | (uint8_t) n);
+    } else if (n <= UINT16_MAX) {
+        mp_be(b, 0xde, n, 2);
+    } else {
+        mp_be(b, 0xdf, n, 4);
+    }
+}
+
+static void mp_json(binary_buf_t *b, json_t *json)
+{
+    const char *key   = NULL;
+    json_t *    value = NULL;
+    size_t      index = 0;
+
+    switch (json_typeof(json)) {
+    case JSON_OBJECT:
+        mp_map(b, json_object_size(json));
+        json_object_foreach(json, key, value)
+        {
+            mp_cstr(b, key);
+            mp_json(b, value);
+        }
+        break;
+    case JSON_ARRAY:
+        mp_array(b, json_array_size(json));
+        json_array_foreach(json, index, value) { mp_json(b, value); }
+        break;
+    case JSON_STRING:
+        mp_str(b, json_string_value(json), json_string_length(json));
+        break;
+    case JSON_INTEGER:
+        mp_int(b, json_integer_value(json));
+        break;
+    case JSON_REAL:
+        mp_double(b, json_real_value(json));
+        break;
+    case JSON_TRUE:
+        mp_bool(b, true);
+        break;
+    case JSON_FALSE:
+        mp_bool(b, false);
+        break;
+    default:
+        mp_nil(b);
+        break;
+    }
+}
+
+#define MP_ARRAY(b, array, items, put)              \
+    mp_array(b, (array).length);                    \
+    for (int i = 0; i < (array).length; i++) {      \
+        put(b, (array).items[i]);                   \
+    }
+
+static void mp_value(binary_buf_t *b, const neu_dvalue_t *dv)
+{
+    const neu_value_u *v = &dv->value;
+
+    switch (dv->type) {
+    case NEU_TYPE_INT8:
+        mp_int(b, v->i8);
+        break;
+    case NEU_TYPE_INT16:
+        mp_int(b, v->i16);
+        break;
+    case NEU_TYPE_INT32:
+    case NEU_TYPE_ERROR:
+        mp_int(b, v->i32);
+        break;
+    case NEU_TYPE_INT64:
+        mp_int(b, v->i64);
+        break;
+    case NEU_TYPE_UINT8:
+    case NEU_TYPE_BIT:
+        mp_uint(b, v->u8);
+        break;
+    case NEU_TYPE_UINT16:
+    case NEU_TYPE_WORD:
+        mp_uint(b, v->u16);
+        break;
+    case NEU_TYPE_UINT32:
+    case NEU_TYPE_DWORD:
+        mp_uint(b, v->u32);
+        break;
+    case NEU_TYPE_UINT64:
+    case NEU_TYPE_LWORD:
+        mp_uint(b, v->u64);
+        break;
+    case NEU_TYPE_FLOAT:
+        mp_float(b, v->f32);
+        break;
+    case NEU_TYPE_DOUBLE:
+        mp_double(b, v->d64);
+        break;
+    case NEU_TYPE_BOOL:
+        mp_bool(b, v->boolean);
+        break;
+    case NEU_TYPE_STRING:
+    case NEU_TYPE_TIME:
+    case NEU_TYPE_DATA_AND_TIME:
+    case NEU_TYPE_ARRAY_CHAR:
+        mp_str(b, v->str, strnlen(v->str, sizeof(v->str)));
+        break;
+    case NEU_TYPE_BYTES:
+        mp_bin(b, v->bytes.bytes, v->bytes.length);
+        break;
+    case NEU_TYPE_PTR:
+        if (v->ptr.type == NEU_TYPE_BYTES) {
+            mp_bin(b, v->ptr.ptr, v->ptr.length);
+        } else {
+            mp_str(b, (char *) v->ptr.ptr,
+                   strnlen((char *) v->ptr.ptr, v->ptr.length));
+        }
+        break;
+    case NEU_TYPE_ARRAY_INT8:
+        MP_ARRAY(b, v->i8s, i8s, mp_int);
+        break;
+    case NEU_TYPE_ARRAY_UINT8:
+        MP_ARRAY(b, v->u8s, u8s, mp_uint);
+        break;
+    case NEU_TYPE_ARRAY_INT16:
+        MP_ARRAY(b, v->i16s, i16s, mp_int);
+        break;
+    case NEU_TYPE_ARRAY_UINT16:
+        MP_ARRAY(b, v->u16s, u16s, mp_uint);
+        break;
+    case NEU_TYPE_ARRAY_INT32:
+        MP_ARRAY(b, v->i32s, i32s, mp_int);
+        break;
+    case NEU_TYPE_ARRAY_UINT32:
+        MP_ARRAY(b, v->u32s, u32s, mp_uint);
+        break;
+    case NEU_TYPE_ARRAY_INT64:
+        MP_ARRAY(b, v->i64s, i64s, mp_int);
+        break;
+    case NEU_TYPE_ARRAY_UINT64:
+        MP_ARRAY(b, v->u64s, u64s, mp_uint);
+        break;
+    case NEU_TYPE_ARRAY_FLOAT:
+        MP_ARRAY(b, v->f32s, f32s, mp_float);
+        break;
+    case NEU_TYPE_ARRAY_DOUBLE:
+        MP_ARRAY(b, v->f64s, f64s, mp_double);
+        break;
+    case NEU_TYPE_ARRAY_BOOL:
+        MP_ARRAY(b, v->bools, bools, mp_bool);
+        break;
+    case NEU_TYPE_ARRAY_STRING:
+        mp_array(b, v->strs.length);
+        for (int i = 0; i < v->strs.length; i++) {
+            if (v->strs.strs[i] == NULL) {
+                mp_nil(b);
+            } else {
+                mp_cstr(b, v->strs.strs[i]);
+            }
+        }
+        break;
+    case NEU_TYPE_CUSTOM:
+        if (v->json == NULL) {
+            mp_nil(b);
+        } else {
+            mp_json(b, v->json);
+        }
+        break;
+    default:
+        mp_nil(b);
+        break;
+    }
+}
+
+static void mp_tag(binary_buf_t *b, const neu_resp_tag_value_meta_t *tag)
+{
+    size_t     n_meta = tag_n_meta(tag);
+    neu_type_e type   = tag_type(&tag->value);
+
+    mp_array(b, n_meta > 0 ? 4 : 3);
+    mp_cstr(b, tag->tag);
+    mp_uint(b, type);
+
+    if (type == NEU_TYPE_ERROR) {
+        mp_int(b, tag_error(&tag->value));
+    } else {
+        mp_value(b, &tag->value);
+    }
+
+    if (n_meta > 0) {
+        mp_map(b, n_meta);
+        for (size_t k = 0; k < n_meta; k++) {
+            mp_cstr(b, tag->metas[k].name);
+            mp_array(b, 2);
+            mp_uint(b, value_type(&tag->metas[k].value));
+            mp_value(b, &tag->metas[k].value);
+        }
+    }
+}
+
+char *mqtt_encode_msgpack(const neu_json_read_periodic_t *header,
+                          UT_array *tags, size_t *len)
+{
+    binary_buf_t b = { 0 };
+
+    buf_init(&b, utarray_len(tags) * 16 + 64);
+
+    mp_map(&b, header->seq > 0 ? 6 : 4);
+    mp_cstr(&b, "node");
+    mp_cstr(&b, header->node);
+    mp_cstr(&b, "group");
+    mp_cstr(&b, header->group);
+    mp_cstr(&b, "timestamp");
+    mp_uint(&b, header->timestamp);
+    mp_cstr(&b, "tags");
+    mp_array(&b, utarray_len(tags));
+
+    utarray_foreach(tags, neu_resp_tag_value_meta_t *, tag)
+    {
+        mp_tag(&b, tag);
+    }
+
+    if (header->seq > 0) {
+        mp_cstr(&b, "seq");
+        mp_uint(&b, header->seq);
+        mp_cstr(&b, "keyframe");
+        mp_bool(&b, header->keyframe);
+    }
+
+    return buf_finish(&b, len);
+}
+
+/*
+ * Protobuf, with the messages generated from neuron_upload.proto
+ */
+
+typedef struct {
+    Neuron__Upload__Value value;
+    union {
+        Neuron__Upload__IntArray    int_array;
+        Neuron__Upload__UintArray   uint_array;
+        Neuron__Upload__FloatArray  float_array;
+        Neuron__Upload__DoubleArray double_array;
+        Neuron__Upload__BoolArray   bool_array;
+        Neuron__Upload__StringArray string_array;
+    };
+    void *buf; // converted array items or text, owned
+} pb_value_t;
+
+typedef struct {
+    Neuron__Upload__Tag   tag;
+    pb_value_t            value;
+    Neuron__Upload__Meta  metas[NEU_TAG_META_SIZE];
+    Neuron__Upload__Meta *meta_ptrs[NEU_TAG_META_SIZE];
+    pb_value_t            meta_values[NEU_TAG_META_SIZE];
+} pb_tag_t;
+
+// the string as it is, or a copy when it fills its buffer without a '\0'
+static char *pb_str(pb_value_t *pv, const char *str, size_t size)
+{
+    if (memchr(str, '\0', size) != NULL) {
+        return (char *) str;
+    }
+
+    pv->buf = strndup(str, size);
+    return pv->buf;
+}
+
+// the items of a neuron array value, converted to the repeated field type
+#define PB_ARRAY(pv, id, field, item_t, array, items)                    \
+    {                                                                    \
+        item_t *values = calloc((array).length + 1, sizeof(item_t));     \
+        if (values == NULL) {                                            \
+            return -1;                                                   \
+        }                                                                \
+        for (int i = 0; i < (array).length; i++) {                       \
+            values[i] = (array).items[i];                                \
+        }                                                                \
+        neuron__upload__##field##__init(&(pv)->field);                   \
+        (pv)->field.n_values   = (array).length;                         \
+        (pv)->field.values     = values;                                 \
+        (pv)->buf              = values;                                 \
+        (pv)->value.value_case = NEURON__UPLOAD__VALUE__VALUE_##id;      \
+        (pv)->value.field      = &(pv)->field;                           \
+    }
+
+static int pb_value_set(pb_value_t *pv, const neu_dvalue_t *dv)
+{
+    const neu_value_u *    v     = &dv->value;
+    Neuron__Upload__Value *value = &pv->value;
+
+    neuron__upload__value__init(value);
+    pv->buf = NULL;
+
+    switch (dv->type) {
+    case NEU_TYPE_INT8:
+        value->value_case = NEURON__UPLOAD__VALUE__VALUE_INT_VALUE;
+        value->int_value  = v->i8;
+        break;
+    case NEU_TYPE_INT16:
+        value->value_case = NEURON__UPLOAD__VALUE__VALUE_INT_VALUE;
+        value->int_value  = v->i16;
+        break;
+    case NEU_TYPE_INT32:
+        value->value_case = NEURON__UPLOAD__VALUE__VALUE_INT_VALUE;
+        value->int_value  = v->i32;
+        break;
+    case NEU_TYPE_INT64:
+        value->value_case = NEURON__UPLOAD__VALUE__VALUE_INT_VALUE;
+        value->int_value  = v->i64;
+        break;
+    case NEU_TYPE_UINT8:
+    case NEU_TYPE_BIT:
+        value->value_case = NEURON__UPLOAD__VALUE__VALUE_UINT_VALUE;
+        value->uint_value = v->u8;
+        break;
+    case NEU_TYPE_UINT16:
+    case NEU_TYPE_WORD:
+        value->value_case = NEURON__UPLOAD__VALUE__VALUE_UINT_VALUE;
+        value->uint_value = v->u16;
+        break;
+    case NEU_TYPE_UINT32:
+    case NEU_TYPE_DWORD:
+        value->value_case = NEURON__UPLOAD__VALUE__VALUE_UINT_VALUE;
+        value->uint_value = v->u32;
+        break;
+    case NEU_TYPE_UINT64:
+    case NEU_TYPE_LWORD:
+        value->value_case = NEURON__UPLOAD__VALUE__VALUE_UINT_VALUE;
+        value->uint_value = v->u64;
+        break;
+    case NEU_TYPE_FLOAT:
+        value->value_case  = NEURON__UPLOAD__VALUE__VALUE_FLOAT_VALUE;
+        value->float_value = v->f32;
+        break;
+    case NEU_TYPE_DOUBLE:
+        value->value_case   = NEURON__UPLOAD__VALUE__VALUE_DOUBLE_VALUE;
+        value->double_value = v->d64;
+        break;
+    case NEU_TYPE_BOOL:
+        value->value_case = NEURON__UPLOAD__VALUE__VALUE_BOOL_VALUE;
+        value->bool_value = v->boolean;
+        break;
+    case NEU_TYPE_STRING:
+    case NEU_TYPE_TIME:
+    case NEU_TYPE_DATA_AND_TIME:
+    case NEU_TYPE_ARRAY_CHAR:
+        value->value_case   = NEURON__UPLOAD__VALUE__VALUE_STRING_VALUE;
+        value->string_value = pb_str(pv, v->str, sizeof(v->str));
+        break;
+    case NEU_TYPE_BYTES:
+        value->value_case       = NEURON__UPLOAD__VALUE__VALUE_BYTES_VALUE;
+        value->bytes_value.len  = v->bytes.length;
+        value->bytes_value.data = (uint8_t *) v->bytes.bytes;
+        break;
+    case NEU_TYPE_PTR:
+        if (v->ptr.type == NEU_TYPE_BYTES) {
+            value->value_case       = NEURON__UPLOAD__VALUE__VALUE_BYTES_VALUE;
+            value->bytes_value.len  = v->ptr.length;
+            value->bytes_value.data = v->ptr.ptr;
+        } else {
+            value->value_case   = NEURON__UPLOAD__VALUE__VALUE_STRING_VALUE;
+            value->string_value =
+                pb_str(pv, (char *) v->ptr.ptr, v->ptr.length);
+        }
+        break;
+    case NEU_TYPE_ARRAY_INT8:
+        PB_ARRAY(pv, INT_ARRAY, int_array, int64_t, v->i8s, i8s);
+        break;
+    case NEU_TYPE_ARRAY_INT16:
+        PB_ARRAY(pv, INT_ARRAY, int_array, int64_t, v->i16s, i16s);
+        break;
+    case NEU_TYPE_ARRAY_INT32:
+        PB_ARRAY(pv, INT_ARRAY, int_array, int64_t, v->i32s, i32s);
+        break;
+    case NEU_TYPE_ARRAY_INT64:
+        PB_ARRAY(pv, INT_ARRAY, int_array, int64_t, v->i64s, i64s);
+        break;
+    case NEU_TYPE_ARRAY_UINT8:
+        PB_ARRAY(pv, UINT_ARRAY, uint_array, uint64_t, v->u8s, u8s);
+        break;
+    case NEU_TYPE_ARRAY_UINT16:
+        PB_ARRAY(pv, UINT_ARRAY, uint_array, uint64_t, v->u16s, u16s);
+        break;
+    case NEU_TYPE_ARRAY_UINT32:
+        PB_ARRAY(pv, UINT_ARRAY, uint_array, uint64_t, v->u32s, u32s);
+        break;
+    case NEU_TYPE_ARRAY_UINT64:
+        PB_ARRAY(pv, UINT_ARRAY, uint_array, uint64_t, v->u64s, u64s);
+        break;
+    case NEU_TYPE_ARRAY_FLOAT:
+        PB_ARRAY(pv, FLOAT_ARRAY, float_array, float, v->f32s, f32s);
+        break;
+    case NEU_TYPE_ARRAY_DOUBLE:
+        PB_ARRAY(pv, DOUBLE_ARRAY, double_array, double, v->f64s, f64s);
+        break;
+    case NEU_TYPE_ARRAY_BOOL:
+        PB_ARRAY(pv, BOOL_ARRAY, bool_array, protobuf_c_boolean, v->bools,
+                 bools);
+        break;
+    case NEU_TYPE_ARRAY_STRING:
+        PB_ARRAY(pv, STRING_ARRAY, string_array, char *, v->strs, strs);
+        for (int i = 0; i < v->strs.length; i++) {
+            if (pv->string_array.values[i] == NULL) {
+                pv->string_array.values[i] = "";
+            }
+        }
+        break;
+    case NEU_TYPE_CUSTOM:
+        if (v->json != NULL) {
+            pv->buf = json_dumps(v->json, JSON_COMPACT | JSON_ENCODE_ANY);
+        }
+        if (pv->buf != NULL) {
+            value->value_case = NEURON__UPLOAD__VALUE__VALUE_JSON_VALUE;
+            value->json_value = pv->buf;
+        }
+        break;
+    default:
+        break;
+    }
+
+    return 0;
+}
+
+static int pb_tag_set(pb_tag_t *pt, const neu_resp_tag_value_meta_t *tag)
+{
+    size_t n_meta = tag_n_meta(tag);
+
+    neuron__upload__tag__init(&pt->tag);
+    pt->tag.name = (char *) tag->tag;
+    pt->tag.type = tag_type(&tag->value);
+
+    if (pt->tag.type == NEU_TYPE_ERROR) {
+        pt->tag.error = tag_error(&tag->value);
+    } else {
+        if (pb_value_set(&pt->value, &tag->value) != 0) {
+            return -1;
+        }
+        pt->tag.value = &pt->value.value;
+    }
+
+    for (size_t k = 0; k < n_meta; k++) {
+        neuron__upload__meta__init(&pt->metas[k]);
+        if (pb_value_set(&pt->meta_values[k], &tag->metas[k].value) != 0) {
+            return -1;
+        }
+        pt->metas[k].name  = (char *) tag->metas[k].name;
+        pt->metas[k].type  = value_type(&tag->metas[k].value);
+        pt->metas[k].value = &pt->meta_values[k].value;
+        pt->meta_ptrs[k]   = &pt->metas[k];
+        pt->tag.n_metas += 1;
+    }
+    pt->tag.metas = pt->meta_ptrs;
+
+    return 0;
+}
+
+static void pb_tag_fini(pb_tag_t *pt)
+{
+    free(pt->value.buf);
+    for (size_t k = 0; k < pt->tag.n_metas; k++) {
+        free(pt->meta_values[k].buf);
+    }
+}
+
+char *mqtt_encode_protobuf(const neu_json_read_periodic_t *header,
+                           UT_array *tags, size_t *len)
+{
+    Neuron__Upload__Upload upload = NEURON__UPLOAD__UPLOAD__INIT;
+    size_t                 n_tag  = utarray_len(tags);
+    pb_tag_t *             pts    = calloc(n_tag + 1, sizeof(pb_tag_t));
+    Neuron__Upload__Tag ** ptrs   = calloc(n_tag + 1, sizeof(*ptrs));
+    uint8_t *              buf    = NULL;
+    size_t                 i      = 0;
+
+    if (pts == NULL || ptrs == NULL) {
+        goto end;
+    }
+
+    utarray_foreach(tags, neu_resp_tag_value_meta_t *, tag)
+    {
+        if (pb_tag_set(&pts[i], tag) != 0) {
+            pb_tag_fini(&pts[i]);
+            goto end;
+        }
+        ptrs[i] = &pts[i].tag;
+        i++;
+    }
+
+    upload.node      = header->node;
+    upload.group     = header->group;
+    upload.timestamp = header->timestamp;
+    upload.n_tags    = n_tag;
+    upload.tags      = ptrs;
+    upload.seq       = header->seq;
+    upload.keyframe  = header->seq > 0 && header->keyframe;
+
+    *len = neuron__upload__upload__get_packed_size(&upload);
+    buf  = malloc(*len > 0 ? *len : 1);
+    if (buf != NULL) {
+        neuron__upload__upload__pack(&upload, buf);
+    }
+
+end:
+    while (i > 0) {
+        pb_tag_fini(&pts[--i]);
+    }
+    free(ptrs);
+    free(pts);
+    return (char *) buf;
+}
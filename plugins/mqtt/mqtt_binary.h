@@ -0,0 +1,66 @@
+/**
+ * NEURON IIoT System for Industry 4.0
+ * Copyright (C) 2020-2022 EMQ Technologies Co., Ltd All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ **/
+
+#ifndef NEURON_PLUGIN_MQTT_BINARY_H
+#define NEURON_PLUGIN_MQTT_BINARY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "json/neu_json_rw.h"
+#include "utils/utarray.h"
+
+/*
+ * Binary upload payloads, built from the neu_resp_tag_value_meta_t of a
+ * trans data. Every tag carries its neu_type_e, so consumers get back the
+ * exact width and signedness of numbers, arrays, bytes and metas. A tag that
+ * failed to read, or whose float value expired (nan), is sent with type
+ * NEU_TYPE_ERROR and the error code.
+ *
+ * MessagePack layout:
+ *
+ *   {"node": str, "group": str, "timestamp": uint (ms),
+ *    "tags": [[name, type, value], [name, type, value, metas], ...]}
+ *
+ *   followed by "seq": uint and "keyframe": bool in delta mode
+ *
+ *   metas  = {meta name: [type, value], ...}
+ *   value  = int or uint for integer types, float 32 for NEU_TYPE_FLOAT,
+ *            float 64 for NEU_TYPE_DOUBLE, bool, str, bin for
+ *            NEU_TYPE_BYTES, array for array types and the plain
+ *            MessagePack form of a NEU_TYPE_CUSTOM json value.
+ *
+ * Protobuf layout: message Upload of plugins/mqtt/neuron_upload.proto.
+ *
+ * Both return a malloc'ed payload and its length in `len`, or NULL.
+ */
+char *mqtt_encode_msgpack(const neu_json_read_periodic_t *header,
+                          UT_array *tags, size_t *len);
+char *mqtt_encode_protobuf(const neu_json_read_periodic_t *header,
+                           UT_array *tags, size_t *len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,903 @@
+/**
+ * NEURON IIoT System for Industry 4.0
+ * Copyright (C) 2020-2022 EMQ Technologies Co., Ltd All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ **/
+
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "mqtt_cache.h"
+
+#define SEGMENT_MAGIC 0x5347434e // "NCGS"
+#define INDEX_MAGIC 0x5844434e   // "NCDX"
+#define CACHE_VERSION 1
+#define SEGMENT_SIZE_MIN 4096
+
+#define ALIGN8(n) (((n) + 7) & ~(size_t) 7)
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t first_seq;
+} segment_header_t;
+
+// followed by the topic with its terminating '\0', then the payload
+typedef struct {
+    uint32_t size; // record size with padding, written last, 0 if none
+    uint32_t len;  // payload length
+    uint64_t seq;
+    uint16_t topic_len;
+    uint8_t  encoding;
+    uint8_t  reserved[5];
+} record_header_t;
+
+// followed by `n_range` ranges
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t next_seq;
+    uint64_t n_range;
+} index_header_t;
+
+typedef struct {
+    uint64_t begin;
+    uint64_t end;
+} seq_range_t;
+
+typedef struct {
+    uint64_t first_seq;
+    uint64_t end_seq; // sequence number after the last record
+    size_t   size;    // file size
+    size_t   used;    // bytes of the header and the records
+    char *   map;     // mapped while written or replayed
+} segment_t;
+
+struct mqtt_cache_s {
+    char * dir;
+    size_t segment_size;
+    size_t max_segments;
+
+    // oldest first, the last one is written to if `writable`
+    segment_t *segs;
+    size_t     n_seg;
+    size_t     seg_cap;
+    bool       writable;
+
+    // sequence numbers not yet acknowledged
+    seq_range_t *ranges;
+    size_t       n_range;
+    size_t       range_cap;
+    size_t       count;
+    uint64_t     next_seq;
+    bool         dirty; // ranges changed since the index was saved
+
+    // replay cursor
+    size_t read_seg;
+    size_t read_off;
+};
+
+static void segment_path(const mqtt_cache_t *cache, uint64_t first_seq,
+                         char *path, size_t size)
+{
+    snprintf(path, size, "%s/%020" PRIu64 ".seg", cache->dir, first_seq);
+}
+
+static bool parse_segment_name(const char *name, uint64_t *first_seq)
+{
+    if (24 != strlen(name) || 0 != strcmp(name + 20, ".seg")) {
+        return false;
+    }
+
+    for (int i = 0; i < 20; ++i) {
+        if (name[i] < '0' || '9' < name[i]) {
+            return false;
+        }
+    }
+
+    *first_seq = strtoull(name, NULL, 10);
+    return true;
+}
+
+static int make_dirs(const char *dir)
+{
+    char path[PATH_MAX] = { 0 };
+
+    if (strlen(dir) >= sizeof(path)) {
+        return -1;
+    }
+
+    strcpy(path, dir);
+    for (char *p = path + 1; *p; ++p) {
+        if ('/' == *p) {
+            *p = '\0';
+            if (0 != mkdir(path, 0700) && EEXIST != errno) {
+                return -1;
+            }
+            *p = '/';
+        }
+    }
+
+    if (0 != mkdir(path, 0700) && EEXIST != errno) {
+        return -1;
+    }
+
+    return 0;
+}
+
+static inline bool is_active(const mqtt_cache_t *cache, size_t i)
+{
+    return cache->writable && i + 1 == cache->n_seg;
+}
+
+static int range_reserve(mqtt_cache_t *cache, size_t n)
+{
+    size_t       cap    = cache->range_cap > 0 ? cache->range_cap : 16;
+    seq_range_t *ranges = NULL;
+
+    if (cache->n_range + n <= cache->range_cap) {
+        return 0;
+    }
+
+    while (cap < cache->n_range + n) {
+        cap *= 2;
+    }
+
+    ranges = realloc(cache->ranges, cap * sizeof(*ranges));
+    if (NULL == ranges) {
+        return -1;
+    }
+
+    cache->ranges    = ranges;
+    cache->range_cap = cap;
+    return 0;
+}
+
+// NOTE: ranges should be pushed in order
+static int range_push(mqtt_cache_t *cache, uint64_t begin, uint64_t end)
+{
+    seq_range_t *last = NULL;
+
+    if (begin >= end) {
+        return 0;
+    }
+
+    if (cache->n_range > 0) {
+        last = &cache->ranges[cache->n_range - 1];
+        if (last->end == begin) {
+            last->end = end;
+            cache->count += end - begin;
+            return 0;
+        }
+    }
+
+    if (0 != range_reserve(cache, 1)) {
+        return -1;
+    }
+
+    cache->ranges[cache->n_range].begin = begin;
+    cache->ranges[cache->n_range].end   = end;
+    cache->n_range += 1;
+    cache->count += end - begin;
+    return 0;
+}
+
+// index of the range holding `seq`, or -1 if acknowledged
+static ssize_t range_find(const mqtt_cache_t *cache, uint64_t seq)
+{
+    size_t lo = 0, hi = cache->n_range;
+
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (seq < cache->ranges[mid].begin) {
+            hi = mid;
+        } else if (seq >= cache->ranges[mid].end) {
+            lo = mid + 1;
+        } else {
+            return mid;
+        }
+    }
+
+    return -1;
+}
+
+// forget sequence numbers below `end`, returns how many were dropped
+static size_t range_drop_below(mqtt_cache_t *cache, uint64_t end)
+{
+    size_t dropped = 0;
+    size_t i       = 0;
+
+    for (; i < cache->n_range && cache->ranges[i].begin < end; ++i) {
+        if (cache->ranges[i].end > end) {
+            dropped += end - cache->ranges[i].begin;
+            cache->ranges[i].begin = end;
+            break;
+        }
+        dropped += cache->ranges[i].end - cache->ranges[i].begin;
+    }
+
+    memmove(cache->ranges, cache->ranges + i,
+            (cache->n_range - i) * sizeof(*cache->ranges));
+    cache->n_range -= i;
+    cache->count -= dropped;
+    return dropped;
+}
+
+static int segment_map(const mqtt_cache_t *cache, segment_t *seg,
+                       bool writable)
+{
+    char  path[PATH_MAX] = { 0 };
+    int   fd             = -1;
+    void *map            = NULL;
+
+    segment_path(cache, seg->first_seq, path, sizeof(path));
+    fd = open(path, writable ? O_RDWR : O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+
+    map = mmap(NULL, seg->size, writable ? PROT_READ | PROT_WRITE : PROT_READ,
+               MAP_SHARED, fd, 0);
+    close(fd);
+    if (MAP_FAILED == map) {
+        return -1;
+    }
+
+    seg->map = map;
+    return 0;
+}
+
+static void segment_unmap(segment_t *seg)
+{
+    if (seg->map) {
+        munmap(seg->map, seg->size);
+        seg->map = NULL;
+    }
+}
+
+// find the records left by a previous run, up to the first torn one
+static int segment_load(const mqtt_cache_t *cache, segment_t *seg)
+{
+    char                    path[PATH_MAX] = { 0 };
+    struct stat             st             = { 0 };
+    const segment_header_t *header         = NULL;
+    size_t                  off            = sizeof(*header);
+    uint64_t                seq            = seg->first_seq;
+
+    segment_path(cache, seg->first_seq, path, sizeof(path));
+    if (0 != stat(path, &st) || (size_t) st.st_size < sizeof(*header)) {
+        return -1;
+    }
+
+    seg->size = st.st_size;
+    if (0 != segment_map(cache, seg, false)) {
+        return -1;
+    }
+
+    header = (const segment_header_t *) seg->map;
+    if (SEGMENT_MAGIC != header->magic || CACHE_VERSION != header->version ||
+        seg->first_seq != header->first_seq) {
+        segment_unmap(seg);
+        return -1;
+    }
+
+    while (off + sizeof(record_header_t) <= seg->size) {
+        const record_header_t *rec   = (const void *) (seg->map + off);
+        const char *           topic = (const char *) (rec + 1);
+
+        if (0 == rec->size || rec->size > seg->size - off ||
+            rec->len > rec->size || seq != rec->seq ||
+            rec->size !=
+                ALIGN8(sizeof(*rec) + rec->topic_len + 1 + (size_t) rec->len) ||
+            '\0' != topic[rec->topic_len]) {
+            break;
+        }
+
+        off += rec->size;
+        seq += 1;
+    }
+
+    seg->used    = off;
+    seg->end_seq = seq;
+    segment_unmap(seg);
+    return 0;
+}
+
+static int segment_reserve(mqtt_cache_t *cache)
+{
+    size_t     cap  = cache->seg_cap > 0 ? cache->seg_cap * 2 : 8;
+    segment_t *segs = NULL;
+
+    if (cache->n_seg < cache->seg_cap) {
+        return 0;
+    }
+
+    segs = realloc(cache->segs, cap * sizeof(*segs));
+    if (NULL == segs) {
+        return -1;
+    }
+
+    cache->segs    = segs;
+    cache->seg_cap = cap;
+    return 0;
+}
+
+// remove the oldest segment, returns the number of unacknowledged messages
+static size_t segment_drop(mqtt_cache_t *cache)
+{
+    char       path[PATH_MAX] = { 0 };
+    segment_t *seg            = &cache->segs[0];
+    size_t     dropped        = range_drop_below(cache, seg->end_seq);
+
+    segment_unmap(seg);
+    segment_path(cache, seg->first_seq, path, sizeof(path));
+    unlink(path);
+
+    if (is_active(cache, 0)) {
+        cache->writable = false;
+    }
+
+    cache->n_seg -= 1;
+    memmove(cache->segs, cache->segs + 1, cache->n_seg * sizeof(*seg));
+
+    if (cache->read_seg > 0) {
+        cache->read_seg -= 1;
+    } else {
+        cache->read_off = sizeof(segment_header_t);
+    }
+
+    cache->dirty = true;
+    return dropped;
+}
+
+// start a segment for writing, returns the number of messages evicted
+static int segment_new(mqtt_cache_t *cache)
+{
+    char              path[PATH_MAX] = { 0 };
+    int               evicted        = 0;
+    int               fd             = -1;
+    segment_header_t *header         = NULL;
+    segment_t         seg            = {
+        .first_seq = cache->next_seq,
+        .end_seq   = cache->next_seq,
+        .size      = cache->segment_size,
+        .used      = sizeof(*header),
+    };
+
+    while (cache->n_seg >= cache->max_segments) {
+        evicted += segment_drop(cache);
+    }
+
+    if (0 != segment_reserve(cache)) {
+        return -1;
+    }
+
+    segment_path(cache, seg.first_seq, path, sizeof(path));
+    fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0) {
+        return -1;
+    }
+
+    // allocate the blocks now, writing to a mapped hole of a full disk would
+    // raise SIGBUS
+    if (0 != posix_fallocate(fd, 0, seg.size)) {
+        close(fd);
+        unlink(path);
+        return -1;
+    }
+
+    seg.map = mmap(NULL, seg.size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (MAP_FAILED == seg.map) {
+        unlink(path);
+        return -1;
+    }
+
+    header            = (segment_header_t *) seg.map;
+    header->magic     = SEGMENT_MAGIC;
+    header->version   = CACHE_VERSION;
+    header->first_seq = seg.first_seq;
+
+    if (cache->writable && cache->read_seg + 1 != cache->n_seg) {
+        segment_unmap(&cache->segs[cache->n_seg - 1]);
+    }
+
+    cache->segs[cache->n_seg++] = seg;
+    cache->writable             = true;
+    return evicted;
+}
+
+// remove the segments whose messages are all acknowledged
+static void segments_release(mqtt_cache_t *cache)
+{
+    while (cache->n_seg > 1 &&
+           (0 == cache->n_range ||
+            cache->segs[0].end_seq <= cache->ranges[0].begin)) {
+        segment_drop(cache);
+    }
+}
+
+static int index_save(const mqtt_cache_t *cache)
+{
+    char           path[PATH_MAX] = { 0 };
+    char           tmp[PATH_MAX]  = { 0 };
+    FILE *         fp             = NULL;
+    index_header_t header         = {
+        .magic    = INDEX_MAGIC,
+        .version  = CACHE_VERSION,
+        .next_seq = cache->next_seq,
+        .n_range  = cache->n_range,
+    };
+
+    snprintf(path, sizeof(path), "%s/index", cache->dir);
+    snprintf(tmp, sizeof(tmp), "%s/index.tmp", cache->dir);
+
+    fp = fopen(tmp, "wb");
+    if (NULL == fp) {
+        return -1;
+    }
+
+    if (1 != fwrite(&header, sizeof(header), 1, fp) ||
+        cache->n_range !=
+            fwrite(cache->ranges, sizeof(*cache->ranges), cache->n_range,
+                   fp) ||
+        0 != fflush(fp) || 0 != fsync(fileno(fp))) {
+        fclose(fp);
+        unlink(tmp);
+        return -1;
+    }
+
+    fclose(fp);
+    return rename(tmp, path);
+}
+
+// the saved ranges, or NULL if no valid index
+static seq_range_t *index_load(const mqtt_cache_t *cache, size_t *n_range,
+                               uint64_t *next_seq)
+{
+    char           path[PATH_MAX] = { 0 };
+    FILE *         fp             = NULL;
+    index_header_t header         = { 0 };
+    seq_range_t *  ranges         = NULL;
+
+    snprintf(path, sizeof(path), "%s/index", cache->dir);
+    fp = fopen(path, "rb");
+    if (NULL == fp) {
+        return NULL;
+    }
+
+    if (1 != fread(&header, sizeof(header), 1, fp) ||
+        INDEX_MAGIC != header.magic || CACHE_VERSION != header.version ||
+        header.n_range > SIZE_MAX / sizeof(*ranges)) {
+        goto error;
+    }
+
+    // one more slot, as the tail appended after the index was saved
+    ranges = calloc(header.n_range + 1, sizeof(*ranges));
+    if (NULL == ranges ||
+        header.n_range != fread(ranges, sizeof(*ranges), header.n_range, fp)) {
+        goto error;
+    }
+
+    for (size_t i = 0; i < header.n_range; ++i) {
+        if (ranges[i].begin >= ranges[i].end ||
+            (i > 0 && ranges[i - 1].end > ranges[i].begin) ||
+            ranges[i].end > header.next_seq) {
+            goto error;
+        }
+    }
+
+    fclose(fp);
+    *n_range  = header.n_range;
+    *next_seq = header.next_seq;
+    return ranges;
+
+error:
+    free(ranges);
+    fclose(fp);
+    return NULL;
+}
+
+static int cmp_seq(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *) a, y = *(const uint64_t *) b;
+    return x < y ? -1 : x > y;
+}
+
+// list the segment files, oldest first
+static uint64_t *segments_list(const mqtt_cache_t *cache, size_t *n)
+{
+    DIR *          dir  = NULL;
+    struct dirent *ent  = NULL;
+    uint64_t *     seqs = NULL;
+    size_t         cap  = 0;
+
+    dir = opendir(cache->dir);
+    if (NULL == dir) {
+        return NULL;
+    }
+
+    *n = 0;
+    while (NULL != (ent = readdir(dir))) {
+        uint64_t seq = 0;
+        if (!parse_segment_name(ent->d_name, &seq)) {
+            continue;
+        }
+        if (*n == cap) {
+            uint64_t *tmp = realloc(seqs, (cap + 16) * sizeof(*seqs));
+            if (NULL == tmp) {
+                continue;
+            }
+            seqs = tmp;
+            cap += 16;
+        }
+        seqs[(*n)++] = seq;
+    }
+    closedir(dir);
+
+    if (*n > 0) {
+        qsort(seqs, *n, sizeof(*seqs), cmp_seq);
+    }
+    return seqs;
+}
+
+static int cache_load(mqtt_cache_t *cache)
+{
+    char         path[PATH_MAX] = { 0 };
+    size_t       n              = 0;
+    uint64_t *   seqs           = segments_list(cache, &n);
+    size_t       n_saved        = 0;
+    uint64_t     saved_next     = 0;
+    seq_range_t *saved          = index_load(cache, &n_saved, &saved_next);
+
+    for (size_t i = 0; i < n; ++i) {
+        segment_t seg = { .first_seq = seqs[i] };
+
+        if (0 != segment_load(cache, &seg) || seg.first_seq == seg.end_seq ||
+            seg.first_seq < cache->next_seq) {
+            segment_path(cache, seqs[i], path, sizeof(path));
+            unlink(path);
+            continue;
+        }
+
+        if (0 != segment_reserve(cache)) {
+            goto error;
+        }
+        cache->segs[cache->n_seg++] = seg;
+        cache->next_seq             = seg.end_seq;
+
+        if (NULL == saved) {
+            // no index, replay everything
+            if (0 != range_push(cache, seg.first_seq, seg.end_seq)) {
+                goto error;
+            }
+            continue;
+        }
+
+        // messages appended after the index was saved are not acknowledged
+        saved[n_saved].begin = saved_next;
+        saved[n_saved].end   = UINT64_MAX;
+        for (size_t j = 0; j <= n_saved; ++j) {
+            uint64_t begin = saved[j].begin > seg.first_seq ? saved[j].begin
+                                                            : seg.first_seq;
+            uint64_t end =
+                saved[j].end < seg.end_seq ? saved[j].end : seg.end_seq;
+            if (0 != range_push(cache, begin, end)) {
+                goto error;
+            }
+        }
+    }
+
+    if (saved && saved_next > cache->next_seq) {
+        cache->next_seq = saved_next;
+    }
+
+    // the disk size may have shrunk since
+    while (cache->n_seg > cache->max_segments) {
+        segment_drop(cache);
+    }
+    segments_release(cache);
+
+    cache->dirty = true;
+    free(saved);
+    free(seqs);
+    return 0;
+
+error:
+    free(saved);
+    free(seqs);
+    return -1;
+}
+
+static void cache_free(mqtt_cache_t *cache)
+{
+    for (size_t i = 0; i < cache->n_seg; ++i) {
+        segment_unmap(&cache->segs[i]);
+    }
+
+    free(cache->segs);
+    free(cache->ranges);
+    free(cache->dir);
+    free(cache);
+}
+
+mqtt_cache_t *mqtt_cache_open(const char *dir, size_t segment_size,
+                              size_t max_bytes)
+{
+    mqtt_cache_t *cache = NULL;
+
+    if (0 != make_dirs(dir)) {
+        return NULL;
+    }
+
+    cache = calloc(1, sizeof(*cache));
+    if (NULL == cache) {
+        return NULL;
+    }
+
+    cache->dir = strdup(dir);
+    if (NULL == cache->dir) {
+        free(cache);
+        return NULL;
+    }
+
+    segment_size = ALIGN8(segment_size);
+    if (segment_size < SEGMENT_SIZE_MIN) {
+        segment_size = SEGMENT_SIZE_MIN;
+    }
+
+    cache->segment_size = segment_size;
+    cache->max_segments = max_bytes / segment_size;
+    if (cache->max_segments < 2) {
+        cache->max_segments = 2;
+    }
+    cache->read_off = sizeof(segment_header_t);
+
+    if (0 != cache_load(cache)) {
+        // not synced, the index of a partial load would lose messages
+        cache_free(cache);
+        return NULL;
+    }
+
+    return cache;
+}
+
+void mqtt_cache_close(mqtt_cache_t *cache)
+{
+    if (cache) {
+        mqtt_cache_sync(cache);
+        cache_free(cache);
+    }
+}
+
+void mqtt_cache_remove(const char *dir)
+{
+    char           path[PATH_MAX] = { 0 };
+    DIR *          d              = NULL;
+    struct dirent *ent            = NULL;
+
+    d = opendir(dir);
+    if (NULL == d) {
+        return;
+    }
+
+    while (NULL != (ent = readdir(d))) {
+        uint64_t seq = 0;
+        if (parse_segment_name(ent->d_name, &seq) ||
+            0 == strcmp("index", ent->d_name) ||
+            0 == strcmp("index.tmp", ent->d_name)) {
+            snprintf(path, sizeof(path), "%s/%s", dir, ent->d_name);
+            unlink(path);
+        }
+    }
+    closedir(d);
+
+    rmdir(dir);
+}
+
+int mqtt_cache_append(mqtt_cache_t *cache, const char *topic,
+                      mqtt_compress_e encoding, const char *payload,
+                      size_t len)
+{
+    size_t           topic_len = strlen(topic);
+    size_t           size      = 0;
+    int              evicted   = 0;
+    segment_t *      seg       = NULL;
+    record_header_t *rec       = NULL;
+    char *           p         = NULL;
+
+    if (topic_len > UINT16_MAX ||
+        len > cache->segment_size - sizeof(segment_header_t)) {
+        return -1;
+    }
+
+    size = ALIGN8(sizeof(*rec) + topic_len + 1 + len);
+    if (size > cache->segment_size - sizeof(segment_header_t) ||
+        0 != range_reserve(cache, 1)) {
+        return -1;
+    }
+
+    seg = cache->writable ? &cache->segs[cache->n_seg - 1] : NULL;
+    if (NULL == seg || seg->used + size > seg->size) {
+        evicted = segment_new(cache);
+        if (evicted < 0) {
+            return -1;
+        }
+        seg = &cache->segs[cache->n_seg - 1];
+    }
+
+    rec            = (record_header_t *) (seg->map + seg->used);
+    rec->len       = len;
+    rec->seq       = cache->next_seq;
+    rec->topic_len = topic_len;
+    rec->encoding  = encoding;
+
+    p = (char *) (rec + 1);
+    memcpy(p, topic, topic_len + 1);
+    memcpy(p + topic_len + 1, payload, len);
+
+    // the size goes last, a record cut short by a crash reads as none
+    __atomic_store_n(&rec->size, (uint32_t) size, __ATOMIC_RELEASE);
+
+    seg->used += size;
+    seg->end_seq = ++cache->next_seq;
+    range_push(cache, rec->seq, rec->seq + 1);
+    cache->dirty = true;
+
+    return evicted;
+}
+
+int mqtt_cache_next(mqtt_cache_t *cache, mqtt_cache_record_t *rec)
+{
+    while (cache->read_seg < cache->n_seg) {
+        segment_t *            seg    = &cache->segs[cache->read_seg];
+        const record_header_t *header = NULL;
+
+        if (cache->read_off >= seg->used) {
+            if (cache->read_seg + 1 >= cache->n_seg) {
+                return -1;
+            }
+            if (!is_active(cache, cache->read_seg)) {
+                segment_unmap(seg);
+            }
+            cache->read_seg += 1;
+            cache->read_off = sizeof(segment_header_t);
+            continue;
+        }
+
+        if (NULL == seg->map && 0 != segment_map(cache, seg, false)) {
+            return -1;
+        }
+
+        header = (const record_header_t *) (seg->map + cache->read_off);
+        cache->read_off += header->size;
+
+        if (range_find(cache, header->seq) < 0) {
+            // acknowledged before a rewind
+            continue;
+        }
+
+        rec->seq      = header->seq;
+        rec->topic    = (const char *) (header + 1);
+        rec->encoding = header->encoding;
+        rec->payload  = rec->topic + header->topic_len + 1;
+        rec->len      = header->len;
+        return 0;
+    }
+
+    return -1;
+}
+
+void mqtt_cache_ack(mqtt_cache_t *cache, uint64_t seq)
+{
+    ssize_t      i = range_find(cache, seq);
+    seq_range_t *r = NULL;
+
+    if (i < 0) {
+        return;
+    }
+
+    r = &cache->ranges[i];
+    if (r->begin == seq) {
+        r->begin += 1;
+        if (r->begin == r->end) {
+            cache->n_range -= 1;
+            memmove(r, r + 1, (cache->n_range - i) * sizeof(*r));
+        }
+    } else if (r->end == seq + 1) {
+        r->end -= 1;
+    } else {
+        if (0 != range_reserve(cache, 1)) {
+            // keep it, a duplicate is better than a loss
+            return;
+        }
+        r = &cache->ranges[i];
+        memmove(r + 2, r + 1, (cache->n_range - i - 1) * sizeof(*r));
+        r[1].begin = seq + 1;
+        r[1].end   = r->end;
+        r->end     = seq;
+        cache->n_range += 1;
+    }
+
+    cache->count -= 1;
+    cache->dirty = true;
+    segments_release(cache);
+}
+
+void mqtt_cache_rewind(mqtt_cache_t *cache)
+{
+    size_t i = 0;
+
+    if (0 == cache->n_seg) {
+        return;
+    }
+
+    if (cache->n_range > 0) {
+        while (i + 1 < cache->n_seg &&
+               cache->segs[i].end_seq <= cache->ranges[0].begin) {
+            ++i;
+        }
+    } else {
+        i = cache->n_seg - 1;
+    }
+
+    if (i != cache->read_seg && cache->read_seg < cache->n_seg &&
+        !is_active(cache, cache->read_seg)) {
+        segment_unmap(&cache->segs[cache->read_seg]);
+    }
+
+    cache->read_seg = i;
+    cache->read_off = sizeof(segment_header_t);
+}
+
+size_t mqtt_cache_count(const mqtt_cache_t *cache)
+{
+    return cache->count;
+}
+
+int mqtt_cache_sync(mqtt_cache_t *cache)
+{
+    int rv = 0;
+
+    if (cache->writable) {
+        segment_t *seg = &cache->segs[cache->n_seg - 1];
+        if (0 != msync(seg->map, seg->used, MS_SYNC)) {
+            rv = -1;
+        }
+    }
+
+    if (cache->dirty) {
+        if (0 == index_save(cache)) {
+            cache->dirty = false;
+        } else {
+            rv = -1;
+        }
+    }
+
+    return rv;
+}
@@ -0,0 +1,100 @@
+/**
+ * NEURON IIoT System for Industry 4.0
+ * Copyright (C) 2020-2022 EMQ Technologies Co., Ltd All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ **/
+
+
+#ifndef NEURON_PLUGIN_MQTT_CACHE_H
+#define NEURON_PLUGIN_MQTT_CACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mqtt_config.h"
+
+// number of cached messages replayed per second
+#define NEU_METRIC_CACHE_DRAIN_RATE "cache_drain_rate"
+#define NEU_METRIC_CACHE_DRAIN_RATE_TYPE NEU_METRIC_TYPE_GAUAGE
+#define NEU_METRIC_CACHE_DRAIN_RATE_HELP \
+    "Number of cached messages replayed in the last second"
+
+/*
+ * Store and forward log of the uploads that could not be sent.
+ *
+ * Messages are appended to fixed size segment files in `dir`, each named
+ * after the sequence number of its first message, and replayed by walking
+ * the mapped segments. Sequence numbers of the messages not yet acknowledged
+ * are kept as sorted ranges, saved to the `index` file by mqtt_cache_sync so
+ * that replay resumes after a restart. A segment is removed once all of its
+ * messages are acknowledged, or evicted as a whole when the cache is full.
+ *
+ * Not thread safe.
+ */
+typedef struct mqtt_cache_s mqtt_cache_t;
+
+typedef struct {
+    uint64_t        seq;
+    const char *    topic;
+    mqtt_compress_e encoding;
+    const char *    payload;
+    size_t          len;
+} mqtt_cache_record_t;
+
+// open the cache in `dir`, reloading the messages left by a previous run
+mqtt_cache_t *mqtt_cache_open(const char *dir, size_t segment_size,
+                              size_t max_bytes);
+// sync and close the cache, the files are kept
+void mqtt_cache_close(mqtt_cache_t *cache);
+// remove the files of a closed cache
+void mqtt_cache_remove(const char *dir);
+
+/*
+ * Append a message, evicting the oldest segment when the cache is full.
+ *
+ * Returns the number of unacknowledged messages evicted, or -1 on failure.
+ */
+int mqtt_cache_append(mqtt_cache_t *cache, const char *topic,
+                      mqtt_compress_e encoding, const char *payload,
+                      size_t len);
+
+/*
+ * Get the next unacknowledged message to replay, pointers of `rec` are valid
+ * until the next call on the cache.
+ *
+ * Returns -1 if no more messages.
+ */
+int mqtt_cache_next(mqtt_cache_t *cache, mqtt_cache_record_t *rec);
+
+void mqtt_cache_ack(mqtt_cache_t *cache, uint64_t seq);
+// replay again from the oldest unacknowledged message
+void mqtt_cache_rewind(mqtt_cache_t *cache);
+
+// number of unacknowledged messages
+size_t mqtt_cache_count(const mqtt_cache_t *cache);
+
+// flush the segment being written and save the index
+int mqtt_cache_sync(mqtt_cache_t *cache);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
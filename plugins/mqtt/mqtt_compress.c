@@ -0,0 +1,110 @@
+/**
+ * NEURON IIoT System for Industry 4.0
+ * Copyright (C) 2020-2022 EMQ Technologies Co., Ltd All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ **/
+
+#include <stdlib.h>
+
+#include <lz4frame.h>
+#include <zlib.h>
+
+#include "mqtt_compress.h"
+
+const char *mqtt_compress_encoding(mqtt_compress_e compress)
+{
+    switch (compress) {
+    case MQTT_COMPRESS_ZLIB:
+        return "deflate";
+    case MQTT_COMPRESS_LZ4:
+        return "lz4";
+    default:
+        return NULL;
+    }
+}
+
+static char *compress_zlib(const char *payload, size_t len, size_t *out_len)
+{
+    uLongf bound = compressBound(len);
+    char * buf   = malloc(bound);
+
+    if (NULL == buf) {
+        return NULL;
+    }
+
+    // level 1: most of the ratio on repetitive JSON for a fraction of the cpu
+    if (Z_OK !=
+        compress2((Bytef *) buf, &bound, (const Bytef *) payload, len, 1)) {
+        free(buf);
+        return NULL;
+    }
+
+    *out_len = bound;
+    return buf;
+}
+
+static char *compress_lz4(const char *payload, size_t len, size_t *out_len)
+{
+    LZ4F_preferences_t prefs = { 0 };
+    size_t             bound = 0;
+    size_t             n     = 0;
+    char *             buf   = NULL;
+
+    prefs.frameInfo.contentSize = len;
+
+    bound = LZ4F_compressFrameBound(len, &prefs);
+    buf   = malloc(bound);
+    if (NULL == buf) {
+        return NULL;
+    }
+
+    n = LZ4F_compressFrame(buf, bound, payload, len, &prefs);
+    if (LZ4F_isError(n)) {
+        free(buf);
+        return NULL;
+    }
+
+    *out_len = n;
+    return buf;
+}
+
+char *mqtt_compress(mqtt_compress_e compress, const char *payload, size_t len,
+                    size_t *out_len)
+{
+    char * buf = NULL;
+    size_t n   = 0;
+
+    switch (compress) {
+    case MQTT_COMPRESS_ZLIB:
+        buf = compress_zlib(payload, len, &n);
+        break;
+    case MQTT_COMPRESS_LZ4:
+        buf = compress_lz4(payload, len, &n);
+        break;
+    default:
+        return NULL;
+    }
+
+    if (NULL != buf && n >= len) {
+        free(buf);
+        buf = NULL;
+    }
+
+    if (NULL != buf) {
+        *out_len = n;
+    }
+    return buf;
+}
@@ -0,0 +1,49 @@
+/**
+ * NEURON IIoT System for Industry 4.0
+ * Copyright (C) 2020-2022 EMQ Technologies Co., Ltd All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ **/
+
+#ifndef NEURON_PLUGIN_MQTT_COMPRESS_H
+#define NEURON_PLUGIN_MQTT_COMPRESS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+
+#include "mqtt_config.h"
+
+// value of the `content-encoding` user property of compressed uploads
+const char *mqtt_compress_encoding(mqtt_compress_e compress);
+
+/*
+ * Compress `len` bytes of `payload`, as a zlib stream for MQTT_COMPRESS_ZLIB
+ * and as a LZ4 frame for MQTT_COMPRESS_LZ4, both self describing so that
+ * consumers need no out of band size.
+ *
+ * Returns a malloc'ed buffer and its length in `out_len`, or NULL on failure
+ * and when the result would not be smaller than the payload.
+ */
+char *mqtt_compress(mqtt_compress_e compress, const char *payload, size_t len,
+                    size_t *out_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
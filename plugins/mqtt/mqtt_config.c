@@ -157,7 +157,9 @@ static int parse_cache_params(neu_plugin_t *plugin, const char *setting,
                               neu_json_elem_t *offline_cache,
                               neu_json_elem_t *cache_mem_size,
                               neu_json_elem_t *cache_disk_size,
-                              neu_json_elem_t *cache_sync_interval)
+                              neu_json_elem_t *cache_sync_interval,
+                              neu_json_elem_t *cache_replay_rate,
+                              neu_json_elem_t *cache_replay_policy)
 {
     int   ret          = 0;
     char *err_param    = NULL;
@@ -175,6 +177,8 @@ static int parse_cache_params(neu_plugin_t *plugin, const char *setting,
         cache_mem_size->v.val_int      = 0;
         cache_disk_size->v.val_int     = 0;
         cache_sync_interval->v.val_int = NEU_MQTT_CACHE_SYNC_INTERVAL_DEFAULT;
+        cache_replay_rate->v.val_int   = MQTT_CACHE_REPLAY_RATE_DEFAULT;
+        cache_replay_policy->v.val_int = MQTT_CACHE_REPLAY_LIVE_FIRST;
         return 0;
     }
 
@@ -239,6 +243,108 @@ static int parse_cache_params(neu_plugin_t *plugin, const char *setting,
         cache_sync_interval->v.val_int = NEU_MQTT_CACHE_SYNC_INTERVAL_DEFAULT;
     }
 
+    // cache-replay-rate, optional
+    ret = neu_parse_param(setting, NULL, 1, cache_replay_rate);
+    if (0 != ret) {
+        cache_replay_rate->v.val_int = MQTT_CACHE_REPLAY_RATE_DEFAULT;
+    } else if (cache_replay_rate->v.val_int < MQTT_CACHE_REPLAY_RATE_MIN ||
+               MQTT_CACHE_REPLAY_RATE_MAX < cache_replay_rate->v.val_int) {
+        plog_error(plugin, "setting invalid cache replay rate: %" PRIi64,
+                   cache_replay_rate->v.val_int);
+        return -1;
+    }
+
+    // cache-replay-policy, optional
+    ret = neu_parse_param(setting, NULL, 1, cache_replay_policy);
+    if (0 != ret) {
+        cache_replay_policy->v.val_int = MQTT_CACHE_REPLAY_LIVE_FIRST;
+    } else if (MQTT_CACHE_REPLAY_LIVE_FIRST != cache_replay_policy->v.val_int &&
+               MQTT_CACHE_REPLAY_OLDEST_FIRST !=
+                   cache_replay_policy->v.val_int) {
+        plog_error(plugin, "setting invalid cache replay policy: %" PRIi64,
+                   cache_replay_policy->v.val_int);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int parse_compress_params(neu_plugin_t *plugin, const char *setting,
+                                 neu_json_elem_t *compress,
+                                 neu_json_elem_t *compress_threshold)
+{
+    // compress, optional for backward compatibility
+    int ret = neu_parse_param(setting, NULL, 1, compress);
+    if (0 != ret) {
+        compress->v.val_int = MQTT_COMPRESS_NONE;
+        return 0;
+    }
+
+    if (MQTT_COMPRESS_NONE != compress->v.val_int &&
+        MQTT_COMPRESS_ZLIB != compress->v.val_int &&
+        MQTT_COMPRESS_LZ4 != compress->v.val_int) {
+        plog_error(plugin, "setting invalid compress: %" PRIi64,
+                   compress->v.val_int);
+        return -1;
+    }
+
+    ret = neu_parse_param(setting, NULL, 1, compress_threshold);
+    if (0 != ret) {
+        compress_threshold->v.val_int = MQTT_COMPRESS_THRESHOLD_DEFAULT;
+    } else if (compress_threshold->v.val_int < 0 ||
+               MQTT_COMPRESS_THRESHOLD_MAX < compress_threshold->v.val_int) {
+        plog_error(plugin, "setting invalid compress threshold: %" PRIi64,
+                   compress_threshold->v.val_int);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int parse_batch_params(neu_plugin_t *plugin, const char *setting,
+                              neu_json_elem_t *batch,
+                              neu_json_elem_t *batch_max_bytes,
+                              neu_json_elem_t *batch_max_count,
+                              neu_json_elem_t *batch_max_delay)
+{
+    // batch flag, optional for backward compatibility
+    int ret = neu_parse_param(setting, NULL, 1, batch);
+    if (0 != ret || !batch->v.val_bool) {
+        plog_notice(plugin, "setting batch disabled");
+        batch->v.val_bool = false;
+        return 0;
+    }
+
+    ret = neu_parse_param(setting, NULL, 1, batch_max_bytes);
+    if (0 != ret) {
+        batch_max_bytes->v.val_int = MQTT_BATCH_MAX_BYTES_DEFAULT;
+    } else if (batch_max_bytes->v.val_int < MQTT_BATCH_MAX_BYTES_MIN ||
+               MQTT_BATCH_MAX_BYTES_MAX < batch_max_bytes->v.val_int) {
+        plog_error(plugin, "setting invalid batch max bytes: %" PRIi64,
+                   batch_max_bytes->v.val_int);
+        return -1;
+    }
+
+    ret = neu_parse_param(setting, NULL, 1, batch_max_count);
+    if (0 != ret) {
+        batch_max_count->v.val_int = MQTT_BATCH_MAX_COUNT_DEFAULT;
+    } else if (batch_max_count->v.val_int < MQTT_BATCH_MAX_COUNT_MIN ||
+               MQTT_BATCH_MAX_COUNT_MAX < batch_max_count->v.val_int) {
+        plog_error(plugin, "setting invalid batch max count: %" PRIi64,
+                   batch_max_count->v.val_int);
+        return -1;
+    }
+
+    ret = neu_parse_param(setting, NULL, 1, batch_max_delay);
+    if (0 != ret) {
+        batch_max_delay->v.val_int = MQTT_BATCH_MAX_DELAY_DEFAULT;
+    } else if (batch_max_delay->v.val_int < MQTT_BATCH_MAX_DELAY_MIN ||
+               MQTT_BATCH_MAX_DELAY_MAX < batch_max_delay->v.val_int) {
+        plog_error(plugin, "setting invalid batch max delay: %" PRIi64,
+                   batch_max_delay->v.val_int);
+        return -1;
+    }
+
     return 0;
 }
 
@@ -295,6 +401,24 @@ int mqtt_config_parse(neu_plugin_t *plugin, const char *setting,
                                         .t    = NEU_JSON_INT };
     neu_json_elem_t cache_sync_interval = { .name = "cache-sync-interval",
                                             .t    = NEU_JSON_INT };
+    neu_json_elem_t cache_replay_rate   = { .name = "cache-replay-rate",
+                                          .t    = NEU_JSON_INT };
+    neu_json_elem_t cache_replay_policy = { .name = "cache-replay-policy",
+                                            .t    = NEU_JSON_INT };
+    neu_json_elem_t compress            = { .name = "compress",
+                                 .t    = NEU_JSON_INT };
+    neu_json_elem_t compress_threshold  = { .name = "compress-threshold",
+                                           .t    = NEU_JSON_INT };
+    neu_json_elem_t batch               = { .name = "batch",
+                              .t    = NEU_JSON_BOOL };
+    neu_json_elem_t batch_max_bytes     = { .name = "batch-max-bytes",
+                                        .t    = NEU_JSON_INT };
+    neu_json_elem_t batch_max_count     = { .name = "batch-max-count",
+                                        .t    = NEU_JSON_INT };
+    neu_json_elem_t batch_max_delay     = { .name = "batch-max-delay",
+                                        .t    = NEU_JSON_INT };
+    neu_json_elem_t connection_pool     = { .name = "connection-pool",
+                                        .t    = NEU_JSON_INT };
     neu_json_elem_t host                = { .name = "host", .t = NEU_JSON_STR };
     neu_json_elem_t port                = { .name = "port", .t = NEU_JSON_INT };
     neu_json_elem_t username = { .name = "username", .t = NEU_JSON_STR };
@@ -355,7 +479,9 @@ int mqtt_config_parse(neu_plugin_t *plugin, const char *setting,
     // format, required
     if (MQTT_UPLOAD_FORMAT_VALUES != format.v.val_int &&
         MQTT_UPLOAD_FORMAT_TAGS != format.v.val_int &&
-        MQTT_UPLOAD_FORMAT_ECP != format.v.val_int) {
+        MQTT_UPLOAD_FORMAT_ECP != format.v.val_int &&
+        MQTT_UPLOAD_FORMAT_MSGPACK != format.v.val_int &&
+        MQTT_UPLOAD_FORMAT_PROTOBUF != format.v.val_int) {
         plog_error(plugin, "setting invalid format: %" PRIi64,
                    format.v.val_int);
         goto error;
@@ -401,11 +527,37 @@ int mqtt_config_parse(neu_plugin_t *plugin, const char *setting,
 
     // offline cache
     ret = parse_cache_params(plugin, setting, &offline_cache, &cache_mem_size,
-                             &cache_disk_size, &cache_sync_interval);
+                             &cache_disk_size, &cache_sync_interval,
+                             &cache_replay_rate, &cache_replay_policy);
+    if (0 != ret) {
+        goto error;
+    }
+
+    // upload compression
+    ret = parse_compress_params(plugin, setting, &compress,
+                                &compress_threshold);
     if (0 != ret) {
         goto error;
     }
 
+    // upload batching
+    ret = parse_batch_params(plugin, setting, &batch, &batch_max_bytes,
+                             &batch_max_count, &batch_max_delay);
+    if (0 != ret) {
+        goto error;
+    }
+
+    // connection pool, optional for backward compatibility
+    ret = neu_parse_param(setting, NULL, 1, &connection_pool);
+    if (0 != ret) {
+        connection_pool.v.val_int = MQTT_CONNECTION_POOL_DEFAULT;
+    } else if (connection_pool.v.val_int < MQTT_CONNECTION_POOL_MIN ||
+               MQTT_CONNECTION_POOL_MAX < connection_pool.v.val_int) {
+        plog_error(plugin, "setting invalid connection pool: %" PRIi64,
+                   connection_pool.v.val_int);
+        goto error;
+    }
+
     // host, required
     if (0 == strlen(host.v.val_str)) {
         plog_error(plugin, "setting invalid host: `%s`", host.v.val_str);
@@ -451,6 +603,8 @@ int mqtt_config_parse(neu_plugin_t *plugin, const char *setting,
     config->client_id                = client_id.v.val_str;
     config->qos                      = qos.v.val_int;
     config->format                   = format.v.val_int;
+    config->compress                 = compress.v.val_int;
+    config->compress_threshold       = compress_threshold.v.val_int;
     config->write_req_topic          = write_req_topic.v.val_str;
     config->write_resp_topic         = write_resp_topic.v.val_str;
     config->driver_action_req_topic  = driver_action_req_topic.v.val_str;
@@ -459,6 +613,13 @@ int mqtt_config_parse(neu_plugin_t *plugin, const char *setting,
     config->cache_mem_size           = cache_mem_size.v.val_int * MB;
     config->cache_disk_size          = cache_disk_size.v.val_int * MB;
     config->cache_sync_interval      = cache_sync_interval.v.val_int;
+    config->cache_replay_rate        = cache_replay_rate.v.val_int;
+    config->cache_replay_policy      = cache_replay_policy.v.val_int;
+    config->batch                    = batch.v.val_bool;
+    config->batch_max_bytes          = batch_max_bytes.v.val_int;
+    config->batch_max_count          = batch_max_count.v.val_int;
+    config->batch_max_delay          = batch_max_delay.v.val_int;
+    config->connection_pool          = connection_pool.v.val_int;
     config->host                     = host.v.val_str;
     config->port                     = port.v.val_int;
     config->username                 = username.v.val_str;
@@ -478,6 +639,12 @@ int mqtt_config_parse(neu_plugin_t *plugin, const char *setting,
     plog_notice(plugin, "config qos             : %d", config->qos);
     plog_notice(plugin, "config format          : %s",
                 mqtt_upload_format_str(config->format));
+    plog_notice(plugin, "config compress        : %s",
+                mqtt_compress_str(config->compress));
+    if (MQTT_COMPRESS_NONE != config->compress) {
+        plog_notice(plugin, "config compress-threshold: %zu",
+                    config->compress_threshold);
+    }
     plog_notice(plugin, "config write-req-topic : %s", config->write_req_topic);
     plog_notice(plugin, "config write-resp-topic: %s",
                 config->write_resp_topic);
@@ -502,6 +669,23 @@ int mqtt_config_parse(neu_plugin_t *plugin, const char *setting,
                 config->cache_disk_size);
     plog_notice(plugin, "config cache-sync-interval : %zu",
                 config->cache_sync_interval);
+    if (config->cache) {
+        plog_notice(plugin, "config cache-replay-rate   : %zu",
+                    config->cache_replay_rate);
+        plog_notice(plugin, "config cache-replay-policy : %s",
+                    mqtt_cache_replay_str(config->cache_replay_policy));
+    }
+    plog_notice(plugin, "config batch           : %d", config->batch);
+    if (config->batch) {
+        plog_notice(plugin, "config batch-max-bytes : %zu",
+                    config->batch_max_bytes);
+        plog_notice(plugin, "config batch-max-count : %zu",
+                    config->batch_max_count);
+        plog_notice(plugin, "config batch-max-delay : %zu",
+                    config->batch_max_delay);
+    }
+    plog_notice(plugin, "config connection-pool : %zu",
+                config->connection_pool);
     plog_notice(plugin, "config host            : %s", config->host);
     plog_notice(plugin, "config port            : %" PRIu16, config->port);
 
@@ -30,10 +30,33 @@ extern "C" {
 #include "connection/mqtt_client.h"
 #include "plugin.h"
 
+#define MQTT_BATCH_MAX_BYTES_MIN 1024
+#define MQTT_BATCH_MAX_BYTES_MAX (16 * 1024 * 1024)
+#define MQTT_BATCH_MAX_BYTES_DEFAULT (64 * 1024)
+#define MQTT_BATCH_MAX_COUNT_MIN 1
+#define MQTT_BATCH_MAX_COUNT_MAX 10000
+#define MQTT_BATCH_MAX_COUNT_DEFAULT 100
+#define MQTT_BATCH_MAX_DELAY_MIN 1
+#define MQTT_BATCH_MAX_DELAY_MAX 60000
+#define MQTT_BATCH_MAX_DELAY_DEFAULT 100
+
+#define MQTT_CACHE_REPLAY_RATE_MIN 1
+#define MQTT_CACHE_REPLAY_RATE_MAX 100000
+#define MQTT_CACHE_REPLAY_RATE_DEFAULT 1000
+
+#define MQTT_CONNECTION_POOL_MIN 1
+#define MQTT_CONNECTION_POOL_MAX 16
+#define MQTT_CONNECTION_POOL_DEFAULT 1
+
+#define MQTT_COMPRESS_THRESHOLD_MAX (1024 * 1024)
+#define MQTT_COMPRESS_THRESHOLD_DEFAULT 1024
+
 typedef enum {
-    MQTT_UPLOAD_FORMAT_VALUES = 0,
-    MQTT_UPLOAD_FORMAT_TAGS   = 1,
-    MQTT_UPLOAD_FORMAT_ECP    = 2,
+    MQTT_UPLOAD_FORMAT_VALUES   = 0,
+    MQTT_UPLOAD_FORMAT_TAGS     = 1,
+    MQTT_UPLOAD_FORMAT_ECP      = 2,
+    MQTT_UPLOAD_FORMAT_MSGPACK  = 3,
+    MQTT_UPLOAD_FORMAT_PROTOBUF = 4,
 } mqtt_upload_format_e;
 
 static inline const char *mqtt_upload_format_str(mqtt_upload_format_e f)
@@ -45,6 +68,53 @@ static inline const char *mqtt_upload_format_str(mqtt_upload_format_e f)
         return "format-tags";
     case MQTT_UPLOAD_FORMAT_ECP:
         return "ECP-format";
+    case MQTT_UPLOAD_FORMAT_MSGPACK:
+        return "format-msgpack";
+    case MQTT_UPLOAD_FORMAT_PROTOBUF:
+        return "format-protobuf";
+    default:
+        return NULL;
+    }
+}
+
+static inline bool mqtt_upload_format_is_binary(mqtt_upload_format_e f)
+{
+    return MQTT_UPLOAD_FORMAT_MSGPACK == f || MQTT_UPLOAD_FORMAT_PROTOBUF == f;
+}
+
+typedef enum {
+    MQTT_COMPRESS_NONE = 0,
+    MQTT_COMPRESS_ZLIB = 1,
+    MQTT_COMPRESS_LZ4  = 2,
+} mqtt_compress_e;
+
+static inline const char *mqtt_compress_str(mqtt_compress_e c)
+{
+    switch (c) {
+    case MQTT_COMPRESS_NONE:
+        return "none";
+    case MQTT_COMPRESS_ZLIB:
+        return "zlib";
+    case MQTT_COMPRESS_LZ4:
+        return "lz4";
+    default:
+        return NULL;
+    }
+}
+
+// how cached messages are sent along with live ones once reconnected
+typedef enum {
+    MQTT_CACHE_REPLAY_LIVE_FIRST   = 0, // publish live ones at once
+    MQTT_CACHE_REPLAY_OLDEST_FIRST = 1, // queue live ones behind the cache
+} mqtt_cache_replay_e;
+
+static inline const char *mqtt_cache_replay_str(mqtt_cache_replay_e p)
+{
+    switch (p) {
+    case MQTT_CACHE_REPLAY_LIVE_FIRST:
+        return "live-first";
+    case MQTT_CACHE_REPLAY_OLDEST_FIRST:
+        return "oldest-first";
     default:
         return NULL;
     }
@@ -55,6 +125,8 @@ typedef struct {
     char *               client_id;               // client id
     neu_mqtt_qos_e       qos;                     // message QoS
     mqtt_upload_format_e format;                  // upload format
+    mqtt_compress_e      compress;                // upload compression
+    size_t               compress_threshold;      // compress from bytes
     char *               write_req_topic;         // write request topic
     char *               write_resp_topic;        // write response topic
     char *               driver_action_req_topic; // driver action request topic
@@ -67,6 +139,13 @@ typedef struct {
     size_t   cache_mem_size;           // cache memory size in bytes
     size_t   cache_disk_size;          // cache disk size in bytes
     size_t   cache_sync_interval;      // cache sync interval
+    size_t   cache_replay_rate;        // cached messages sent per second
+    mqtt_cache_replay_e cache_replay_policy; // cache replay policy
+    bool     batch;                    // upload batching flag
+    size_t   batch_max_bytes;          // batch payload size limit in bytes
+    size_t   batch_max_count;          // batch report number limit
+    size_t   batch_max_delay;          // batch delay limit in milliseconds
+    size_t   connection_pool;          // number of client sessions
     char *   host;                     // broker host
     uint16_t port;                     // broker port
     char *   username;                 // user name
@@ -0,0 +1,243 @@
+/**
+ * NEURON IIoT System for Industry 4.0
+ * Copyright (C) 2020-2022 EMQ Technologies Co., Ltd All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ **/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <jansson.h>
+
+#include "msg.h"
+
+#include "mqtt_delta.h"
+
+#define FNV_OFFSET 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+
+static uint64_t fnv1a(uint64_t h, const void *data, size_t len)
+{
+    const uint8_t *p = data;
+
+    for (size_t i = 0; i < len; i++) {
+        h ^= p[i];
+        h *= FNV_PRIME;
+    }
+    return h;
+}
+
+// only the bytes in use, the rest of the union may hold anything
+static uint64_t value_digest(uint64_t h, const neu_dvalue_t *dv)
+{
+    const neu_value_u *v    = &dv->value;
+    char *             json = NULL;
+
+    h = fnv1a(h, &dv->type, sizeof(dv->type));
+
+    switch (dv->type) {
+    case NEU_TYPE_INT8:
+    case NEU_TYPE_UINT8:
+    case NEU_TYPE_BIT:
+        return fnv1a(h, &v->u8, sizeof(v->u8));
+    case NEU_TYPE_INT16:
+    case NEU_TYPE_UINT16:
+    case NEU_TYPE_WORD:
+        return fnv1a(h, &v->u16, sizeof(v->u16));
+    case NEU_TYPE_INT32:
+    case NEU_TYPE_UINT32:
+    case NEU_TYPE_DWORD:
+    case NEU_TYPE_ERROR:
+        return fnv1a(h, &v->u32, sizeof(v->u32));
+    case NEU_TYPE_INT64:
+    case NEU_TYPE_UINT64:
+    case NEU_TYPE_LWORD:
+        return fnv1a(h, &v->u64, sizeof(v->u64));
+    case NEU_TYPE_FLOAT:
+        return fnv1a(h, &v->f32, sizeof(v->f32));
+    case NEU_TYPE_DOUBLE:
+        return fnv1a(h, &v->d64, sizeof(v->d64));
+    case NEU_TYPE_BOOL:
+        return fnv1a(h, &v->boolean, sizeof(v->boolean));
+    case NEU_TYPE_STRING:
+    case NEU_TYPE_TIME:
+    case NEU_TYPE_DATA_AND_TIME:
+    case NEU_TYPE_ARRAY_CHAR:
+        return fnv1a(h, v->str, strnlen(v->str, sizeof(v->str)));
+    case NEU_TYPE_BYTES:
+        return fnv1a(h, v->bytes.bytes, v->bytes.length);
+    case NEU_TYPE_PTR:
+        return fnv1a(h, v->ptr.ptr, v->ptr.length);
+    case NEU_TYPE_ARRAY_INT8:
+        return fnv1a(h, v->i8s.i8s, v->i8s.length * sizeof(int8_t));
+    case NEU_TYPE_ARRAY_UINT8:
+        return fnv1a(h, v->u8s.u8s, v->u8s.length * sizeof(uint8_t));
+    case NEU_TYPE_ARRAY_INT16:
+        return fnv1a(h, v->i16s.i16s, v->i16s.length * sizeof(int16_t));
+    case NEU_TYPE_ARRAY_UINT16:
+        return fnv1a(h, v->u16s.u16s, v->u16s.length * sizeof(uint16_t));
+    case NEU_TYPE_ARRAY_INT32:
+        return fnv1a(h, v->i32s.i32s, v->i32s.length * sizeof(int32_t));
+    case NEU_TYPE_ARRAY_UINT32:
+        return fnv1a(h, v->u32s.u32s, v->u32s.length * sizeof(uint32_t));
+    case NEU_TYPE_ARRAY_INT64:
+        return fnv1a(h, v->i64s.i64s, v->i64s.length * sizeof(int64_t));
+    case NEU_TYPE_ARRAY_UINT64:
+        return fnv1a(h, v->u64s.u64s, v->u64s.length * sizeof(uint64_t));
+    case NEU_TYPE_ARRAY_FLOAT:
+        return fnv1a(h, v->f32s.f32s, v->f32s.length * sizeof(float));
+    case NEU_TYPE_ARRAY_DOUBLE:
+        return fnv1a(h, v->f64s.f64s, v->f64s.length * sizeof(double));
+    case NEU_TYPE_ARRAY_BOOL:
+        return fnv1a(h, v->bools.bools, v->bools.length * sizeof(bool));
+    case NEU_TYPE_ARRAY_STRING:
+        h = fnv1a(h, &v->strs.length, sizeof(v->strs.length));
+        for (uint8_t i = 0; i < v->strs.length; i++) {
+            // the terminating zeros keep ["ab", "c"] apart from ["a", "bc"]
+            if (NULL != v->strs.strs[i]) {
+                h = fnv1a(h, v->strs.strs[i], strlen(v->strs.strs[i]) + 1);
+            }
+        }
+        return h;
+    case NEU_TYPE_CUSTOM:
+        json = json_dumps(v->json, JSON_COMPACT | JSON_SORT_KEYS);
+        if (NULL != json) {
+            h = fnv1a(h, json, strlen(json));
+            free(json);
+        }
+        return h;
+    }
+
+    return h;
+}
+
+static uint64_t tag_digest(const neu_resp_tag_value_meta_t *tag)
+{
+    uint64_t h = value_digest(FNV_OFFSET, &tag->value);
+
+    for (int k = 0; k < NEU_TAG_META_SIZE && tag->metas[k].name[0]; k++) {
+        h = fnv1a(h, tag->metas[k].name, strlen(tag->metas[k].name) + 1);
+        h = value_digest(h, &tag->metas[k].value);
+    }
+
+    return h;
+}
+
+static void clear_tags(mqtt_delta_t *delta)
+{
+    mqtt_delta_tag_t *t = NULL, *tmp = NULL;
+
+    HASH_ITER(hh, delta->tags, t, tmp)
+    {
+        HASH_DEL(delta->tags, t);
+        free(t);
+    }
+}
+
+mqtt_delta_t *mqtt_delta_new(uint32_t keyframe)
+{
+    mqtt_delta_t *delta = calloc(1, sizeof(*delta));
+
+    if (NULL != delta) {
+        delta->keyframe = keyframe > 0 ? keyframe : 1;
+    }
+    return delta;
+}
+
+void mqtt_delta_free(mqtt_delta_t *delta)
+{
+    if (NULL != delta) {
+        clear_tags(delta);
+        free(delta);
+    }
+}
+
+// record the digest, return whether it differs from the recorded one
+static int update_tag(mqtt_delta_t *delta, const char *name, uint64_t digest)
+{
+    mqtt_delta_tag_t *t = NULL;
+
+    HASH_FIND_STR(delta->tags, name, t);
+    if (NULL != t) {
+        if (t->digest == digest) {
+            return 0;
+        }
+        t->digest = digest;
+        return 1;
+    }
+
+    t = calloc(1, sizeof(*t));
+    if (NULL == t) {
+        return -1;
+    }
+    strncpy(t->name, name, sizeof(t->name) - 1);
+    t->digest = digest;
+    HASH_ADD_STR(delta->tags, name, t);
+    return 1;
+}
+
+UT_array *mqtt_delta_filter(mqtt_delta_t *delta, UT_array *tags,
+                            bool skip_error, uint64_t *seq, bool *keyframe)
+{
+    UT_array *out = NULL;
+    bool      key = 0 == delta->seq || delta->n_delta + 1 >= delta->keyframe;
+
+    utarray_new(out, neu_resp_tag_value_meta_icd());
+
+    if (key) {
+        // tags removed from the group are forgotten
+        clear_tags(delta);
+    }
+
+    utarray_foreach(tags, neu_resp_tag_value_meta_t *, tag)
+    {
+        int changed = 0;
+
+        if (skip_error && NEU_TYPE_ERROR == tag->value.type) {
+            continue;
+        }
+
+        changed = update_tag(delta, tag->tag, tag_digest(tag));
+
+        if (changed < 0) {
+            // forget everything, the next report is a keyframe
+            mqtt_delta_resync(delta);
+            utarray_free(out);
+            return NULL;
+        }
+
+        if (key || changed) {
+            utarray_push_back(out, tag);
+        }
+    }
+
+    // reports without any change count towards the keyframe all the same, so
+    // that a keyframe is sent now and then even if nothing changes
+    delta->n_delta = key ? 0 : delta->n_delta + 1;
+
+    if (utarray_len(out) > 0) {
+        *seq      = ++delta->seq;
+        *keyframe = key;
+    }
+
+    return out;
+}
+
+void mqtt_delta_resync(mqtt_delta_t *delta)
+{
+    clear_tags(delta);
+    delta->n_delta = delta->keyframe;
+}
@@ -0,0 +1,74 @@
+/**
+ * NEURON IIoT System for Industry 4.0
+ * Copyright (C) 2020-2022 EMQ Technologies Co., Ltd All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ **/
+
+#ifndef NEURON_PLUGIN_MQTT_DELTA_H
+#define NEURON_PLUGIN_MQTT_DELTA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "define.h"
+#include "utils/utarray.h"
+#include "utils/uthash.h"
+
+#define MQTT_DELTA_KEYFRAME_MIN 1
+#define MQTT_DELTA_KEYFRAME_MAX 100000
+#define MQTT_DELTA_KEYFRAME_DEFAULT 60
+
+typedef struct {
+    char           name[NEU_TAG_NAME_LEN];
+    uint64_t       digest;
+    UT_hash_handle hh;
+} mqtt_delta_tag_t;
+
+/*
+ * Delta upload state of a subscription. An upload carries only the tags whose
+ * value or metas changed since the previous upload, and every `keyframe`
+ * uploads one carries all of them. Uploads are numbered from 1 so that
+ * consumers can tell a lost upload and wait for the next keyframe.
+ */
+typedef struct {
+    uint32_t          keyframe; // uploads from a keyframe to the next one
+    uint32_t          n_delta;  // uploads since the last keyframe
+    uint64_t          seq;      // sequence number of the last upload
+    mqtt_delta_tag_t *tags;     // digests of the values last uploaded
+} mqtt_delta_t;
+
+mqtt_delta_t *mqtt_delta_new(uint32_t keyframe);
+void          mqtt_delta_free(mqtt_delta_t *delta);
+
+// return the tags of the next upload, an array of neu_resp_tag_value_meta_t
+// sharing the values of `tags`, empty if there is nothing to upload, NULL on
+// failure. Tags of NEU_TYPE_ERROR are left out if `skip_error`, and keep the
+// value they had. `seq` and `keyframe` are set unless the array is empty
+UT_array *mqtt_delta_filter(mqtt_delta_t *delta, UT_array *tags,
+                            bool skip_error, uint64_t *seq, bool *keyframe);
+
+// the last upload was not sent, make the next one a keyframe
+void mqtt_delta_resync(mqtt_delta_t *delta);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
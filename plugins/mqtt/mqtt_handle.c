@@ -25,9 +25,13 @@
 #include "json/neu_json_driver.h"
 #include "json/neu_json_mqtt.h"
 #include "json/neu_json_rw.h"
+#include "json/neu_json_stream.h"
 
+#include "mqtt_binary.h"
+#include "mqtt_compress.h"
 #include "mqtt_handle.h"
 #include "mqtt_plugin.h"
+#include "mqtt_shard.h"
 
 static void to_traceparent(uint8_t *trace_id, char *span_id, char *out)
 {
@@ -64,66 +68,89 @@ static int tag_values_to_json(UT_array *tags, neu_json_read_resp_t *json)
     return 0;
 }
 
-void filter_error_tags(neu_reqresp_trans_data_t *data)
+// the tags without the error ones, `tags` itself if none of them is, else a
+// copy for the caller to free, as `tags` is shared by the subscribers
+static UT_array *filter_error_tags(UT_array *tags)
 {
-    if (!data || !data->tags) {
-        return;
+    UT_array *filtered_tags = NULL;
+
+    neu_resp_tag_value_meta_t *tag_ptr = NULL;
+    while ((tag_ptr =
+                (neu_resp_tag_value_meta_t *) utarray_next(tags, tag_ptr))) {
+        if (tag_ptr->value.type == NEU_TYPE_ERROR) {
+            break;
+        }
+    }
+    if (NULL == tag_ptr) {
+        // no error tags, spare the copy
+        return tags;
     }
 
-    UT_array *filtered_tags;
     utarray_new(filtered_tags, neu_resp_tag_value_meta_icd());
 
-    neu_resp_tag_value_meta_t *tag_ptr = NULL;
-    while ((tag_ptr = (neu_resp_tag_value_meta_t *) utarray_next(data->tags,
-                                                                 tag_ptr))) {
+    tag_ptr = NULL;
+    while ((tag_ptr =
+                (neu_resp_tag_value_meta_t *) utarray_next(tags, tag_ptr))) {
         if (tag_ptr->value.type != NEU_TYPE_ERROR) {
             utarray_push_back(filtered_tags, tag_ptr);
         }
     }
 
-    utarray_free(data->tags);
-    data->tags = filtered_tags;
+    return filtered_tags;
 }
 
-char *generate_upload_json(neu_plugin_t *plugin, neu_reqresp_trans_data_t *data,
-                           mqtt_upload_format_e format, bool *skip)
+static char *encode_json(neu_plugin_t *plugin, neu_reqresp_trans_data_t *data,
+                         UT_array *tags, neu_json_read_periodic_t *header,
+                         mqtt_upload_format_e format, bool *skip)
 {
-    char *                   json_str = NULL;
-    neu_json_read_periodic_t header   = { .group     = (char *) data->group,
-                                        .node      = (char *) data->driver,
-                                        .timestamp = global_timestamp };
-    neu_json_read_resp_t     json     = { 0 };
+    char *               json_str = NULL;
+    neu_json_read_resp_t json     = { 0 };
 
-    if (!plugin->config.upload_err && skip != NULL) {
-        filter_error_tags(data);
+    int ret = -1;
 
-        if (utarray_len(data->tags) == 0) {
-            *skip = true;
-            return NULL;
-        }
+    switch (format) {
+    case MQTT_UPLOAD_FORMAT_VALUES:
+        ret = neu_json_stream_encode_values(header, tags, &json_str);
+        break;
+    case MQTT_UPLOAD_FORMAT_TAGS:
+        ret = neu_json_stream_encode_tags(header, tags, &json_str);
+        break;
+    case MQTT_UPLOAD_FORMAT_ECP:
+        ret = neu_json_stream_encode_ecp(header, tags, &json_str);
+        break;
+    default:
+        break;
     }
 
-    if (0 != tag_values_to_json(data->tags, &json)) {
-        plog_error(plugin, "tag_values_to_json fail");
+    if (ret == 0) {
+        return json_str;
+    } else if (ret == -2) {
+        *skip = true;
+        plog_warn(plugin, "driver:%s group:%s, no valid tags", data->driver,
+                  data->group);
         return NULL;
     }
 
-    int ret;
+    // custom json values and the like, encode with jansson
+    if (0 != tag_values_to_json(tags, &json)) {
+        plog_error(plugin, "tag_values_to_json fail");
+        return NULL;
+    }
 
     switch (format) {
     case MQTT_UPLOAD_FORMAT_VALUES:
-        neu_json_encode_with_mqtt(&json, neu_json_encode_read_resp1, &header,
+        neu_json_encode_with_mqtt(&json, neu_json_encode_read_resp1, header,
                                   neu_json_encode_read_periodic_resp,
                                   &json_str);
         break;
     case MQTT_UPLOAD_FORMAT_TAGS:
-        neu_json_encode_with_mqtt(&json, neu_json_encode_read_resp2, &header,
+        neu_json_encode_with_mqtt(&json, neu_json_encode_read_resp2, header,
                                   neu_json_encode_read_periodic_resp,
                                   &json_str);
         break;
     case MQTT_UPLOAD_FORMAT_ECP:
         ret = neu_json_encode_with_mqtt_ecp(
-            &json, neu_json_encode_read_resp_ecp, &header,
+            &json, neu_json_encode_read_resp_ecp, header,
             neu_json_encode_read_periodic_resp, &json_str);
         if (ret == -2) {
             *skip = true;
@@ -148,6 +175,84 @@ char *generate_upload_json(neu_plugin_t *plugin, neu_reqresp_trans_data_t *data,
     return json_str;
 }
 
+static char *upload_json(neu_plugin_t *plugin, neu_reqresp_trans_data_t *data,
+                         neu_json_read_periodic_t *header,
+                         mqtt_upload_format_e format, bool *skip)
+{
+    UT_array *tags     = data->tags;
+    char *    json_str = NULL;
+
+    if (!plugin->config.upload_err && skip != NULL) {
+        tags = filter_error_tags(data->tags);
+
+        if (utarray_len(tags) == 0) {
+            *skip = true;
+            goto end;
+        }
+    }
+
+    json_str = encode_json(plugin, data, tags, header, format, skip);
+
+end:
+    if (tags != data->tags) {
+        utarray_free(tags);
+    }
+    return json_str;
+}
+
+char *generate_upload_json(neu_plugin_t *plugin, neu_reqresp_trans_data_t *data,
+                           mqtt_upload_format_e format, bool *skip)
+{
+    neu_json_read_periodic_t header = { .group     = (char *) data->group,
+                                        .node      = (char *) data->driver,
+                                        .timestamp = global_timestamp };
+
+    return upload_json(plugin, data, &header, format, skip);
+}
+
+char *generate_upload_payload(neu_plugin_t *            plugin,
+                              neu_reqresp_trans_data_t *data, uint64_t seq,
+                              bool keyframe, mqtt_upload_format_e format,
+                              bool *skip, size_t *len)
+{
+    char *                   payload = NULL;
+    UT_array *               tags    = data->tags;
+    neu_json_read_periodic_t header  = { .group     = (char *) data->group,
+                                         .node      = (char *) data->driver,
+                                         .timestamp = global_timestamp,
+                                         .seq       = seq,
+                                         .keyframe  = keyframe };
+
+    if (!mqtt_upload_format_is_binary(format)) {
+        payload = upload_json(plugin, data, &header, format, skip);
+        if (NULL != payload) {
+            *len = strlen(payload);
+        }
+        return payload;
+    }
+
+    if (!plugin->config.upload_err && skip != NULL) {
+        tags = filter_error_tags(data->tags);
+
+        if (utarray_len(tags) == 0) {
+            *skip = true;
+            goto end;
+        }
+    }
+
+    if (MQTT_UPLOAD_FORMAT_MSGPACK == format) {
+        payload = mqtt_encode_msgpack(&header, tags, len);
+    } else {
+        payload = mqtt_encode_protobuf(&header, tags, len);
+    }
+
+end:
+    if (tags != data->tags) {
+        utarray_free(tags);
+    }
+    return payload;
+}
+
 static char *generate_read_resp_json(neu_plugin_t *         plugin,
                                      neu_json_mqtt_t *      mqtt,
                                      neu_resp_read_group_t *data)
@@ -171,17 +276,22 @@ static char *generate_read_resp_json(neu_plugin_t *         plugin,
     return json_str;
 }
 
-static char *generate_write_resp_json(neu_plugin_t *    plugin,
-                                      neu_json_mqtt_t * mqtt,
-                                      neu_resp_error_t *data)
+static char *generate_write_resp_json(neu_plugin_t *         plugin,
+                                      neu_json_mqtt_t *      mqtt,
+                                      neu_resp_write_tags_t *data)
 {
     (void) plugin;
 
     neu_json_error_resp_t error    = { .error = data->error };
     char *                json_str = NULL;
 
-    neu_json_encode_with_mqtt(&error, neu_json_encode_error_resp, mqtt,
-                              neu_json_encode_mqtt_resp, &json_str);
+    if (NULL != data->tags) {
+        neu_json_encode_with_mqtt(data, neu_json_encode_write_tags_resp, mqtt,
+                                  neu_json_encode_mqtt_resp, &json_str);
+    } else {
+        neu_json_encode_with_mqtt(&error, neu_json_encode_error_resp, mqtt,
+                                  neu_json_encode_mqtt_resp, &json_str);
+    }
 
     return json_str;
 }
@@ -452,7 +562,7 @@ static int send_write_tags_req(neu_plugin_t *plugin, neu_json_mqtt_t *mqtt,
 }
 
 static void publish_cb(int errcode, neu_mqtt_qos_e qos, char *topic,
-                       uint8_t *payload, uint32_t len, void *data)
+                       uint32_t len, void *data)
 {
     (void) qos;
     (void) topic;
@@ -469,22 +579,21 @@ static void publish_cb(int errcode, neu_mqtt_qos_e qos, char *topic,
         NEU_PLUGIN_UPDATE_METRIC(plugin, NEU_METRIC_SEND_MSG_ERRORS_TOTAL, 1,
                                  NULL);
     }
-
-    free(payload);
 }
 
+// NOTE: the client copies the payload, which is freed once handed over
 int publish(neu_plugin_t *plugin, neu_mqtt_qos_e qos, char *topic,
             char *payload, size_t payload_len)
 {
 
-    int rv =
-        neu_mqtt_client_publish(plugin->client, qos, topic, (uint8_t *) payload,
-                                (uint32_t) payload_len, plugin, publish_cb);
+    int rv = neu_mqtt_client_publish_with_props(
+        plugin->client, qos, topic, (uint8_t *) payload, (uint32_t) payload_len,
+        plugin, publish_cb, NULL, 0);
+    free(payload);
     if (0 != rv) {
         plog_error(plugin, "pub [%s, QoS%d] fail", topic, qos);
         NEU_PLUGIN_UPDATE_METRIC(plugin, NEU_METRIC_SEND_MSG_ERRORS_TOTAL, 1,
                                  NULL);
-        free(payload);
         rv = NEU_ERR_MQTT_PUBLISH_FAILURE;
     }
 
@@ -495,20 +604,382 @@ int publish_with_trace(neu_plugin_t *plugin, neu_mqtt_qos_e qos, char *topic,
                        char *payload, size_t payload_len,
                        const char *traceparent)
 {
-    int rv = neu_mqtt_client_publish_with_trace(
+    neu_mqtt_user_prop_t prop = {
+        .name  = "traceparent",
+        .value = traceparent,
+    };
+
+    int rv = neu_mqtt_client_publish_with_props(
         plugin->client, qos, topic, (uint8_t *) payload, (uint32_t) payload_len,
-        plugin, publish_cb, traceparent);
+        plugin, publish_cb, &prop, 1);
+    free(payload);
     if (0 != rv) {
         plog_error(plugin, "pub [%s, QoS%d] fail", topic, qos);
         NEU_PLUGIN_UPDATE_METRIC(plugin, NEU_METRIC_SEND_MSG_ERRORS_TOTAL, 1,
                                  NULL);
+        rv = NEU_ERR_MQTT_PUBLISH_FAILURE;
+    }
+
+    return rv;
+}
+
+// the session uploading to `topic`, reports of a topic keep their order
+// NOTE: `client_lock` should be held while the session is in use
+static neu_mqtt_client_t *upload_client(neu_plugin_t *plugin,
+                                        const char *  topic)
+{
+    int32_t i = 0;
+
+    if (0 == plugin->n_shard) {
+        return plugin->client;
+    }
+
+    i = mqtt_shard_of(topic, (int32_t) plugin->n_shard + 1);
+    return 0 == i ? plugin->client : plugin->shards[i - 1];
+}
+
+// whether an upload goes to the offline cache rather than to the broker
+static bool upload_to_cache(neu_plugin_t *plugin, neu_mqtt_client_t *client)
+{
+    bool cached = false;
+
+    pthread_mutex_lock(&plugin->cache_mtx);
+    if (NULL != plugin->cache) {
+        cached = !neu_mqtt_client_is_connected(client) ||
+            (MQTT_CACHE_REPLAY_OLDEST_FIRST ==
+                 plugin->config.cache_replay_policy &&
+             mqtt_cache_count(plugin->cache) > 0);
+    }
+    pthread_mutex_unlock(&plugin->cache_mtx);
+
+    return cached;
+}
+
+// NOTE: we take ownership of `payload`
+static int cache_upload(neu_plugin_t *plugin, const char *topic,
+                        mqtt_compress_e encoding, char *payload, size_t len)
+{
+    int rv = -1;
+
+    pthread_mutex_lock(&plugin->cache_mtx);
+    if (NULL != plugin->cache) {
+        rv = mqtt_cache_append(plugin->cache, topic, encoding, payload, len);
+    }
+    pthread_mutex_unlock(&plugin->cache_mtx);
+
+    free(payload);
+
+    if (rv < 0) {
+        plog_error(plugin, "cache [%s] %zu bytes fail", topic, len);
+        NEU_PLUGIN_UPDATE_METRIC(plugin, NEU_METRIC_SEND_MSG_ERRORS_TOTAL, 1,
+                                 NULL);
+        return NEU_ERR_MQTT_PUBLISH_FAILURE;
+    }
+
+    if (rv > 0) {
+        plog_warn(plugin, "cache full, %d oldest messages dropped", rv);
+    }
+
+    return 0;
+}
+
+// compress the upload as configured, and tell its encoding with MQTT v5
+static int publish_upload(neu_plugin_t *plugin, char *topic, char *payload,
+                          size_t len, const char *traceparent)
+{
+    int                  rv       = 0;
+    const mqtt_config_t *config   = &plugin->config;
+    neu_mqtt_client_t *  client   = NULL;
+    neu_mqtt_user_prop_t props[2] = { 0 };
+    size_t               n_prop   = 0;
+    size_t               z_len    = 0;
+    char *               z        = NULL;
+    mqtt_compress_e      encoding = MQTT_COMPRESS_NONE;
+
+    if (MQTT_COMPRESS_NONE != config->compress &&
+        len >= config->compress_threshold) {
+        z = mqtt_compress(config->compress, payload, len, &z_len);
+    }
+
+    if (NULL != z) {
         free(payload);
+        payload               = z;
+        len                   = z_len;
+        encoding              = config->compress;
+        props[n_prop].name    = "content-encoding";
+        props[n_prop++].value = mqtt_compress_encoding(encoding);
+    }
+
+    // the sessions are not swapped by a reconfiguration in the meantime
+    pthread_rwlock_rdlock(&plugin->client_lock);
+    client = upload_client(plugin, topic);
+    if (upload_to_cache(plugin, client)) {
+        pthread_rwlock_unlock(&plugin->client_lock);
+        return cache_upload(plugin, topic, encoding, payload, len);
+    }
+
+    if (NULL != traceparent) {
+        props[n_prop].name    = "traceparent";
+        props[n_prop++].value = traceparent;
+    }
+
+    rv = neu_mqtt_client_publish_with_props(client, config->qos, topic,
+                                            (uint8_t *) payload, (uint32_t) len,
+                                            plugin, publish_cb, props, n_prop);
+    pthread_rwlock_unlock(&plugin->client_lock);
+    free(payload);
+    if (0 != rv) {
+        plog_error(plugin, "pub [%s, QoS%d] fail", topic, config->qos);
+        NEU_PLUGIN_UPDATE_METRIC(plugin, NEU_METRIC_SEND_MSG_ERRORS_TOTAL, 1,
+                                 NULL);
         rv = NEU_ERR_MQTT_PUBLISH_FAILURE;
     }
 
     return rv;
 }
 
+// NOTE: `batch_mtx` should be held, `reason` is NULL for explicit flushes
+static int flush_batch(neu_plugin_t *plugin, mqtt_batch_t *batch,
+                       const char *reason)
+{
+    size_t count   = batch->count;
+    size_t len     = 0;
+    char * payload = mqtt_batch_take(batch, &len);
+
+    if (NULL == payload) {
+        return 0;
+    }
+
+    NEU_PLUGIN_UPDATE_METRIC(plugin, NEU_METRIC_BATCH_SIZE, count, NULL);
+    if (reason) {
+        NEU_PLUGIN_UPDATE_METRIC(plugin, reason, 1, NULL);
+    }
+
+    return publish_upload(plugin, batch->topic, payload, len, NULL);
+}
+
+// NOTE: we take ownership of `payload`
+static int publish_batched(neu_plugin_t *plugin, char *topic, char *payload,
+                           size_t len)
+{
+    int                  rv     = 0;
+    const mqtt_config_t *config = &plugin->config;
+    mqtt_batch_t *       batch  = NULL;
+
+    pthread_mutex_lock(&plugin->batch_mtx);
+
+    batch = mqtt_batch_get(&plugin->batch_tbl, topic);
+    if (NULL == batch) {
+        pthread_mutex_unlock(&plugin->batch_mtx);
+        plog_error(plugin, "get batch of [%s] fail", topic);
+        free(payload);
+        return NEU_ERR_EINTERNAL;
+    }
+
+    if (batch->count > 0 &&
+        mqtt_batch_size_with(batch, len) > config->batch_max_bytes) {
+        flush_batch(plugin, batch, NEU_METRIC_BATCH_FLUSH_BYTES);
+    }
+
+    if (0 != mqtt_batch_add(batch, config->format, payload, len,
+                            neu_time_ms())) {
+        plog_error(plugin, "add to batch of [%s] fail", topic);
+        rv = NEU_ERR_EINTERNAL;
+    } else if (batch->count >= config->batch_max_count) {
+        rv = flush_batch(plugin, batch, NEU_METRIC_BATCH_FLUSH_COUNT);
+    } else if (mqtt_batch_size(batch) >= config->batch_max_bytes) {
+        // a single report reaching the max bytes
+        rv = flush_batch(plugin, batch, NEU_METRIC_BATCH_FLUSH_BYTES);
+    }
+
+    pthread_mutex_unlock(&plugin->batch_mtx);
+
+    free(payload);
+    return rv;
+}
+
+static void flush_topic_batch(neu_plugin_t *plugin, const char *topic)
+{
+    mqtt_batch_t *batch = NULL;
+
+    pthread_mutex_lock(&plugin->batch_mtx);
+    HASH_FIND_STR(plugin->batch_tbl, topic, batch);
+    if (batch) {
+        flush_batch(plugin, batch, NULL);
+    }
+    pthread_mutex_unlock(&plugin->batch_mtx);
+}
+
+int handle_batch_timer(neu_plugin_t *plugin)
+{
+    int64_t       now      = neu_time_ms();
+    int64_t       max      = plugin->config.batch_max_delay;
+    int64_t       interval = batch_timer_interval(max);
+    mqtt_batch_t *batch = NULL, *tmp = NULL;
+
+    pthread_mutex_lock(&plugin->batch_mtx);
+    HASH_ITER(hh, plugin->batch_tbl, batch, tmp)
+    {
+        if (batch->count > 0 && now - batch->ts + interval > max) {
+            flush_batch(plugin, batch, NEU_METRIC_BATCH_FLUSH_DELAY);
+        }
+    }
+    pthread_mutex_unlock(&plugin->batch_mtx);
+
+    return 0;
+}
+
+void flush_batches(neu_plugin_t *plugin)
+{
+    mqtt_batch_t *batch = NULL, *tmp = NULL;
+
+    pthread_mutex_lock(&plugin->batch_mtx);
+    HASH_ITER(hh, plugin->batch_tbl, batch, tmp)
+    {
+        flush_batch(plugin, batch, NULL);
+    }
+    pthread_mutex_unlock(&plugin->batch_mtx);
+}
+
+typedef struct {
+    neu_plugin_t *plugin;
+    uint64_t      seq;
+    char          topic[];
+} replay_ctx_t;
+
+static void replay_cb(int errcode, neu_mqtt_qos_e qos, char *topic,
+                      uint32_t len, void *data)
+{
+    replay_ctx_t *ctx    = data;
+    neu_plugin_t *plugin = ctx->plugin;
+
+    pthread_mutex_lock(&plugin->cache_mtx);
+    if (0 != errcode) {
+        plugin->cache_rewind = true;
+    } else if (NULL != plugin->cache) {
+        mqtt_cache_ack(plugin->cache, ctx->seq);
+        plugin->cache_drained += 1;
+    }
+    pthread_mutex_unlock(&plugin->cache_mtx);
+
+    publish_cb(errcode, qos, topic, len, plugin);
+    free(ctx);
+}
+
+// publish the next cached message, which stays cached until acknowledged
+static int replay_cached(neu_plugin_t *plugin)
+{
+    int                  rv   = 0;
+    mqtt_cache_record_t  rec  = { 0 };
+    neu_mqtt_user_prop_t prop = { 0 };
+    replay_ctx_t *       ctx  = NULL;
+
+    pthread_mutex_lock(&plugin->cache_mtx);
+    if (NULL == plugin->cache || 0 != mqtt_cache_next(plugin->cache, &rec)) {
+        pthread_mutex_unlock(&plugin->cache_mtx);
+        return -1;
+    }
+
+    ctx = malloc(sizeof(*ctx) + strlen(rec.topic) + 1);
+    if (NULL == ctx) {
+        plugin->cache_rewind = true;
+        pthread_mutex_unlock(&plugin->cache_mtx);
+        return -1;
+    }
+
+    ctx->plugin = plugin;
+    ctx->seq    = rec.seq;
+    strcpy(ctx->topic, rec.topic);
+    if (MQTT_COMPRESS_NONE != rec.encoding) {
+        prop.name  = "content-encoding";
+        prop.value = mqtt_compress_encoding(rec.encoding);
+    }
+
+    // the client copies the payload straight from the mapped segment, which
+    // stays mapped as long as `cache_mtx` is held
+    rv = neu_mqtt_client_publish_with_props(
+        plugin->client, plugin->config.qos, ctx->topic,
+        (uint8_t *) rec.payload, (uint32_t) rec.len, ctx, replay_cb, &prop,
+        NULL != prop.name ? 1 : 0);
+    if (0 != rv) {
+        plugin->cache_rewind = true;
+    }
+    pthread_mutex_unlock(&plugin->cache_mtx);
+
+    if (0 != rv) {
+        plog_error(plugin, "pub cached [%s, QoS%d] fail", ctx->topic,
+                   plugin->config.qos);
+        NEU_PLUGIN_UPDATE_METRIC(plugin, NEU_METRIC_SEND_MSG_ERRORS_TOTAL, 1,
+                                 NULL);
+        free(ctx);
+        return -1;
+    }
+
+    return 0;
+}
+
+int handle_cache_timer(neu_plugin_t *plugin)
+{
+    int64_t now       = neu_time_ms();
+    int64_t rate      = plugin->config.cache_replay_rate;
+    bool    connected = neu_mqtt_client_is_connected(plugin->client);
+    int64_t n         = 0;
+    size_t  count     = 0;
+    size_t  drained   = 0;
+
+    pthread_mutex_lock(&plugin->cache_mtx);
+    if (NULL == plugin->cache) {
+        pthread_mutex_unlock(&plugin->cache_mtx);
+        return 0;
+    }
+
+    if (connected && (!plugin->cache_connected || plugin->cache_rewind)) {
+        // messages in flight when disconnected or failed are sent again
+        mqtt_cache_rewind(plugin->cache);
+        plugin->cache_rewind = false;
+    }
+    plugin->cache_connected = connected;
+
+    if (connected) {
+        // at most a second of allowance
+        plugin->cache_credit += rate * (now - plugin->cache_tick_ts);
+        if (plugin->cache_credit > rate * 1000) {
+            plugin->cache_credit = rate * 1000;
+        }
+        n = plugin->cache_credit / 1000;
+        plugin->cache_credit -= n * 1000;
+    }
+    plugin->cache_tick_ts = now;
+    pthread_mutex_unlock(&plugin->cache_mtx);
+
+    for (; n > 0; --n) {
+        if (0 != replay_cached(plugin)) {
+            break;
+        }
+    }
+
+    if (now - plugin->cache_sync_ts < 1000) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&plugin->cache_mtx);
+    if (NULL != plugin->cache && 0 != mqtt_cache_sync(plugin->cache)) {
+        plog_error(plugin, "sync cache fail");
+    }
+    count                 = plugin->cache ? mqtt_cache_count(plugin->cache) : 0;
+    drained               = plugin->cache_drained;
+    plugin->cache_drained = 0;
+    pthread_mutex_unlock(&plugin->cache_mtx);
+
+    NEU_PLUGIN_UPDATE_METRIC(plugin, NEU_METRIC_CACHED_MSGS_NUM, count, NULL);
+    NEU_PLUGIN_UPDATE_METRIC(plugin, NEU_METRIC_CACHE_DRAIN_RATE,
+                             drained * 1000 / (now - plugin->cache_sync_ts),
+                             NULL);
+    plugin->cache_sync_ts = now;
+
+    return 0;
+}
+
 void handle_write_req(neu_mqtt_qos_e qos, const char *topic,
                       const uint8_t *payload, uint32_t len, void *data,
                       trace_w3c_t *trace_w3c)
@@ -575,7 +1046,7 @@ void handle_write_req(neu_mqtt_qos_e qos, const char *topic,
 }
 
 int handle_write_response(neu_plugin_t *plugin, neu_json_mqtt_t *mqtt_json,
-                          neu_resp_error_t *data, void *trace_scope,
+                          neu_resp_write_tags_t *data, void *trace_scope,
                           void *trace_ctx, char *span_id)
 {
     int   rv       = 0;
@@ -809,7 +1280,8 @@ end:
 int handle_trans_data(neu_plugin_t *            plugin,
                       neu_reqresp_trans_data_t *trans_data)
 {
-    int rv = 0;
+    int  rv     = 0;
+    bool locked = false;
 
     neu_otel_trace_ctx trans_trace       = NULL;
     neu_otel_scope_ctx trans_scope       = NULL;
@@ -846,6 +1318,12 @@ int handle_trans_data(neu_plugin_t *            plugin,
             break;
         }
 
+        // the route, its topic and delta stay until the end of the upload.
+        // The data of a group goes to one consumer, the only one that changes
+        // its delta under the read lock
+        pthread_rwlock_rdlock(&plugin->route_lock);
+        locked = true;
+
         const route_entry_t *route = route_tbl_get(
             &plugin->route_tbl, trans_data->driver, trans_data->group);
         if (NULL == route) {
@@ -855,31 +1333,74 @@ int handle_trans_data(neu_plugin_t *            plugin,
             break;
         }
 
-        bool  skip_none = false;
-        char *json_str  = generate_upload_json(
-            plugin, trans_data, plugin->config.format, &skip_none);
+        neu_reqresp_trans_data_t *data     = trans_data;
+        neu_reqresp_trans_data_t  changed  = { 0 };
+        uint64_t                  seq      = 0;
+        bool                      keyframe = false;
+
+        if (NULL != route->delta) {
+            // the tags of trans data are shared with other apps, so encode
+            // the changed ones from a copy
+            changed      = *trans_data;
+            changed.tags = mqtt_delta_filter(route->delta, trans_data->tags,
+                                             !plugin->config.upload_err, &seq,
+                                             &keyframe);
+            if (NULL == changed.tags) {
+                plog_error(plugin, "delta of driver:%s group:%s fail",
+                           trans_data->driver, trans_data->group);
+                rv = NEU_ERR_EINTERNAL;
+                break;
+            }
+            if (0 == utarray_len(changed.tags)) {
+                utarray_free(changed.tags);
+                break;
+            }
+            data = &changed;
+        }
+
+        bool   skip_none = false;
+        size_t len       = 0;
+        char * payload   = generate_upload_payload(
+            plugin, data, seq, keyframe, plugin->config.format, &skip_none,
+            &len);
+        if (data == &changed) {
+            utarray_free(changed.tags);
+        }
         if (skip_none) {
             break;
         }
-        if (NULL == json_str) {
-            plog_error(plugin, "generate upload json fail");
+        if (NULL == payload) {
+            plog_error(plugin, "generate upload payload fail");
             rv = NEU_ERR_EINTERNAL;
             break;
         }
 
-        char *         topic = route->topic;
-        neu_mqtt_qos_e qos   = plugin->config.qos;
+        char *topic = route->topic;
 
         if (plugin->config.version == NEU_MQTT_VERSION_V5 && trans_trace) {
-            rv = publish_with_trace(plugin, qos, topic, json_str,
-                                    strlen(json_str), trace_parent);
+            if (plugin->config.batch) {
+                // keep the order of reports on the topic
+                flush_topic_batch(plugin, topic);
+            }
+            rv = publish_upload(plugin, topic, payload, len, trace_parent);
+        } else if (plugin->config.batch) {
+            rv = publish_batched(plugin, topic, payload, len);
         } else {
-            rv = publish(plugin, qos, topic, json_str, strlen(json_str));
+            rv = publish_upload(plugin, topic, payload, len, NULL);
         }
 
-        json_str = NULL;
+        if (0 != rv && NULL != route->delta) {
+            // consumers see the gap, and get the values with a keyframe
+            mqtt_delta_resync(route->delta);
+        }
+
+        payload = NULL;
     } while (0);
 
+    if (locked) {
+        pthread_rwlock_unlock(&plugin->route_lock);
+    }
+
     if (trans_trace) {
         if (rv == NEU_ERR_SUCCESS) {
             neu_otel_scope_set_status_code2(trans_scope, NEU_OTEL_STATUS_OK, 0);
@@ -901,9 +1422,51 @@ static inline char *default_upload_topic(neu_req_subscribe_t *info)
     return t;
 }
 
+// optional delta mode of a subscription, `{"delta": true, "keyframe": 60}`
+static int parse_delta(neu_plugin_t *plugin, const char *params,
+                       mqtt_delta_t **delta)
+{
+    neu_json_elem_t enable   = { .name      = "delta",
+                                .t         = NEU_JSON_BOOL,
+                                .attribute = NEU_JSON_ATTRIBUTE_OPTIONAL };
+    neu_json_elem_t keyframe = { .name      = "keyframe",
+                                .t         = NEU_JSON_INT,
+                                .attribute = NEU_JSON_ATTRIBUTE_OPTIONAL,
+                                .v.val_int = MQTT_DELTA_KEYFRAME_DEFAULT };
+
+    *delta = NULL;
+    if (NULL == params) {
+        return 0;
+    }
+
+    if (0 != neu_parse_param(params, NULL, 2, &enable, &keyframe)) {
+        plog_error(plugin, "parse `%s` for delta fail", params);
+        return NEU_ERR_GROUP_PARAMETER_INVALID;
+    }
+
+    if (!enable.v.val_bool) {
+        return 0;
+    }
+
+    if (keyframe.v.val_int < MQTT_DELTA_KEYFRAME_MIN ||
+        keyframe.v.val_int > MQTT_DELTA_KEYFRAME_MAX) {
+        plog_error(plugin, "keyframe %" PRIi64 " out of range",
+                   keyframe.v.val_int);
+        return NEU_ERR_GROUP_PARAMETER_INVALID;
+    }
+
+    *delta = mqtt_delta_new((uint32_t) keyframe.v.val_int);
+    if (NULL == *delta) {
+        return NEU_ERR_EINTERNAL;
+    }
+
+    return 0;
+}
+
 int handle_subscribe_group(neu_plugin_t *plugin, neu_req_subscribe_t *sub_info)
 {
-    int rv = 0;
+    int           rv    = 0;
+    mqtt_delta_t *delta = NULL;
 
     neu_json_elem_t topic = { .name = "topic", .t = NEU_JSON_STR };
     if (NULL == sub_info->params) {
@@ -919,17 +1482,26 @@ int handle_subscribe_group(neu_plugin_t *plugin, neu_req_subscribe_t *sub_info)
         goto end;
     }
 
+    rv = parse_delta(plugin, sub_info->params, &delta);
+    if (0 != rv) {
+        free(topic.v.val_str);
+        goto end;
+    }
+
+    pthread_rwlock_wrlock(&plugin->route_lock);
     rv = route_tbl_add_new(&plugin->route_tbl, sub_info->driver,
-                           sub_info->group, topic.v.val_str);
-    // topic.v.val_str ownership moved
+                           sub_info->group, topic.v.val_str, delta);
+    pthread_rwlock_unlock(&plugin->route_lock);
+    // topic.v.val_str and delta ownership moved
     if (0 != rv) {
         plog_error(plugin, "route driver:%s group:%s fail, `%s`",
                    sub_info->driver, sub_info->group, sub_info->params);
         goto end;
     }
 
-    plog_notice(plugin, "route driver:%s group:%s to topic:%s",
-                sub_info->driver, sub_info->group, topic.v.val_str);
+    plog_notice(plugin, "route driver:%s group:%s to topic:%s%s",
+                sub_info->driver, sub_info->group, topic.v.val_str,
+                delta ? " in delta mode" : "");
 
 end:
     free(sub_info->params);
@@ -938,7 +1510,8 @@ end:
 
 int handle_update_subscribe(neu_plugin_t *plugin, neu_req_subscribe_t *sub_info)
 {
-    int rv = 0;
+    int           rv    = 0;
+    mqtt_delta_t *delta = NULL;
 
     if (NULL == sub_info->params) {
         rv = NEU_ERR_GROUP_PARAMETER_INVALID;
@@ -952,17 +1525,27 @@ int handle_update_subscribe(neu_plugin_t *plugin, neu_req_subscribe_t *sub_info)
         goto end;
     }
 
+    rv = parse_delta(plugin, sub_info->params, &delta);
+    if (0 != rv) {
+        free(topic.v.val_str);
+        goto end;
+    }
+
+    // uploads in progress go on with the old topic and delta
+    pthread_rwlock_wrlock(&plugin->route_lock);
     rv = route_tbl_update(&plugin->route_tbl, sub_info->driver, sub_info->group,
-                          topic.v.val_str);
-    // topic.v.val_str ownership moved
+                          topic.v.val_str, delta);
+    pthread_rwlock_unlock(&plugin->route_lock);
+    // topic.v.val_str and delta ownership moved
     if (0 != rv) {
         plog_error(plugin, "route driver:%s group:%s fail, `%s`",
                    sub_info->driver, sub_info->group, sub_info->params);
         goto end;
     }
 
-    plog_notice(plugin, "route driver:%s group:%s to topic:%s",
-                sub_info->driver, sub_info->group, topic.v.val_str);
+    plog_notice(plugin, "route driver:%s group:%s to topic:%s%s",
+                sub_info->driver, sub_info->group, topic.v.val_str,
+                delta ? " in delta mode" : "");
 
 end:
     free(sub_info->params);
@@ -972,7 +1555,9 @@ end:
 int handle_unsubscribe_group(neu_plugin_t *         plugin,
                              neu_req_unsubscribe_t *unsub_info)
 {
+    pthread_rwlock_wrlock(&plugin->route_lock);
     route_tbl_del(&plugin->route_tbl, unsub_info->driver, unsub_info->group);
+    pthread_rwlock_unlock(&plugin->route_lock);
     plog_notice(plugin, "del route driver:%s group:%s", unsub_info->driver,
                 unsub_info->group);
     return 0;
@@ -980,7 +1565,9 @@ int handle_unsubscribe_group(neu_plugin_t *         plugin,
 
 int handle_del_group(neu_plugin_t *plugin, neu_req_del_group_t *req)
 {
+    pthread_rwlock_wrlock(&plugin->route_lock);
     route_tbl_del(&plugin->route_tbl, req->driver, req->group);
+    pthread_rwlock_unlock(&plugin->route_lock);
     plog_notice(plugin, "del route driver:%s group:%s", req->driver,
                 req->group);
     return 0;
@@ -988,8 +1575,10 @@ int handle_del_group(neu_plugin_t *plugin, neu_req_del_group_t *req)
 
 int handle_update_group(neu_plugin_t *plugin, neu_req_update_group_t *req)
 {
+    pthread_rwlock_wrlock(&plugin->route_lock);
     route_tbl_update_group(&plugin->route_tbl, req->driver, req->group,
                            req->new_name);
+    pthread_rwlock_unlock(&plugin->route_lock);
     plog_notice(plugin, "update route driver:%s group:%s to %s", req->driver,
                 req->group, req->new_name);
     return 0;
@@ -997,7 +1586,9 @@ int handle_update_group(neu_plugin_t *plugin, neu_req_update_group_t *req)
 
 int handle_update_driver(neu_plugin_t *plugin, neu_req_update_node_t *req)
 {
+    pthread_rwlock_wrlock(&plugin->route_lock);
     route_tbl_update_driver(&plugin->route_tbl, req->node, req->new_name);
+    pthread_rwlock_unlock(&plugin->route_lock);
     plog_notice(plugin, "update route driver:%s to %s", req->node,
                 req->new_name);
     return 0;
@@ -1005,7 +1596,9 @@ int handle_update_driver(neu_plugin_t *plugin, neu_req_update_node_t *req)
 
 int handle_del_driver(neu_plugin_t *plugin, neu_reqresp_node_deleted_t *req)
 {
+    pthread_rwlock_wrlock(&plugin->route_lock);
     route_tbl_del_driver(&plugin->route_tbl, req->node);
+    pthread_rwlock_unlock(&plugin->route_lock);
     plog_notice(plugin, "delete route driver:%s", req->node);
     return 0;
 }
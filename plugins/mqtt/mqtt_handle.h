@@ -39,8 +39,9 @@ void handle_write_req(neu_mqtt_qos_e qos, const char *topic,
                       const uint8_t *payload, uint32_t len, void *data,
                       trace_w3c_t *trace_w3c);
 
+// NEU_RESP_ERROR as a neu_resp_write_tags_t without tags
 int handle_write_response(neu_plugin_t *plugin, neu_json_mqtt_t *mqtt_json,
-                          neu_resp_error_t *data, void *trace_scope,
+                          neu_resp_write_tags_t *data, void *trace_scope,
                           void *trace_ctx, char *span_id);
 
 void handle_read_req(neu_mqtt_qos_e qos, const char *topic,
@@ -57,11 +58,35 @@ int  handle_driver_action_response(neu_plugin_t *            plugin,
                                    neu_json_mqtt_t *         mqtt_json,
                                    neu_resp_driver_action_t *data);
 
+// json or binary payload of the upload format, with its length in `len`,
+// `seq` is 0 unless the subscription is in delta mode
+char *generate_upload_payload(neu_plugin_t *            plugin,
+                              neu_reqresp_trans_data_t *data, uint64_t seq,
+                              bool keyframe, mqtt_upload_format_e format,
+                              bool *skip, size_t *len);
+
 char *generate_upload_json(neu_plugin_t *plugin, neu_reqresp_trans_data_t *data,
                            mqtt_upload_format_e format, bool *skip);
 int   handle_trans_data(neu_plugin_t *            plugin,
                         neu_reqresp_trans_data_t *trans_data);
 
+// the batch timer fires four times per batch max delay
+static inline int64_t batch_timer_interval(size_t max_delay)
+{
+    return max_delay >= 4 ? max_delay / 4 : 1;
+}
+
+// flush the batches that would exceed the max delay before the next tick
+int  handle_batch_timer(neu_plugin_t *plugin);
+void flush_batches(neu_plugin_t *plugin);
+
+// interval of the cache timer in milliseconds
+#define MQTT_CACHE_TIMER_INTERVAL 100
+
+// replay cached messages within the replay rate, and sync the cache every
+// second
+int handle_cache_timer(neu_plugin_t *plugin);
+
 int handle_subscribe_group(neu_plugin_t *plugin, neu_req_subscribe_t *sub_info);
 int handle_update_subscribe(neu_plugin_t *       plugin,
                             neu_req_subscribe_t *sub_info);
@@ -29,14 +29,15 @@
 #define DESCRIPTION_ZH "基于 NanoSDK 的北向应用 MQTT 插件"
 
 const neu_plugin_module_t neu_plugin_module = {
-    .version         = NEURON_PLUGIN_VER_1_0,
-    .schema          = "mqtt",
-    .module_name     = "MQTT",
-    .module_descr    = DESCRIPTION,
-    .module_descr_zh = DESCRIPTION_ZH,
-    .intf_funs       = &mqtt_plugin_intf_funs,
-    .kind            = NEU_PLUGIN_KIND_SYSTEM,
-    .type            = NEU_NA_TYPE_APP,
-    .display         = true,
-    .single          = false,
+    .version              = NEURON_PLUGIN_VER_1_0,
+    .schema               = "mqtt",
+    .module_name          = "MQTT",
+    .module_descr         = DESCRIPTION,
+    .module_descr_zh      = DESCRIPTION_ZH,
+    .intf_funs            = &mqtt_plugin_intf_funs,
+    .kind                 = NEU_PLUGIN_KIND_SYSTEM,
+    .type                 = NEU_NA_TYPE_APP,
+    .display              = true,
+    .single               = false,
+    .trans_data_reentrant = true,
 };
@@ -27,7 +27,10 @@ extern "C" {
 #include "connection/mqtt_client.h"
 #include "neuron.h"
 
+#include "mqtt_batch.h"
+#include "mqtt_cache.h"
 #include "mqtt_config.h"
+#include "mqtt_delta.h"
 
 typedef struct {
     char driver[NEU_NODE_NAME_LEN];
@@ -37,7 +40,8 @@ typedef struct {
 typedef struct {
     route_key_t key;
 
-    char *topic;
+    char *        topic;
+    mqtt_delta_t *delta; // NULL unless the subscription is in delta mode
 
     UT_hash_handle hh;
 } route_entry_t;
@@ -46,12 +50,28 @@ struct neu_plugin {
     neu_plugin_common_t common;
     neu_events_t *      events;
     neu_event_timer_t * heartbeat_timer;
+    neu_event_timer_t * batch_timer;
+    pthread_mutex_t     batch_mtx;
+    mqtt_batch_t *      batch_tbl;
+    neu_event_timer_t * cache_timer;
+    pthread_mutex_t     cache_mtx;
+    mqtt_cache_t *      cache;
+    bool                cache_connected; // connection state of the last tick
+    bool                cache_rewind;    // a replayed message failed
+    size_t              cache_drained;   // messages acknowledged since sync
+    int64_t             cache_credit;    // replay allowance, in 1/1000 message
+    int64_t             cache_tick_ts;
+    int64_t             cache_sync_ts;
     mqtt_config_t       config;
-    neu_mqtt_client_t * client;
+    neu_mqtt_client_t * client;  // primary session
+    neu_mqtt_client_t **shards;  // upload sessions besides the primary one
+    size_t              n_shard;
+    pthread_rwlock_t    client_lock; // held by uploads, written on swaps
     int64_t             cache_metric_update_ts;
     char *              read_req_topic;
     char *              read_resp_topic;
     char *              upload_topic;
+    pthread_rwlock_t    route_lock; // written by subscription changes
     route_entry_t *     route_tbl;
 
     int (*parse_config)(neu_plugin_t *plugin, const char *setting,
@@ -63,6 +83,7 @@ struct neu_plugin {
 static inline void route_entry_free(route_entry_t *e)
 {
     free(e->topic);
+    mqtt_delta_free(e->delta);
     free(e);
 }
 
@@ -89,46 +110,55 @@ route_tbl_get(route_entry_t **tbl, const char *driver, const char *group)
     return find;
 }
 
-// NOTE: we take ownership of `topic`
+// NOTE: we take ownership of `topic` and `delta`
 static inline int route_tbl_add_new(route_entry_t **tbl, const char *driver,
-                                    const char *group, char *topic)
+                                    const char *group, char *topic,
+                                    mqtt_delta_t *delta)
 {
     route_entry_t *find = NULL;
 
     find = route_tbl_get(tbl, driver, group);
     if (find) {
         free(topic);
+        mqtt_delta_free(delta);
         return NEU_ERR_GROUP_ALREADY_SUBSCRIBED;
     }
 
     find = calloc(1, sizeof(*find));
     if (NULL == find) {
         free(topic);
+        mqtt_delta_free(delta);
         return NEU_ERR_EINTERNAL;
     }
 
     strncpy(find->key.driver, driver, sizeof(find->key.driver));
     strncpy(find->key.group, group, sizeof(find->key.group));
     find->topic = topic;
+    find->delta = delta;
     HASH_ADD(hh, *tbl, key, sizeof(find->key), find);
 
     return 0;
 }
 
-// NOTE: we take ownership of `topic`
+// NOTE: we take ownership of `topic` and `delta`
 static inline int route_tbl_update(route_entry_t **tbl, const char *driver,
-                                   const char *group, char *topic)
+                                   const char *group, char *topic,
+                                   mqtt_delta_t *delta)
 {
     route_entry_t *find = NULL;
 
     find = route_tbl_get(tbl, driver, group);
     if (NULL == find) {
         free(topic);
+        mqtt_delta_free(delta);
         return NEU_ERR_GROUP_NOT_SUBSCRIBE;
     }
 
     free(find->topic);
     find->topic = topic;
+    // restarting the sequence makes the next upload a keyframe
+    mqtt_delta_free(find->delta);
+    find->delta = delta;
 
     return 0;
 }
@@ -93,6 +93,164 @@ end:
     return 0;
 }
 
+static int batch_timer_cb(void *data)
+{
+    return handle_batch_timer(data);
+}
+
+static inline void stop_batch_timer(neu_plugin_t *plugin)
+{
+    if (plugin->batch_timer) {
+        neu_event_del_timer(plugin->events, plugin->batch_timer);
+        plugin->batch_timer = NULL;
+        plog_notice(plugin, "batch timer stopped");
+    }
+}
+
+static int start_batch_timer(neu_plugin_t *plugin)
+{
+    int64_t interval = batch_timer_interval(plugin->config.batch_max_delay);
+
+    stop_batch_timer(plugin);
+
+    if (!plugin->config.batch) {
+        return 0;
+    }
+
+    if (NULL == plugin->events) {
+        plugin->events = neu_event_new();
+        if (NULL == plugin->events) {
+            plog_error(plugin, "neu_event_new fail");
+            return NEU_ERR_EINTERNAL;
+        }
+    }
+
+    neu_event_timer_param_t param = {
+        .second      = interval / 1000,
+        .millisecond = interval % 1000,
+        .cb          = batch_timer_cb,
+        .usr_data    = plugin,
+    };
+
+    plugin->batch_timer = neu_event_add_timer(plugin->events, param);
+    if (NULL == plugin->batch_timer) {
+        plog_error(plugin, "neu_event_add_timer fail");
+        return NEU_ERR_EINTERNAL;
+    }
+
+    plog_notice(plugin, "start_batch_timer interval: %" PRIi64, interval);
+    return 0;
+}
+
+static int cache_timer_cb(void *data)
+{
+    return handle_cache_timer(data);
+}
+
+static inline void stop_cache_timer(neu_plugin_t *plugin)
+{
+    if (plugin->cache_timer) {
+        neu_event_del_timer(plugin->events, plugin->cache_timer);
+        plugin->cache_timer = NULL;
+        plog_notice(plugin, "cache timer stopped");
+    }
+}
+
+static int start_cache_timer(neu_plugin_t *plugin)
+{
+    stop_cache_timer(plugin);
+
+    if (NULL == plugin->cache) {
+        return 0;
+    }
+
+    if (NULL == plugin->events) {
+        plugin->events = neu_event_new();
+        if (NULL == plugin->events) {
+            plog_error(plugin, "neu_event_new fail");
+            return NEU_ERR_EINTERNAL;
+        }
+    }
+
+    neu_event_timer_param_t param = {
+        .second      = 0,
+        .millisecond = MQTT_CACHE_TIMER_INTERVAL,
+        .cb          = cache_timer_cb,
+        .usr_data    = plugin,
+    };
+
+    plugin->cache_timer = neu_event_add_timer(plugin->events, param);
+    if (NULL == plugin->cache_timer) {
+        plog_error(plugin, "neu_event_add_timer fail");
+        return NEU_ERR_EINTERNAL;
+    }
+
+    plog_notice(plugin, "start_cache_timer interval: %d",
+                MQTT_CACHE_TIMER_INTERVAL);
+    return 0;
+}
+
+static inline char *cache_dir(neu_plugin_t *plugin)
+{
+    char *dir = NULL;
+    neu_asprintf(&dir, "persistence/mqtt-cache/%s", plugin->common.name);
+    return dir;
+}
+
+// reopen the cache with the new sizes, messages cached are kept
+static int config_cache(neu_plugin_t *plugin, const mqtt_config_t *config)
+{
+    int   rv  = 0;
+    char *dir = cache_dir(plugin);
+
+    if (NULL == dir) {
+        return NEU_ERR_EINTERNAL;
+    }
+
+    pthread_mutex_lock(&plugin->cache_mtx);
+    mqtt_cache_close(plugin->cache);
+    plugin->cache           = NULL;
+    plugin->cache_connected = false;
+
+    if (config->cache) {
+        // segments mapped, the one written and the one replayed, fit in the
+        // memory size
+        plugin->cache = mqtt_cache_open(dir, config->cache_mem_size / 2,
+                                        config->cache_disk_size);
+        if (NULL == plugin->cache) {
+            plog_error(plugin, "open cache %s fail", dir);
+            rv = NEU_ERR_EINTERNAL;
+        } else {
+            plog_notice(plugin, "open cache %s, %zu messages", dir,
+                        mqtt_cache_count(plugin->cache));
+        }
+    } else {
+        mqtt_cache_remove(dir);
+    }
+    pthread_mutex_unlock(&plugin->cache_mtx);
+
+    free(dir);
+    return rv;
+}
+
+static void remove_cache(neu_plugin_t *plugin)
+{
+    char *dir = cache_dir(plugin);
+
+    stop_cache_timer(plugin);
+
+    pthread_mutex_lock(&plugin->cache_mtx);
+    mqtt_cache_close(plugin->cache);
+    plugin->cache = NULL;
+    pthread_mutex_unlock(&plugin->cache_mtx);
+
+    if (dir) {
+        mqtt_cache_remove(dir);
+        plog_notice(plugin, "rm cache %s", dir);
+        free(dir);
+    }
+}
+
 static void connect_cb(void *data)
 {
     neu_plugin_t *plugin      = data;
@@ -111,6 +269,64 @@ static void disconnect_cb(void *data)
                 neu_plugin_module.module_name);
 }
 
+static void shard_connect_cb(void *data)
+{
+    neu_plugin_t *plugin = data;
+    plog_notice(plugin, "upload session connected");
+}
+
+static void shard_disconnect_cb(void *data)
+{
+    neu_plugin_t *plugin = data;
+    plog_notice(plugin, "upload session disconnected");
+}
+
+static void free_clients(neu_mqtt_client_t **clients, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        neu_mqtt_client_close(clients[i]);
+        neu_mqtt_client_free(clients[i]);
+    }
+    free(clients);
+}
+
+// install the upload sessions `shards`, the old ones are freed once no upload
+// holds them
+static void swap_shards(neu_plugin_t *plugin, neu_mqtt_client_t **shards,
+                        size_t n_shard)
+{
+    neu_mqtt_client_t **old   = NULL;
+    size_t              n_old = 0;
+
+    pthread_rwlock_wrlock(&plugin->client_lock);
+    old             = plugin->shards;
+    n_old           = plugin->n_shard;
+    plugin->shards  = shards;
+    plugin->n_shard = n_shard;
+    pthread_rwlock_unlock(&plugin->client_lock);
+
+    free_clients(old, n_old);
+}
+
+static void free_shards(neu_plugin_t *plugin)
+{
+    swap_shards(plugin, NULL, 0);
+}
+
+// replace the primary session, once no upload holds it
+static void renew_client(neu_plugin_t *plugin, neu_mqtt_version_e version)
+{
+    neu_mqtt_client_t *client = neu_mqtt_client_new(version);
+    neu_mqtt_client_t *old    = NULL;
+
+    pthread_rwlock_wrlock(&plugin->client_lock);
+    old            = plugin->client;
+    plugin->client = client;
+    pthread_rwlock_unlock(&plugin->client_lock);
+
+    neu_mqtt_client_free(old);
+}
+
 neu_plugin_t *mqtt_plugin_open(void)
 {
     neu_plugin_t *plugin = (neu_plugin_t *) calloc(1, sizeof(neu_plugin_t));
@@ -150,6 +366,16 @@ int mqtt_plugin_init(neu_plugin_t *plugin, bool load)
     NEU_PLUGIN_REGISTER_METRIC(plugin, NEU_METRIC_DISCONNECTION_60S, 60000);
     NEU_PLUGIN_REGISTER_METRIC(plugin, NEU_METRIC_DISCONNECTION_600S, 600000);
     NEU_PLUGIN_REGISTER_METRIC(plugin, NEU_METRIC_DISCONNECTION_1800S, 1800000);
+    NEU_PLUGIN_REGISTER_METRIC(plugin, NEU_METRIC_BATCH_SIZE, 0);
+    NEU_PLUGIN_REGISTER_METRIC(plugin, NEU_METRIC_BATCH_FLUSH_BYTES, 0);
+    NEU_PLUGIN_REGISTER_METRIC(plugin, NEU_METRIC_BATCH_FLUSH_COUNT, 0);
+    NEU_PLUGIN_REGISTER_METRIC(plugin, NEU_METRIC_BATCH_FLUSH_DELAY, 0);
+    NEU_PLUGIN_REGISTER_METRIC(plugin, NEU_METRIC_CACHE_DRAIN_RATE, 0);
+
+    pthread_mutex_init(&plugin->batch_mtx, NULL);
+    pthread_mutex_init(&plugin->cache_mtx, NULL);
+    pthread_rwlock_init(&plugin->route_lock, NULL);
+    pthread_rwlock_init(&plugin->client_lock, NULL);
 
     plog_notice(plugin, "initialize plugin `%s` success",
                 neu_plugin_module.module_name);
@@ -159,6 +385,8 @@ int mqtt_plugin_init(neu_plugin_t *plugin, bool load)
 int mqtt_plugin_uninit(neu_plugin_t *plugin)
 {
     stop_heartbeart_timer(plugin);
+    stop_batch_timer(plugin);
+    stop_cache_timer(plugin);
 
     if (NULL != plugin->events) {
         neu_event_close(plugin->events);
@@ -171,6 +399,7 @@ int mqtt_plugin_uninit(neu_plugin_t *plugin)
         neu_mqtt_client_free(plugin->client);
         plugin->client = NULL;
     }
+    free_shards(plugin);
 
     free(plugin->read_req_topic);
     plugin->read_req_topic = NULL;
@@ -180,6 +409,18 @@ int mqtt_plugin_uninit(neu_plugin_t *plugin)
     plugin->upload_topic = NULL;
 
     route_tbl_free(plugin->route_tbl);
+    plugin->route_tbl = NULL;
+    pthread_rwlock_destroy(&plugin->route_lock);
+    pthread_rwlock_destroy(&plugin->client_lock);
+
+    mqtt_batch_tbl_free(plugin->batch_tbl);
+    plugin->batch_tbl = NULL;
+    pthread_mutex_destroy(&plugin->batch_mtx);
+
+    // after the client, no more acknowledgements
+    mqtt_cache_close(plugin->cache);
+    plugin->cache = NULL;
+    pthread_mutex_destroy(&plugin->cache_mtx);
 
     plog_notice(plugin, "uninitialize plugin `%s` success",
                 neu_plugin_module.module_name);
@@ -226,8 +467,8 @@ static int config_mqtt_client(neu_plugin_t *plugin, neu_mqtt_client_t *client,
         return -1;
     }
 
-    rv = neu_mqtt_client_set_cache_size(client, config->cache_mem_size,
-                                        config->cache_disk_size);
+    // uploads are cached by the plugin instead, see mqtt_cache.h
+    rv = neu_mqtt_client_set_cache_size(client, 0, 0);
     if (0 != rv) {
         plog_error(plugin, "neu_mqtt_client_set_msg_cache_limit fail");
         return -1;
@@ -258,6 +499,87 @@ static int config_mqtt_client(neu_plugin_t *plugin, neu_mqtt_client_t *client,
     return rv;
 }
 
+// upload sessions besides the primary one, client ids suffixed by -1, -2 ...
+// the new sessions are set up aside and swapped in, as uploads may go on
+static int config_shards(neu_plugin_t *plugin, const mqtt_config_t *config)
+{
+    neu_mqtt_client_t **shards  = NULL;
+    size_t              n_shard = 0;
+    size_t              n       = 0;
+
+    if (config->connection_pool > 1) {
+        n = config->connection_pool - 1;
+    }
+
+    if (0 == n) {
+        free_shards(plugin);
+        return 0;
+    }
+
+    shards = calloc(n, sizeof(*shards));
+    if (NULL == shards) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        char *             id     = NULL;
+        neu_mqtt_client_t *client = neu_mqtt_client_new(config->version);
+        if (NULL == client) {
+            plog_error(plugin, "neu_mqtt_client_new fail");
+            goto error;
+        }
+        shards[n_shard++] = client;
+
+        if (0 != config_mqtt_client(plugin, client, config)) {
+            goto error;
+        }
+
+        neu_asprintf(&id, "%s-%zu", config->client_id, i + 1);
+        if (NULL == id || 0 != neu_mqtt_client_set_id(client, id)) {
+            plog_error(plugin, "neu_mqtt_client_set_id fail");
+            free(id);
+            goto error;
+        }
+        free(id);
+
+        if (0 !=
+                neu_mqtt_client_set_connect_cb(client, shard_connect_cb,
+                                               plugin) ||
+            0 !=
+                neu_mqtt_client_set_disconnect_cb(client, shard_disconnect_cb,
+                                                  plugin)) {
+            plog_error(plugin, "neu_mqtt_client_set_connect_cb fail");
+            goto error;
+        }
+    }
+
+    swap_shards(plugin, shards, n_shard);
+    plog_notice(plugin, "%zu upload sessions besides the primary one", n);
+    return 0;
+
+error:
+    free_clients(shards, n_shard);
+    return -1;
+}
+
+static int open_shards(neu_plugin_t *plugin)
+{
+    for (size_t i = 0; i < plugin->n_shard; ++i) {
+        if (0 != neu_mqtt_client_open(plugin->shards[i])) {
+            plog_error(plugin, "open upload session %zu fail", i + 1);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void close_shards(neu_plugin_t *plugin)
+{
+    for (size_t i = 0; i < plugin->n_shard; ++i) {
+        neu_mqtt_client_close(plugin->shards[i]);
+    }
+}
+
 static int create_topic(neu_plugin_t *plugin)
 {
     if (plugin->read_req_topic) {
@@ -350,6 +672,9 @@ int mqtt_plugin_config(neu_plugin_t *plugin, const char *setting)
         }
     } else if (neu_mqtt_client_is_open(plugin->client)) {
         started = true;
+        stop_batch_timer(plugin);
+        stop_cache_timer(plugin);
+        flush_batches(plugin);
         plugin->unsubscribe(plugin, &plugin->config);
         rv = neu_mqtt_client_close(plugin->client);
         if (0 != rv) {
@@ -359,14 +684,12 @@ int mqtt_plugin_config(neu_plugin_t *plugin, const char *setting)
         }
         if (neu_mqtt_client_check_version_change(plugin->client,
                                                  config.version)) {
-            neu_mqtt_client_free(plugin->client);
-            plugin->client = neu_mqtt_client_new(config.version);
+            renew_client(plugin, config.version);
         }
     } else if (neu_mqtt_client_check_version_change(plugin->client,
                                                     config.version)) {
         // plugin stopped and version changed
-        neu_mqtt_client_free(plugin->client);
-        plugin->client = neu_mqtt_client_new(config.version);
+        renew_client(plugin, config.version);
     }
 
     rv = config_mqtt_client(plugin, plugin->client, &config);
@@ -375,12 +698,26 @@ int mqtt_plugin_config(neu_plugin_t *plugin, const char *setting)
         goto error;
     }
 
+    if (0 != config_shards(plugin, &config)) {
+        rv = NEU_ERR_MQTT_INIT_FAILURE;
+        goto error;
+    }
+
+    rv = config_cache(plugin, &config);
+    if (0 != rv) {
+        goto error;
+    }
+
     if (started) {
         if (0 != neu_mqtt_client_open(plugin->client)) {
             plog_error(plugin, "neu_mqtt_client_open fail");
             rv = NEU_ERR_MQTT_CONNECT_FAILURE;
             goto error;
         }
+        if (0 != open_shards(plugin)) {
+            rv = NEU_ERR_MQTT_CONNECT_FAILURE;
+            goto error;
+        }
         if (0 != start_hearbeat_timer(plugin, config.heartbeat_interval)) {
             plog_error(plugin, "start hearbeat_timer failed");
             rv = NEU_ERR_EINTERNAL;
@@ -397,6 +734,16 @@ int mqtt_plugin_config(neu_plugin_t *plugin, const char *setting)
     }
     memmove(&plugin->config, &config, sizeof(config));
 
+    if (started && 0 != start_batch_timer(plugin)) {
+        plog_error(plugin, "start batch timer failed");
+        return NEU_ERR_EINTERNAL;
+    }
+
+    if (started && 0 != start_cache_timer(plugin)) {
+        plog_error(plugin, "start cache timer failed");
+        return NEU_ERR_EINTERNAL;
+    }
+
     plog_notice(plugin, "config plugin `%s` success", plugin_name);
     return 0;
 
@@ -423,12 +770,29 @@ int mqtt_plugin_start(neu_plugin_t *plugin)
         goto end;
     }
 
+    if (0 != open_shards(plugin)) {
+        rv = NEU_ERR_MQTT_CONNECT_FAILURE;
+        goto end;
+    }
+
     if (0 != start_hearbeat_timer(plugin, plugin->config.heartbeat_interval)) {
         plog_error(plugin, "start hearbeat_timer failed");
         rv = NEU_ERR_EINTERNAL;
         goto end;
     }
 
+    if (0 != start_batch_timer(plugin)) {
+        plog_error(plugin, "start batch timer failed");
+        rv = NEU_ERR_EINTERNAL;
+        goto end;
+    }
+
+    if (0 != start_cache_timer(plugin)) {
+        plog_error(plugin, "start cache timer failed");
+        rv = NEU_ERR_EINTERNAL;
+        goto end;
+    }
+
     rv = plugin->subscribe(plugin, &plugin->config);
 
 end:
@@ -438,18 +802,30 @@ end:
         plog_error(plugin, "start plugin `%s` failed, error %d", plugin_name,
                    rv);
         neu_mqtt_client_close(plugin->client);
+        close_shards(plugin);
     }
     return rv;
 }
 
 int mqtt_plugin_stop(neu_plugin_t *plugin)
 {
+    stop_batch_timer(plugin);
+    stop_cache_timer(plugin);
+
     if (plugin->client) {
+        flush_batches(plugin);
         plugin->unsubscribe(plugin, &plugin->config);
         neu_mqtt_client_close(plugin->client);
+        close_shards(plugin);
         plog_notice(plugin, "mqtt client closed");
     }
 
+    pthread_mutex_lock(&plugin->cache_mtx);
+    if (plugin->cache && 0 != mqtt_cache_sync(plugin->cache)) {
+        plog_error(plugin, "sync cache fail");
+    }
+    pthread_mutex_unlock(&plugin->cache_mtx);
+
     stop_heartbeart_timer(plugin);
 
     plog_notice(plugin, "stop plugin `%s` success",
@@ -462,15 +838,6 @@ int mqtt_plugin_request(neu_plugin_t *plugin, neu_reqresp_head_t *head,
 {
     neu_err_code_e error = NEU_ERR_SUCCESS;
 
-    // update cached messages number per seconds
-    if (NULL != plugin->client &&
-        (global_timestamp - plugin->cache_metric_update_ts) >= 1000) {
-        NEU_PLUGIN_UPDATE_METRIC(
-            plugin, NEU_METRIC_CACHED_MSGS_NUM,
-            neu_mqtt_client_get_cached_msgs_num(plugin->client), NULL);
-        plugin->cache_metric_update_ts = global_timestamp;
-    }
-
     neu_otel_trace_ctx trace           = NULL;
     neu_otel_scope_ctx scope           = NULL;
     char               new_span_id[36] = { 0 };
@@ -492,7 +859,15 @@ int mqtt_plugin_request(neu_plugin_t *plugin, neu_reqresp_head_t *head,
     }
 
     switch (head->type) {
-    case NEU_RESP_ERROR:
+    case NEU_RESP_ERROR: {
+        neu_resp_write_tags_t resp = {
+            .error = ((neu_resp_error_t *) data)->error,
+        };
+        error = handle_write_response(plugin, head->ctx, &resp, scope, trace,
+                                      new_span_id);
+        break;
+    }
+    case NEU_RESP_WRITE_TAGS:
         error = handle_write_response(plugin, head->ctx, data, scope, trace,
                                       new_span_id);
         break;
@@ -543,6 +918,7 @@ int mqtt_plugin_request(neu_plugin_t *plugin, neu_reqresp_head_t *head,
             if (plugin->client) {
                 neu_mqtt_client_remove_cache_db(plugin->client);
             }
+            remove_cache(plugin);
         }
         break;
     }
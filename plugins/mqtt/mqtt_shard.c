@@ -0,0 +1,45 @@
+/**
+ * NEURON IIoT System for Industry 4.0
+ * Copyright (C) 2020-2022 EMQ Technologies Co., Ltd All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ **/
+
+#include "mqtt_shard.h"
+
+int32_t mqtt_jump_hash(uint64_t key, int32_t n)
+{
+    int64_t b = -1, j = 0;
+
+    while (j < n) {
+        b   = j;
+        key = key * 2862933555777941757ULL + 1;
+        j   = (int64_t)((b + 1) *
+                      ((double) (1LL << 31) / (double) ((key >> 33) + 1)));
+    }
+
+    return (int32_t) b;
+}
+
+int32_t mqtt_shard_of(const char *topic, int32_t n)
+{
+    uint64_t h = 14695981039346656037ULL; // FNV-1a
+
+    for (const char *p = topic; *p; ++p) {
+        h = (h ^ (uint8_t) *p) * 1099511628211ULL;
+    }
+
+    return mqtt_jump_hash(h, n);
+}
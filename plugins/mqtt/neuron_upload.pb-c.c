@@ -0,0 +1,1234 @@
+/* Generated by the protocol buffer compiler.  DO NOT EDIT! */
+/* Generated from: neuron_upload.proto */
+
+/* Do not generate deprecated warnings for self */
+#ifndef PROTOBUF_C__NO_DEPRECATED
+#define PROTOBUF_C__NO_DEPRECATED
+#endif
+
+#include "neuron_upload.pb-c.h"
+void   neuron__upload__int_array__init
+                     (Neuron__Upload__IntArray         *message)
+{
+  static const Neuron__Upload__IntArray init_value = NEURON__UPLOAD__INT_ARRAY__INIT;
+  *message = init_value;
+}
+size_t neuron__upload__int_array__get_packed_size
+                     (const Neuron__Upload__IntArray *message)
+{
+  assert(message->base.descriptor == &neuron__upload__int_array__descriptor);
+  return protobuf_c_message_get_packed_size ((const ProtobufCMessage*)(message));
+}
+size_t neuron__upload__int_array__pack
+                     (const Neuron__Upload__IntArray *message,
+                      uint8_t       *out)
+{
+  assert(message->base.descriptor == &neuron__upload__int_array__descriptor);
+  return protobuf_c_message_pack ((const ProtobufCMessage*)message, out);
+}
+size_t neuron__upload__int_array__pack_to_buffer
+                     (const Neuron__Upload__IntArray *message,
+                      ProtobufCBuffer *buffer)
+{
+  assert(message->base.descriptor == &neuron__upload__int_array__descriptor);
+  return protobuf_c_message_pack_to_buffer ((const ProtobufCMessage*)message, buffer);
+}
+Neuron__Upload__IntArray *
+       neuron__upload__int_array__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data)
+{
+  return (Neuron__Upload__IntArray *)
+     protobuf_c_message_unpack (&neuron__upload__int_array__descriptor,
+                                allocator, len, data);
+}
+void   neuron__upload__int_array__free_unpacked
+                     (Neuron__Upload__IntArray *message,
+                      ProtobufCAllocator *allocator)
+{
+  if(!message)
+    return;
+  assert(message->base.descriptor == &neuron__upload__int_array__descriptor);
+  protobuf_c_message_free_unpacked ((ProtobufCMessage*)message, allocator);
+}
+void   neuron__upload__uint_array__init
+                     (Neuron__Upload__UintArray         *message)
+{
+  static const Neuron__Upload__UintArray init_value = NEURON__UPLOAD__UINT_ARRAY__INIT;
+  *message = init_value;
+}
+size_t neuron__upload__uint_array__get_packed_size
+                     (const Neuron__Upload__UintArray *message)
+{
+  assert(message->base.descriptor == &neuron__upload__uint_array__descriptor);
+  return protobuf_c_message_get_packed_size ((const ProtobufCMessage*)(message));
+}
+size_t neuron__upload__uint_array__pack
+                     (const Neuron__Upload__UintArray *message,
+                      uint8_t       *out)
+{
+  assert(message->base.descriptor == &neuron__upload__uint_array__descriptor);
+  return protobuf_c_message_pack ((const ProtobufCMessage*)message, out);
+}
+size_t neuron__upload__uint_array__pack_to_buffer
+                     (const Neuron__Upload__UintArray *message,
+                      ProtobufCBuffer *buffer)
+{
+  assert(message->base.descriptor == &neuron__upload__uint_array__descriptor);
+  return protobuf_c_message_pack_to_buffer ((const ProtobufCMessage*)message, buffer);
+}
+Neuron__Upload__UintArray *
+       neuron__upload__uint_array__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data)
+{
+  return (Neuron__Upload__UintArray *)
+     protobuf_c_message_unpack (&neuron__upload__uint_array__descriptor,
+                                allocator, len, data);
+}
+void   neuron__upload__uint_array__free_unpacked
+                     (Neuron__Upload__UintArray *message,
+                      ProtobufCAllocator *allocator)
+{
+  if(!message)
+    return;
+  assert(message->base.descriptor == &neuron__upload__uint_array__descriptor);
+  protobuf_c_message_free_unpacked ((ProtobufCMessage*)message, allocator);
+}
+void   neuron__upload__float_array__init
+                     (Neuron__Upload__FloatArray         *message)
+{
+  static const Neuron__Upload__FloatArray init_value = NEURON__UPLOAD__FLOAT_ARRAY__INIT;
+  *message = init_value;
+}
+size_t neuron__upload__float_array__get_packed_size
+                     (const Neuron__Upload__FloatArray *message)
+{
+  assert(message->base.descriptor == &neuron__upload__float_array__descriptor);
+  return protobuf_c_message_get_packed_size ((const ProtobufCMessage*)(message));
+}
+size_t neuron__upload__float_array__pack
+                     (const Neuron__Upload__FloatArray *message,
+                      uint8_t       *out)
+{
+  assert(message->base.descriptor == &neuron__upload__float_array__descriptor);
+  return protobuf_c_message_pack ((const ProtobufCMessage*)message, out);
+}
+size_t neuron__upload__float_array__pack_to_buffer
+                     (const Neuron__Upload__FloatArray *message,
+                      ProtobufCBuffer *buffer)
+{
+  assert(message->base.descriptor == &neuron__upload__float_array__descriptor);
+  return protobuf_c_message_pack_to_buffer ((const ProtobufCMessage*)message, buffer);
+}
+Neuron__Upload__FloatArray *
+       neuron__upload__float_array__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data)
+{
+  return (Neuron__Upload__FloatArray *)
+     protobuf_c_message_unpack (&neuron__upload__float_array__descriptor,
+                                allocator, len, data);
+}
+void   neuron__upload__float_array__free_unpacked
+                     (Neuron__Upload__FloatArray *message,
+                      ProtobufCAllocator *allocator)
+{
+  if(!message)
+    return;
+  assert(message->base.descriptor == &neuron__upload__float_array__descriptor);
+  protobuf_c_message_free_unpacked ((ProtobufCMessage*)message, allocator);
+}
+void   neuron__upload__double_array__init
+                     (Neuron__Upload__DoubleArray         *message)
+{
+  static const Neuron__Upload__DoubleArray init_value = NEURON__UPLOAD__DOUBLE_ARRAY__INIT;
+  *message = init_value;
+}
+size_t neuron__upload__double_array__get_packed_size
+                     (const Neuron__Upload__DoubleArray *message)
+{
+  assert(message->base.descriptor == &neuron__upload__double_array__descriptor);
+  return protobuf_c_message_get_packed_size ((const ProtobufCMessage*)(message));
+}
+size_t neuron__upload__double_array__pack
+                     (const Neuron__Upload__DoubleArray *message,
+                      uint8_t       *out)
+{
+  assert(message->base.descriptor == &neuron__upload__double_array__descriptor);
+  return protobuf_c_message_pack ((const ProtobufCMessage*)message, out);
+}
+size_t neuron__upload__double_array__pack_to_buffer
+                     (const Neuron__Upload__DoubleArray *message,
+                      ProtobufCBuffer *buffer)
+{
+  assert(message->base.descriptor == &neuron__upload__double_array__descriptor);
+  return protobuf_c_message_pack_to_buffer ((const ProtobufCMessage*)message, buffer);
+}
+Neuron__Upload__DoubleArray *
+       neuron__upload__double_array__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data)
+{
+  return (Neuron__Upload__DoubleArray *)
+     protobuf_c_message_unpack (&neuron__upload__double_array__descriptor,
+                                allocator, len, data);
+}
+void   neuron__upload__double_array__free_unpacked
+                     (Neuron__Upload__DoubleArray *message,
+                      ProtobufCAllocator *allocator)
+{
+  if(!message)
+    return;
+  assert(message->base.descriptor == &neuron__upload__double_array__descriptor);
+  protobuf_c_message_free_unpacked ((ProtobufCMessage*)message, allocator);
+}
+void   neuron__upload__bool_array__init
+                     (Neuron__Upload__BoolArray         *message)
+{
+  static const Neuron__Upload__BoolArray init_value = NEURON__UPLOAD__BOOL_ARRAY__INIT;
+  *message = init_value;
+}
+size_t neuron__upload__bool_array__get_packed_size
+                     (const Neuron__Upload__BoolArray *message)
+{
+  assert(message->base.descriptor == &neuron__upload__bool_array__descriptor);
+  return protobuf_c_message_get_packed_size ((const ProtobufCMessage*)(message));
+}
+size_t neuron__upload__bool_array__pack
+                     (const Neuron__Upload__BoolArray *message,
+                      uint8_t       *out)
+{
+  assert(message->base.descriptor == &neuron__upload__bool_array__descriptor);
+  return protobuf_c_message_pack ((const ProtobufCMessage*)message, out);
+}
+size_t neuron__upload__bool_array__pack_to_buffer
+                     (const Neuron__Upload__BoolArray *message,
+                      ProtobufCBuffer *buffer)
+{
+  assert(message->base.descriptor == &neuron__upload__bool_array__descriptor);
+  return protobuf_c_message_pack_to_buffer ((const ProtobufCMessage*)message, buffer);
+}
+Neuron__Upload__BoolArray *
+       neuron__upload__bool_array__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data)
+{
+  return (Neuron__Upload__BoolArray *)
+     protobuf_c_message_unpack (&neuron__upload__bool_array__descriptor,
+                                allocator, len, data);
+}
+void   neuron__upload__bool_array__free_unpacked
+                     (Neuron__Upload__BoolArray *message,
+                      ProtobufCAllocator *allocator)
+{
+  if(!message)
+    return;
+  assert(message->base.descriptor == &neuron__upload__bool_array__descriptor);
+  protobuf_c_message_free_unpacked ((ProtobufCMessage*)message, allocator);
+}
+void   neuron__upload__string_array__init
+                     (Neuron__Upload__StringArray         *message)
+{
+  static const Neuron__Upload__StringArray init_value = NEURON__UPLOAD__STRING_ARRAY__INIT;
+  *message = init_value;
+}
+size_t neuron__upload__string_array__get_packed_size
+                     (const Neuron__Upload__StringArray *message)
+{
+  assert(message->base.descriptor == &neuron__upload__string_array__descriptor);
+  return protobuf_c_message_get_packed_size ((const ProtobufCMessage*)(message));
+}
+size_t neuron__upload__string_array__pack
+                     (const Neuron__Upload__StringArray *message,
+                      uint8_t       *out)
+{
+  assert(message->base.descriptor == &neuron__upload__string_array__descriptor);
+  return protobuf_c_message_pack ((const ProtobufCMessage*)message, out);
+}
+size_t neuron__upload__string_array__pack_to_buffer
+                     (const Neuron__Upload__StringArray *message,
+                      ProtobufCBuffer *buffer)
+{
+  assert(message->base.descriptor == &neuron__upload__string_array__descriptor);
+  return protobuf_c_message_pack_to_buffer ((const ProtobufCMessage*)message, buffer);
+}
+Neuron__Upload__StringArray *
+       neuron__upload__string_array__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data)
+{
+  return (Neuron__Upload__StringArray *)
+     protobuf_c_message_unpack (&neuron__upload__string_array__descriptor,
+                                allocator, len, data);
+}
+void   neuron__upload__string_array__free_unpacked
+                     (Neuron__Upload__StringArray *message,
+                      ProtobufCAllocator *allocator)
+{
+  if(!message)
+    return;
+  assert(message->base.descriptor == &neuron__upload__string_array__descriptor);
+  protobuf_c_message_free_unpacked ((ProtobufCMessage*)message, allocator);
+}
+void   neuron__upload__value__init
+                     (Neuron__Upload__Value         *message)
+{
+  static const Neuron__Upload__Value init_value = NEURON__UPLOAD__VALUE__INIT;
+  *message = init_value;
+}
+size_t neuron__upload__value__get_packed_size
+                     (const Neuron__Upload__Value *message)
+{
+  assert(message->base.descriptor == &neuron__upload__value__descriptor);
+  return protobuf_c_message_get_packed_size ((const ProtobufCMessage*)(message));
+}
+size_t neuron__upload__value__pack
+                     (const Neuron__Upload__Value *message,
+                      uint8_t       *out)
+{
+  assert(message->base.descriptor == &neuron__upload__value__descriptor);
+  return protobuf_c_message_pack ((const ProtobufCMessage*)message, out);
+}
+size_t neuron__upload__value__pack_to_buffer
+                     (const Neuron__Upload__Value *message,
+                      ProtobufCBuffer *buffer)
+{
+  assert(message->base.descriptor == &neuron__upload__value__descriptor);
+  return protobuf_c_message_pack_to_buffer ((const ProtobufCMessage*)message, buffer);
+}
+Neuron__Upload__Value *
+       neuron__upload__value__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data)
+{
+  return (Neuron__Upload__Value *)
+     protobuf_c_message_unpack (&neuron__upload__value__descriptor,
+                                allocator, len, data);
+}
+void   neuron__upload__value__free_unpacked
+                     (Neuron__Upload__Value *message,
+                      ProtobufCAllocator *allocator)
+{
+  if(!message)
+    return;
+  assert(message->base.descriptor == &neuron__upload__value__descriptor);
+  protobuf_c_message_free_unpacked ((ProtobufCMessage*)message, allocator);
+}
+void   neuron__upload__meta__init
+                     (Neuron__Upload__Meta         *message)
+{
+  static const Neuron__Upload__Meta init_value = NEURON__UPLOAD__META__INIT;
+  *message = init_value;
+}
+size_t neuron__upload__meta__get_packed_size
+                     (const Neuron__Upload__Meta *message)
+{
+  assert(message->base.descriptor == &neuron__upload__meta__descriptor);
+  return protobuf_c_message_get_packed_size ((const ProtobufCMessage*)(message));
+}
+size_t neuron__upload__meta__pack
+                     (const Neuron__Upload__Meta *message,
+                      uint8_t       *out)
+{
+  assert(message->base.descriptor == &neuron__upload__meta__descriptor);
+  return protobuf_c_message_pack ((const ProtobufCMessage*)message, out);
+}
+size_t neuron__upload__meta__pack_to_buffer
+                     (const Neuron__Upload__Meta *message,
+                      ProtobufCBuffer *buffer)
+{
+  assert(message->base.descriptor == &neuron__upload__meta__descriptor);
+  return protobuf_c_message_pack_to_buffer ((const ProtobufCMessage*)message, buffer);
+}
+Neuron__Upload__Meta *
+       neuron__upload__meta__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data)
+{
+  return (Neuron__Upload__Meta *)
+     protobuf_c_message_unpack (&neuron__upload__meta__descriptor,
+                                allocator, len, data);
+}
+void   neuron__upload__meta__free_unpacked
+                     (Neuron__Upload__Meta *message,
+                      ProtobufCAllocator *allocator)
+{
+  if(!message)
+    return;
+  assert(message->base.descriptor == &neuron__upload__meta__descriptor);
+  protobuf_c_message_free_unpacked ((ProtobufCMessage*)message, allocator);
+}
+void   neuron__upload__tag__init
+                     (Neuron__Upload__Tag         *message)
+{
+  static const Neuron__Upload__Tag init_value = NEURON__UPLOAD__TAG__INIT;
+  *message = init_value;
+}
+size_t neuron__upload__tag__get_packed_size
+                     (const Neuron__Upload__Tag *message)
+{
+  assert(message->base.descriptor == &neuron__upload__tag__descriptor);
+  return protobuf_c_message_get_packed_size ((const ProtobufCMessage*)(message));
+}
+size_t neuron__upload__tag__pack
+                     (const Neuron__Upload__Tag *message,
+                      uint8_t       *out)
+{
+  assert(message->base.descriptor == &neuron__upload__tag__descriptor);
+  return protobuf_c_message_pack ((const ProtobufCMessage*)message, out);
+}
+size_t neuron__upload__tag__pack_to_buffer
+                     (const Neuron__Upload__Tag *message,
+                      ProtobufCBuffer *buffer)
+{
+  assert(message->base.descriptor == &neuron__upload__tag__descriptor);
+  return protobuf_c_message_pack_to_buffer ((const ProtobufCMessage*)message, buffer);
+}
+Neuron__Upload__Tag *
+       neuron__upload__tag__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data)
+{
+  return (Neuron__Upload__Tag *)
+     protobuf_c_message_unpack (&neuron__upload__tag__descriptor,
+                                allocator, len, data);
+}
+void   neuron__upload__tag__free_unpacked
+                     (Neuron__Upload__Tag *message,
+                      ProtobufCAllocator *allocator)
+{
+  if(!message)
+    return;
+  assert(message->base.descriptor == &neuron__upload__tag__descriptor);
+  protobuf_c_message_free_unpacked ((ProtobufCMessage*)message, allocator);
+}
+void   neuron__upload__upload__init
+                     (Neuron__Upload__Upload         *message)
+{
+  static const Neuron__Upload__Upload init_value = NEURON__UPLOAD__UPLOAD__INIT;
+  *message = init_value;
+}
+size_t neuron__upload__upload__get_packed_size
+                     (const Neuron__Upload__Upload *message)
+{
+  assert(message->base.descriptor == &neuron__upload__upload__descriptor);
+  return protobuf_c_message_get_packed_size ((const ProtobufCMessage*)(message));
+}
+size_t neuron__upload__upload__pack
+                     (const Neuron__Upload__Upload *message,
+                      uint8_t       *out)
+{
+  assert(message->base.descriptor == &neuron__upload__upload__descriptor);
+  return protobuf_c_message_pack ((const ProtobufCMessage*)message, out);
+}
+size_t neuron__upload__upload__pack_to_buffer
+                     (const Neuron__Upload__Upload *message,
+                      ProtobufCBuffer *buffer)
+{
+  assert(message->base.descriptor == &neuron__upload__upload__descriptor);
+  return protobuf_c_message_pack_to_buffer ((const ProtobufCMessage*)message, buffer);
+}
+Neuron__Upload__Upload *
+       neuron__upload__upload__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data)
+{
+  return (Neuron__Upload__Upload *)
+     protobuf_c_message_unpack (&neuron__upload__upload__descriptor,
+                                allocator, len, data);
+}
+void   neuron__upload__upload__free_unpacked
+                     (Neuron__Upload__Upload *message,
+                      ProtobufCAllocator *allocator)
+{
+  if(!message)
+    return;
+  assert(message->base.descriptor == &neuron__upload__upload__descriptor);
+  protobuf_c_message_free_unpacked ((ProtobufCMessage*)message, allocator);
+}
+void   neuron__upload__batch__init
+                     (Neuron__Upload__Batch         *message)
+{
+  static const Neuron__Upload__Batch init_value = NEURON__UPLOAD__BATCH__INIT;
+  *message = init_value;
+}
+size_t neuron__upload__batch__get_packed_size
+                     (const Neuron__Upload__Batch *message)
+{
+  assert(message->base.descriptor == &neuron__upload__batch__descriptor);
+  return protobuf_c_message_get_packed_size ((const ProtobufCMessage*)(message));
+}
+size_t neuron__upload__batch__pack
+                     (const Neuron__Upload__Batch *message,
+                      uint8_t       *out)
+{
+  assert(message->base.descriptor == &neuron__upload__batch__descriptor);
+  return protobuf_c_message_pack ((const ProtobufCMessage*)message, out);
+}
+size_t neuron__upload__batch__pack_to_buffer
+                     (const Neuron__Upload__Batch *message,
+                      ProtobufCBuffer *buffer)
+{
+  assert(message->base.descriptor == &neuron__upload__batch__descriptor);
+  return protobuf_c_message_pack_to_buffer ((const ProtobufCMessage*)message, buffer);
+}
+Neuron__Upload__Batch *
+       neuron__upload__batch__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data)
+{
+  return (Neuron__Upload__Batch *)
+     protobuf_c_message_unpack (&neuron__upload__batch__descriptor,
+                                allocator, len, data);
+}
+void   neuron__upload__batch__free_unpacked
+                     (Neuron__Upload__Batch *message,
+                      ProtobufCAllocator *allocator)
+{
+  if(!message)
+    return;
+  assert(message->base.descriptor == &neuron__upload__batch__descriptor);
+  protobuf_c_message_free_unpacked ((ProtobufCMessage*)message, allocator);
+}
+static const ProtobufCFieldDescriptor neuron__upload__int_array__field_descriptors[1] =
+{
+  {
+    "values",
+    1,
+    PROTOBUF_C_LABEL_REPEATED,
+    PROTOBUF_C_TYPE_SINT64,
+    offsetof(Neuron__Upload__IntArray, n_values),
+    offsetof(Neuron__Upload__IntArray, values),
+    NULL,
+    NULL,
+    0 | PROTOBUF_C_FIELD_FLAG_PACKED,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+};
+static const unsigned neuron__upload__int_array__field_indices_by_name[] = {
+  0,   /* field[0] = values */
+};
+static const ProtobufCIntRange neuron__upload__int_array__number_ranges[1 + 1] =
+{
+  { 1, 0 },
+  { 0, 1 }
+};
+const ProtobufCMessageDescriptor neuron__upload__int_array__descriptor =
+{
+  PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
+  "neuron.upload.IntArray",
+  "IntArray",
+  "Neuron__Upload__IntArray",
+  "neuron.upload",
+  sizeof(Neuron__Upload__IntArray),
+  1,
+  neuron__upload__int_array__field_descriptors,
+  neuron__upload__int_array__field_indices_by_name,
+  1,  neuron__upload__int_array__number_ranges,
+  (ProtobufCMessageInit) neuron__upload__int_array__init,
+  NULL,NULL,NULL    /* reserved[123] */
+};
+static const ProtobufCFieldDescriptor neuron__upload__uint_array__field_descriptors[1] =
+{
+  {
+    "values",
+    1,
+    PROTOBUF_C_LABEL_REPEATED,
+    PROTOBUF_C_TYPE_UINT64,
+    offsetof(Neuron__Upload__UintArray, n_values),
+    offsetof(Neuron__Upload__UintArray, values),
+    NULL,
+    NULL,
+    0 | PROTOBUF_C_FIELD_FLAG_PACKED,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+};
+static const unsigned neuron__upload__uint_array__field_indices_by_name[] = {
+  0,   /* field[0] = values */
+};
+static const ProtobufCIntRange neuron__upload__uint_array__number_ranges[1 + 1] =
+{
+  { 1, 0 },
+  { 0, 1 }
+};
+const ProtobufCMessageDescriptor neuron__upload__uint_array__descriptor =
+{
+  PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
+  "neuron.upload.UintArray",
+  "UintArray",
+  "Neuron__Upload__UintArray",
+  "neuron.upload",
+  sizeof(Neuron__Upload__UintArray),
+  1,
+  neuron__upload__uint_array__field_descriptors,
+  neuron__upload__uint_array__field_indices_by_name,
+  1,  neuron__upload__uint_array__number_ranges,
+  (ProtobufCMessageInit) neuron__upload__uint_array__init,
+  NULL,NULL,NULL    /* reserved[123] */
+};
+static const ProtobufCFieldDescriptor neuron__upload__float_array__field_descriptors[1] =
+{
+  {
+    "values",
+    1,
+    PROTOBUF_C_LABEL_REPEATED,
+    PROTOBUF_C_TYPE_FLOAT,
+    offsetof(Neuron__Upload__FloatArray, n_values),
+    offsetof(Neuron__Upload__FloatArray, values),
+    NULL,
+    NULL,
+    0 | PROTOBUF_C_FIELD_FLAG_PACKED,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+};
+static const unsigned neuron__upload__float_array__field_indices_by_name[] = {
+  0,   /* field[0] = values */
+};
+static const ProtobufCIntRange neuron__upload__float_array__number_ranges[1 + 1] =
+{
+  { 1, 0 },
+  { 0, 1 }
+};
+const ProtobufCMessageDescriptor neuron__upload__float_array__descriptor =
+{
+  PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
+  "neuron.upload.FloatArray",
+  "FloatArray",
+  "Neuron__Upload__FloatArray",
+  "neuron.upload",
+  sizeof(Neuron__Upload__FloatArray),
+  1,
+  neuron__upload__float_array__field_descriptors,
+  neuron__upload__float_array__field_indices_by_name,
+  1,  neuron__upload__float_array__number_ranges,
+  (ProtobufCMessageInit) neuron__upload__float_array__init,
+  NULL,NULL,NULL    /* reserved[123] */
+};
+static const ProtobufCFieldDescriptor neuron__upload__double_array__field_descriptors[1] =
+{
+  {
+    "values",
+    1,
+    PROTOBUF_C_LABEL_REPEATED,
+    PROTOBUF_C_TYPE_DOUBLE,
+    offsetof(Neuron__Upload__DoubleArray, n_values),
+    offsetof(Neuron__Upload__DoubleArray, values),
+    NULL,
+    NULL,
+    0 | PROTOBUF_C_FIELD_FLAG_PACKED,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+};
+static const unsigned neuron__upload__double_array__field_indices_by_name[] = {
+  0,   /* field[0] = values */
+};
+static const ProtobufCIntRange neuron__upload__double_array__number_ranges[1 + 1] =
+{
+  { 1, 0 },
+  { 0, 1 }
+};
+const ProtobufCMessageDescriptor neuron__upload__double_array__descriptor =
+{
+  PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
+  "neuron.upload.DoubleArray",
+  "DoubleArray",
+  "Neuron__Upload__DoubleArray",
+  "neuron.upload",
+  sizeof(Neuron__Upload__DoubleArray),
+  1,
+  neuron__upload__double_array__field_descriptors,
+  neuron__upload__double_array__field_indices_by_name,
+  1,  neuron__upload__double_array__number_ranges,
+  (ProtobufCMessageInit) neuron__upload__double_array__init,
+  NULL,NULL,NULL    /* reserved[123] */
+};
+static const ProtobufCFieldDescriptor neuron__upload__bool_array__field_descriptors[1] =
+{
+  {
+    "values",
+    1,
+    PROTOBUF_C_LABEL_REPEATED,
+    PROTOBUF_C_TYPE_BOOL,
+    offsetof(Neuron__Upload__BoolArray, n_values),
+    offsetof(Neuron__Upload__BoolArray, values),
+    NULL,
+    NULL,
+    0 | PROTOBUF_C_FIELD_FLAG_PACKED,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+};
+static const unsigned neuron__upload__bool_array__field_indices_by_name[] = {
+  0,   /* field[0] = values */
+};
+static const ProtobufCIntRange neuron__upload__bool_array__number_ranges[1 + 1] =
+{
+  { 1, 0 },
+  { 0, 1 }
+};
+const ProtobufCMessageDescriptor neuron__upload__bool_array__descriptor =
+{
+  PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
+  "neuron.upload.BoolArray",
+  "BoolArray",
+  "Neuron__Upload__BoolArray",
+  "neuron.upload",
+  sizeof(Neuron__Upload__BoolArray),
+  1,
+  neuron__upload__bool_array__field_descriptors,
+  neuron__upload__bool_array__field_indices_by_name,
+  1,  neuron__upload__bool_array__number_ranges,
+  (ProtobufCMessageInit) neuron__upload__bool_array__init,
+  NULL,NULL,NULL    /* reserved[123] */
+};
+static const ProtobufCFieldDescriptor neuron__upload__string_array__field_descriptors[1] =
+{
+  {
+    "values",
+    1,
+    PROTOBUF_C_LABEL_REPEATED,
+    PROTOBUF_C_TYPE_STRING,
+    offsetof(Neuron__Upload__StringArray, n_values),
+    offsetof(Neuron__Upload__StringArray, values),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+};
+static const unsigned neuron__upload__string_array__field_indices_by_name[] = {
+  0,   /* field[0] = values */
+};
+static const ProtobufCIntRange neuron__upload__string_array__number_ranges[1 + 1] =
+{
+  { 1, 0 },
+  { 0, 1 }
+};
+const ProtobufCMessageDescriptor neuron__upload__string_array__descriptor =
+{
+  PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
+  "neuron.upload.StringArray",
+  "StringArray",
+  "Neuron__Upload__StringArray",
+  "neuron.upload",
+  sizeof(Neuron__Upload__StringArray),
+  1,
+  neuron__upload__string_array__field_descriptors,
+  neuron__upload__string_array__field_indices_by_name,
+  1,  neuron__upload__string_array__number_ranges,
+  (ProtobufCMessageInit) neuron__upload__string_array__init,
+  NULL,NULL,NULL    /* reserved[123] */
+};
+static const ProtobufCFieldDescriptor neuron__upload__value__field_descriptors[14] =
+{
+  {
+    "int_value",
+    1,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_SINT64,
+    offsetof(Neuron__Upload__Value, value_case),
+    offsetof(Neuron__Upload__Value, int_value),
+    NULL,
+    NULL,
+    0 | PROTOBUF_C_FIELD_FLAG_ONEOF,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "uint_value",
+    2,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT64,
+    offsetof(Neuron__Upload__Value, value_case),
+    offsetof(Neuron__Upload__Value, uint_value),
+    NULL,
+    NULL,
+    0 | PROTOBUF_C_FIELD_FLAG_ONEOF,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "float_value",
+    3,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_FLOAT,
+    offsetof(Neuron__Upload__Value, value_case),
+    offsetof(Neuron__Upload__Value, float_value),
+    NULL,
+    NULL,
+    0 | PROTOBUF_C_FIELD_FLAG_ONEOF,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "double_value",
+    4,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_DOUBLE,
+    offsetof(Neuron__Upload__Value, value_case),
+    offsetof(Neuron__Upload__Value, double_value),
+    NULL,
+    NULL,
+    0 | PROTOBUF_C_FIELD_FLAG_ONEOF,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "bool_value",
+    5,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_BOOL,
+    offsetof(Neuron__Upload__Value, value_case),
+    offsetof(Neuron__Upload__Value, bool_value),
+    NULL,
+    NULL,
+    0 | PROTOBUF_C_FIELD_FLAG_ONEOF,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "string_value",
+    6,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_STRING,
+    offsetof(Neuron__Upload__Value, value_case),
+    offsetof(Neuron__Upload__Value, string_value),
+    NULL,
+    &protobuf_c_empty_string,
+    0 | PROTOBUF_C_FIELD_FLAG_ONEOF,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "bytes_value",
+    7,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_BYTES,
+    offsetof(Neuron__Upload__Value, value_case),
+    offsetof(Neuron__Upload__Value, bytes_value),
+    NULL,
+    NULL,
+    0 | PROTOBUF_C_FIELD_FLAG_ONEOF,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "int_array",
+    8,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_MESSAGE,
+    offsetof(Neuron__Upload__Value, value_case),
+    offsetof(Neuron__Upload__Value, int_array),
+    &neuron__upload__int_array__descriptor,
+    NULL,
+    0 | PROTOBUF_C_FIELD_FLAG_ONEOF,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "uint_array",
+    9,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_MESSAGE,
+    offsetof(Neuron__Upload__Value, value_case),
+    offsetof(Neuron__Upload__Value, uint_array),
+    &neuron__upload__uint_array__descriptor,
+    NULL,
+    0 | PROTOBUF_C_FIELD_FLAG_ONEOF,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "float_array",
+    10,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_MESSAGE,
+    offsetof(Neuron__Upload__Value, value_case),
+    offsetof(Neuron__Upload__Value, float_array),
+    &neuron__upload__float_array__descriptor,
+    NULL,
+    0 | PROTOBUF_C_FIELD_FLAG_ONEOF,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "double_array",
+    11,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_MESSAGE,
+    offsetof(Neuron__Upload__Value, value_case),
+    offsetof(Neuron__Upload__Value, double_array),
+    &neuron__upload__double_array__descriptor,
+    NULL,
+    0 | PROTOBUF_C_FIELD_FLAG_ONEOF,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "bool_array",
+    12,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_MESSAGE,
+    offsetof(Neuron__Upload__Value, value_case),
+    offsetof(Neuron__Upload__Value, bool_array),
+    &neuron__upload__bool_array__descriptor,
+    NULL,
+    0 | PROTOBUF_C_FIELD_FLAG_ONEOF,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "string_array",
+    13,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_MESSAGE,
+    offsetof(Neuron__Upload__Value, value_case),
+    offsetof(Neuron__Upload__Value, string_array),
+    &neuron__upload__string_array__descriptor,
+    NULL,
+    0 | PROTOBUF_C_FIELD_FLAG_ONEOF,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "json_value",
+    14,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_STRING,
+    offsetof(Neuron__Upload__Value, value_case),
+    offsetof(Neuron__Upload__Value, json_value),
+    NULL,
+    &protobuf_c_empty_string,
+    0 | PROTOBUF_C_FIELD_FLAG_ONEOF,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+};
+static const unsigned neuron__upload__value__field_indices_by_name[] = {
+  11,   /* field[11] = bool_array */
+  4,   /* field[4] = bool_value */
+  6,   /* field[6] = bytes_value */
+  10,   /* field[10] = double_array */
+  3,   /* field[3] = double_value */
+  9,   /* field[9] = float_array */
+  2,   /* field[2] = float_value */
+  7,   /* field[7] = int_array */
+  0,   /* field[0] = int_value */
+  13,   /* field[13] = json_value */
+  12,   /* field[12] = string_array */
+  5,   /* field[5] = string_value */
+  8,   /* field[8] = uint_array */
+  1,   /* field[1] = uint_value */
+};
+static const ProtobufCIntRange neuron__upload__value__number_ranges[1 + 1] =
+{
+  { 1, 0 },
+  { 0, 14 }
+};
+const ProtobufCMessageDescriptor neuron__upload__value__descriptor =
+{
+  PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
+  "neuron.upload.Value",
+  "Value",
+  "Neuron__Upload__Value",
+  "neuron.upload",
+  sizeof(Neuron__Upload__Value),
+  14,
+  neuron__upload__value__field_descriptors,
+  neuron__upload__value__field_indices_by_name,
+  1,  neuron__upload__value__number_ranges,
+  (ProtobufCMessageInit) neuron__upload__value__init,
+  NULL,NULL,NULL    /* reserved[123] */
+};
+static const ProtobufCFieldDescriptor neuron__upload__meta__field_descriptors[3] =
+{
+  {
+    "name",
+    1,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_STRING,
+    0,   /* quantifier_offset */
+    offsetof(Neuron__Upload__Meta, name),
+    NULL,
+    &protobuf_c_empty_string,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "type",
+    2,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(Neuron__Upload__Meta, type),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "value",
+    3,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_MESSAGE,
+    0,   /* quantifier_offset */
+    offsetof(Neuron__Upload__Meta, value),
+    &neuron__upload__value__descriptor,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+};
+static const unsigned neuron__upload__meta__field_indices_by_name[] = {
+  0,   /* field[0] = name */
+  1,   /* field[1] = type */
+  2,   /* field[2] = value */
+};
+static const ProtobufCIntRange neuron__upload__meta__number_ranges[1 + 1] =
+{
+  { 1, 0 },
+  { 0, 3 }
+};
+const ProtobufCMessageDescriptor neuron__upload__meta__descriptor =
+{
+  PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
+  "neuron.upload.Meta",
+  "Meta",
+  "Neuron__Upload__Meta",
+  "neuron.upload",
+  sizeof(Neuron__Upload__Meta),
+  3,
+  neuron__upload__meta__field_descriptors,
+  neuron__upload__meta__field_indices_by_name,
+  1,  neuron__upload__meta__number_ranges,
+  (ProtobufCMessageInit) neuron__upload__meta__init,
+  NULL,NULL,NULL    /* reserved[123] */
+};
+static const ProtobufCFieldDescriptor neuron__upload__tag__field_descriptors[5] =
+{
+  {
+    "name",
+    1,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_STRING,
+    0,   /* quantifier_offset */
+    offsetof(Neuron__Upload__Tag, name),
+    NULL,
+    &protobuf_c_empty_string,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "type",
+    2,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(Neuron__Upload__Tag, type),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "value",
+    3,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_MESSAGE,
+    0,   /* quantifier_offset */
+    offsetof(Neuron__Upload__Tag, value),
+    &neuron__upload__value__descriptor,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "error",
+    4,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_INT32,
+    0,   /* quantifier_offset */
+    offsetof(Neuron__Upload__Tag, error),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "metas",
+    5,
+    PROTOBUF_C_LABEL_REPEATED,
+    PROTOBUF_C_TYPE_MESSAGE,
+    offsetof(Neuron__Upload__Tag, n_metas),
+    offsetof(Neuron__Upload__Tag, metas),
+    &neuron__upload__meta__descriptor,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+};
+static const unsigned neuron__upload__tag__field_indices_by_name[] = {
+  3,   /* field[3] = error */
+  4,   /* field[4] = metas */
+  0,   /* field[0] = name */
+  1,   /* field[1] = type */
+  2,   /* field[2] = value */
+};
+static const ProtobufCIntRange neuron__upload__tag__number_ranges[1 + 1] =
+{
+  { 1, 0 },
+  { 0, 5 }
+};
+const ProtobufCMessageDescriptor neuron__upload__tag__descriptor =
+{
+  PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
+  "neuron.upload.Tag",
+  "Tag",
+  "Neuron__Upload__Tag",
+  "neuron.upload",
+  sizeof(Neuron__Upload__Tag),
+  5,
+  neuron__upload__tag__field_descriptors,
+  neuron__upload__tag__field_indices_by_name,
+  1,  neuron__upload__tag__number_ranges,
+  (ProtobufCMessageInit) neuron__upload__tag__init,
+  NULL,NULL,NULL    /* reserved[123] */
+};
+static const ProtobufCFieldDescriptor neuron__upload__upload__field_descriptors[6] =
+{
+  {
+    "node",
+    1,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_STRING,
+    0,   /* quantifier_offset */
+    offsetof(Neuron__Upload__Upload, node),
+    NULL,
+    &protobuf_c_empty_string,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "group",
+    2,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_STRING,
+    0,   /* quantifier_offset */
+    offsetof(Neuron__Upload__Upload, group),
+    NULL,
+    &protobuf_c_empty_string,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "timestamp",
+    3,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT64,
+    0,   /* quantifier_offset */
+    offsetof(Neuron__Upload__Upload, timestamp),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "tags",
+    4,
+    PROTOBUF_C_LABEL_REPEATED,
+    PROTOBUF_C_TYPE_MESSAGE,
+    offsetof(Neuron__Upload__Upload, n_tags),
+    offsetof(Neuron__Upload__Upload, tags),
+    &neuron__upload__tag__descriptor,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "seq",
+    5,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT64,
+    0,   /* quantifier_offset */
+    offsetof(Neuron__Upload__Upload, seq),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "keyframe",
+    6,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_BOOL,
+    0,   /* quantifier_offset */
+    offsetof(Neuron__Upload__Upload, keyframe),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+};
+static const unsigned neuron__upload__upload__field_indices_by_name[] = {
+  1,   /* field[1] = group */
+  5,   /* field[5] = keyframe */
+  0,   /* field[0] = node */
+  4,   /* field[4] = seq */
+  3,   /* field[3] = tags */
+  2,   /* field[2] = timestamp */
+};
+static const ProtobufCIntRange neuron__upload__upload__number_ranges[1 + 1] =
+{
+  { 1, 0 },
+  { 0, 6 }
+};
+const ProtobufCMessageDescriptor neuron__upload__upload__descriptor =
+{
+  PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
+  "neuron.upload.Upload",
+  "Upload",
+  "Neuron__Upload__Upload",
+  "neuron.upload",
+  sizeof(Neuron__Upload__Upload),
+  6,
+  neuron__upload__upload__field_descriptors,
+  neuron__upload__upload__field_indices_by_name,
+  1,  neuron__upload__upload__number_ranges,
+  (ProtobufCMessageInit) neuron__upload__upload__init,
+  NULL,NULL,NULL    /* reserved[123] */
+};
+static const ProtobufCFieldDescriptor neuron__upload__batch__field_descriptors[1] =
+{
+  {
+    "uploads",
+    1,
+    PROTOBUF_C_LABEL_REPEATED,
+    PROTOBUF_C_TYPE_MESSAGE,
+    offsetof(Neuron__Upload__Batch, n_uploads),
+    offsetof(Neuron__Upload__Batch, uploads),
+    &neuron__upload__upload__descriptor,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+};
+static const unsigned neuron__upload__batch__field_indices_by_name[] = {
+  0,   /* field[0] = uploads */
+};
+static const ProtobufCIntRange neuron__upload__batch__number_ranges[1 + 1] =
+{
+  { 1, 0 },
+  { 0, 1 }
+};
+const ProtobufCMessageDescriptor neuron__upload__batch__descriptor =
+{
+  PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
+  "neuron.upload.Batch",
+  "Batch",
+  "Neuron__Upload__Batch",
+  "neuron.upload",
+  sizeof(Neuron__Upload__Batch),
+  1,
+  neuron__upload__batch__field_descriptors,
+  neuron__upload__batch__field_indices_by_name,
+  1,  neuron__upload__batch__number_ranges,
+  (ProtobufCMessageInit) neuron__upload__batch__init,
+  NULL,NULL,NULL    /* reserved[123] */
+};
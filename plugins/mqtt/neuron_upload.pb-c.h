@@ -0,0 +1,502 @@
+/* Generated by the protocol buffer compiler.  DO NOT EDIT! */
+/* Generated from: neuron_upload.proto */
+
+#ifndef PROTOBUF_C_neuron_5fupload_2eproto__INCLUDED
+#define PROTOBUF_C_neuron_5fupload_2eproto__INCLUDED
+
+#include <protobuf-c/protobuf-c.h>
+
+PROTOBUF_C__BEGIN_DECLS
+
+#if PROTOBUF_C_VERSION_NUMBER < 1003000
+# error This file was generated by a newer version of protoc-c which is incompatible with your libprotobuf-c headers. Please update your headers.
+#elif 1004000 < PROTOBUF_C_MIN_COMPILER_VERSION
+# error This file was generated by an older version of protoc-c which is incompatible with your libprotobuf-c headers. Please regenerate this file with a newer version of protoc-c.
+#endif
+
+
+typedef struct Neuron__Upload__IntArray Neuron__Upload__IntArray;
+typedef struct Neuron__Upload__UintArray Neuron__Upload__UintArray;
+typedef struct Neuron__Upload__FloatArray Neuron__Upload__FloatArray;
+typedef struct Neuron__Upload__DoubleArray Neuron__Upload__DoubleArray;
+typedef struct Neuron__Upload__BoolArray Neuron__Upload__BoolArray;
+typedef struct Neuron__Upload__StringArray Neuron__Upload__StringArray;
+typedef struct Neuron__Upload__Value Neuron__Upload__Value;
+typedef struct Neuron__Upload__Meta Neuron__Upload__Meta;
+typedef struct Neuron__Upload__Tag Neuron__Upload__Tag;
+typedef struct Neuron__Upload__Upload Neuron__Upload__Upload;
+typedef struct Neuron__Upload__Batch Neuron__Upload__Batch;
+
+
+/* --- enums --- */
+
+
+/* --- messages --- */
+
+struct  Neuron__Upload__IntArray
+{
+  ProtobufCMessage base;
+  size_t n_values;
+  int64_t *values;
+};
+#define NEURON__UPLOAD__INT_ARRAY__INIT \
+ { PROTOBUF_C_MESSAGE_INIT (&neuron__upload__int_array__descriptor) \
+    , 0,NULL }
+
+
+struct  Neuron__Upload__UintArray
+{
+  ProtobufCMessage base;
+  size_t n_values;
+  uint64_t *values;
+};
+#define NEURON__UPLOAD__UINT_ARRAY__INIT \
+ { PROTOBUF_C_MESSAGE_INIT (&neuron__upload__uint_array__descriptor) \
+    , 0,NULL }
+
+
+struct  Neuron__Upload__FloatArray
+{
+  ProtobufCMessage base;
+  size_t n_values;
+  float *values;
+};
+#define NEURON__UPLOAD__FLOAT_ARRAY__INIT \
+ { PROTOBUF_C_MESSAGE_INIT (&neuron__upload__float_array__descriptor) \
+    , 0,NULL }
+
+
+struct  Neuron__Upload__DoubleArray
+{
+  ProtobufCMessage base;
+  size_t n_values;
+  double *values;
+};
+#define NEURON__UPLOAD__DOUBLE_ARRAY__INIT \
+ { PROTOBUF_C_MESSAGE_INIT (&neuron__upload__double_array__descriptor) \
+    , 0,NULL }
+
+
+struct  Neuron__Upload__BoolArray
+{
+  ProtobufCMessage base;
+  size_t n_values;
+  protobuf_c_boolean *values;
+};
+#define NEURON__UPLOAD__BOOL_ARRAY__INIT \
+ { PROTOBUF_C_MESSAGE_INIT (&neuron__upload__bool_array__descriptor) \
+    , 0,NULL }
+
+
+struct  Neuron__Upload__StringArray
+{
+  ProtobufCMessage base;
+  size_t n_values;
+  char **values;
+};
+#define NEURON__UPLOAD__STRING_ARRAY__INIT \
+ { PROTOBUF_C_MESSAGE_INIT (&neuron__upload__string_array__descriptor) \
+    , 0,NULL }
+
+
+typedef enum {
+  NEURON__UPLOAD__VALUE__VALUE__NOT_SET = 0,
+  NEURON__UPLOAD__VALUE__VALUE_INT_VALUE = 1,
+  NEURON__UPLOAD__VALUE__VALUE_UINT_VALUE = 2,
+  NEURON__UPLOAD__VALUE__VALUE_FLOAT_VALUE = 3,
+  NEURON__UPLOAD__VALUE__VALUE_DOUBLE_VALUE = 4,
+  NEURON__UPLOAD__VALUE__VALUE_BOOL_VALUE = 5,
+  NEURON__UPLOAD__VALUE__VALUE_STRING_VALUE = 6,
+  NEURON__UPLOAD__VALUE__VALUE_BYTES_VALUE = 7,
+  NEURON__UPLOAD__VALUE__VALUE_INT_ARRAY = 8,
+  NEURON__UPLOAD__VALUE__VALUE_UINT_ARRAY = 9,
+  NEURON__UPLOAD__VALUE__VALUE_FLOAT_ARRAY = 10,
+  NEURON__UPLOAD__VALUE__VALUE_DOUBLE_ARRAY = 11,
+  NEURON__UPLOAD__VALUE__VALUE_BOOL_ARRAY = 12,
+  NEURON__UPLOAD__VALUE__VALUE_STRING_ARRAY = 13,
+  NEURON__UPLOAD__VALUE__VALUE_JSON_VALUE = 14
+    PROTOBUF_C__FORCE_ENUM_TO_BE_INT_SIZE(NEURON__UPLOAD__VALUE__VALUE__CASE)
+} Neuron__Upload__Value__ValueCase;
+
+struct  Neuron__Upload__Value
+{
+  ProtobufCMessage base;
+  Neuron__Upload__Value__ValueCase value_case;
+  union {
+    /*
+     * INT8, INT16, INT32, INT64
+     */
+    int64_t int_value;
+    /*
+     * UINT8, UINT16, UINT32, UINT64, WORD, DWORD, LWORD, BIT
+     */
+    uint64_t uint_value;
+    float float_value;
+    double double_value;
+    protobuf_c_boolean bool_value;
+    /*
+     * STRING, TIME, DATA_AND_TIME, ARRAY_CHAR
+     */
+    char *string_value;
+    ProtobufCBinaryData bytes_value;
+    /*
+     * ARRAY_INT8, ARRAY_INT16, ARRAY_INT32, ARRAY_INT64
+     */
+    Neuron__Upload__IntArray *int_array;
+    /*
+     * ARRAY_UINT8, ARRAY_UINT16, ARRAY_UINT32, ARRAY_UINT64
+     */
+    Neuron__Upload__UintArray *uint_array;
+    Neuron__Upload__FloatArray *float_array;
+    Neuron__Upload__DoubleArray *double_array;
+    Neuron__Upload__BoolArray *bool_array;
+    Neuron__Upload__StringArray *string_array;
+    /*
+     * CUSTOM, compact JSON text
+     */
+    char *json_value;
+  };
+};
+#define NEURON__UPLOAD__VALUE__INIT \
+ { PROTOBUF_C_MESSAGE_INIT (&neuron__upload__value__descriptor) \
+    , NEURON__UPLOAD__VALUE__VALUE__NOT_SET, {0} }
+
+
+struct  Neuron__Upload__Meta
+{
+  ProtobufCMessage base;
+  char *name;
+  uint32_t type;
+  Neuron__Upload__Value *value;
+};
+#define NEURON__UPLOAD__META__INIT \
+ { PROTOBUF_C_MESSAGE_INIT (&neuron__upload__meta__descriptor) \
+    , (char *)protobuf_c_empty_string, 0, NULL }
+
+
+struct  Neuron__Upload__Tag
+{
+  ProtobufCMessage base;
+  char *name;
+  uint32_t type;
+  /*
+   * unset when type is ERROR (15)
+   */
+  Neuron__Upload__Value *value;
+  /*
+   * neuron error code when type is ERROR
+   */
+  int32_t error;
+  size_t n_metas;
+  Neuron__Upload__Meta **metas;
+};
+#define NEURON__UPLOAD__TAG__INIT \
+ { PROTOBUF_C_MESSAGE_INIT (&neuron__upload__tag__descriptor) \
+    , (char *)protobuf_c_empty_string, 0, NULL, 0, 0,NULL }
+
+
+struct  Neuron__Upload__Upload
+{
+  ProtobufCMessage base;
+  char *node;
+  char *group;
+  /*
+   * milliseconds since the epoch
+   */
+  uint64_t timestamp;
+  size_t n_tags;
+  Neuron__Upload__Tag **tags;
+  /*
+   * delta mode of the subscription only: the upload number from 1 per
+   * subscription, and whether the upload carries all tags of the group
+   * instead of those changed since the previous upload
+   */
+  uint64_t seq;
+  protobuf_c_boolean keyframe;
+};
+#define NEURON__UPLOAD__UPLOAD__INIT \
+ { PROTOBUF_C_MESSAGE_INIT (&neuron__upload__upload__descriptor) \
+    , (char *)protobuf_c_empty_string, (char *)protobuf_c_empty_string, 0, 0,NULL, 0, 0 }
+
+
+/*
+ * Published instead of Upload when upload batching is enabled, with the
+ * reports bound for the same topic in arrival order.
+ */
+struct  Neuron__Upload__Batch
+{
+  ProtobufCMessage base;
+  size_t n_uploads;
+  Neuron__Upload__Upload **uploads;
+};
+#define NEURON__UPLOAD__BATCH__INIT \
+ { PROTOBUF_C_MESSAGE_INIT (&neuron__upload__batch__descriptor) \
+    , 0,NULL }
+
+
+/* Neuron__Upload__IntArray methods */
+void   neuron__upload__int_array__init
+                     (Neuron__Upload__IntArray         *message);
+size_t neuron__upload__int_array__get_packed_size
+                     (const Neuron__Upload__IntArray   *message);
+size_t neuron__upload__int_array__pack
+                     (const Neuron__Upload__IntArray   *message,
+                      uint8_t             *out);
+size_t neuron__upload__int_array__pack_to_buffer
+                     (const Neuron__Upload__IntArray   *message,
+                      ProtobufCBuffer     *buffer);
+Neuron__Upload__IntArray *
+       neuron__upload__int_array__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data);
+void   neuron__upload__int_array__free_unpacked
+                     (Neuron__Upload__IntArray *message,
+                      ProtobufCAllocator *allocator);
+/* Neuron__Upload__UintArray methods */
+void   neuron__upload__uint_array__init
+                     (Neuron__Upload__UintArray         *message);
+size_t neuron__upload__uint_array__get_packed_size
+                     (const Neuron__Upload__UintArray   *message);
+size_t neuron__upload__uint_array__pack
+                     (const Neuron__Upload__UintArray   *message,
+                      uint8_t             *out);
+size_t neuron__upload__uint_array__pack_to_buffer
+                     (const Neuron__Upload__UintArray   *message,
+                      ProtobufCBuffer     *buffer);
+Neuron__Upload__UintArray *
+       neuron__upload__uint_array__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data);
+void   neuron__upload__uint_array__free_unpacked
+                     (Neuron__Upload__UintArray *message,
+                      ProtobufCAllocator *allocator);
+/* Neuron__Upload__FloatArray methods */
+void   neuron__upload__float_array__init
+                     (Neuron__Upload__FloatArray         *message);
+size_t neuron__upload__float_array__get_packed_size
+                     (const Neuron__Upload__FloatArray   *message);
+size_t neuron__upload__float_array__pack
+                     (const Neuron__Upload__FloatArray   *message,
+                      uint8_t             *out);
+size_t neuron__upload__float_array__pack_to_buffer
+                     (const Neuron__Upload__FloatArray   *message,
+                      ProtobufCBuffer     *buffer);
+Neuron__Upload__FloatArray *
+       neuron__upload__float_array__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data);
+void   neuron__upload__float_array__free_unpacked
+                     (Neuron__Upload__FloatArray *message,
+                      ProtobufCAllocator *allocator);
+/* Neuron__Upload__DoubleArray methods */
+void   neuron__upload__double_array__init
+                     (Neuron__Upload__DoubleArray         *message);
+size_t neuron__upload__double_array__get_packed_size
+                     (const Neuron__Upload__DoubleArray   *message);
+size_t neuron__upload__double_array__pack
+                     (const Neuron__Upload__DoubleArray   *message,
+                      uint8_t             *out);
+size_t neuron__upload__double_array__pack_to_buffer
+                     (const Neuron__Upload__DoubleArray   *message,
+                      ProtobufCBuffer     *buffer);
+Neuron__Upload__DoubleArray *
+       neuron__upload__double_array__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data);
+void   neuron__upload__double_array__free_unpacked
+                     (Neuron__Upload__DoubleArray *message,
+                      ProtobufCAllocator *allocator);
+/* Neuron__Upload__BoolArray methods */
+void   neuron__upload__bool_array__init
+                     (Neuron__Upload__BoolArray         *message);
+size_t neuron__upload__bool_array__get_packed_size
+                     (const Neuron__Upload__BoolArray   *message);
+size_t neuron__upload__bool_array__pack
+                     (const Neuron__Upload__BoolArray   *message,
+                      uint8_t             *out);
+size_t neuron__upload__bool_array__pack_to_buffer
+                     (const Neuron__Upload__BoolArray   *message,
+                      ProtobufCBuffer     *buffer);
+Neuron__Upload__BoolArray *
+       neuron__upload__bool_array__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data);
+void   neuron__upload__bool_array__free_unpacked
+                     (Neuron__Upload__BoolArray *message,
+                      ProtobufCAllocator *allocator);
+/* Neuron__Upload__StringArray methods */
+void   neuron__upload__string_array__init
+                     (Neuron__Upload__StringArray         *message);
+size_t neuron__upload__string_array__get_packed_size
+                     (const Neuron__Upload__StringArray   *message);
+size_t neuron__upload__string_array__pack
+                     (const Neuron__Upload__StringArray   *message,
+                      uint8_t             *out);
+size_t neuron__upload__string_array__pack_to_buffer
+                     (const Neuron__Upload__StringArray   *message,
+                      ProtobufCBuffer     *buffer);
+Neuron__Upload__StringArray *
+       neuron__upload__string_array__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data);
+void   neuron__upload__string_array__free_unpacked
+                     (Neuron__Upload__StringArray *message,
+                      ProtobufCAllocator *allocator);
+/* Neuron__Upload__Value methods */
+void   neuron__upload__value__init
+                     (Neuron__Upload__Value         *message);
+size_t neuron__upload__value__get_packed_size
+                     (const Neuron__Upload__Value   *message);
+size_t neuron__upload__value__pack
+                     (const Neuron__Upload__Value   *message,
+                      uint8_t             *out);
+size_t neuron__upload__value__pack_to_buffer
+                     (const Neuron__Upload__Value   *message,
+                      ProtobufCBuffer     *buffer);
+Neuron__Upload__Value *
+       neuron__upload__value__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data);
+void   neuron__upload__value__free_unpacked
+                     (Neuron__Upload__Value *message,
+                      ProtobufCAllocator *allocator);
+/* Neuron__Upload__Meta methods */
+void   neuron__upload__meta__init
+                     (Neuron__Upload__Meta         *message);
+size_t neuron__upload__meta__get_packed_size
+                     (const Neuron__Upload__Meta   *message);
+size_t neuron__upload__meta__pack
+                     (const Neuron__Upload__Meta   *message,
+                      uint8_t             *out);
+size_t neuron__upload__meta__pack_to_buffer
+                     (const Neuron__Upload__Meta   *message,
+                      ProtobufCBuffer     *buffer);
+Neuron__Upload__Meta *
+       neuron__upload__meta__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data);
+void   neuron__upload__meta__free_unpacked
+                     (Neuron__Upload__Meta *message,
+                      ProtobufCAllocator *allocator);
+/* Neuron__Upload__Tag methods */
+void   neuron__upload__tag__init
+                     (Neuron__Upload__Tag         *message);
+size_t neuron__upload__tag__get_packed_size
+                     (const Neuron__Upload__Tag   *message);
+size_t neuron__upload__tag__pack
+                     (const Neuron__Upload__Tag   *message,
+                      uint8_t             *out);
+size_t neuron__upload__tag__pack_to_buffer
+                     (const Neuron__Upload__Tag   *message,
+                      ProtobufCBuffer     *buffer);
+Neuron__Upload__Tag *
+       neuron__upload__tag__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data);
+void   neuron__upload__tag__free_unpacked
+                     (Neuron__Upload__Tag *message,
+                      ProtobufCAllocator *allocator);
+/* Neuron__Upload__Upload methods */
+void   neuron__upload__upload__init
+                     (Neuron__Upload__Upload         *message);
+size_t neuron__upload__upload__get_packed_size
+                     (const Neuron__Upload__Upload   *message);
+size_t neuron__upload__upload__pack
+                     (const Neuron__Upload__Upload   *message,
+                      uint8_t             *out);
+size_t neuron__upload__upload__pack_to_buffer
+                     (const Neuron__Upload__Upload   *message,
+                      ProtobufCBuffer     *buffer);
+Neuron__Upload__Upload *
+       neuron__upload__upload__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data);
+void   neuron__upload__upload__free_unpacked
+                     (Neuron__Upload__Upload *message,
+                      ProtobufCAllocator *allocator);
+/* Neuron__Upload__Batch methods */
+void   neuron__upload__batch__init
+                     (Neuron__Upload__Batch         *message);
+size_t neuron__upload__batch__get_packed_size
+                     (const Neuron__Upload__Batch   *message);
+size_t neuron__upload__batch__pack
+                     (const Neuron__Upload__Batch   *message,
+                      uint8_t             *out);
+size_t neuron__upload__batch__pack_to_buffer
+                     (const Neuron__Upload__Batch   *message,
+                      ProtobufCBuffer     *buffer);
+Neuron__Upload__Batch *
+       neuron__upload__batch__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data);
+void   neuron__upload__batch__free_unpacked
+                     (Neuron__Upload__Batch *message,
+                      ProtobufCAllocator *allocator);
+/* --- per-message closures --- */
+
+typedef void (*Neuron__Upload__IntArray_Closure)
+                 (const Neuron__Upload__IntArray *message,
+                  void *closure_data);
+typedef void (*Neuron__Upload__UintArray_Closure)
+                 (const Neuron__Upload__UintArray *message,
+                  void *closure_data);
+typedef void (*Neuron__Upload__FloatArray_Closure)
+                 (const Neuron__Upload__FloatArray *message,
+                  void *closure_data);
+typedef void (*Neuron__Upload__DoubleArray_Closure)
+                 (const Neuron__Upload__DoubleArray *message,
+                  void *closure_data);
+typedef void (*Neuron__Upload__BoolArray_Closure)
+                 (const Neuron__Upload__BoolArray *message,
+                  void *closure_data);
+typedef void (*Neuron__Upload__StringArray_Closure)
+                 (const Neuron__Upload__StringArray *message,
+                  void *closure_data);
+typedef void (*Neuron__Upload__Value_Closure)
+                 (const Neuron__Upload__Value *message,
+                  void *closure_data);
+typedef void (*Neuron__Upload__Meta_Closure)
+                 (const Neuron__Upload__Meta *message,
+                  void *closure_data);
+typedef void (*Neuron__Upload__Tag_Closure)
+                 (const Neuron__Upload__Tag *message,
+                  void *closure_data);
+typedef void (*Neuron__Upload__Upload_Closure)
+                 (const Neuron__Upload__Upload *message,
+                  void *closure_data);
+typedef void (*Neuron__Upload__Batch_Closure)
+                 (const Neuron__Upload__Batch *message,
+                  void *closure_data);
+
+/* --- services --- */
+
+
+/* --- descriptors --- */
+
+extern const ProtobufCMessageDescriptor neuron__upload__int_array__descriptor;
+extern const ProtobufCMessageDescriptor neuron__upload__uint_array__descriptor;
+extern const ProtobufCMessageDescriptor neuron__upload__float_array__descriptor;
+extern const ProtobufCMessageDescriptor neuron__upload__double_array__descriptor;
+extern const ProtobufCMessageDescriptor neuron__upload__bool_array__descriptor;
+extern const ProtobufCMessageDescriptor neuron__upload__string_array__descriptor;
+extern const ProtobufCMessageDescriptor neuron__upload__value__descriptor;
+extern const ProtobufCMessageDescriptor neuron__upload__meta__descriptor;
+extern const ProtobufCMessageDescriptor neuron__upload__tag__descriptor;
+extern const ProtobufCMessageDescriptor neuron__upload__upload__descriptor;
+extern const ProtobufCMessageDescriptor neuron__upload__batch__descriptor;
+
+PROTOBUF_C__END_DECLS
+
+
+#endif  /* PROTOBUF_C_neuron_5fupload_2eproto__INCLUDED */
@@ -173,6 +173,10 @@ void handle_get_adapter(nng_aio *aio)
         strcpy(cmd.node, node_name);
     }
 
+    if (neu_rest_not_modified(aio, NULL, NULL)) {
+        return;
+    }
+
     cmd.type = node_type;
     ret      = neu_plugin_op(plugin, header, &cmd);
     if (ret != 0) {
@@ -255,6 +259,10 @@ void handle_get_node_setting(nng_aio *aio)
         return;
     }
 
+    if (neu_rest_not_modified(aio, node_name, NULL)) {
+        return;
+    }
+
     header.ctx             = aio;
     header.type            = NEU_REQ_GET_NODE_SETTING;
     header.otel_trace_type = NEU_OTEL_TRACE_TYPE_REST_COMM;
@@ -382,6 +382,10 @@ void handle_get_tags(nng_aio *aio)
         return;
     }
 
+    if (neu_rest_not_modified(aio, node, group)) {
+        return;
+    }
+
     if (neu_http_get_param_str(aio, "name", tag_name, sizeof(tag_name)) >= 0) {
         strcpy(cmd.name, tag_name);
     }
@@ -397,34 +401,59 @@ void handle_get_tags(nng_aio *aio)
     }
 }
 
-void handle_get_tags_resp(nng_aio *aio, neu_resp_get_tag_t *tags)
+int handle_encode_tags(neu_http_chunked_t *chunked, UT_array *tags)
 {
-    neu_json_get_tags_resp_t tags_res = { 0 };
-    char *                   result   = NULL;
+    const char *sep = "";
 
-    tags_res.n_tag = utarray_len(tags->tags);
-    tags_res.tags  = calloc(tags_res.n_tag, sizeof(neu_json_tag_t));
+    if (0 != neu_http_chunked_puts(chunked, "[")) {
+        return -1;
+    }
 
-    utarray_foreach(tags->tags, neu_datatag_t *, tag)
+    utarray_foreach(tags, neu_datatag_t *, tag)
     {
-        int index = utarray_eltidx(tags->tags, tag);
-
-        tags_res.tags[index].name        = tag->name;
-        tags_res.tags[index].address     = tag->address;
-        tags_res.tags[index].description = tag->description;
-        tags_res.tags[index].type        = tag->type;
-        tags_res.tags[index].attribute   = tag->attribute;
-        tags_res.tags[index].precision   = tag->precision;
-        tags_res.tags[index].decimal     = tag->decimal;
-        tags_res.tags[index].bias        = tag->bias;
-        tags_res.tags[index].t           = NEU_JSON_UNDEFINE;
+        char *         result = NULL;
+        int            rv     = 0;
+        neu_json_tag_t jtag   = {
+            .name        = tag->name,
+            .address     = tag->address,
+            .description = tag->description,
+            .type        = tag->type,
+            .attribute   = tag->attribute,
+            .precision   = tag->precision,
+            .decimal     = tag->decimal,
+            .bias        = tag->bias,
+            .t           = NEU_JSON_UNDEFINE,
+        };
+
+        if (0 != neu_json_encode_by_fn(&jtag, neu_json_encode_tag, &result)) {
+            return -1;
+        }
+        neu_http_chunked_puts(chunked, sep);
+        rv = neu_http_chunked_puts(chunked, result);
+        free(result);
+        if (0 != rv) {
+            return -1;
+        }
+        sep = ", ";
     }
 
-    neu_json_encode_by_fn(&tags_res, neu_json_encode_get_tags_resp, &result);
+    return neu_http_chunked_puts(chunked, "]");
+}
 
-    neu_http_ok(aio, result);
+void handle_get_tags_resp(nng_aio *aio, neu_resp_get_tag_t *tags)
+{
+    neu_http_chunked_t *chunked = neu_http_chunked_new(aio, "application/json");
+
+    // the same body as neu_json_encode_get_tags_resp, one tag at a time
+    if (NULL != chunked && 0 == neu_http_chunked_puts(chunked, "{\"tags\": ") &&
+        0 == handle_encode_tags(chunked, tags->tags) &&
+        0 == neu_http_chunked_puts(chunked, "}")) {
+        neu_http_chunked_end(chunked);
+    } else if (!neu_http_chunked_abort(chunked)) {
+        NEU_JSON_RESPONSE_ERROR(NEU_ERR_EINTERNAL, {
+            neu_http_response(aio, NEU_ERR_EINTERNAL, result_error);
+        });
+    }
 
-    free(result);
-    free(tags_res.tags);
     utarray_free(tags->tags);
 }
\ No newline at end of file
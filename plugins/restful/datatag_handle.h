@@ -23,6 +23,7 @@
 #include <nng/nng.h>
 
 #include "adapter.h"
+#include "utils/http.h"
 
 void handle_add_tags(nng_aio *aio);
 void handle_add_tags_resp(nng_aio *aio, neu_resp_add_tag_t *resp);
@@ -34,4 +35,7 @@ void handle_update_tags_resp(nng_aio *aio, neu_resp_update_tag_t *resp);
 void handle_get_tags(nng_aio *aio);
 void handle_get_tags_resp(nng_aio *aio, neu_resp_get_tag_t *tags);
 
+// writes the tags as the json array of neu_json_encode_tag_array
+int handle_encode_tags(neu_http_chunked_t *chunked, UT_array *tags);
+
 #endif
\ No newline at end of file
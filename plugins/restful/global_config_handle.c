@@ -38,6 +38,7 @@
 #include "utils/set.h"
 #include "utils/utarray.h"
 
+#include "datatag_handle.h"
 #include "group_config_handle.h"
 
 typedef enum {
@@ -81,6 +82,8 @@ typedef struct {
             neu_json_driver_array_t jdrivers; // get drivers
             char *                  names;    //
             neu_strset_t            filter;   //
+            neu_http_chunked_t *    chunked;  // get global, from the tags on
+            int                     n_gtag;   //
         };
         // put
         struct {
@@ -100,6 +103,7 @@ static int get_driver_groups_resp(context_t *                  ctx,
                                   neu_resp_get_driver_group_t *groups);
 static int get_tags(context_t *ctx, neu_resp_driver_group_info_t *info);
 static int get_tags_resp(context_t *ctx, neu_resp_get_tag_t *tags);
+static int get_global_tail(context_t *ctx);
 static int get_driver_tags_resp(context_t *ctx, neu_resp_get_tag_t *tags);
 static int get_subscriptions(context_t *ctx, neu_resp_node_info_t *info);
 static int get_subscriptions_resp(context_t *                     ctx,
@@ -206,8 +210,6 @@ static void context_free(context_t *ctx)
 static void get_global_context_next(context_t *ctx, neu_reqresp_type_e type,
                                     void *data)
 {
-    char *result = NULL;
-
     switch (ctx->state) {
     case STATE_START:
         NEXT(ctx, get_nodes, NEU_NA_TYPE_APP);
@@ -289,16 +291,22 @@ static void get_global_context_next(context_t *ctx, neu_reqresp_type_e type,
     }
 
     if (STATE_END == ctx->state) {
-        if (ctx->error) {
-            NEU_JSON_RESPONSE_ERROR(ctx->error, {
-                neu_http_response(ctx->aio, ctx->error, result_error);
-            });
-        } else {
-            neu_json_encode(ctx->json, &result);
-            neu_http_ok(ctx->aio, result);
-            free(result);
+        nng_aio *           aio     = ctx->aio;
+        neu_http_chunked_t *chunked = ctx->chunked;
+        int                 error   = ctx->error;
+
+        if (0 == error && 0 != get_global_tail(ctx)) {
+            error = NEU_ERR_EINTERNAL;
         }
         context_free(ctx);
+
+        if (0 == error) {
+            neu_http_chunked_end(chunked);
+        } else if (!neu_http_chunked_abort(chunked)) {
+            NEU_JSON_RESPONSE_ERROR(error, {
+                neu_http_response(aio, error, result_error);
+            });
+        }
     }
 }
 
@@ -783,73 +791,89 @@ static int get_tags(context_t *ctx, neu_resp_driver_group_info_t *info)
     return rv;
 }
 
-static int get_tags_resp(context_t *ctx, neu_resp_get_tag_t *tags)
+/*
+ * The `tags` array is the bulk of the global config, so it is not kept in
+ * ctx->json but written out group by group. The members before it are written
+ * with the first group, and the ones after it by get_global_tail, with the
+ * same bytes as encoding the whole object at once.
+ */
+static int get_global_head(context_t *ctx)
 {
-    int                      rv       = 0;
-    neu_json_get_tags_resp_t tags_res = { 0 };
-    json_t *                 tag_obj  = NULL;
-    void *                   tag_arr  = NULL;
-
-    // allocate `tags` array if none
-    if (NULL == (tag_arr = json_object_get(ctx->json, "tags")) &&
-        (NULL == (tag_arr = json_array()) ||
-         // tag array ownership moved
-         0 != json_object_set_new(ctx->json, "tags", tag_arr))) {
-        rv = NEU_ERR_EINTERNAL;
-        goto end;
+    char *head = NULL;
+    int   rv   = 0;
+
+    ctx->chunked = neu_http_chunked_new(ctx->aio, "application/json");
+    if (NULL == ctx->chunked || 0 != neu_json_encode(ctx->json, &head)) {
+        return NEU_ERR_EINTERNAL;
     }
 
-    if (NULL == tags || 0 == utarray_len(tags->tags)) {
-        // empty tags array, all done
-        goto end;
+    // without the closing brace
+    neu_http_chunked_write(ctx->chunked, head, strlen(head) - 1);
+    neu_http_chunked_puts(ctx->chunked, strlen(head) > 2 ? ", " : "");
+    rv = neu_http_chunked_puts(ctx->chunked, "\"tags\": [");
+    free(head);
+
+    json_object_clear(ctx->json);
+    return 0 == rv ? 0 : NEU_ERR_EINTERNAL;
+}
+
+static int get_global_tail(context_t *ctx)
+{
+    char *tail = NULL;
+    int   rv   = 0;
+
+    if (NULL == ctx->chunked || 0 != neu_json_encode(ctx->json, &tail)) {
+        return NEU_ERR_EINTERNAL;
     }
 
-    tags_res.n_tag = utarray_len(tags->tags);
-    tags_res.tags  = calloc(tags_res.n_tag, sizeof(neu_json_tag_t));
-    if (NULL == tags_res.tags) {
-        rv = NEU_ERR_EINTERNAL;
+    // without the opening brace
+    neu_http_chunked_puts(ctx->chunked, "]");
+    neu_http_chunked_puts(ctx->chunked, strlen(tail) > 2 ? ", " : "");
+    rv = neu_http_chunked_puts(ctx->chunked, tail + 1);
+    free(tail);
+
+    return 0 == rv ? 0 : NEU_ERR_EINTERNAL;
+}
+
+static int get_tags_resp(context_t *ctx, neu_resp_get_tag_t *tags)
+{
+    int     rv     = 0;
+    json_t *gr_obj = NULL;
+    char *  gr_str = NULL;
+
+    if (NULL == ctx->chunked && 0 != (rv = get_global_head(ctx))) {
         goto end;
     }
 
-    utarray_foreach(tags->tags, neu_datatag_t *, tag)
-    {
-        int index = utarray_eltidx(tags->tags, tag);
-
-        tags_res.tags[index].name        = tag->name;
-        tags_res.tags[index].address     = tag->address;
-        tags_res.tags[index].description = tag->description;
-        tags_res.tags[index].type        = tag->type;
-        tags_res.tags[index].attribute   = tag->attribute;
-        tags_res.tags[index].precision   = tag->precision;
-        tags_res.tags[index].decimal     = tag->decimal;
-        tags_res.tags[index].bias        = tag->bias;
-        tags_res.tags[index].t           = NEU_JSON_UNDEFINE;
-    }
-
-    // accumulate tag object in `tags` array
-    if (NULL == (tag_obj = json_object()) ||
-        // tag object ownership moved
-        0 != json_array_append_new(tag_arr, tag_obj)) {
-        rv = NEU_ERR_EINTERNAL;
+    if (NULL == tags || 0 == utarray_len(tags->tags)) {
+        // empty tags array, all done
         goto end;
     }
 
-    // encode `tags` data
-    if (0 != neu_json_encode_get_tags_resp(tag_obj, &tags_res)) {
+    // encode `driver` and `group`
+    neu_resp_driver_group_info_t *info = ctx->iter;
+    if (NULL == (gr_obj = json_object()) ||
+        0 != json_object_set_new(gr_obj, "driver", json_string(info->driver)) ||
+        0 != json_object_set_new(gr_obj, "group", json_string(info->group)) ||
+        0 != neu_json_encode(gr_obj, &gr_str)) {
         rv = NEU_ERR_EINTERNAL;
         goto end;
     }
 
-    neu_resp_driver_group_info_t *info = ctx->iter;
-    // encode `driver` and `group`
-    if (0 !=
-            json_object_set_new(tag_obj, "driver", json_string(info->driver)) ||
-        0 != json_object_set_new(tag_obj, "group", json_string(info->group))) {
+    // {"tags": [...], "driver": "", "group": ""}
+    neu_http_chunked_puts(ctx->chunked, ctx->n_gtag++ > 0 ? ", " : "");
+    neu_http_chunked_puts(ctx->chunked, "{\"tags\": ");
+    if (0 != handle_encode_tags(ctx->chunked, tags->tags) ||
+        0 != neu_http_chunked_puts(ctx->chunked, ", ") ||
+        0 != neu_http_chunked_puts(ctx->chunked, gr_str + 1)) {
         rv = NEU_ERR_EINTERNAL;
     }
 
 end:
-    free(tags_res.tags);
+    if (gr_obj) {
+        json_decref(gr_obj);
+    }
+    free(gr_str);
     if (tags && tags->tags) {
         utarray_free(tags->tags);
     }
@@ -1248,6 +1272,10 @@ void handle_get_global_config(nng_aio *aio)
 {
     NEU_VALIDATE_JWT(aio);
 
+    if (neu_rest_not_modified(aio, NULL, NULL)) {
+        return;
+    }
+
     context_t *ctx = context_new(aio, GET_GLOBAL);
     if (NULL == ctx) {
         NEU_JSON_RESPONSE_ERROR(NEU_ERR_EINTERNAL, {
@@ -178,6 +178,11 @@ void handle_get_group_config(nng_aio *aio)
         header.type = NEU_REQ_GET_DRIVER_GROUP;
     }
 
+    if (neu_rest_not_modified(aio, strlen(cmd.driver) ? cmd.driver : NULL,
+                              NULL)) {
+        return;
+    }
+
     ret = neu_plugin_op(plugin, header, &cmd);
     if (ret != 0) {
         NEU_JSON_RESPONSE_ERROR(NEU_ERR_IS_BUSY, {
@@ -446,6 +451,11 @@ void handle_grp_get_subscribe(nng_aio *aio)
         return;
     }
 
+    // driver and group renames change the subscriptions of the apps too
+    if (neu_rest_not_modified(aio, NULL, NULL)) {
+        return;
+    }
+
     ret = neu_plugin_op(plugin, header, &cmd);
     if (ret != 0) {
         NEU_JSON_RESPONSE_ERROR(NEU_ERR_IS_BUSY, {
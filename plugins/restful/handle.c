@@ -16,12 +16,15 @@
  * along with this program; if not, write to the Free Software Foundation,
  * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
  **/
+#include <inttypes.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 
 #include <nng/nng.h>
 #include <nng/supplemental/http/http.h>
 
+#include "base/config_gen.h"
 #include "plugin.h"
 
 #include "adapter_handle.h"
@@ -36,6 +39,7 @@
 #include "plugin_handle.h"
 #include "rw_handle.h"
 #include "scan_handle.h"
+#include "stream_handle.h"
 #include "system_handle.h"
 #include "utils/http.h"
 #include "version_handle.h"
@@ -79,6 +83,12 @@ static struct neu_http_handler cors_handler[] = {
     {
         .url = "/api/v2/read/paginate",
     },
+    {
+        .url = "/api/v2/read/groups",
+    },
+    {
+        .url = "/api/v2/read/stream",
+    },
     {
         .url = "/api/v2/read/test",
     },
@@ -174,6 +184,7 @@ static struct neu_http_handler rest_handlers[] = {
         .type          = NEU_HTTP_HANDLER_FUNCTION,
         .url           = "/api/v2/ping",
         .value.handler = handle_ping,
+        .cls           = NEU_HTTP_CLASS_LIGHT,
     },
     {
         .method        = NEU_HTTP_METHOD_POST,
@@ -302,6 +313,19 @@ static struct neu_http_handler rest_handlers[] = {
         .url           = "/api/v2/read/paginate",
         .value.handler = handle_read_paginate,
     },
+    {
+        .method        = NEU_HTTP_METHOD_POST,
+        .type          = NEU_HTTP_HANDLER_FUNCTION,
+        .url           = "/api/v2/read/groups",
+        .value.handler = handle_read_groups,
+        .cls           = NEU_HTTP_CLASS_HEAVY,
+    },
+    {
+        .method        = NEU_HTTP_METHOD_GET,
+        .type          = NEU_HTTP_HANDLER_FUNCTION,
+        .url           = "/api/v2/read/stream",
+        .value.handler = handle_read_stream,
+    },
     {
         .method        = NEU_HTTP_METHOD_POST,
         .type          = NEU_HTTP_HANDLER_FUNCTION,
@@ -385,6 +409,7 @@ static struct neu_http_handler rest_handlers[] = {
         .type          = NEU_HTTP_HANDLER_FUNCTION,
         .url           = "/api/v2/node/state",
         .value.handler = handle_get_node_state,
+        .cls           = NEU_HTTP_CLASS_LIGHT,
     },
     {
         .method        = NEU_HTTP_METHOD_PUT,
@@ -403,54 +428,63 @@ static struct neu_http_handler rest_handlers[] = {
         .type          = NEU_HTTP_HANDLER_FUNCTION,
         .url           = "/api/v2/log/file",
         .value.handler = handle_log_file,
+        .cls           = NEU_HTTP_CLASS_HEAVY,
     },
     {
         .method        = NEU_HTTP_METHOD_GET,
         .type          = NEU_HTTP_HANDLER_FUNCTION,
         .url           = "/api/v2/version",
         .value.handler = handle_get_version,
+        .cls           = NEU_HTTP_CLASS_LIGHT,
     },
     {
         .method        = NEU_HTTP_METHOD_GET,
         .type          = NEU_HTTP_HANDLER_FUNCTION,
         .url           = "/api/v2/global/config",
         .value.handler = handle_get_global_config,
+        .cls           = NEU_HTTP_CLASS_HEAVY,
     },
     {
         .method        = NEU_HTTP_METHOD_PUT,
         .type          = NEU_HTTP_HANDLER_FUNCTION,
         .url           = "/api/v2/global/config",
         .value.handler = handle_put_global_config,
+        .cls           = NEU_HTTP_CLASS_HEAVY,
     },
     {
         .method        = NEU_HTTP_METHOD_PUT,
         .type          = NEU_HTTP_HANDLER_FUNCTION,
         .url           = "/api/v2/global/drivers",
         .value.handler = handle_put_drivers,
+        .cls           = NEU_HTTP_CLASS_HEAVY,
     },
     {
         .method        = NEU_HTTP_METHOD_GET,
         .type          = NEU_HTTP_HANDLER_FUNCTION,
         .url           = "/api/v2/global/drivers",
         .value.handler = handle_get_drivers,
+        .cls           = NEU_HTTP_CLASS_HEAVY,
     },
     {
         .method        = NEU_HTTP_METHOD_GET,
         .type          = NEU_HTTP_HANDLER_FUNCTION,
         .url           = "/api/v2/metrics",
         .value.handler = handle_get_metric,
+        .cls           = NEU_HTTP_CLASS_LIGHT,
     },
     {
         .method        = NEU_HTTP_METHOD_POST,
         .type          = NEU_HTTP_HANDLER_FUNCTION,
         .url           = "/api/v2/scan/tags",
         .value.handler = handle_scan_tags,
+        .cls           = NEU_HTTP_CLASS_HEAVY,
     },
     {
         .method        = NEU_HTTP_METHOD_GET,
         .type          = NEU_HTTP_HANDLER_FUNCTION,
         .url           = "/api/v2/status",
         .value.handler = handle_status,
+        .cls           = NEU_HTTP_CLASS_LIGHT,
     },
     {
         .method        = NEU_HTTP_METHOD_POST,
@@ -512,6 +546,7 @@ void neu_rest_api_cors_handler(const struct neu_http_handler **handlers,
         cors_handler[i].method        = NEU_HTTP_METHOD_OPTIONS;
         cors_handler[i].type          = NEU_HTTP_HANDLER_FUNCTION;
         cors_handler[i].value.handler = neu_http_handle_cors;
+        cors_handler[i].cls           = NEU_HTTP_CLASS_LIGHT;
     }
 }
 
@@ -532,3 +567,13 @@ void *neu_rest_get_plugin()
 {
     return rest_ctx->plugin;
 }
+
+bool neu_rest_not_modified(nng_aio *aio, const char *node, const char *group)
+{
+    char etag[48] = { 0 };
+
+    // weak, as a gzip encoded body shares it
+    snprintf(etag, sizeof(etag), "W/\"%" PRIx64 "-%" PRIx64 "\"",
+             neu_config_gen_epoch(), neu_config_gen(node, group));
+    return neu_http_check_etag(aio, etag);
+}
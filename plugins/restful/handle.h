@@ -20,6 +20,7 @@
 #ifndef _NEU_PLUGIN_REST_HANDLE_H_
 #define _NEU_PLUGIN_REST_HANDLE_H_
 
+#include <stdbool.h>
 #include <stdlib.h>
 
 #include "plugin.h"
@@ -31,6 +32,10 @@ neu_rest_handle_ctx_t *neu_rest_init_ctx(void *plugin);
 void                   neu_rest_free_ctx(neu_rest_handle_ctx_t *ctx);
 void *                 neu_rest_get_plugin();
 
+// tags the response with the configuration generation of `node` and `group`,
+// see base/config_gen.h, returns true if it is answered with 304 Not Modified
+bool neu_rest_not_modified(nng_aio *aio, const char *node, const char *group);
+
 void neu_rest_handler(const struct neu_http_handler **handlers, uint32_t *size);
 void neu_rest_api_cors_handler(const struct neu_http_handler **handlers,
                                uint32_t *                      size);
@@ -176,7 +176,7 @@ static int response(nng_aio *aio, char *content, enum nng_http_status status)
                 nng_http_req_get_uri(nng_req), status);
 
     nng_aio_set_output(aio, 0, res);
-    nng_aio_finish(aio, 0);
+    neu_http_finish(aio);
 
     return 0;
 }
@@ -18,6 +18,7 @@
  **/
 
 #include <stdio.h>
+#include <stdlib.h>
 
 #include <pthread.h>
 
@@ -28,6 +29,7 @@
 #include "utils/http.h"
 #include "utils/http_handler.h"
 #include "utils/log.h"
+#include "utils/utarray.h"
 
 #include "metric_handle.h"
 
@@ -122,7 +124,7 @@ static int response(nng_aio *aio, char *content, enum nng_http_status status)
               nng_http_req_get_uri(nng_req), status);
 
     nng_aio_set_output(aio, 0, res);
-    nng_aio_finish(aio, 0);
+    neu_http_finish(aio);
 
     return 0;
 }
@@ -151,192 +153,302 @@ static inline bool parse_metrics_catgory(const char *s, size_t len,
     return false;
 }
 
-static inline void gen_global_metrics(const neu_metrics_t *metrics,
-                                      FILE *               stream)
+static void copy_global_metrics(const neu_metrics_t *metrics,
+                                neu_metrics_t *      copy)
 {
-    fprintf(stream, METRIC_GLOBAL_TMPL, metrics->distro, metrics->kernel,
-            metrics->machine, metrics->clib, metrics->clib_version,
-            metrics->cpu_percent, metrics->cpu_cores, metrics->mem_total_bytes,
-            metrics->mem_used_bytes, metrics->mem_cache_bytes,
-            metrics->mem_used_bytes, metrics->disk_size_gibibytes,
-            metrics->disk_used_gibibytes, metrics->disk_avail_gibibytes,
-            metrics->core_dumped, metrics->uptime_seconds,
-            metrics->license_max_tags, metrics->license_used_tags,
-            metrics->north_nodes, metrics->north_running_nodes,
-            metrics->north_disconnected_nodes, metrics->south_nodes,
-            metrics->south_running_nodes, metrics->south_disconnected_nodes);
+    *copy = *metrics;
 }
 
-static inline void gen_single_node_metrics(neu_node_metrics_t *node_metrics,
-                                           FILE *              stream)
+// rendered after the metrics lock is released, writing may block
+static void gen_global_metrics(FILE *stream)
 {
-    fprintf(stream,
-            "# HELP node_type Driver(1) or APP(2)\n"
-            "# TYPE node_type gauge\n"
-            "node_type{node=\"%s\"} %d\n",
-            node_metrics->name, node_metrics->type);
+    neu_metrics_t metrics = { 0 };
+
+    neu_metrics_visist((neu_metrics_cb_t) copy_global_metrics, &metrics);
+    fprintf(stream, METRIC_GLOBAL_TMPL, metrics.distro, metrics.kernel,
+            metrics.machine, metrics.clib, metrics.clib_version,
+            metrics.cpu_percent, metrics.cpu_cores, metrics.mem_total_bytes,
+            metrics.mem_used_bytes, metrics.mem_cache_bytes,
+            metrics.mem_used_bytes, metrics.disk_size_gibibytes,
+            metrics.disk_used_gibibytes, metrics.disk_avail_gibibytes,
+            metrics.core_dumped, metrics.uptime_seconds,
+            metrics.license_max_tags, metrics.license_used_tags,
+            metrics.north_nodes, metrics.north_running_nodes,
+            metrics.north_disconnected_nodes, metrics.south_nodes,
+            metrics.south_running_nodes, metrics.south_disconnected_nodes);
+}
 
-    neu_metric_entry_t *e = NULL;
+/*
+ * A scrape takes a snapshot of the nodes under the metrics lock, with one
+ * series per metric entry, and renders the snapshot after the lock is
+ * released. The series find their metric family through an index of the
+ * registered metrics built once per scrape, so rendering is linear in the
+ * number of series.
+ */
+
+typedef struct {
+    const char *      name; // string literals of the registered metric
+    const char *      help; //
+    neu_metric_type_e type;
+    int               head; // first and last series, -1 if none
+    int               tail; //
+    UT_hash_handle    hh;
+} metric_family_t;
+
+typedef struct {
+    metric_family_t *family;
+    char             node[NEU_NODE_NAME_LEN];
+    char             group[NEU_GROUP_NAME_LEN]; // empty for node metrics
+    bool             shadowed; // by the node metric of the same name
+    uint64_t         value;
+    int              next; // the next series of the family
+} metric_series_t;
+
+typedef struct {
+    char            name[NEU_NODE_NAME_LEN];
+    neu_node_type_e type;
+} metric_node_t;
+
+typedef struct {
+    int              filter;
+    const char *     node; // a single node if not empty
+    int              status;
+    metric_family_t *families; // in the order of registration
+    metric_family_t *index;
+    unsigned         n_family;
+    UT_array *       nodes;  // metric_node_t
+    UT_array *       series; // metric_series_t
+} metric_snapshot_t;
+
+static const UT_icd metric_series_icd = { sizeof(metric_series_t), NULL, NULL,
+                                          NULL };
+
+static const UT_icd metric_node_icd = { sizeof(metric_node_t), NULL, NULL,
+                                        NULL };
+
+static int new_families(const neu_metrics_t *metrics, metric_snapshot_t *snap)
+{
+    neu_metric_entry_t *r = NULL;
+    size_t              n = HASH_COUNT(metrics->registered_metrics);
 
-    pthread_mutex_lock(&node_metrics->lock);
-    HASH_LOOP(hh, node_metrics->entries, e)
+    snap->families = calloc(n + 1, sizeof(metric_family_t));
+    if (NULL == snap->families) {
+        return -1;
+    }
+
+    HASH_LOOP(hh, metrics->registered_metrics, r)
     {
-        if (neu_metric_type_is_rolling_counter(e->type)) {
-            // force clean stale value
-            e->value = neu_rolling_counter_inc(e->rcnt, global_timestamp, 0);
-        }
-        fprintf(stream,
-                "# HELP %s %s\n# TYPE %s %s\n%s{node=\"%s\"} %" PRIu64 "\n",
-                e->name, e->help, e->name, neu_metric_type_str(e->type),
-                e->name, node_metrics->name, e->value);
+        metric_family_t *f = &snap->families[snap->n_family++];
+
+        f->name = r->name;
+        f->help = r->help;
+        f->type = r->type;
+        f->head = -1;
+        f->tail = -1;
+        HASH_ADD_KEYPTR(hh, snap->index, f->name, strlen(f->name), f);
     }
 
-    neu_group_metrics_t *g = NULL;
-    HASH_LOOP(hh, node_metrics->group_metrics, g)
+    return 0;
+}
+
+static void add_series(metric_family_t *index, UT_array *series,
+                       neu_node_metrics_t *n, neu_group_metrics_t *g,
+                       neu_metric_entry_t *e)
+{
+    metric_series_t s = { 0 };
+
+    HASH_FIND_STR(index, e->name, s.family);
+    if (NULL == s.family) {
+        return;
+    }
+
+    if (neu_metric_type_is_rolling_counter(e->type)) {
+        // force clean stale value
+        e->value = neu_rolling_counter_inc(e->rcnt, global_timestamp, 0);
+    }
+
+    strncpy(s.node, n->name, sizeof(s.node) - 1);
+    s.value = e->value;
+    s.next  = -1;
+    if (g) {
+        neu_metric_entry_t *ne = NULL;
+        HASH_FIND_STR(n->entries, e->name, ne);
+        s.shadowed = NULL != ne;
+        strncpy(s.group, g->name, sizeof(s.group) - 1);
+    }
+    utarray_push_back(series, &s);
+}
+
+static void snapshot_node(metric_snapshot_t *snap, neu_node_metrics_t *n)
+{
+    neu_metric_entry_t * e    = NULL;
+    neu_group_metrics_t *g    = NULL;
+    metric_node_t        node = { 0 };
+
+    strncpy(node.name, n->name, sizeof(node.name) - 1);
+    node.type = n->type;
+    utarray_push_back(snap->nodes, &node);
+
+    if (NULL == snap->families) {
+        return;
+    }
+
+    pthread_mutex_lock(&n->lock);
+    HASH_LOOP(hh, n->entries, e)
+    {
+        add_series(snap->index, snap->series, n, NULL, e);
+    }
+    HASH_LOOP(hh, n->group_metrics, g)
     {
         HASH_LOOP(hh, g->entries, e)
         {
-            if (neu_metric_type_is_rolling_counter(e->type)) {
-                // force clean stale value
-                e->value =
-                    neu_rolling_counter_inc(e->rcnt, global_timestamp, 0);
-            }
-            fprintf(stream,
-                    "# HELP %s %s\n# TYPE %s %s\n%s{node=\"%s\",group=\"%s\"} "
-                    "%" PRIu64 "\n",
-                    e->name, e->help, e->name, neu_metric_type_str(e->type),
-                    e->name, node_metrics->name, g->name, e->value);
+            add_series(snap->index, snap->series, n, g, e);
         }
     }
-    pthread_mutex_unlock(&node_metrics->lock);
+    pthread_mutex_unlock(&n->lock);
 }
 
-static inline bool has_entry(neu_node_metrics_t *node_metrics, const char *name)
+// the metrics lock is held, nothing is written here
+static void snapshot_metrics(const neu_metrics_t *metrics,
+                             metric_snapshot_t *  snap)
 {
-    neu_metric_entry_t * e = NULL;
-    neu_group_metrics_t *g = NULL;
-    HASH_FIND_STR(node_metrics->entries, name, e);
-    if (e) {
-        return true;
+    neu_node_metrics_t *n = NULL;
+
+    if (snap->node[0]) {
+        HASH_FIND_STR(metrics->node_metrics, snap->node, n);
+        if (NULL == n || 0 == (snap->filter & n->type)) {
+            snap->status = NNG_HTTP_STATUS_NOT_FOUND;
+            return;
+        }
+    }
+
+    new_families(metrics, snap);
+
+    if (NULL != n) {
+        snapshot_node(snap, n);
+        return;
     }
 
-    HASH_LOOP(hh, node_metrics->group_metrics, g)
+    HASH_LOOP(hh, metrics->node_metrics, n)
     {
-        HASH_FIND_STR(g->entries, name, e);
-        if (e) {
-            return true;
+        if (snap->filter & n->type) {
+            snapshot_node(snap, n);
         }
     }
-    return false;
 }
 
-static void gen_all_node_metrics(neu_metrics_t *metrics, int type_filter,
-                                 FILE *stream)
+static void print_series(FILE *stream, metric_series_t *s)
+{
+    if (s->group[0]) {
+        fprintf(stream, "%s{node=\"%s\",group=\"%s\"} %" PRIu64 "\n",
+                s->family->name, s->node, s->group, s->value);
+    } else {
+        fprintf(stream, "%s{node=\"%s\"} %" PRIu64 "\n", s->family->name,
+                s->node, s->value);
+    }
+}
+
+static void print_family_comment(FILE *stream, metric_family_t *f)
 {
-    neu_metric_entry_t * e = NULL, *r = NULL;
-    neu_group_metrics_t *g = NULL;
-    neu_node_metrics_t * n = NULL;
+    fprintf(stream, "# HELP %s %s\n# TYPE %s %s\n", f->name, f->help,
+            f->name, neu_metric_type_str(f->type));
+}
 
-    bool commented = false;
-    HASH_LOOP(hh, metrics->node_metrics, n)
+static void gen_single_node_metrics(metric_snapshot_t *snap, FILE *stream)
+{
+    metric_node_t *node = utarray_front(snap->nodes);
+
+    fprintf(stream,
+            "# HELP node_type Driver(1) or APP(2)\n"
+            "# TYPE node_type gauge\n"
+            "node_type{node=\"%s\"} %d\n",
+            node->name, node->type);
+
+    utarray_foreach(snap->series, metric_series_t *, s)
     {
-        if (!(type_filter & n->type)) {
-            continue;
-        }
+        print_family_comment(stream, s->family);
+        print_series(stream, s);
+    }
+}
 
-        if (!commented) {
-            commented = true;
-            fprintf(stream,
-                    "# HELP node_type Driver(1) or APP(2)\n"
-                    "# TYPE node_type gauge\n");
-        }
+static void gen_all_node_metrics(metric_snapshot_t *snap, FILE *stream)
+{
+    UT_array *series = snap->series;
 
+    if (utarray_len(snap->nodes) > 0) {
+        fprintf(stream,
+                "# HELP node_type Driver(1) or APP(2)\n"
+                "# TYPE node_type gauge\n");
+    }
+    utarray_foreach(snap->nodes, metric_node_t *, n)
+    {
         fprintf(stream, "node_type{node=\"%s\"} %d\n", n->name, n->type);
     }
 
-    n = NULL;
+    // chain the series of every family, in the order of the nodes
+    for (unsigned i = 0; i < utarray_len(series); ++i) {
+        metric_series_t *s = utarray_eltptr(series, i);
+        metric_family_t *f = s->family;
 
-    HASH_LOOP(hh, metrics->registered_metrics, r)
-    {
-        commented = false;
-        HASH_LOOP(hh, metrics->node_metrics, n)
-        {
-            if (!(type_filter & n->type)) {
-                continue;
-            }
-
-            if (!has_entry(n, r->name)) {
-                continue;
-            }
-
-            if (!commented) {
-                commented = true;
-                fprintf(stream, "# HELP %s %s\n# TYPE %s %s\n", r->name,
-                        r->help, r->name, neu_metric_type_str(r->type));
-            }
-
-            pthread_mutex_lock(&n->lock);
-            HASH_FIND_STR(n->entries, r->name, e);
-            if (e) {
-                if (neu_metric_type_is_rolling_counter(e->type)) {
-                    // force clean stale value
-                    e->value =
-                        neu_rolling_counter_inc(e->rcnt, global_timestamp, 0);
-                }
-                fprintf(stream, "%s{node=\"%s\"} %" PRIu64 "\n", e->name,
-                        n->name, e->value);
-
-                pthread_mutex_unlock(&n->lock);
-                continue;
-            }
-
-            HASH_LOOP(hh, n->group_metrics, g)
-            {
-                HASH_FIND_STR(g->entries, r->name, e);
-                if (e) {
-                    if (neu_metric_type_is_rolling_counter(e->type)) {
-                        // force clean stale value
-                        e->value = neu_rolling_counter_inc(e->rcnt,
-                                                           global_timestamp, 0);
-                    }
-                    fprintf(stream,
-                            "%s{node=\"%s\",group=\"%s\"} %" PRIu64 "\n",
-                            e->name, n->name, g->name, e->value);
-                }
-            }
-            pthread_mutex_unlock(&n->lock);
+        if (s->shadowed) {
+            continue;
+        }
+        if (f->tail < 0) {
+            f->head = i;
+        } else {
+            metric_series_t *t = utarray_eltptr(series, (unsigned) f->tail);
+            t->next            = i;
         }
+        f->tail = i;
     }
-}
 
-struct context {
-    int         filter;
-    int *       status;
-    FILE *      stream;
-    const char *node;
-};
+    // families in the order of registration
+    for (unsigned i = 0; i < snap->n_family; ++i) {
+        metric_family_t *f = &snap->families[i];
+
+        if (f->head >= 0) {
+            print_family_comment(stream, f);
+        }
+        for (int k = f->head; k >= 0;) {
+            metric_series_t *s = utarray_eltptr(series, (unsigned) k);
+            print_series(stream, s);
+            k = s->next;
+        }
+    }
+}
 
-static void gen_node_metrics(neu_metrics_t *metrics, struct context *ctx)
+static int gen_node_metrics(int filter, const char *node, FILE *stream)
 {
-    if (ctx->node[0]) {
-        neu_node_metrics_t *n = NULL;
-        HASH_FIND_STR(metrics->node_metrics, ctx->node, n);
-        if (NULL == n || 0 == (ctx->filter & n->type)) {
-            *ctx->status = NNG_HTTP_STATUS_NOT_FOUND;
-            return;
+    metric_snapshot_t snap = {
+        .filter = filter,
+        .node   = node,
+        .status = NNG_HTTP_STATUS_OK,
+    };
+
+    utarray_new(snap.nodes, &metric_node_icd);
+    utarray_new(snap.series, &metric_series_icd);
+    neu_metrics_visist((neu_metrics_cb_t) snapshot_metrics, &snap);
+
+    if (NNG_HTTP_STATUS_OK == snap.status) {
+        if (node[0]) {
+            gen_single_node_metrics(&snap, stream);
+        } else {
+            gen_all_node_metrics(&snap, stream);
         }
-        gen_single_node_metrics(n, ctx->stream);
-    } else {
-        gen_all_node_metrics(metrics, ctx->filter, ctx->stream);
     }
+
+    utarray_free(snap.series);
+    utarray_free(snap.nodes);
+    HASH_CLEAR(hh, snap.index);
+    free(snap.families);
+    return snap.status;
 }
 
 void handle_get_metric(nng_aio *aio)
 {
-    int    status = NNG_HTTP_STATUS_OK;
-    char * result = NULL;
-    size_t len    = 0;
-    FILE * stream = NULL;
+    int                 status  = NNG_HTTP_STATUS_OK;
+    neu_http_chunked_t *chunked = NULL;
+    FILE *              stream  = NULL;
 
     neu_metrics_category_e cat           = NEU_METRICS_CATEGORY_ALL;
     size_t                 cat_param_len = 0;
@@ -358,34 +470,30 @@ void handle_get_metric(nng_aio *aio)
         goto end;
     }
 
-    stream = open_memstream(&result, &len);
+    // written out as it is generated, in chunks once it outgrows the buffer
+    chunked = neu_http_chunked_new(aio, "text/plain");
+    stream  = chunked ? neu_http_chunked_stream(chunked) : NULL;
     if (NULL == stream) {
         status = NNG_HTTP_STATUS_INTERNAL_SERVER_ERROR;
         goto end;
     }
 
-    struct context ctx = {
-        .status = &status,
-        .stream = stream,
-        .node   = node_name,
-    };
-
     switch (cat) {
     case NEU_METRICS_CATEGORY_GLOBAL:
-        neu_metrics_visist((neu_metrics_cb_t) gen_global_metrics, stream);
+        gen_global_metrics(stream);
+        neu_http_class_metrics(stream);
         break;
     case NEU_METRICS_CATEGORY_DRIVER:
-        ctx.filter = NEU_NA_TYPE_DRIVER;
-        neu_metrics_visist((neu_metrics_cb_t) gen_node_metrics, &ctx);
+        status = gen_node_metrics(NEU_NA_TYPE_DRIVER, node_name, stream);
         break;
     case NEU_METRICS_CATEGORY_APP:
-        ctx.filter = NEU_NA_TYPE_APP;
-        neu_metrics_visist((neu_metrics_cb_t) gen_node_metrics, &ctx);
+        status = gen_node_metrics(NEU_NA_TYPE_APP, node_name, stream);
         break;
     case NEU_METRICS_CATEGORY_ALL:
-        ctx.filter = NEU_NA_TYPE_DRIVER | NEU_NA_TYPE_APP;
-        neu_metrics_visist((neu_metrics_cb_t) gen_global_metrics, stream);
-        neu_metrics_visist((neu_metrics_cb_t) gen_node_metrics, &ctx);
+        gen_global_metrics(stream);
+        neu_http_class_metrics(stream);
+        status = gen_node_metrics(NEU_NA_TYPE_DRIVER | NEU_NA_TYPE_APP,
+                                  node_name, stream);
         break;
     }
 
@@ -393,6 +501,9 @@ end:
     if (NULL != stream) {
         fclose(stream);
     }
-    response(aio, NNG_HTTP_STATUS_OK == status ? result : NULL, status);
-    free(result);
+    if (NNG_HTTP_STATUS_OK == status) {
+        neu_http_chunked_end(chunked);
+    } else if (!neu_http_chunked_abort(chunked)) {
+        response(aio, NULL, status);
+    }
 }
@@ -37,6 +37,7 @@
 #include "rest.h"
 #include "rw_handle.h"
 #include "scan_handle.h"
+#include "stream_handle.h"
 #include "utils/http.h"
 #include "utils/log.h"
 #include "utils/neu_jwt.h"
@@ -85,6 +86,10 @@ static neu_plugin_t *dashb_plugin_open(void)
     neu_plugin_common_init(&plugin->common);
 
     plugin->handle_ctx = neu_rest_init_ctx(plugin);
+    if (0 != handle_stream_init(plugin)) {
+        nlog_error("Failed to create stream timer");
+        goto server_init_fail;
+    }
 
     plugin->server = server_init();
 
@@ -113,6 +118,8 @@ server_init_fail:
     if (plugin->server != NULL) {
         nng_http_server_release(plugin->server);
     }
+    handle_stream_uninit();
+    handle_rw_uninit();
     neu_rest_free_ctx(plugin->handle_ctx);
     free(plugin);
     return NULL;
@@ -124,6 +131,8 @@ static int dashb_plugin_close(neu_plugin_t *plugin)
 
     nng_http_server_stop(plugin->server);
     nng_http_server_release(plugin->server);
+    handle_stream_uninit();
+    handle_rw_uninit();
 
     free(plugin);
     nlog_notice("Success to free plugin: %s", neu_plugin_module.module_name);
@@ -164,11 +173,52 @@ static int dashb_plugin_config(neu_plugin_t *plugin, const char *configs)
     return rv;
 }
 
+// messages of the groups subscribed for the streams, the ctx of the ones
+// forwarded by the manager may be an aio of another request or a request of
+// the streams
+static bool dashb_stream_request(neu_reqresp_head_t *header, void *data)
+{
+    switch (header->type) {
+    case NEU_RESP_ERROR:
+        return handle_stream_sub_resp(header->ctx, (neu_resp_error_t *) data);
+    case NEU_REQRESP_TRANS_DATA:
+        handle_stream_trans_data((neu_reqresp_trans_data_t *) data);
+        return true;
+    case NEU_REQ_SUBSCRIBE_GROUP:
+    case NEU_REQ_UPDATE_SUBSCRIBE_GROUP:
+        free(((neu_req_subscribe_t *) data)->params);
+        return true;
+    case NEU_REQ_UNSUBSCRIBE_GROUP:
+        handle_stream_unsubscribe(header->ctx,
+                                  (neu_req_unsubscribe_t *) data);
+        return true;
+    case NEU_REQ_UPDATE_GROUP:
+        handle_stream_update_group((neu_req_update_group_t *) data);
+        return true;
+    case NEU_REQ_DEL_GROUP:
+        handle_stream_del_group((neu_req_del_group_t *) data);
+        return true;
+    case NEU_REQ_UPDATE_NODE:
+        handle_stream_update_node((neu_req_update_node_t *) data);
+        return true;
+    case NEU_REQRESP_NODE_DELETED:
+        handle_stream_del_node((neu_reqresp_node_deleted_t *) data);
+        return true;
+    default:
+        return false;
+    }
+}
+
 static int dashb_plugin_request(neu_plugin_t *      plugin,
                                 neu_reqresp_head_t *header, void *data)
 {
     (void) plugin;
 
+    if (dashb_stream_request(header, data) ||
+        handle_read_groups_resp(header, data)) {
+        return 0;
+    }
+
     if (header->ctx && nng_aio_get_input(header->ctx, 3)) {
         // catch all response messages for global config request
         handle_global_config_resp(header->ctx, header->type, data);
@@ -320,6 +370,14 @@ static int dashb_plugin_request(neu_plugin_t *      plugin,
             neu_otel_scope_set_status_code2(scope, NEU_OTEL_STATUS_OK, 0);
         }
         break;
+    case NEU_RESP_WRITE_TAGS:
+        handle_write_tags_resp(header->ctx, (neu_resp_write_tags_t *) data);
+        if (neu_otel_control_is_started() && trace) {
+            neu_otel_scope_set_status_code2(
+                scope, NEU_OTEL_STATUS_ERROR,
+                ((neu_resp_write_tags_t *) data)->error);
+        }
+        break;
     case NEU_RESP_SCAN_TAGS:
         handle_scan_tags_resp(header->ctx, (neu_resp_scan_tags_t *) data);
         if (neu_otel_control_is_started() && trace) {
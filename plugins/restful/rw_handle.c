@@ -16,10 +16,13 @@
  * along with this program; if not, write to the Free Software Foundation,
  * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
  **/
+#include <pthread.h>
 #include <stdlib.h>
 
 #include "plugin.h"
 #include "utils/log.h"
+#include "utils/uthash.h"
+#include "utils/utlist.h"
 #include "json/neu_json_fn.h"
 #include "json/neu_json_rw.h"
 
@@ -31,6 +34,44 @@
 
 #include "otel/otel_manager.h"
 
+#define READ_GROUPS_MAX 128
+#define READ_GROUPS_TIMEOUT_MS 3000
+#define READ_GROUPS_MAX_TIMEOUT_MS 60000
+
+typedef struct read_groups read_groups_t;
+
+// a group of handle_read_groups, the ctx of its read request
+typedef struct {
+    void *         key; // the entry itself
+    read_groups_t *bulk;
+    char *         node;
+    char *         group;
+    char *         result; // group object of the response
+    bool           done;
+    UT_hash_handle hh;
+} read_entry_t;
+
+struct read_groups {
+    nng_aio *      aio;
+    nng_aio *      timer; // sleeps until the deadline
+    bool           responded;
+    int            refs; // reads in flight, the sender, responder and timer
+    int            n_entry;
+    int            n_done;
+    read_entry_t * entries;
+    read_groups_t *next;
+};
+
+typedef struct {
+    pthread_mutex_t mtx;
+    read_entry_t *  entries; // reads in flight
+    read_groups_t * pending; // not responded yet
+} read_ctx_t;
+
+static read_ctx_t read_ctx = {
+    .mtx = PTHREAD_MUTEX_INITIALIZER,
+};
+
 void handle_read(nng_aio *aio)
 {
     neu_plugin_t *plugin = neu_rest_get_plugin();
@@ -800,154 +841,70 @@ void handle_write_gtags(nng_aio *aio)
         })
 }
 
-void handle_read_resp(nng_aio *aio, neu_resp_read_group_t *resp)
+static void read_resp_to_json(neu_resp_read_group_t *resp,
+                              neu_json_read_resp_t * api_res)
 {
-    neu_json_read_resp_t api_res = { 0 };
-    char *               result  = NULL;
-    int                  index   = 0;
+    int index = 0;
 
-    api_res.n_tag = utarray_len(resp->tags);
-    api_res.tags  = calloc(api_res.n_tag, sizeof(neu_json_read_resp_tag_t));
+    api_res->n_tag = utarray_len(resp->tags);
+    api_res->tags  = calloc(api_res->n_tag, sizeof(neu_json_read_resp_tag_t));
 
     utarray_foreach(resp->tags, neu_resp_tag_value_meta_t *, tag_value)
     {
-        neu_tag_value_to_json(tag_value, &api_res.tags[index]);
+        neu_tag_value_to_json(tag_value, &api_res->tags[index]);
         index += 1;
     }
+}
 
-    neu_json_encode_by_fn(&api_res, neu_json_encode_read_resp, &result);
-    for (int i = 0; i < api_res.n_tag; i++) {
-        if (api_res.tags[i].n_meta > 0) {
-            free(api_res.tags[i].metas);
+static void read_resp_json_fini(neu_json_read_resp_t *api_res)
+{
+    for (int i = 0; i < api_res->n_tag; i++) {
+        if (api_res->tags[i].n_meta > 0) {
+            free(api_res->tags[i].metas);
         }
 
-        if (api_res.tags[i].t == NEU_JSON_ARRAY_STR) {
-            for (int j = 0; j < api_res.tags[i].value.val_array_str.length;
+        if (api_res->tags[i].t == NEU_JSON_ARRAY_STR) {
+            for (int j = 0; j < api_res->tags[i].value.val_array_str.length;
                  j++) {
-                free(api_res.tags[i].value.val_array_str.p_strs[j]);
+                free(api_res->tags[i].value.val_array_str.p_strs[j]);
             }
         }
     }
+    free(api_res->tags);
+}
+
+void handle_read_resp(nng_aio *aio, neu_resp_read_group_t *resp)
+{
+    neu_json_read_resp_t api_res = { 0 };
+    char *               result  = NULL;
+
+    read_resp_to_json(resp, &api_res);
+    neu_json_encode_by_fn(&api_res, neu_json_encode_read_resp, &result);
+    read_resp_json_fini(&api_res);
     neu_http_ok(aio, result);
-    free(api_res.tags);
     free(result);
 }
 
 void handle_read_paginate_resp(nng_aio *                       aio,
                                neu_resp_read_group_paginate_t *resp)
 {
-    neu_json_read_paginate_resp_t api_res    = { 0 };
-    char *                        result     = NULL;
-    unsigned int                  total_tags = resp->total_count;
-
-    if (resp->is_error) {
-        UT_array *filtered_tags;
-        utarray_new(filtered_tags, neu_resp_tag_value_meta_paginate_icd());
-
-        utarray_foreach(resp->tags, neu_resp_tag_value_meta_paginate_t *,
-                        tag_value)
-        {
-            if (tag_value->value.type == NEU_TYPE_ERROR) {
-                neu_resp_tag_value_meta_paginate_t new_tag_value;
-                memcpy(&new_tag_value, tag_value,
-                       sizeof(neu_resp_tag_value_meta_paginate_t));
-
-                new_tag_value.datatag.name = strdup(tag_value->datatag.name);
-                new_tag_value.datatag.address =
-                    strdup(tag_value->datatag.address);
-                new_tag_value.datatag.description =
-                    strdup(tag_value->datatag.description);
-
-                utarray_push_back(filtered_tags, &new_tag_value);
-            }
-        }
-
-        for (unsigned int i = 0; i < utarray_len(resp->tags); ++i) {
-            neu_resp_tag_value_meta_paginate_t *orig_tag_value;
-            orig_tag_value =
-                (neu_resp_tag_value_meta_paginate_t *) utarray_eltptr(
-                    resp->tags, i);
-            if (orig_tag_value) {
-                free(orig_tag_value->datatag.name);
-                free(orig_tag_value->datatag.address);
-                free(orig_tag_value->datatag.description);
-            }
-        }
-
-        utarray_free(resp->tags);
-        resp->tags = filtered_tags;
-        total_tags = utarray_len(resp->tags);
-
-        if (resp->current_page > 0 && resp->page_size > 0) {
-            unsigned int start_index =
-                (resp->current_page - 1) * resp->page_size;
-            unsigned int end_index = start_index + resp->page_size;
-
-            if (start_index >= total_tags) {
-                api_res.n_tag = 0;
-                api_res.tags =
-                    calloc(1, sizeof(neu_json_read_paginate_resp_tag_t));
-            } else {
-                if (end_index > total_tags) {
-                    end_index = total_tags;
-                }
+    neu_json_read_paginate_resp_t api_res = { 0 };
+    char *                        result  = NULL;
+    int                           index   = 0;
 
-                api_res.n_tag = end_index - start_index;
-                api_res.tags  = calloc(
-                    api_res.n_tag, sizeof(neu_json_read_paginate_resp_tag_t));
-
-                for (unsigned int i = start_index; i < end_index; i++) {
-                    neu_resp_tag_value_meta_paginate_t *tag_value =
-                        (neu_resp_tag_value_meta_paginate_t *) utarray_eltptr(
-                            resp->tags, i);
-                    neu_tag_value_to_json_paginate(
-                        tag_value, &api_res.tags[i - start_index]);
-                }
-            }
-        } else {
-            api_res.n_tag = total_tags;
-            api_res.tags  = calloc(api_res.n_tag,
-                                  sizeof(neu_json_read_paginate_resp_tag_t));
-            int index     = 0;
-
-            utarray_foreach(resp->tags, neu_resp_tag_value_meta_paginate_t *,
-                            tag_value)
-            {
-                neu_tag_value_to_json_paginate(tag_value,
-                                               &api_res.tags[index++]);
-            }
-        }
-    } else {
-
-        if (resp->current_page > 0 && resp->page_size > 0) {
-            api_res.n_tag = utarray_len(resp->tags);
-            api_res.tags  = calloc(api_res.n_tag,
-                                  sizeof(neu_json_read_paginate_resp_tag_t));
-            int index     = 0;
-            utarray_foreach(resp->tags, neu_resp_tag_value_meta_paginate_t *,
-                            tag_value)
-            {
-                neu_tag_value_to_json_paginate(tag_value,
-                                               &api_res.tags[index++]);
-            }
-        } else {
-            api_res.n_tag = total_tags;
-            api_res.tags  = calloc(api_res.n_tag,
-                                  sizeof(neu_json_read_paginate_resp_tag_t));
-            int index     = 0;
-
-            utarray_foreach(resp->tags, neu_resp_tag_value_meta_paginate_t *,
-                            tag_value)
-            {
-                neu_tag_value_to_json_paginate(tag_value,
-                                               &api_res.tags[index++]);
-            }
-        }
+    // the driver has applied the filters and the page window already
+    api_res.n_tag = utarray_len(resp->tags);
+    api_res.tags =
+        calloc(api_res.n_tag, sizeof(neu_json_read_paginate_resp_tag_t));
+    utarray_foreach(resp->tags, neu_resp_tag_value_meta_paginate_t *,
+                    tag_value)
+    {
+        neu_tag_value_to_json_paginate(tag_value, &api_res.tags[index++]);
     }
 
     api_res.meta.current_page = resp->current_page;
     api_res.meta.page_size    = resp->page_size;
-    api_res.meta.total        = total_tags;
+    api_res.meta.total        = resp->total_count;
 
     neu_json_encode_by_fn(&api_res, neu_json_encode_read_paginate_resp,
                           &result);
@@ -986,4 +943,373 @@ void handle_test_read_tag_resp(nng_aio *aio, neu_resp_test_read_tag_t *resp)
     neu_json_encode_by_fn(resp, neu_json_encode_test_read_tag_resp, &result);
     neu_http_ok(aio, result);
     free(result);
-}
\ No newline at end of file
+}
+
+void handle_write_tags_resp(nng_aio *aio, neu_resp_write_tags_t *resp)
+{
+    char *result = NULL;
+    neu_json_encode_by_fn(resp, neu_json_encode_write_tags_resp, &result);
+    neu_http_response(aio, resp->error, result);
+    free(result);
+}
+
+static char *read_entry_encode(read_entry_t *entry, int error,
+                               neu_resp_read_group_t *resp)
+{
+    char *                            result = NULL;
+    neu_json_read_groups_resp_group_t group  = {
+        .node  = entry->node,
+        .group = entry->group,
+        .error = error,
+    };
+
+    if (NULL != resp) {
+        read_resp_to_json(resp, &group.resp);
+    }
+    neu_json_encode_by_fn(&group, neu_json_encode_read_groups_resp_group,
+                          &result);
+    read_resp_json_fini(&group.resp);
+    return result;
+}
+
+static void read_groups_free(read_groups_t *bulk)
+{
+    for (int i = 0; i < bulk->n_entry; i++) {
+        free(bulk->entries[i].node);
+        free(bulk->entries[i].group);
+        free(bulk->entries[i].result);
+    }
+    free(bulk->entries);
+    // the last reference may be dropped by the timer callback
+    if (NULL != bulk->timer) {
+        nng_aio_reap(bulk->timer);
+    }
+    free(bulk);
+}
+
+static void read_groups_unref(read_groups_t *bulk)
+{
+    bool release = false;
+
+    pthread_mutex_lock(&read_ctx.mtx);
+    release = 0 == --bulk->refs;
+    pthread_mutex_unlock(&read_ctx.mtx);
+
+    if (release) {
+        read_groups_free(bulk);
+    }
+}
+
+// by the one that marks the bulk responded, the entries are not changed since
+static void read_groups_respond(read_groups_t *bulk)
+{
+    neu_http_chunked_t *chunked =
+        neu_http_chunked_new(bulk->aio, "application/json");
+    int rv = NULL == chunked
+        ? -1
+        : neu_http_chunked_puts(chunked, "{\"groups\": [");
+
+    for (int i = 0; 0 == rv && i < bulk->n_entry; i++) {
+        read_entry_t *entry = &bulk->entries[i];
+
+        if (NULL == entry->result) {
+            int error =
+                entry->done ? NEU_ERR_EINTERNAL : NEU_ERR_REQUEST_TIMEOUT;
+            entry->result = read_entry_encode(entry, error, NULL);
+        }
+
+        if (NULL == entry->result ||
+            0 != neu_http_chunked_puts(chunked, 0 == i ? "" : ", ") ||
+            0 != neu_http_chunked_puts(chunked, entry->result)) {
+            rv = -1;
+        }
+    }
+
+    if (0 == rv && 0 == neu_http_chunked_puts(chunked, "]}")) {
+        neu_http_chunked_end(chunked);
+    } else if (!neu_http_chunked_abort(chunked)) {
+        NEU_JSON_RESPONSE_ERROR(NEU_ERR_EINTERNAL, {
+            neu_http_response(bulk->aio, NEU_ERR_EINTERNAL, result_error);
+        });
+    }
+}
+
+static read_entry_t *read_entry_take(void *key)
+{
+    read_entry_t *entry = NULL;
+
+    pthread_mutex_lock(&read_ctx.mtx);
+    HASH_FIND_PTR(read_ctx.entries, &key, entry);
+    if (NULL != entry) {
+        HASH_DEL(read_ctx.entries, entry);
+    }
+    pthread_mutex_unlock(&read_ctx.mtx);
+
+    return entry;
+}
+
+// the read of the entry is done, result is dropped if the bulk is responded
+static void read_entry_done(read_entry_t *entry, char *result)
+{
+    read_groups_t *bulk    = entry->bulk;
+    bool           respond = false;
+
+    pthread_mutex_lock(&read_ctx.mtx);
+    if (!bulk->responded) {
+        entry->result = result;
+        entry->done   = true;
+        result        = NULL;
+        if (++bulk->n_done == bulk->n_entry) {
+            bulk->responded = true;
+            LL_DELETE(read_ctx.pending, bulk);
+            respond = true;
+        }
+    }
+    pthread_mutex_unlock(&read_ctx.mtx);
+
+    free(result);
+    if (respond) {
+        nng_aio_cancel(bulk->timer);
+        read_groups_respond(bulk);
+        read_groups_unref(bulk);
+    }
+    read_groups_unref(bulk);
+}
+
+bool handle_read_groups_resp(neu_reqresp_head_t *header, void *data)
+{
+    read_entry_t *entry = NULL;
+    char *        result;
+
+    if (NULL == header->ctx ||
+        (NEU_RESP_READ_GROUP != header->type &&
+         NEU_RESP_ERROR != header->type)) {
+        return false;
+    }
+
+    entry = read_entry_take(header->ctx);
+    if (NULL == entry) {
+        return false;
+    }
+
+    if (NEU_RESP_ERROR == header->type) {
+        result = read_entry_encode(entry, ((neu_resp_error_t *) data)->error,
+                                   NULL);
+    } else {
+        result = read_entry_encode(entry, 0, (neu_resp_read_group_t *) data);
+    }
+
+    read_entry_done(entry, result);
+    return true;
+}
+
+// on the nng task threads, at the deadline or once cancelled
+static void read_groups_timeout_cb(void *arg)
+{
+    read_groups_t *bulk    = arg;
+    bool           respond = false;
+
+    pthread_mutex_lock(&read_ctx.mtx);
+    if (!bulk->responded) {
+        bulk->responded = true;
+        LL_DELETE(read_ctx.pending, bulk);
+        respond = true;
+    }
+    pthread_mutex_unlock(&read_ctx.mtx);
+
+    if (respond) {
+        read_groups_respond(bulk);
+        read_groups_unref(bulk);
+    }
+    read_groups_unref(bulk);
+}
+
+static int read_entry_check(neu_json_read_req_t *req)
+{
+    if (strlen(req->node) >= NEU_NODE_NAME_LEN) {
+        return NEU_ERR_NODE_NAME_TOO_LONG;
+    }
+
+    if (strlen(req->group) >= NEU_GROUP_NAME_LEN) {
+        return NEU_ERR_GROUP_NAME_TOO_LONG;
+    }
+
+    if (req->name && strlen(req->name) >= NEU_TAG_NAME_LEN) {
+        return NEU_ERR_TAG_NAME_TOO_LONG;
+    }
+
+    if (req->n_tags > UINT16_MAX) {
+        return NEU_ERR_PARAM_IS_WRONG;
+    }
+
+    return NEU_ERR_SUCCESS;
+}
+
+static int read_entry_send(neu_plugin_t *plugin, read_entry_t *entry,
+                           neu_json_read_req_t *req)
+{
+    neu_reqresp_head_t   header = { 0 };
+    neu_req_read_group_t cmd    = { 0 };
+
+    // the ctx is not an aio, no trace of the rest communication
+    header.ctx  = entry;
+    header.type = NEU_REQ_READ_GROUP;
+
+    cmd.driver  = strdup(entry->node);
+    cmd.group   = strdup(entry->group);
+    cmd.name    = req->name;
+    cmd.desc    = req->desc;
+    cmd.sync    = req->sync;
+    cmd.n_tag   = req->n_tags;
+    cmd.tags    = req->tags;
+    req->name   = NULL;
+    req->desc   = NULL;
+    req->n_tags = 0;
+    req->tags   = NULL;
+
+    if (NULL == cmd.driver || NULL == cmd.group ||
+        0 != neu_plugin_op(plugin, header, &cmd)) {
+        neu_req_read_group_fini(&cmd);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int read_groups_start(nng_aio *aio, neu_plugin_t *plugin,
+                             neu_json_read_groups_req_t *req)
+{
+    read_groups_t *bulk    = NULL;
+    int            n_entry = req->n_group;
+    int            timeout = READ_GROUPS_TIMEOUT_MS;
+    bool           respond = false;
+
+    if (n_entry > READ_GROUPS_MAX || req->timeout < 0 ||
+        req->timeout > READ_GROUPS_MAX_TIMEOUT_MS) {
+        return NEU_ERR_PARAM_IS_WRONG;
+    }
+
+    if (req->timeout > 0) {
+        timeout = req->timeout;
+    }
+
+    bulk = calloc(1, sizeof(read_groups_t));
+    if (NULL == bulk ||
+        NULL == (bulk->entries = calloc(n_entry, sizeof(read_entry_t))) ||
+        0 != nng_aio_alloc(&bulk->timer, read_groups_timeout_cb, bulk)) {
+        if (NULL != bulk) {
+            free(bulk->entries);
+        }
+        free(bulk);
+        return NEU_ERR_EINTERNAL;
+    }
+
+    bulk->aio     = aio;
+    bulk->n_entry = n_entry;
+    bulk->refs    = 2;
+
+    for (int i = 0; i < n_entry; i++) {
+        read_entry_t *entry = &bulk->entries[i];
+        int           error = read_entry_check(&req->groups[i]);
+
+        entry->key   = entry;
+        entry->bulk  = bulk;
+        entry->node  = req->groups[i].node;
+        entry->group = req->groups[i].group;
+
+        req->groups[i].node  = NULL;
+        req->groups[i].group = NULL;
+
+        if (NEU_ERR_SUCCESS != error) {
+            entry->result = read_entry_encode(entry, error, NULL);
+            entry->done   = true;
+            bulk->n_done += 1;
+        }
+    }
+
+    // every read is found by its response before the first one is sent
+    pthread_mutex_lock(&read_ctx.mtx);
+    for (int i = 0; i < n_entry; i++) {
+        read_entry_t *entry = &bulk->entries[i];
+
+        if (!entry->done) {
+            HASH_ADD_PTR(read_ctx.entries, key, entry);
+            bulk->refs += 1;
+        }
+    }
+    if (bulk->n_done < n_entry) {
+        LL_APPEND(read_ctx.pending, bulk);
+        bulk->refs += 1;
+        nng_sleep_aio(timeout, bulk->timer);
+    } else {
+        bulk->responded = true;
+        respond         = true;
+    }
+    pthread_mutex_unlock(&read_ctx.mtx);
+
+    if (respond) {
+        read_groups_respond(bulk);
+        read_groups_unref(bulk);
+    }
+
+    for (int i = 0; i < n_entry; i++) {
+        read_entry_t *entry = &bulk->entries[i];
+
+        if (!entry->done &&
+            0 != read_entry_send(plugin, entry, &req->groups[i])) {
+            entry = read_entry_take(entry);
+            read_entry_done(entry,
+                            read_entry_encode(entry, NEU_ERR_IS_BUSY, NULL));
+        }
+    }
+
+    read_groups_unref(bulk);
+    return NEU_ERR_SUCCESS;
+}
+
+void handle_read_groups(nng_aio *aio)
+{
+    neu_plugin_t *plugin = neu_rest_get_plugin();
+
+    NEU_PROCESS_HTTP_REQUEST_VALIDATE_JWT(
+        aio, neu_json_read_groups_req_t, neu_json_decode_read_groups_req, {
+            int error = read_groups_start(aio, plugin, req);
+
+            if (NEU_ERR_SUCCESS != error) {
+                NEU_JSON_RESPONSE_ERROR(error, {
+                    neu_http_response(aio, error, result_error);
+                });
+            }
+        })
+}
+
+void handle_rw_uninit()
+{
+    read_groups_t *bulk = NULL, *tmp = NULL;
+    read_entry_t * entry = NULL, *etmp = NULL;
+    read_groups_t *stopped = NULL, *released = NULL;
+
+    // the server is stopped, the requests are not answered any more, and the
+    // reads still in flight release their bulks, responded or not
+    pthread_mutex_lock(&read_ctx.mtx);
+    HASH_ITER(hh, read_ctx.entries, entry, etmp)
+    {
+        HASH_DEL(read_ctx.entries, entry);
+        bulk = entry->bulk;
+        if (0 == --bulk->refs) {
+            LL_PREPEND(released, bulk);
+        }
+    }
+    LL_FOREACH_SAFE(read_ctx.pending, bulk, tmp)
+    {
+        // the timer keeps a reference until its callback
+        LL_DELETE(read_ctx.pending, bulk);
+        bulk->responded = true;
+        bulk->refs -= 1;
+        LL_PREPEND(stopped, bulk);
+    }
+    pthread_mutex_unlock(&read_ctx.mtx);
+
+    LL_FOREACH_SAFE(stopped, bulk, tmp) { nng_aio_cancel(bulk->timer); }
+    LL_FOREACH_SAFE(released, bulk, tmp) { read_groups_free(bulk); }
+}
@@ -24,10 +24,10 @@
 
 #include "adapter.h"
 
-void handle_rw_init();
 void handle_rw_uninit();
 void handle_read(nng_aio *aio);
 void handle_read_paginate(nng_aio *aio);
+void handle_read_groups(nng_aio *aio);
 void handle_test_read_tag(nng_aio *aio);
 void handle_write(nng_aio *aio);
 void handle_write_tags(nng_aio *aio);
@@ -36,5 +36,10 @@ void handle_read_resp(nng_aio *aio, neu_resp_read_group_t *resp);
 void handle_read_paginate_resp(nng_aio *                       aio,
                                neu_resp_read_group_paginate_t *resp);
 void handle_test_read_tag_resp(nng_aio *aio, neu_resp_test_read_tag_t *resp);
+void handle_write_tags_resp(nng_aio *aio, neu_resp_write_tags_t *resp);
+
+// the responses to the reads of handle_read_groups, whose ctx is not an aio,
+// returns false for the other messages
+bool handle_read_groups_resp(neu_reqresp_head_t *header, void *data);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,914 @@
+/**
+ * NEURON IIoT System for Industry 4.0
+ * Copyright (C) 2020-2022 EMQ Technologies Co., Ltd All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ **/
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <nng/nng.h>
+#include <nng/supplemental/http/http.h>
+
+#include "plugin.h"
+#include "utils/asprintf.h"
+#include "utils/log.h"
+#include "utils/uthash.h"
+#include "utils/utlist.h"
+#include "json/neu_json_fn.h"
+#include "json/neu_json_rw.h"
+
+#include "handle.h"
+#include "utils/http.h"
+#include "utils/time.h"
+
+#include "stream_handle.h"
+
+#define STREAM_TIMER_MS 100
+#define STREAM_PING_MS 15000
+#define STREAM_WRITE_TIMEOUT_MS 30000
+
+#define STREAM_HTTP_HEAD                  \
+    "HTTP/1.1 200 OK\r\n"                 \
+    "Content-Type: text/event-stream\r\n" \
+    "Cache-Control: no-cache\r\n"         \
+    "Connection: keep-alive\r\n"          \
+    "Access-Control-Allow-Origin: *\r\n"  \
+    "\r\n"
+
+#define STREAM_PING ": ping\n\n"
+
+typedef struct {
+    char *         name;
+    char *         json;    // tag object of the latest value
+    size_t         len;     // length of json
+    uint64_t       version; // group version when the value changed
+    UT_hash_handle hh;
+} stream_tag_t;
+
+typedef struct stream_client stream_client_t;
+typedef struct stream_group  stream_group_t;
+
+// a subscribe or unsubscribe request of the streams, the ctx of the request
+typedef struct stream_req {
+    neu_reqresp_type_e type;
+    char               driver[NEU_NODE_NAME_LEN];
+    char               group[NEU_GROUP_NAME_LEN];
+    stream_group_t *   sub; // the group a subscribe request is for
+    struct stream_req *next;
+} stream_req_t;
+
+// a group subscribed by the REST node on behalf of its streams
+struct stream_group {
+    char                 driver[NEU_NODE_NAME_LEN];
+    char                 group[NEU_GROUP_NAME_LEN];
+    char *               head; // `{"node": "", "group": ""` of the events
+    uint64_t             version;
+    int64_t              timestamp;
+    stream_req_t *       sub_req; // the subscribe request not replied yet
+    stream_tag_t *       tags;    // in the order of versions
+    stream_client_t *    clients;
+    struct stream_group *next;
+};
+
+struct stream_client {
+    nng_http_conn *  conn;
+    nng_aio *        aio;
+    stream_group_t * group;
+    char **          tags; // sorted, all tags of the group if n_tag is 0
+    int              n_tag;
+    int64_t          interval; // least milliseconds between two events
+    int64_t          last;     // when the last event was sent
+    int64_t          last_io;  // when the last write was started
+    uint64_t         sent;     // group version sent
+    bool             busy;     // a write is in flight
+    bool             closed;
+    char *           buf;
+    stream_client_t *next;
+};
+
+typedef struct {
+    pthread_mutex_t    mtx;
+    neu_plugin_t *     plugin;
+    neu_events_t *     events;
+    neu_event_timer_t *timer;
+    stream_group_t *   groups;
+    stream_client_t *  closed; // freed by the timer once the write is done
+    stream_req_t *     reqs;   // requests sent and not replied yet
+} stream_ctx_t;
+
+static stream_ctx_t stream_ctx = {
+    .mtx = PTHREAD_MUTEX_INITIALIZER,
+};
+
+static void client_flush(stream_client_t *client, int64_t now);
+
+static int str_cmp(const void *a, const void *b)
+{
+    return strcmp(*(char *const *) a, *(char *const *) b);
+}
+
+static bool client_want(stream_client_t *client, const char *tag)
+{
+    return 0 == client->n_tag ||
+        NULL !=
+        bsearch(&tag, client->tags, client->n_tag, sizeof(char *), str_cmp);
+}
+
+// the lock is held
+static void client_write(stream_client_t *client, char *buf, size_t len,
+                         int64_t now)
+{
+    nng_iov iov = {
+        .iov_buf = buf,
+        .iov_len = len,
+    };
+
+    if (NULL == buf) {
+        return;
+    }
+
+    free(client->buf);
+    client->buf     = buf;
+    client->busy    = true;
+    client->last_io = now;
+
+    nng_aio_set_iov(client->aio, 1, &iov);
+    nng_aio_set_timeout(client->aio, STREAM_WRITE_TIMEOUT_MS);
+    nng_http_conn_write_all(client->conn, client->aio);
+}
+
+// the lock is held, the request is the ctx of its forwarded copy and reply
+static int send_sub_req(neu_reqresp_type_e type, stream_group_t *group)
+{
+    neu_plugin_t *       plugin = stream_ctx.plugin;
+    neu_plugin_common_t *common = neu_plugin_to_plugin_common(plugin);
+    stream_req_t *       req    = calloc(1, sizeof(*req));
+    neu_reqresp_head_t   header = {
+        .ctx  = req,
+        .type = type,
+    };
+    int ret = 0;
+
+    if (NULL == req) {
+        return NEU_ERR_EINTERNAL;
+    }
+
+    req->type = type;
+    strcpy(req->driver, group->driver);
+    strcpy(req->group, group->group);
+
+    if (NEU_REQ_SUBSCRIBE_GROUP == type) {
+        neu_req_subscribe_t cmd = { 0 };
+        strcpy(cmd.app, common->name);
+        strcpy(cmd.driver, group->driver);
+        strcpy(cmd.group, group->group);
+        ret = neu_plugin_op(plugin, header, &cmd);
+    } else {
+        neu_req_unsubscribe_t cmd = { 0 };
+        strcpy(cmd.app, common->name);
+        strcpy(cmd.driver, group->driver);
+        strcpy(cmd.group, group->group);
+        ret = neu_plugin_op(plugin, header, &cmd);
+    }
+
+    if (0 != ret) {
+        free(req);
+        return NEU_ERR_IS_BUSY;
+    }
+
+    if (NEU_REQ_SUBSCRIBE_GROUP == type) {
+        req->sub       = group;
+        group->sub_req = req;
+    }
+    LL_PREPEND(stream_ctx.reqs, req);
+    return 0;
+}
+
+static stream_req_t *req_find(void *ctx)
+{
+    stream_req_t *req = NULL;
+
+    LL_FOREACH(stream_ctx.reqs, req)
+    {
+        if (req == ctx) {
+            return req;
+        }
+    }
+
+    return NULL;
+}
+
+static int group_set_head(stream_group_t *group)
+{
+    void *          json    = neu_json_encode_new();
+    char *          result  = NULL;
+    neu_json_elem_t elems[] = {
+        {
+            .name      = "node",
+            .t         = NEU_JSON_STR,
+            .v.val_str = group->driver,
+        },
+        {
+            .name      = "group",
+            .t         = NEU_JSON_STR,
+            .v.val_str = group->group,
+        },
+    };
+
+    if (NULL == json) {
+        return -1;
+    }
+
+    if (0 == neu_json_encode_field(json, elems, NEU_JSON_ELEM_SIZE(elems))) {
+        neu_json_encode(json, &result);
+    }
+    neu_json_encode_free(json);
+
+    if (NULL == result) {
+        return -1;
+    }
+
+    // the other members are appended to the object
+    result[strlen(result) - 1] = '\0';
+    free(group->head);
+    group->head = result;
+    return 0;
+}
+
+static stream_group_t *group_find(const char *driver, const char *group)
+{
+    stream_group_t *grp = NULL;
+
+    LL_FOREACH(stream_ctx.groups, grp)
+    {
+        if (0 == strcmp(grp->driver, driver) &&
+            0 == strcmp(grp->group, group)) {
+            return grp;
+        }
+    }
+
+    return NULL;
+}
+
+// the lock is held
+static stream_group_t *group_get(const char *driver, const char *group,
+                                 int *error)
+{
+    stream_group_t *grp = group_find(driver, group);
+
+    if (NULL != grp) {
+        return grp;
+    }
+
+    grp = calloc(1, sizeof(*grp));
+    if (NULL == grp) {
+        *error = NEU_ERR_EINTERNAL;
+        return NULL;
+    }
+
+    strcpy(grp->driver, driver);
+    strcpy(grp->group, group);
+    if (0 != group_set_head(grp)) {
+        free(grp);
+        *error = NEU_ERR_EINTERNAL;
+        return NULL;
+    }
+
+    *error = send_sub_req(NEU_REQ_SUBSCRIBE_GROUP, grp);
+    if (0 != *error) {
+        free(grp->head);
+        free(grp);
+        return NULL;
+    }
+
+    LL_PREPEND(stream_ctx.groups, grp);
+    return grp;
+}
+
+// the lock is held
+static void group_free(stream_group_t *group, bool unsubscribe)
+{
+    stream_tag_t *tag = NULL, *tmp = NULL;
+
+    LL_DELETE(stream_ctx.groups, group);
+    if (NULL != group->sub_req) {
+        group->sub_req->sub = NULL;
+    }
+    if (unsubscribe && 0 != send_sub_req(NEU_REQ_UNSUBSCRIBE_GROUP, group)) {
+        nlog_warn("stream unsubscribe %s:%s fail", group->driver,
+                  group->group);
+    }
+
+    HASH_ITER(hh, group->tags, tag, tmp)
+    {
+        HASH_DEL(group->tags, tag);
+        free(tag->name);
+        free(tag->json);
+        free(tag);
+    }
+    free(group->head);
+    free(group);
+}
+
+// the lock is held, the last client of a group unsubscribes it
+static void client_close(stream_client_t *client, bool unsubscribe)
+{
+    stream_group_t *group = client->group;
+
+    if (client->closed) {
+        return;
+    }
+
+    client->closed = true;
+    client->group  = NULL;
+    LL_DELETE(group->clients, client);
+    LL_PREPEND(stream_ctx.closed, client);
+
+    if (NULL == group->clients) {
+        group_free(group, unsubscribe);
+    }
+}
+
+// the lock is held, tells the clients of a group why they are closed
+static void group_close(stream_group_t *group, int error, bool unsubscribe)
+{
+    stream_client_t *client = NULL, *tmp = NULL;
+    int64_t          now    = neu_time_ms();
+
+    LL_FOREACH_SAFE(group->clients, client, tmp)
+    {
+        if (!client->busy) {
+            char *buf = NULL;
+            int   len = neu_asprintf(
+                &buf, "event: error\ndata: {\"error\": %d}\n\n", error);
+            if (len > 0) {
+                client_write(client, buf, len, now);
+            }
+        }
+        client_close(client, unsubscribe);
+    }
+}
+
+static void client_free(stream_client_t *client)
+{
+    if (NULL != client->conn) {
+        nng_http_conn_close(client->conn);
+    }
+    nng_aio_free(client->aio);
+    for (int i = 0; i < client->n_tag; i++) {
+        free(client->tags[i]);
+    }
+    free(client->tags);
+    free(client->buf);
+    free(client);
+}
+
+// frees the closed clients without a write in flight, or all of them
+static void sweep(bool all)
+{
+    stream_client_t *client = NULL, *tmp = NULL;
+    stream_client_t *done = NULL;
+
+    pthread_mutex_lock(&stream_ctx.mtx);
+    LL_FOREACH_SAFE(stream_ctx.closed, client, tmp)
+    {
+        if (all || !client->busy) {
+            LL_DELETE(stream_ctx.closed, client);
+            LL_PREPEND(done, client);
+        }
+    }
+    pthread_mutex_unlock(&stream_ctx.mtx);
+
+    // waits for the write callbacks, which take the lock
+    LL_FOREACH_SAFE(done, client, tmp)
+    {
+        LL_DELETE(done, client);
+        client_free(client);
+    }
+}
+
+static void write_cb(void *arg)
+{
+    stream_client_t *client = arg;
+    int              rv     = nng_aio_result(client->aio);
+
+    pthread_mutex_lock(&stream_ctx.mtx);
+    client->busy = false;
+    free(client->buf);
+    client->buf = NULL;
+
+    if (!client->closed) {
+        if (0 != rv) {
+            nlog_info("stream %s:%s client write fail: %s",
+                      client->group->driver, client->group->group,
+                      nng_strerror(rv));
+            client_close(client, true);
+        } else {
+            // values changed while writing
+            client_flush(client, neu_time_ms());
+        }
+    }
+    pthread_mutex_unlock(&stream_ctx.mtx);
+}
+
+static stream_tag_t *tags_first_after(stream_group_t *group, uint64_t version)
+{
+    stream_tag_t *tag = NULL;
+
+    if (NULL == group->tags) {
+        return NULL;
+    }
+
+    tag = ELMT_FROM_HH(group->tags->hh.tbl, group->tags->hh.tbl->tail);
+    if (tag->version <= version) {
+        return NULL;
+    }
+
+    while (NULL != tag->hh.prev &&
+           ((stream_tag_t *) tag->hh.prev)->version > version) {
+        tag = tag->hh.prev;
+    }
+
+    return tag;
+}
+
+// the lock is held, sends the tags changed since the last event
+static void client_flush(stream_client_t *client, int64_t now)
+{
+    stream_group_t *group    = client->group;
+    stream_tag_t *  first    = NULL;
+    size_t          size     = 0;
+    size_t          len      = 0;
+    char *          buf      = NULL;
+    char            tail[64] = { 0 };
+    int             n_tail   = 0;
+
+    if (client->busy) {
+        return;
+    }
+
+    if (group->version <= client->sent ||
+        (client->interval > 0 && now - client->last < client->interval)) {
+        if (now - client->last_io >= STREAM_PING_MS) {
+            client_write(client, strdup(STREAM_PING), strlen(STREAM_PING),
+                         now);
+        }
+        return;
+    }
+
+    first = tags_first_after(group, client->sent);
+    for (stream_tag_t *tag = first; NULL != tag; tag = tag->hh.next) {
+        if (client_want(client, tag->name)) {
+            size += tag->len + 1;
+        }
+    }
+    client->sent = group->version;
+    if (0 == size) {
+        return;
+    }
+
+    n_tail = snprintf(tail, sizeof(tail), ", \"timestamp\": %" PRId64
+                      ", \"tags\": [",
+                      group->timestamp);
+    size += strlen("data: ") + strlen(group->head) + n_tail +
+        strlen("]}\n\n") + 1;
+    buf = malloc(size);
+    if (NULL == buf) {
+        return;
+    }
+
+    len = sprintf(buf, "data: %s%s", group->head, tail);
+    for (stream_tag_t *tag = first; NULL != tag; tag = tag->hh.next) {
+        if (client_want(client, tag->name)) {
+            if (buf[len - 1] != '[') {
+                buf[len++] = ',';
+            }
+            memcpy(buf + len, tag->json, tag->len);
+            len += tag->len;
+        }
+    }
+    memcpy(buf + len, "]}\n\n", 4);
+    len += 4;
+
+    client->last = now;
+    client_write(client, buf, len, now);
+}
+
+static int timer_cb(void *usr_data)
+{
+    stream_group_t * group  = NULL;
+    stream_client_t *client = NULL;
+    int64_t          now    = neu_time_ms();
+
+    (void) usr_data;
+
+    pthread_mutex_lock(&stream_ctx.mtx);
+    LL_FOREACH(stream_ctx.groups, group)
+    {
+        LL_FOREACH(group->clients, client) { client_flush(client, now); }
+    }
+    pthread_mutex_unlock(&stream_ctx.mtx);
+
+    sweep(false);
+    return 0;
+}
+
+int handle_stream_init(neu_plugin_t *plugin)
+{
+    neu_event_timer_param_t param = {
+        .second      = 0,
+        .millisecond = STREAM_TIMER_MS,
+        .cb          = timer_cb,
+        .usr_data    = NULL,
+        .type        = NEU_EVENT_TIMER_NOBLOCK,
+    };
+
+    stream_ctx.plugin = plugin;
+    stream_ctx.events = neu_event_new();
+    if (NULL == stream_ctx.events) {
+        return -1;
+    }
+
+    stream_ctx.timer = neu_event_add_timer(stream_ctx.events, param);
+    if (NULL == stream_ctx.timer) {
+        neu_event_close(stream_ctx.events);
+        stream_ctx.events = NULL;
+        return -1;
+    }
+
+    return 0;
+}
+
+void handle_stream_uninit()
+{
+    stream_group_t *group = NULL, *tmp = NULL;
+    stream_req_t *  req   = NULL, *req_tmp = NULL;
+
+    if (NULL != stream_ctx.events) {
+        neu_event_del_timer(stream_ctx.events, stream_ctx.timer);
+        neu_event_close(stream_ctx.events);
+        stream_ctx.events = NULL;
+        stream_ctx.timer  = NULL;
+    }
+
+    pthread_mutex_lock(&stream_ctx.mtx);
+    LL_FOREACH_SAFE(stream_ctx.groups, group, tmp)
+    {
+        group_close(group, NEU_ERR_NODE_NOT_RUNNING, false);
+    }
+    LL_FOREACH_SAFE(stream_ctx.reqs, req, req_tmp)
+    {
+        LL_DELETE(stream_ctx.reqs, req);
+        free(req);
+    }
+    pthread_mutex_unlock(&stream_ctx.mtx);
+
+    sweep(true);
+}
+
+static int parse_tags(nng_aio *aio, stream_client_t *client)
+{
+    size_t      len  = 0;
+    const char *s    = neu_http_get_param(aio, "tags", &len);
+    char *      buf  = NULL;
+    char *      save = NULL;
+
+    if (NULL == s || 0 == len) {
+        return 0;
+    }
+
+    buf = calloc(1, len + 1);
+    if (NULL == buf) {
+        return NEU_ERR_EINTERNAL;
+    }
+
+    if (neu_url_decode(s, len, buf, len + 1) < 0) {
+        free(buf);
+        return NEU_ERR_PARAM_IS_WRONG;
+    }
+
+    // at most one name per comma
+    client->tags = calloc(len / 2 + 1, sizeof(char *));
+    if (NULL == client->tags) {
+        free(buf);
+        return NEU_ERR_EINTERNAL;
+    }
+
+    for (char *name = strtok_r(buf, ",", &save); NULL != name;
+         name = strtok_r(NULL, ",", &save)) {
+        client->tags[client->n_tag] = strdup(name);
+        if (NULL == client->tags[client->n_tag]) {
+            free(buf);
+            return NEU_ERR_EINTERNAL;
+        }
+        client->n_tag += 1;
+    }
+    free(buf);
+
+    qsort(client->tags, client->n_tag, sizeof(char *), str_cmp);
+    return 0;
+}
+
+static stream_client_t *client_new(nng_aio *aio, int *error)
+{
+    stream_client_t *client   = calloc(1, sizeof(*client));
+    uintmax_t        interval = 0;
+
+    if (NULL == client) {
+        *error = NEU_ERR_EINTERNAL;
+        return NULL;
+    }
+
+    if (0 != nng_aio_alloc(&client->aio, write_cb, client)) {
+        free(client);
+        *error = NEU_ERR_EINTERNAL;
+        return NULL;
+    }
+
+    *error = parse_tags(aio, client);
+    if (0 == *error && 0 == neu_http_get_param_uintmax(aio, "interval",
+                                                       &interval)) {
+        client->interval = interval < INT32_MAX ? interval : INT32_MAX;
+    }
+
+    if (0 != *error) {
+        client_free(client);
+        return NULL;
+    }
+
+    return client;
+}
+
+void handle_read_stream(nng_aio *aio)
+{
+    char             node[NEU_NODE_NAME_LEN]   = { 0 };
+    char             group[NEU_GROUP_NAME_LEN] = { 0 };
+    int              ret                       = 0;
+    stream_group_t * grp                       = NULL;
+    stream_client_t *client                    = NULL;
+
+    NEU_VALIDATE_JWT(aio);
+
+    if (neu_http_get_param_str(aio, "node", node, sizeof(node)) <= 0 ||
+        neu_http_get_param_str(aio, "group", group, sizeof(group)) <= 0) {
+        NEU_JSON_RESPONSE_ERROR(NEU_ERR_PARAM_IS_WRONG, {
+            neu_http_response(aio, NEU_ERR_PARAM_IS_WRONG, result_error);
+        })
+        return;
+    }
+
+    client = client_new(aio, &ret);
+    if (NULL == client) {
+        NEU_JSON_RESPONSE_ERROR(
+            ret, { neu_http_response(aio, ret, result_error); })
+        return;
+    }
+
+    pthread_mutex_lock(&stream_ctx.mtx);
+    grp = group_get(node, group, &ret);
+    if (NULL == grp) {
+        pthread_mutex_unlock(&stream_ctx.mtx);
+        client_free(client);
+        NEU_JSON_RESPONSE_ERROR(
+            ret, { neu_http_response(aio, ret, result_error); })
+        return;
+    }
+
+    // the connection is written by the stream from now on
+    client->conn = nng_aio_get_input(aio, 2);
+    if (0 != nng_http_hijack(client->conn)) {
+        if (NULL == grp->clients) {
+            group_free(grp, true);
+        }
+        pthread_mutex_unlock(&stream_ctx.mtx);
+        client->conn = NULL;
+        client_free(client);
+        NEU_JSON_RESPONSE_ERROR(NEU_ERR_EINTERNAL, {
+            neu_http_response(aio, NEU_ERR_EINTERNAL, result_error);
+        })
+        return;
+    }
+
+    client->group = grp;
+    LL_PREPEND(grp->clients, client);
+    // the current values follow the head once it is written
+    client_write(client, strdup(STREAM_HTTP_HEAD), strlen(STREAM_HTTP_HEAD),
+                 neu_time_ms());
+    pthread_mutex_unlock(&stream_ctx.mtx);
+
+    nlog_info("stream %s:%s client open, tags: %d, interval: %" PRId64,
+              node, group, client->n_tag, client->interval);
+    neu_http_finish(aio);
+}
+
+void handle_stream_trans_data(neu_reqresp_trans_data_t *data)
+{
+    int             n_tag   = utarray_len(data->tags);
+    char **         jsons   = calloc(n_tag, sizeof(char *));
+    int             index   = 0;
+    stream_group_t *group   = NULL;
+    uint64_t        version = 0;
+    int64_t         now     = neu_time_ms();
+
+    if (NULL == jsons) {
+        return;
+    }
+
+    // encoded out of the lock
+    utarray_foreach(data->tags, neu_resp_tag_value_meta_t *, tag_value)
+    {
+        neu_json_read_resp_tag_t json_tag = { 0 };
+
+        neu_tag_value_to_json(tag_value, &json_tag);
+        neu_json_encode_by_fn(&json_tag, neu_json_encode_read_resp_tag,
+                              &jsons[index++]);
+        if (json_tag.n_meta > 0) {
+            free(json_tag.metas);
+        }
+        if (json_tag.t == NEU_JSON_ARRAY_STR) {
+            for (int j = 0; j < json_tag.value.val_array_str.length; j++) {
+                free(json_tag.value.val_array_str.p_strs[j]);
+            }
+        }
+    }
+
+    pthread_mutex_lock(&stream_ctx.mtx);
+    group = group_find(data->driver, data->group);
+    if (NULL == group) {
+        pthread_mutex_unlock(&stream_ctx.mtx);
+        for (int i = 0; i < n_tag; i++) {
+            free(jsons[i]);
+        }
+        free(jsons);
+        return;
+    }
+
+    version = group->version + 1;
+    index   = 0;
+    utarray_foreach(data->tags, neu_resp_tag_value_meta_t *, tag_value)
+    {
+        char *        json = jsons[index++];
+        stream_tag_t *tag  = NULL;
+
+        HASH_FIND_STR(group->tags, tag_value->tag, tag);
+        if (NULL == json || (NULL != tag && 0 == strcmp(tag->json, json))) {
+            free(json);
+            continue;
+        }
+
+        if (NULL == tag) {
+            tag = calloc(1, sizeof(*tag));
+            if (NULL == tag) {
+                free(json);
+                continue;
+            }
+            tag->name = strdup(tag_value->tag);
+            if (NULL == tag->name) {
+                free(tag);
+                free(json);
+                continue;
+            }
+        } else {
+            HASH_DEL(group->tags, tag);
+            free(tag->json);
+        }
+
+        // changed tags move to the end
+        tag->json    = json;
+        tag->len     = strlen(json);
+        tag->version = version;
+        HASH_ADD_KEYPTR(hh, group->tags, tag->name, strlen(tag->name), tag);
+        group->version = version;
+    }
+    free(jsons);
+    group->timestamp = now;
+
+    stream_client_t *client = NULL;
+    LL_FOREACH(group->clients, client) { client_flush(client, now); }
+    pthread_mutex_unlock(&stream_ctx.mtx);
+}
+
+bool handle_stream_sub_resp(void *ctx, neu_resp_error_t *error)
+{
+    stream_req_t *  req   = NULL;
+    stream_group_t *group = NULL;
+
+    pthread_mutex_lock(&stream_ctx.mtx);
+    req = req_find(ctx);
+    if (NULL == req) {
+        pthread_mutex_unlock(&stream_ctx.mtx);
+        return false;
+    }
+
+    LL_DELETE(stream_ctx.reqs, req);
+    group = req->sub;
+    if (NULL != group) {
+        group->sub_req = NULL;
+    }
+
+    if (NULL != group && 0 != error->error &&
+        NEU_ERR_GROUP_ALREADY_SUBSCRIBED != error->error) {
+        nlog_warn("stream subscribe %s:%s fail: %d", group->driver,
+                  group->group, error->error);
+        group_close(group, error->error, false);
+    } else if (NEU_REQ_UNSUBSCRIBE_GROUP == req->type && 0 != error->error) {
+        nlog_warn("stream unsubscribe %s:%s fail: %d", req->driver,
+                  req->group, error->error);
+    }
+    pthread_mutex_unlock(&stream_ctx.mtx);
+
+    free(req);
+    return true;
+}
+
+void handle_stream_unsubscribe(void *ctx, neu_req_unsubscribe_t *req)
+{
+    stream_group_t *group = NULL;
+
+    pthread_mutex_lock(&stream_ctx.mtx);
+    // the copy of an unsubscribe of the streams is forwarded before the reply,
+    // a group opened again since then is left subscribed
+    if (NULL == req_find(ctx)) {
+        // unsubscribed through the api rather than by the last client
+        group = group_find(req->driver, req->group);
+    }
+    if (NULL != group) {
+        group_close(group, NEU_ERR_GROUP_NOT_SUBSCRIBE, false);
+    }
+    pthread_mutex_unlock(&stream_ctx.mtx);
+}
+
+void handle_stream_update_group(neu_req_update_group_t *req)
+{
+    stream_group_t *group = NULL;
+
+    pthread_mutex_lock(&stream_ctx.mtx);
+    group = group_find(req->driver, req->group);
+    if (NULL != group && 0 != strcmp(req->group, req->new_name)) {
+        strcpy(group->group, req->new_name);
+        if (0 != group_set_head(group)) {
+            group_close(group, NEU_ERR_EINTERNAL, true);
+        }
+    }
+    pthread_mutex_unlock(&stream_ctx.mtx);
+}
+
+void handle_stream_del_group(neu_req_del_group_t *req)
+{
+    stream_group_t *group = NULL;
+
+    pthread_mutex_lock(&stream_ctx.mtx);
+    group = group_find(req->driver, req->group);
+    if (NULL != group) {
+        group_close(group, NEU_ERR_GROUP_NOT_EXIST, false);
+    }
+    pthread_mutex_unlock(&stream_ctx.mtx);
+}
+
+void handle_stream_update_node(neu_req_update_node_t *req)
+{
+    stream_group_t *group = NULL, *tmp = NULL;
+
+    pthread_mutex_lock(&stream_ctx.mtx);
+    LL_FOREACH_SAFE(stream_ctx.groups, group, tmp)
+    {
+        if (0 == strcmp(group->driver, req->node)) {
+            strcpy(group->driver, req->new_name);
+            if (0 != group_set_head(group)) {
+                group_close(group, NEU_ERR_EINTERNAL, true);
+            }
+        }
+    }
+    pthread_mutex_unlock(&stream_ctx.mtx);
+}
+
+void handle_stream_del_node(neu_reqresp_node_deleted_t *req)
+{
+    stream_group_t *group = NULL, *tmp = NULL;
+
+    pthread_mutex_lock(&stream_ctx.mtx);
+    LL_FOREACH_SAFE(stream_ctx.groups, group, tmp)
+    {
+        if (0 == strcmp(group->driver, req->node)) {
+            group_close(group, NEU_ERR_NODE_NOT_EXIST, false);
+        }
+    }
+    pthread_mutex_unlock(&stream_ctx.mtx);
+}
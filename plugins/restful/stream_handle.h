@@ -0,0 +1,51 @@
+/**
+ * NEURON IIoT System for Industry 4.0
+ * Copyright (C) 2020-2022 EMQ Technologies Co., Ltd All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ **/
+
+#ifndef _NEU_STREAM_HANDLE_H_
+#define _NEU_STREAM_HANDLE_H_
+
+#include <nng/nng.h>
+
+#include "adapter.h"
+
+/*
+ * Live tag values over Server-Sent Events.
+ *
+ * GET /api/v2/read/stream?node=&group=[&tags=a,b][&interval=ms] keeps the
+ * connection open. The REST node subscribes the group while any stream of it
+ * is open, and every event carries the tags changed since the last event of
+ * the connection. A connection gets at most one event per `interval`, and one
+ * that is still writing misses the intermediate values of a tag.
+ */
+
+int  handle_stream_init(neu_plugin_t *plugin);
+void handle_stream_uninit();
+void handle_read_stream(nng_aio *aio);
+
+void handle_stream_trans_data(neu_reqresp_trans_data_t *data);
+// the manager response to a subscribe or unsubscribe request of the streams,
+// false if `ctx` is not one of their requests
+bool handle_stream_sub_resp(void *ctx, neu_resp_error_t *error);
+void handle_stream_unsubscribe(void *ctx, neu_req_unsubscribe_t *req);
+void handle_stream_update_group(neu_req_update_group_t *req);
+void handle_stream_del_group(neu_req_del_group_t *req);
+void handle_stream_update_node(neu_req_update_node_t *req);
+void handle_stream_del_node(neu_reqresp_node_deleted_t *req);
+
+#endif
@@ -0,0 +1,521 @@
+/**
+ * NEURON IIoT System for Industry 4.0
+ * Copyright (C) 2020-2022 EMQ Technologies Co., Ltd All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ **/
+
+/*
+ * Modbus TCP load generator for benchmarking the gateway.
+ *
+ * Every listening port hosts `units` unit ids with a synthetic register space,
+ * so thousands of devices can be simulated without keeping their registers in
+ * memory. Each request can be delayed, dropped or answered with an exception,
+ * and the request rate is printed periodically.
+ */
+#include <arpa/inet.h>
+#include <errno.h>
+#include <getopt.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_PORTS 1024
+#define MAX_UNITS 247
+
+#define EXCEPTION_ILLEGAL_FUNCTION 0x01
+#define EXCEPTION_ILLEGAL_VALUE 0x03
+#define EXCEPTION_DEVICE_FAILURE 0x04
+#define EXCEPTION_TARGET_FAILED 0x0B
+
+struct bench_option {
+    uint16_t port;
+    uint16_t n_port;
+    uint16_t units;
+    uint32_t latency;
+    uint32_t jitter;
+    double   drop;
+    double   exception;
+    uint32_t stats;
+};
+
+struct bench_stats {
+    uint64_t requests;
+    uint64_t responses;
+    uint64_t drops;
+    uint64_t exceptions;
+    uint64_t registers;
+    int64_t  connections;
+};
+
+struct bench_client {
+    int      fd;
+    uint16_t port;
+};
+
+static struct bench_option option = {
+    .port      = 5020,
+    .n_port    = 1,
+    .units     = MAX_UNITS,
+    .latency   = 0,
+    .jitter    = 0,
+    .drop      = 0,
+    .exception = 0,
+    .stats     = 5,
+};
+static struct bench_stats stats   = { 0 };
+static volatile bool      exiting = false;
+
+static inline void stats_add(uint64_t *counter, uint64_t n)
+{
+    __atomic_add_fetch(counter, n, __ATOMIC_RELAXED);
+}
+
+static inline uint64_t stats_get(uint64_t *counter)
+{
+    return __atomic_load_n(counter, __ATOMIC_RELAXED);
+}
+
+static bool chance(unsigned int *seed, double percent)
+{
+    return percent > 0 && rand_r(seed) % 10000 < percent * 100;
+}
+
+static void sleep_ms(uint32_t ms)
+{
+    struct timespec t = { .tv_sec = ms / 1000, .tv_nsec = ms % 1000 * 1000000 };
+
+    while (nanosleep(&t, &t) == -1 && errno == EINTR) {
+    }
+}
+
+static int recv_all(int fd, uint8_t *buf, size_t len)
+{
+    size_t done = 0;
+
+    while (done < len) {
+        ssize_t ret = recv(fd, buf + done, len - done, 0);
+        if (ret == 0) {
+            return -1;
+        }
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        done += ret;
+    }
+
+    return 0;
+}
+
+static int send_all(int fd, const uint8_t *buf, size_t len)
+{
+    size_t done = 0;
+
+    while (done < len) {
+        ssize_t ret = send(fd, buf + done, len - done, MSG_NOSIGNAL);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        done += ret;
+    }
+
+    return 0;
+}
+
+// synthetic register value, stable per port, unit and address
+static inline uint16_t register_value(uint16_t port, uint8_t unit,
+                                      uint16_t address)
+{
+    return (uint16_t)(port * 31 + unit * 257 + address);
+}
+
+static uint16_t exception_pdu(uint8_t *pdu, uint8_t code)
+{
+    pdu[0] |= 0x80;
+    pdu[1] = code;
+    return 2;
+}
+
+/*
+ * Build the response pdu in place, `pdu` holds the request of `len` bytes
+ * and has room for the largest response. Returns the response pdu length.
+ */
+static uint16_t handle_pdu(uint16_t port, uint8_t unit, uint8_t *pdu,
+                           uint16_t len)
+{
+    uint8_t  function = pdu[0];
+    uint16_t address  = 0;
+    uint16_t n        = 0;
+
+    if (len < 5) {
+        return exception_pdu(pdu, EXCEPTION_ILLEGAL_VALUE);
+    }
+
+    address = pdu[1] << 8 | pdu[2];
+    n       = pdu[3] << 8 | pdu[4];
+
+    switch (function) {
+    case 0x01:
+    case 0x02:
+        if (n == 0 || n > 2000) {
+            return exception_pdu(pdu, EXCEPTION_ILLEGAL_VALUE);
+        }
+        pdu[1] = (n + 7) / 8;
+        memset(&pdu[2], 0, pdu[1]);
+        for (uint16_t i = 0; i < n; i++) {
+            if (register_value(port, unit, address + i) & 0x1) {
+                pdu[2 + i / 8] |= 1 << i % 8;
+            }
+        }
+        stats_add(&stats.registers, n);
+        return 2 + pdu[1];
+    case 0x03:
+    case 0x04:
+        if (n == 0 || n > 125) {
+            return exception_pdu(pdu, EXCEPTION_ILLEGAL_VALUE);
+        }
+        pdu[1] = n * 2;
+        for (uint16_t i = 0; i < n; i++) {
+            uint16_t value = register_value(port, unit, address + i);
+
+            pdu[2 + i * 2]     = value >> 8;
+            pdu[2 + i * 2 + 1] = value & 0xff;
+        }
+        stats_add(&stats.registers, n);
+        return 2 + pdu[1];
+    case 0x05:
+    case 0x06:
+        stats_add(&stats.registers, 1);
+        return 5;
+    case 0x0F:
+    case 0x10:
+        if (n == 0 || len < 6 || len < 6 + pdu[5]) {
+            return exception_pdu(pdu, EXCEPTION_ILLEGAL_VALUE);
+        }
+        stats_add(&stats.registers, n);
+        return 5;
+    default:
+        return exception_pdu(pdu, EXCEPTION_ILLEGAL_FUNCTION);
+    }
+}
+
+static void *client_routine(void *arg)
+{
+    struct bench_client *client = (struct bench_client *) arg;
+    unsigned int         seed   = (unsigned int) client->fd ^ time(NULL);
+    uint8_t              buf[7 + 260];
+
+    __atomic_add_fetch(&stats.connections, 1, __ATOMIC_RELAXED);
+
+    while (!exiting) {
+        if (recv_all(client->fd, buf, 7) != 0) {
+            break;
+        }
+
+        uint16_t len  = buf[4] << 8 | buf[5];
+        uint8_t  unit = buf[6];
+
+        if (len < 2 || len > 254 || buf[2] != 0 || buf[3] != 0) {
+            break;
+        }
+        if (recv_all(client->fd, buf + 7, len - 1) != 0) {
+            break;
+        }
+
+        stats_add(&stats.requests, 1);
+
+        if (chance(&seed, option.drop)) {
+            stats_add(&stats.drops, 1);
+            continue;
+        }
+
+        uint32_t delay = option.latency;
+        if (option.jitter > 0) {
+            delay += rand_r(&seed) % (option.jitter + 1);
+        }
+        if (delay > 0) {
+            sleep_ms(delay);
+        }
+
+        if (unit == 0 || unit > option.units) {
+            len = exception_pdu(buf + 7, EXCEPTION_TARGET_FAILED);
+        } else if (chance(&seed, option.exception)) {
+            len = exception_pdu(buf + 7, EXCEPTION_DEVICE_FAILURE);
+        } else {
+            len = handle_pdu(client->port, unit, buf + 7, len - 1);
+        }
+
+        if (buf[7] & 0x80) {
+            stats_add(&stats.exceptions, 1);
+        }
+
+        buf[4] = (len + 1) >> 8;
+        buf[5] = (len + 1) & 0xff;
+        if (send_all(client->fd, buf, 7 + len) != 0) {
+            break;
+        }
+        stats_add(&stats.responses, 1);
+    }
+
+    __atomic_sub_fetch(&stats.connections, 1, __ATOMIC_RELAXED);
+    close(client->fd);
+    free(client);
+    return NULL;
+}
+
+static int listen_port(uint16_t port)
+{
+    struct sockaddr_in addr = { 0 };
+    int                on   = 1;
+    int                fd   = socket(AF_INET, SOCK_STREAM, 0);
+
+    if (fd < 0) {
+        return -1;
+    }
+
+    addr.sin_family      = AF_INET;
+    addr.sin_port        = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    if (bind(fd, (struct sockaddr *) &addr, sizeof(addr)) != 0 ||
+        listen(fd, 128) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+static void *listen_routine(void *arg)
+{
+    uint16_t       port = (uint16_t)(uintptr_t) arg;
+    pthread_attr_t attr;
+    int            fd = listen_port(port);
+
+    if (fd < 0) {
+        fprintf(stderr, "listen on port %hu fail: %s\n", port,
+                strerror(errno));
+        exit(1);
+    }
+
+    // keep the stack small, one thread serves one connection
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, 64 * 1024);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+    while (!exiting) {
+        int       on  = 1;
+        pthread_t tid = 0;
+        int       cfd = accept(fd, NULL, NULL);
+
+        if (cfd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            fprintf(stderr, "accept on port %hu fail: %s\n", port,
+                    strerror(errno));
+            sleep_ms(100);
+            continue;
+        }
+
+        setsockopt(cfd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+        struct bench_client *client = calloc(1, sizeof(struct bench_client));
+        client->fd                  = cfd;
+        client->port                = port;
+        if (pthread_create(&tid, &attr, client_routine, client) != 0) {
+            close(cfd);
+            free(client);
+        }
+    }
+
+    pthread_attr_destroy(&attr);
+    close(fd);
+    return NULL;
+}
+
+static void print_stats(double seconds, struct bench_stats *last)
+{
+    struct bench_stats now = {
+        .requests    = stats_get(&stats.requests),
+        .responses   = stats_get(&stats.responses),
+        .drops       = stats_get(&stats.drops),
+        .exceptions  = stats_get(&stats.exceptions),
+        .registers   = stats_get(&stats.registers),
+        .connections = __atomic_load_n(&stats.connections, __ATOMIC_RELAXED),
+    };
+
+    printf("connections: %ld, req/s: %.1f, resp/s: %.1f, registers/s: %.1f, "
+           "drops: %lu, exceptions: %lu\n",
+           (long) now.connections,
+           (now.requests - last->requests) / seconds,
+           (now.responses - last->responses) / seconds,
+           (now.registers - last->registers) / seconds,
+           (unsigned long) now.drops, (unsigned long) now.exceptions);
+    fflush(stdout);
+
+    *last = now;
+}
+
+static void sig_handler(int sig)
+{
+    (void) sig;
+    exiting = true;
+}
+
+static void usage(const char *name)
+{
+    printf("%s [options]\n"
+           "  -p, --port <port>        first listening port (5020)\n"
+           "  -n, --ports <n>          number of listening ports (1)\n"
+           "  -u, --units <n>          unit ids per port, 1-247 (247)\n"
+           "  -l, --latency <ms>       latency added to each request (0)\n"
+           "  -j, --jitter <ms>        random extra latency, 0-jitter (0)\n"
+           "  -d, --drop <percent>     requests left unanswered (0)\n"
+           "  -e, --exception <pct>    requests answered with exception (0)\n"
+           "  -s, --stats <seconds>    statistics interval, 0 to disable (5)\n",
+           name);
+}
+
+static int parse_option(int argc, char *argv[])
+{
+    const struct option long_options[] = {
+        { "port", required_argument, NULL, 'p' },
+        { "ports", required_argument, NULL, 'n' },
+        { "units", required_argument, NULL, 'u' },
+        { "latency", required_argument, NULL, 'l' },
+        { "jitter", required_argument, NULL, 'j' },
+        { "drop", required_argument, NULL, 'd' },
+        { "exception", required_argument, NULL, 'e' },
+        { "stats", required_argument, NULL, 's' },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 },
+    };
+    int c = 0;
+
+    while ((c = getopt_long(argc, argv, "p:n:u:l:j:d:e:s:h", long_options,
+                            NULL)) != -1) {
+        switch (c) {
+        case 'p':
+            option.port = atoi(optarg);
+            break;
+        case 'n':
+            option.n_port = atoi(optarg);
+            break;
+        case 'u':
+            option.units = atoi(optarg);
+            break;
+        case 'l':
+            option.latency = atoi(optarg);
+            break;
+        case 'j':
+            option.jitter = atoi(optarg);
+            break;
+        case 'd':
+            option.drop = atof(optarg);
+            break;
+        case 'e':
+            option.exception = atof(optarg);
+            break;
+        case 's':
+            option.stats = atoi(optarg);
+            break;
+        default:
+            return -1;
+        }
+    }
+
+    if (option.port <= 1024 || option.n_port == 0 ||
+        option.n_port > MAX_PORTS || option.port + option.n_port > 65536) {
+        printf("invalid port range\n");
+        return -1;
+    }
+    if (option.units == 0 || option.units > MAX_UNITS) {
+        printf("units should be 1-%d\n", MAX_UNITS);
+        return -1;
+    }
+    if (option.drop < 0 || option.drop > 100 || option.exception < 0 ||
+        option.exception > 100) {
+        printf("rates should be 0-100\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    struct bench_stats last     = { 0 };
+    struct sigaction   sa       = { 0 };
+    uint32_t           interval = 0;
+
+    if (parse_option(argc, argv) != 0) {
+        usage(argv[0]);
+        return -1;
+    }
+
+    // no SA_RESTART, so the sleep below is interrupted on exit
+    sa.sa_handler = sig_handler;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    for (uint16_t i = 0; i < option.n_port; i++) {
+        pthread_t tid = 0;
+
+        if (pthread_create(&tid, NULL, listen_routine,
+                           (void *) (uintptr_t)(option.port + i)) != 0) {
+            fprintf(stderr, "start listen thread fail\n");
+            return -1;
+        }
+        pthread_detach(tid);
+    }
+
+    printf("modbus bench simulator, ports: %hu-%d, units: %hu, latency: %u "
+           "+ %u ms, drop: %.2f%%, exception: %.2f%%\n",
+           option.port, option.port + option.n_port - 1, option.units,
+           option.latency, option.jitter, option.drop, option.exception);
+    fflush(stdout);
+
+    while (!exiting) {
+        sleep(1);
+        interval += 1;
+        if (option.stats > 0 && interval >= option.stats) {
+            print_stats(interval, &last);
+            interval = 0;
+        }
+    }
+
+    printf("exit, requests: %lu, responses: %lu\n",
+           (unsigned long) stats_get(&stats.requests),
+           (unsigned long) stats_get(&stats.responses));
+    return 0;
+}
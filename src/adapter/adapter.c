@@ -37,6 +37,7 @@
 
 #include "adapter.h"
 #include "adapter_internal.h"
+#include "base/config_gen.h"
 #include "base/msg_internal.h"
 #include "driver/driver_internal.h"
 #include "errcodes.h"
@@ -74,6 +75,8 @@ static const adapter_callbacks_t callback_funs = {
 
 static __thread int create_adapter_error = 0;
 
+extern uint32_t app_workers;
+
 #define REGISTER_METRIC(adapter, name, init) \
     adapter_register_metric(adapter, name, name##_HELP, name##_TYPE, init);
 
@@ -111,14 +114,20 @@ void neu_adapter_set_error(int error)
 
 static void *adapter_consumer(void *arg)
 {
-    neu_adapter_t *adapter = (neu_adapter_t *) arg;
+    adapter_consumer_t *consumer = (adapter_consumer_t *) arg;
+    neu_adapter_t *     adapter  = consumer->adapter;
 
     while (1) {
         neu_msg_t *         msg    = NULL;
-        uint32_t            n      = adapter_msg_q_pop(adapter->msg_q, &msg);
-        neu_reqresp_head_t *header = neu_msg_get_header(msg);
+        int                 n      = adapter_msg_q_pop(consumer->msg_q, &msg);
+        neu_reqresp_head_t *header = NULL;
+
+        if (n < 0) {
+            break;
+        }
 
-        nlog_debug("adapter(%s) recv msg from: %s %p, type: %s, %u",
+        header = neu_msg_get_header(msg);
+        nlog_debug("adapter(%s) recv msg from: %s %p, type: %s, %d",
                    adapter->name, header->sender, header->ctx,
                    neu_reqresp_type_string(header->type), n);
         adapter->module->intf_funs->request(
@@ -130,6 +139,84 @@ static void *adapter_consumer(void *arg)
     return NULL;
 }
 
+static void adapter_consumers_start(neu_adapter_t *adapter)
+{
+    uint32_t n = adapter->module->trans_data_reentrant ? app_workers : 1;
+
+    adapter->consumers  = calloc(n, sizeof(adapter_consumer_t));
+    adapter->n_consumer = n;
+
+    for (uint32_t i = 0; i < n; ++i) {
+        adapter_consumer_t *consumer = &adapter->consumers[i];
+
+        consumer->adapter = adapter;
+        consumer->msg_q   = adapter_msg_q_new(adapter->name, 1024);
+        if (0 ==
+            pthread_create(&consumer->tid, NULL, adapter_consumer,
+                           (void *) consumer)) {
+            consumer->running = true;
+        } else {
+            nlog_error("adapter(%s) start consumer %" PRIu32 " fail",
+                       adapter->name, i);
+        }
+    }
+
+    if (n > 1) {
+        nlog_notice("adapter(%s) %" PRIu32 " trans data consumers",
+                    adapter->name, n);
+    }
+}
+
+// the consumers are out of the plugin once this returns, their queues stay
+// for the trans data still coming in until adapter_consumers_free
+static void adapter_consumers_stop(neu_adapter_t *adapter)
+{
+    for (uint32_t i = 0; i < adapter->n_consumer; ++i) {
+        adapter_msg_q_close(adapter->consumers[i].msg_q);
+    }
+
+    for (uint32_t i = 0; i < adapter->n_consumer; ++i) {
+        if (adapter->consumers[i].running) {
+            pthread_join(adapter->consumers[i].tid, NULL);
+            adapter->consumers[i].running = false;
+        }
+    }
+}
+
+static void adapter_consumers_free(neu_adapter_t *adapter)
+{
+    adapter_consumers_stop(adapter);
+
+    for (uint32_t i = 0; i < adapter->n_consumer; ++i) {
+        adapter_msg_q_free(adapter->consumers[i].msg_q);
+    }
+
+    free(adapter->consumers);
+    adapter->consumers  = NULL;
+    adapter->n_consumer = 0;
+}
+
+// data of a group always goes to the same consumer, and keeps its order
+static inline adapter_consumer_t *
+adapter_consumer_of(neu_adapter_t *adapter, neu_reqresp_trans_data_t *data)
+{
+    uint32_t h = 2166136261u; // FNV-1a
+
+    if (1 == adapter->n_consumer) {
+        return &adapter->consumers[0];
+    }
+
+    for (const char *p = data->driver; *p; ++p) {
+        h = (h ^ (uint8_t) *p) * 16777619u;
+    }
+    h = (h ^ '\0') * 16777619u;
+    for (const char *p = data->group; *p; ++p) {
+        h = (h ^ (uint8_t) *p) * 16777619u;
+    }
+
+    return &adapter->consumers[h % adapter->n_consumer];
+}
+
 static inline zlog_category_t *get_log_category(const char *node)
 {
     char name[NEU_NODE_NAME_LEN] = { 0 };
@@ -230,9 +317,7 @@ neu_adapter_t *neu_adapter_create(neu_adapter_info_t *info, bool load)
         neu_adapter_driver_init((neu_adapter_driver_t *) adapter);
         break;
     case NEU_NA_TYPE_APP: {
-        adapter->msg_q = adapter_msg_q_new(adapter->name, 1024);
-        pthread_create(&adapter->consumer_tid, NULL, adapter_consumer,
-                       (void *) adapter);
+        adapter_consumers_start(adapter);
         while (true) {
             // use port number to distinguish each Linux abstract domain socket
             port = neu_manager_get_port();
@@ -643,7 +728,9 @@ static int adapter_trans_data(enum neu_event_io_type type, int fd,
     }
 
     if (header->type == NEU_REQRESP_TRANS_DATA) {
-        if (adapter_msg_q_push(adapter->msg_q, msg) < 0) {
+        adapter_consumer_t *consumer = adapter_consumer_of(
+            adapter, (neu_reqresp_trans_data_t *) &header[1]);
+        if (adapter_msg_q_push(consumer->msg_q, msg) < 0) {
             nlog_warn("adapter: %s trans data msg q is full, drop msg",
                       adapter->name);
             neu_trans_data_free((neu_reqresp_trans_data_t *) &header[1]);
@@ -739,6 +826,12 @@ static int adapter_loop(enum neu_event_io_type type, int fd, void *usr_data)
         neu_resp_read_free((neu_resp_read_group_t *) &header[1]);
         neu_msg_free(msg);
         break;
+    case NEU_RESP_WRITE_TAGS:
+        adapter->module->intf_funs->request(
+            adapter->plugin, (neu_reqresp_head_t *) header, &header[1]);
+        neu_resp_write_tags_fini((neu_resp_write_tags_t *) &header[1]);
+        neu_msg_free(msg);
+        break;
     case NEU_REQ_READ_GROUP: {
         neu_resp_error_t error = { 0 };
 
@@ -978,6 +1071,7 @@ static int adapter_loop(enum neu_event_io_type type, int fd, void *usr_data)
         error.error = neu_adapter_set_setting(adapter, cmd->setting);
         if (error.error == NEU_ERR_SUCCESS) {
             adapter_storage_setting(adapter->name, cmd->setting);
+            neu_config_gen_bump(adapter->name, NULL);
             free(cmd->setting);
         } else {
             free(cmd->setting);
@@ -1084,6 +1178,7 @@ static int adapter_loop(enum neu_event_io_type type, int fd, void *usr_data)
         if (error.error == NEU_ERR_SUCCESS) {
             adapter_storage_add_group(adapter->name, cmd->group, cmd->interval,
                                       NULL);
+            neu_config_gen_bump(adapter->name, cmd->group);
         }
 
         neu_msg_exchange(header);
@@ -1107,6 +1202,8 @@ static int adapter_loop(enum neu_event_io_type type, int fd, void *usr_data)
         if (resp.error == NEU_ERR_SUCCESS) {
             adapter_storage_update_group(adapter->name, cmd->group,
                                          cmd->new_name, cmd->interval);
+            neu_config_gen_bump(adapter->name, cmd->group);
+            neu_config_gen_bump(adapter->name, cmd->new_name);
         }
 
         strcpy(resp.driver, cmd->driver);
@@ -1133,6 +1230,7 @@ static int adapter_loop(enum neu_event_io_type type, int fd, void *usr_data)
 
         if (error.error == NEU_ERR_SUCCESS) {
             adapter_storage_del_group(cmd->driver, cmd->group);
+            neu_config_gen_bump(adapter->name, cmd->group);
         }
 
         neu_msg_exchange(header);
@@ -1188,6 +1286,7 @@ static int adapter_loop(enum neu_event_io_type type, int fd, void *usr_data)
                     break;
                 }
             }
+            neu_config_gen_bump(adapter->name, cmd->group);
         } else {
             error.error = NEU_ERR_GROUP_NOT_ALLOW;
         }
@@ -1249,6 +1348,7 @@ static int adapter_loop(enum neu_event_io_type type, int fd, void *usr_data)
             // we have added some tags, try to persist
             adapter_storage_add_tags(cmd->driver, cmd->group, cmd->tags,
                                      resp.index);
+            neu_config_gen_bump(adapter->name, cmd->group);
         }
 
         for (uint16_t i = 0; i < cmd->n_tag; i++) {
@@ -1277,6 +1377,9 @@ static int adapter_loop(enum neu_event_io_type type, int fd, void *usr_data)
                                              cmd->groups[i].n_tag);
                 }
             }
+            for (int i = 0; i < cmd->n_group; i++) {
+                neu_config_gen_bump(adapter->name, cmd->groups[i].group);
+            }
         }
 
         for (int i = 0; i < cmd->n_group; i++) {
@@ -1320,6 +1423,9 @@ static int adapter_loop(enum neu_event_io_type type, int fd, void *usr_data)
                     break;
                 }
             }
+            if (resp.index > 0) {
+                neu_config_gen_bump(adapter->name, cmd->group);
+            }
         } else {
             resp.error = NEU_ERR_GROUP_NOT_ALLOW;
         }
@@ -1547,6 +1653,7 @@ void neu_adapter_destroy(neu_adapter_t *adapter)
     close(adapter->control_fd);
     close(adapter->trans_data_fd);
 
+    adapter_consumers_stop(adapter);
     adapter->module->intf_funs->close(adapter->plugin);
 
     if (NULL != adapter->metrics) {
@@ -1554,13 +1661,6 @@ void neu_adapter_destroy(neu_adapter_t *adapter)
         neu_node_metrics_free(adapter->metrics);
     }
 
-    if (adapter->consumer_tid != 0) {
-        pthread_cancel(adapter->consumer_tid);
-    }
-    if (adapter->msg_q != NULL) {
-        adapter_msg_q_free(adapter->msg_q);
-    }
-
     char *setting = NULL;
     if (adapter_load_setting(adapter->name, &setting) != 0) {
         remove_logs(adapter->name);
@@ -1576,6 +1676,7 @@ void neu_adapter_destroy(neu_adapter_t *adapter)
     }
 
     neu_event_close(adapter->events);
+    adapter_consumers_free(adapter);
 #ifdef NEU_RELEASE
     if (adapter->handle != NULL) {
         dlclose(adapter->handle);
@@ -1589,6 +1690,7 @@ int neu_adapter_uninit(neu_adapter_t *adapter)
     if (adapter->module->type == NEU_NA_TYPE_DRIVER) {
         neu_adapter_driver_uninit((neu_adapter_driver_t *) adapter);
     }
+    adapter_consumers_stop(adapter);
     adapter->module->intf_funs->uninit(adapter->plugin);
 
     neu_event_del_io(adapter->events, adapter->control_io);
@@ -28,6 +28,14 @@
 #include "core/manager.h"
 #include "msg_q.h"
 
+// a thread handling trans data of an app, and its queue
+typedef struct {
+    neu_adapter_t *  adapter;
+    adapter_msg_q_t *msg_q;
+    pthread_t        tid;
+    bool             running; // not joined yet
+} adapter_consumer_t;
+
 struct neu_adapter {
     char *name;
     char *setting;
@@ -46,8 +54,8 @@ struct neu_adapter {
     int control_fd;
     int trans_data_fd;
 
-    adapter_msg_q_t *msg_q;
-    pthread_t        consumer_tid;
+    adapter_consumer_t *consumers;
+    uint32_t            n_consumer;
 
     uint16_t trans_data_port;
 
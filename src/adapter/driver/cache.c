@@ -906,6 +906,25 @@ int neu_driver_cache_meta_get(neu_driver_cache_t *cache, const char *group,
     return ret;
 }
 
+int neu_driver_cache_peek(neu_driver_cache_t *cache, const char *group,
+                          const char *tag, neu_type_e *type, int64_t *timestamp)
+{
+    struct elem *elem = NULL;
+    int          ret  = -1;
+    tkey_t       key  = to_key(group, tag);
+
+    pthread_mutex_lock(&cache->mtx);
+    HASH_FIND(hh, cache->table, &key, sizeof(tkey_t), elem);
+    if (elem != NULL) {
+        *type      = elem->value.type;
+        *timestamp = elem->timestamp;
+        ret        = 0;
+    }
+    pthread_mutex_unlock(&cache->mtx);
+
+    return ret;
+}
+
 int neu_driver_cache_meta_get_changed(neu_driver_cache_t *cache,
                                       const char *group, const char *tag,
                                       neu_driver_cache_value_t *value,
@@ -58,6 +58,10 @@ typedef struct {
 int neu_driver_cache_meta_get(neu_driver_cache_t *cache, const char *group,
                               const char *tag, neu_driver_cache_value_t *value,
                               neu_tag_meta_t *metas, int n_meta);
+// type and timestamp of a cached value without copying it out
+int neu_driver_cache_peek(neu_driver_cache_t *cache, const char *group,
+                          const char *tag, neu_type_e *type,
+                          int64_t *timestamp);
 int neu_driver_cache_meta_get_changed(neu_driver_cache_t *cache,
                                       const char *group, const char *tag,
                                       neu_driver_cache_value_t *value,
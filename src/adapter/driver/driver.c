@@ -159,7 +159,9 @@ static void format_tag_value(neu_dvalue_t *value)
     value->value.d64 *= negative;
 }
 
-static void write_response(neu_adapter_t *adapter, void *r, neu_error error)
+// `tags` are the failed tags of a write of several tags, NULL for none
+static void send_write_response(neu_adapter_t *adapter, void *r,
+                                neu_error error, UT_array *tags)
 {
     neu_reqresp_head_t *req    = (neu_reqresp_head_t *) r;
     neu_resp_error_t    nerror = { .error = error };
@@ -200,11 +202,21 @@ static void write_response(neu_adapter_t *adapter, void *r, neu_error error)
         }
     }
 
-    req->type = NEU_RESP_ERROR;
-
     nlog_notice("write tag response start <%p>", req->ctx);
 
-    adapter->cb_funs.response(adapter, req, &nerror);
+    if (NULL != tags && utarray_len(tags) > 0) {
+        neu_resp_write_tags_t resp = { .error = error };
+
+        utarray_new(resp.tags, neu_resp_write_tag_error_icd());
+        utarray_concat(resp.tags, tags);
+        req->type = NEU_RESP_WRITE_TAGS;
+        if (0 != adapter->cb_funs.response(adapter, req, &resp)) {
+            neu_resp_write_tags_fini(&resp);
+        }
+    } else {
+        req->type = NEU_RESP_ERROR;
+        adapter->cb_funs.response(adapter, req, &nerror);
+    }
 
     if (neu_otel_control_is_started() && trace) {
         if (error == NEU_ERR_SUCCESS) {
@@ -218,6 +230,17 @@ static void write_response(neu_adapter_t *adapter, void *r, neu_error error)
     }
 }
 
+static void write_response(neu_adapter_t *adapter, void *r, neu_error error)
+{
+    send_write_response(adapter, r, error, NULL);
+}
+
+static void write_tags_response(neu_adapter_t *adapter, void *r, int error,
+                                UT_array *tags)
+{
+    send_write_response(adapter, r, error, tags);
+}
+
 static void update_with_meta(neu_adapter_t *adapter, const char *group,
                              const char *tag, neu_dvalue_t value,
                              neu_tag_meta_t *metas, int n_meta)
@@ -431,6 +454,7 @@ neu_adapter_driver_t *neu_adapter_driver_create()
     driver->adapter.cb_funs.driver.scan_tags_response = scan_tags_response;
     driver->adapter.cb_funs.driver.test_read_tag_response =
         test_read_tag_response;
+    driver->adapter.cb_funs.driver.write_tags_response = write_tags_response;
 
     return driver;
 }
@@ -629,6 +653,53 @@ void neu_adapter_driver_read_group(neu_adapter_driver_t *driver,
     driver->adapter.cb_funs.response(&driver->adapter, req, &resp);
 }
 
+typedef struct {
+    neu_driver_cache_t * cache;
+    const char *         group;
+    int64_t              timestamp;
+    int64_t              timeout;
+    neu_tag_cache_type_e cache_type;
+    bool                 cached; // values are read from the cache
+} read_error_query_t;
+
+// whether reading the tag from the cache gives an error value, checked with
+// the group locked so that only the error tags of the page are copied out
+static bool read_error_filter(const neu_datatag_t *tag, void *data)
+{
+    read_error_query_t *q         = data;
+    neu_type_e          type      = NEU_TYPE_ERROR;
+    int64_t             timestamp = 0;
+
+    if (!neu_tag_attribute_test(tag, NEU_ATTRIBUTE_READ) &&
+        !neu_tag_attribute_test(tag, NEU_ATTRIBUTE_SUBSCRIBE)) {
+        return false;
+    }
+
+    if (!q->cached) {
+        return true;
+    }
+
+    if (neu_driver_cache_peek(q->cache, q->group, tag->name, &type,
+                              &timestamp) != 0) {
+        return true;
+    }
+
+    return type == NEU_TYPE_ERROR ||
+        (q->cache_type != NEU_TAG_CACHE_TYPE_NEVER &&
+         (q->timestamp - timestamp) > q->timeout);
+}
+
+// move the tag into the response, the queried tags are copies of our own
+static void take_datatag(neu_resp_tag_value_meta_paginate_t *tag_value,
+                         neu_datatag_t *                     tag)
+{
+    strcpy(tag_value->tag, tag->name);
+    tag_value->datatag = *tag;
+    tag->name          = NULL;
+    tag->address       = NULL;
+    tag->description   = NULL;
+}
+
 void neu_adapter_driver_read_group_paginate(neu_adapter_driver_t *driver,
                                             neu_reqresp_head_t *  req)
 {
@@ -643,86 +714,73 @@ void neu_adapter_driver_read_group_paginate(neu_adapter_driver_t *driver,
         return;
     }
 
-    neu_resp_read_group_paginate_t resp  = { 0 };
-    neu_group_t *                  group = g->group;
-    UT_array *                     tags;
+    neu_resp_read_group_paginate_t resp      = { 0 };
+    neu_group_t *                  group     = g->group;
+    UT_array *                     tags      = NULL;
+    int                            error     = 0;
+    int                            page_size = 0;
+    read_error_query_t             query     = { 0 };
+
+    if (cmd->current_page > 0 && cmd->page_size > 0) {
+        page_size = cmd->page_size;
+    }
+
+    query.cache = driver->cache;
+    query.group = cmd->group;
+    query.timeout =
+        neu_group_get_interval(group) * NEU_DRIVER_TAG_CACHE_EXPIRE_TIME;
+    query.cache_type = neu_adapter_get_tag_cache_type(&driver->adapter);
 
-    if (cmd->is_error != true && cmd->current_page > 0 && cmd->page_size > 0) {
+    if (driver->adapter.state != NEU_NODE_RUNNING_STATE_RUNNING) {
+        error = NEU_ERR_PLUGIN_NOT_RUNNING;
+    } else if (cmd->sync &&
+               NULL == driver->adapter.module->intf_funs->driver.group_sync) {
+        // plugin does not support sync read
+        error = NEU_ERR_PLUGIN_NOT_SUPPORT_READ_SYNC;
+    } else if (cmd->sync) {
+        // sync read to update cache, before the error tags are picked out
+        stop_group_timer(driver, g);
+        driver->adapter.module->intf_funs->driver.group_sync(
+            driver->adapter.plugin, &g->grp);
+    }
+    query.timestamp = global_timestamp;
+    query.cached    = 0 == error;
+
+    // the filters and the page window are applied before any tag is copied
+    if (cmd->is_error) {
+        tags = neu_group_query_read_tag_paginate(
+            group, cmd->name, cmd->desc, read_error_filter, &query,
+            cmd->current_page, page_size, &resp.total_count);
+    } else if (page_size > 0) {
         tags = neu_group_query_read_tag_paginate(
-            group, cmd->name, cmd->desc, cmd->current_page, cmd->page_size,
-            &resp.total_count);
+            group, cmd->name, cmd->desc, NULL, NULL, cmd->current_page,
+            page_size, &resp.total_count);
     } else {
         tags = neu_group_query_read_tag(group, cmd->name, cmd->desc, 0, NULL);
         resp.total_count = utarray_len(tags);
     }
 
     utarray_new(resp.tags, neu_resp_tag_value_meta_paginate_icd());
+    utarray_reserve(resp.tags, utarray_len(tags));
 
-    if (driver->adapter.state != NEU_NODE_RUNNING_STATE_RUNNING) {
+    if (error != 0) {
         utarray_foreach(tags, neu_datatag_t *, tag)
         {
             neu_resp_tag_value_meta_paginate_t tag_value = { 0 };
-            strcpy(tag_value.tag, tag->name);
-            tag_value.value.type      = NEU_TYPE_ERROR;
-            tag_value.value.value.i32 = NEU_ERR_PLUGIN_NOT_RUNNING;
 
-            tag_value.datatag.name        = strdup(tag->name);
-            tag_value.datatag.address     = strdup(tag->address);
-            tag_value.datatag.attribute   = tag->attribute;
-            tag_value.datatag.type        = tag->type;
-            tag_value.datatag.precision   = tag->precision;
-            tag_value.datatag.decimal     = tag->decimal;
-            tag_value.datatag.bias        = tag->bias;
-            tag_value.datatag.description = strdup(tag->description);
-            tag_value.datatag.option      = tag->option;
-            memcpy(tag_value.datatag.meta, tag->meta, NEU_TAG_META_LENGTH);
+            take_datatag(&tag_value, tag);
+            tag_value.value.type      = NEU_TYPE_ERROR;
+            tag_value.value.value.i32 = error;
 
             utarray_push_back(resp.tags, &tag_value);
         }
-    } else if (cmd->sync) {
-        if (NULL == driver->adapter.module->intf_funs->driver.group_sync) {
-            // plugin does not support sync read
-            utarray_foreach(tags, neu_datatag_t *, tag)
-            {
-                neu_resp_tag_value_meta_paginate_t tag_value = { 0 };
-                strcpy(tag_value.tag, tag->name);
-                tag_value.value.type = NEU_TYPE_ERROR;
-                tag_value.value.value.i32 =
-                    NEU_ERR_PLUGIN_NOT_SUPPORT_READ_SYNC;
-
-                tag_value.datatag.name        = strdup(tag->name);
-                tag_value.datatag.address     = strdup(tag->address);
-                tag_value.datatag.attribute   = tag->attribute;
-                tag_value.datatag.type        = tag->type;
-                tag_value.datatag.precision   = tag->precision;
-                tag_value.datatag.decimal     = tag->decimal;
-                tag_value.datatag.bias        = tag->bias;
-                tag_value.datatag.description = strdup(tag->description);
-                tag_value.datatag.option      = tag->option;
-                memcpy(tag_value.datatag.meta, tag->meta, NEU_TAG_META_LENGTH);
-
-                utarray_push_back(resp.tags, &tag_value);
-            }
-        } else {
-            // sync read to update cache
-            stop_group_timer(driver, g);
-            driver->adapter.module->intf_funs->driver.group_sync(
-                driver->adapter.plugin, &g->grp);
-            // fetch updated data from cache
-            read_group_paginate(
-                global_timestamp,
-                neu_group_get_interval(group) *
-                    NEU_DRIVER_TAG_CACHE_EXPIRE_TIME,
-                neu_adapter_get_tag_cache_type(&driver->adapter), driver->cache,
-                cmd->group, tags, resp.tags);
-            start_group_timer(driver, g);
-        }
     } else {
-        read_group_paginate(global_timestamp,
-                            neu_group_get_interval(group) *
-                                NEU_DRIVER_TAG_CACHE_EXPIRE_TIME,
-                            neu_adapter_get_tag_cache_type(&driver->adapter),
+        // fetch data from cache
+        read_group_paginate(query.timestamp, query.timeout, query.cache_type,
                             driver->cache, cmd->group, tags, resp.tags);
+        if (cmd->sync) {
+            start_group_timer(driver, g);
+        }
     }
 
     resp.driver       = cmd->driver;
@@ -2749,18 +2807,7 @@ static void read_group_paginate(int64_t timestamp, int64_t timeout,
         neu_resp_tag_value_meta_paginate_t tag_value = { 0 };
         neu_driver_cache_value_t           value     = { 0 };
 
-        strcpy(tag_value.tag, tag->name);
-
-        tag_value.datatag.name        = strdup(tag->name);
-        tag_value.datatag.address     = strdup(tag->address);
-        tag_value.datatag.attribute   = tag->attribute;
-        tag_value.datatag.type        = tag->type;
-        tag_value.datatag.precision   = tag->precision;
-        tag_value.datatag.decimal     = tag->decimal;
-        tag_value.datatag.bias        = tag->bias;
-        tag_value.datatag.description = strdup(tag->description);
-        tag_value.datatag.option      = tag->option;
-        memcpy(tag_value.datatag.meta, tag->meta, NEU_TAG_META_LENGTH);
+        take_datatag(&tag_value, tag);
 
         if (tag->attribute == NEU_ATTRIBUTE_WRITE) {
             tag_value.value.type         = NEU_TYPE_STRING;
@@ -2769,7 +2816,7 @@ static void read_group_paginate(int64_t timestamp, int64_t timeout,
             continue;
         }
 
-        if (neu_driver_cache_meta_get(cache, group, tag->name, &value,
+        if (neu_driver_cache_meta_get(cache, group, tag_value.tag, &value,
                                       tag_value.metas,
                                       NEU_TAG_META_SIZE) != 0) {
             tag_value.value.type      = NEU_TYPE_ERROR;
@@ -33,6 +33,7 @@ struct adapter_msg_q {
     uint32_t     max;
     uint32_t     current;
     char *       name;
+    bool         closed;
 
     pthread_mutex_t mtx;
     pthread_cond_t  cond;
@@ -70,10 +71,23 @@ void adapter_msg_q_free(adapter_msg_q_t *q)
     free(q);
 }
 
+void adapter_msg_q_close(adapter_msg_q_t *q)
+{
+    pthread_mutex_lock(&q->mtx);
+    q->closed = true;
+    pthread_mutex_unlock(&q->mtx);
+
+    pthread_cond_broadcast(&q->cond);
+}
+
 int adapter_msg_q_push(adapter_msg_q_t *q, neu_msg_t *msg)
 {
     int ret = -1;
     pthread_mutex_lock(&q->mtx);
+    if (q->closed) {
+        pthread_mutex_unlock(&q->mtx);
+        return -1;
+    }
     if (q->current < q->max) {
         q->current += 1;
         struct item *elt = calloc(1, sizeof(struct item));
@@ -93,14 +107,18 @@ int adapter_msg_q_push(adapter_msg_q_t *q, neu_msg_t *msg)
     return ret;
 }
 
-uint32_t adapter_msg_q_pop(adapter_msg_q_t *q, neu_msg_t **p_data)
+int adapter_msg_q_pop(adapter_msg_q_t *q, neu_msg_t **p_data)
 {
-    uint32_t ret = 0;
+    int ret = 0;
 
     pthread_mutex_lock(&q->mtx);
-    while (q->current == 0) {
+    while (q->current == 0 && !q->closed) {
         pthread_cond_wait(&q->cond, &q->mtx);
     }
+    if (q->closed) {
+        pthread_mutex_unlock(&q->mtx);
+        return -1;
+    }
     struct item *elt = DL_LAST(q->list);
 
     if (elt != NULL) {
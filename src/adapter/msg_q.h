@@ -29,8 +29,11 @@ typedef struct adapter_msg_q adapter_msg_q_t;
 
 adapter_msg_q_t *adapter_msg_q_new(const char *name, uint32_t size);
 void             adapter_msg_q_free(adapter_msg_q_t *q);
+// wakes up the poppers, later pushes fail and pops return -1
+void adapter_msg_q_close(adapter_msg_q_t *q);
 
-int      adapter_msg_q_push(adapter_msg_q_t *q, neu_msg_t *msg);
-uint32_t adapter_msg_q_pop(adapter_msg_q_t *q, neu_msg_t **p_data);
+int adapter_msg_q_push(adapter_msg_q_t *q, neu_msg_t *msg);
+// the number of messages left, or -1 once the queue is closed
+int adapter_msg_q_pop(adapter_msg_q_t *q, neu_msg_t **p_data);
 
 #endif
\ No newline at end of file
@@ -32,6 +32,7 @@
 
 #include "argparse.h"
 #include "persist/persist.h"
+#include "utils/http.h"
 #include "utils/log.h"
 #include "version.h"
 #include "json/json.h"
@@ -81,6 +82,9 @@ const char *usage_text =
 "    --syslog_host <HOST> syslog server host to which neuron will send logs\n"
 "    --syslog_port <PORT> syslog server port (default 541 if not provided)\n"
 "    --sub_filter_error The subscribe attribute only detects the last read value and does not report any error tags\n"
+"    --app_workers <N>    number of threads handling trans data of apps that support it (default 1)\n"
+"    --gzip_level <N>     compression level of http responses for clients accepting gzip, 0-9, 0 disables (default 6)\n"
+"    --gzip_min_size <N>  smallest http response body in bytes to compress (default 1024)\n"
 "\n";
 // clang-format on
 
@@ -135,6 +139,52 @@ static inline size_t parse_restart_policy(const char *s, size_t *out)
     return 0;
 }
 
+static inline int parse_app_workers(const char *s, uint32_t *out)
+{
+    char *    end = NULL;
+    uintmax_t n   = 0;
+
+    errno = 0;
+    n     = strtoumax(s, &end, 10);
+    if (0 != errno || '\0' == *s || '\0' != *end || 0 == n ||
+        n > NEU_APP_WORKERS_MAX) {
+        return -1;
+    }
+
+    *out = (uint32_t) n;
+    return 0;
+}
+
+static inline int parse_gzip_level(const char *s, int *out)
+{
+    char *    end = NULL;
+    uintmax_t n   = 0;
+
+    errno = 0;
+    n     = strtoumax(s, &end, 10);
+    if (0 != errno || '\0' == *s || '\0' != *end || n > 9) {
+        return -1;
+    }
+
+    *out = (int) n;
+    return 0;
+}
+
+static inline int parse_gzip_min_size(const char *s, size_t *out)
+{
+    char *    end = NULL;
+    uintmax_t n   = 0;
+
+    errno = 0;
+    n     = strtoumax(s, &end, 10);
+    if (0 != errno || '\0' == *s || '\0' != *end || n > SIZE_MAX) {
+        return -1;
+    }
+
+    *out = (size_t) n;
+    return 0;
+}
+
 static inline bool file_exists(const char *const path)
 {
     struct stat buf = { 0 };
@@ -195,6 +245,30 @@ static inline int load_env(neu_cli_args_t *args, char **log_level_out,
             }
         }
 
+        char *app_workers = getenv(NEU_ENV_APP_WORKERS);
+        if (app_workers != NULL &&
+            0 != parse_app_workers(app_workers, &args->app_workers)) {
+            printf("neuron %s setting invalid!\n", NEU_ENV_APP_WORKERS);
+            ret = -1;
+            break;
+        }
+
+        char *gzip_level = getenv(NEU_ENV_GZIP_LEVEL);
+        if (gzip_level != NULL &&
+            0 != parse_gzip_level(gzip_level, &args->gzip_level)) {
+            printf("neuron %s setting invalid!\n", NEU_ENV_GZIP_LEVEL);
+            ret = -1;
+            break;
+        }
+
+        char *gzip_min_size = getenv(NEU_ENV_GZIP_MIN_SIZE);
+        if (gzip_min_size != NULL &&
+            0 != parse_gzip_min_size(gzip_min_size, &args->gzip_min_size)) {
+            printf("neuron %s setting invalid!\n", NEU_ENV_GZIP_MIN_SIZE);
+            ret = -1;
+            break;
+        }
+
         char *log_level = getenv(NEU_ENV_LOG_LEVEL);
         if (log_level != NULL) {
             if (*log_level_out != NULL) {
@@ -450,10 +524,16 @@ void neu_cli_args_init(neu_cli_args_t *args, int argc, char *argv[])
         { "syslog_host", required_argument, NULL, 'S' },
         { "syslog_port", required_argument, NULL, 'P' },
         { "sub_filter_error", no_argument, NULL, 'f' },
+        { "app_workers", required_argument, NULL, 'w' },
+        { "gzip_level", required_argument, NULL, 'z' },
+        { "gzip_min_size", required_argument, NULL, 'Z' },
         { NULL, 0, NULL, 0 },
     };
 
     memset(args, 0, sizeof(*args));
+    args->app_workers   = 1;
+    args->gzip_level    = NEU_HTTP_GZIP_LEVEL;
+    args->gzip_min_size = NEU_HTTP_GZIP_MIN_SIZE;
 
     int c            = 0;
     int option_index = 0;
@@ -546,6 +626,31 @@ void neu_cli_args_init(neu_cli_args_t *args, int argc, char *argv[])
         case 'f':
             args->sub_filter_err = true;
             break;
+        case 'w':
+            if (0 != parse_app_workers(optarg, &args->app_workers)) {
+                fprintf(stderr, "%s: option '--app_workers' invalid : `%s`\n",
+                        argv[0], optarg);
+                ret = 1;
+                goto quit;
+            }
+            break;
+        case 'z':
+            if (0 != parse_gzip_level(optarg, &args->gzip_level)) {
+                fprintf(stderr, "%s: option '--gzip_level' invalid : `%s`\n",
+                        argv[0], optarg);
+                ret = 1;
+                goto quit;
+            }
+            break;
+        case 'Z':
+            if (0 != parse_gzip_min_size(optarg, &args->gzip_min_size)) {
+                fprintf(stderr,
+                        "%s: option '--gzip_min_size' invalid : `%s`\n",
+                        argv[0], optarg);
+                ret = 1;
+                goto quit;
+            }
+            break;
         case '?':
         default:
             usage();
@@ -36,6 +36,11 @@
 #define NEU_ENV_SYSLOG_HOST "NEURON_SYSLOG_HOST"
 #define NEU_ENV_SYSLOG_PORT "NEURON_SYSLOG_PORT"
 #define NEU_ENV_SUB_FILTER_ERROR "NEURON_SUB_FILTER_ERROR"
+#define NEU_ENV_APP_WORKERS "NEURON_APP_WORKERS"
+#define NEU_ENV_GZIP_LEVEL "NEURON_GZIP_LEVEL"
+#define NEU_ENV_GZIP_MIN_SIZE "NEURON_GZIP_MIN_SIZE"
+
+#define NEU_APP_WORKERS_MAX 32
 
 #define NEURON_CONFIG_FNAME "./config/neuron.json"
 
@@ -66,6 +71,9 @@ typedef struct {
     char *   syslog_host;
     uint16_t syslog_port;
     bool     sub_filter_err;
+    uint32_t app_workers; // trans data consumers of reentrant apps
+    int      gzip_level;    // of http responses, 0 to disable
+    size_t   gzip_min_size; // smallest http response body to compress
 } neu_cli_args_t;
 
 /** Parse command line arguments.
@@ -0,0 +1,132 @@
+/**
+ * NEURON IIoT System for Industry 4.0
+ * Copyright (C) 2020-2022 EMQ Technologies Co., Ltd All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ **/
+
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "define.h"
+#include "utils/time.h"
+#include "utils/uthash.h"
+
+#include "config_gen.h"
+
+typedef struct {
+    char           name[NEU_GROUP_NAME_LEN];
+    uint64_t       gen;
+    UT_hash_handle hh;
+} group_gen_t;
+
+typedef struct {
+    char           name[NEU_NODE_NAME_LEN];
+    uint64_t       gen;
+    // last change to the node as a whole
+    uint64_t       reset;
+    group_gen_t *  groups;
+    UT_hash_handle hh;
+} node_gen_t;
+
+static pthread_mutex_t g_mtx_   = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t        g_gen_   = 0;
+static uint64_t        g_epoch_ = 0;
+static node_gen_t *    g_nodes_ = NULL;
+
+static node_gen_t *find_node(const char *node, bool create)
+{
+    node_gen_t *n = NULL;
+
+    HASH_FIND_STR(g_nodes_, node, n);
+    if (NULL == n && create) {
+        n = calloc(1, sizeof(*n));
+        strncpy(n->name, node, sizeof(n->name) - 1);
+        HASH_ADD_STR(g_nodes_, name, n);
+    }
+
+    return n;
+}
+
+static group_gen_t *find_group(node_gen_t *n, const char *group, bool create)
+{
+    group_gen_t *g = NULL;
+
+    HASH_FIND_STR(n->groups, group, g);
+    if (NULL == g && create) {
+        g = calloc(1, sizeof(*g));
+        strncpy(g->name, group, sizeof(g->name) - 1);
+        HASH_ADD_STR(n->groups, name, g);
+    }
+
+    return g;
+}
+
+void neu_config_gen_bump(const char *node, const char *group)
+{
+    pthread_mutex_lock(&g_mtx_);
+    g_gen_ += 1;
+    if (NULL != node) {
+        node_gen_t *n = find_node(node, true);
+        n->gen        = g_gen_;
+        if (NULL != group) {
+            find_group(n, group, true)->gen = g_gen_;
+        } else {
+            n->reset = g_gen_;
+        }
+    }
+    pthread_mutex_unlock(&g_mtx_);
+}
+
+uint64_t neu_config_gen(const char *node, const char *group)
+{
+    uint64_t gen = 0;
+
+    pthread_mutex_lock(&g_mtx_);
+    if (NULL == node) {
+        gen = g_gen_;
+    } else {
+        node_gen_t *n = find_node(node, false);
+        if (NULL != n && NULL == group) {
+            gen = n->gen;
+        } else if (NULL != n) {
+            group_gen_t *g = find_group(n, group, false);
+            gen            = n->reset;
+            if (NULL != g && g->gen > gen) {
+                gen = g->gen;
+            }
+        }
+    }
+    pthread_mutex_unlock(&g_mtx_);
+
+    return gen;
+}
+
+uint64_t neu_config_gen_epoch()
+{
+    uint64_t epoch = 0;
+
+    pthread_mutex_lock(&g_mtx_);
+    if (0 == g_epoch_) {
+        g_epoch_ = neu_time_ms();
+    }
+    epoch = g_epoch_;
+    pthread_mutex_unlock(&g_mtx_);
+
+    return epoch;
+}
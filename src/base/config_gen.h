@@ -0,0 +1,50 @@
+/**
+ * NEURON IIoT System for Industry 4.0
+ * Copyright (C) 2020-2022 EMQ Technologies Co., Ltd All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ **/
+
+
+#ifndef _NEU_CONFIG_GEN_H_
+#define _NEU_CONFIG_GEN_H_
+
+#include <stdint.h>
+
+/*
+ * Configuration generations.
+ *
+ * Every change of the configuration takes the next value of one process wide
+ * counter, and records it as the generation of the global configuration, of
+ * the node and of the group it touches. A generation only ever grows, a node
+ * or a group that is deleted or renamed keeps its last one. Changes are
+ * bumped after they are applied, so a reader that takes the generation before
+ * reading the configuration never pairs a stale view with a newer generation.
+ */
+
+// bumps the global generation, then the node's if `node` is not NULL, then
+// the group's if `group` is not NULL as well. A change to a node as a whole,
+// `group` being NULL, bumps all the groups of the node too
+void neu_config_gen_bump(const char *node, const char *group);
+
+// the generation of the global configuration if `node` is NULL, of the node
+// and all its groups if `group` is NULL, of the group otherwise
+uint64_t neu_config_gen(const char *node, const char *group);
+
+// changes on every start of the process, to tell generations apart across
+// restarts
+uint64_t neu_config_gen_epoch();
+
+#endif
@@ -16,6 +16,7 @@
  * along with this program; if not, write to the Free Software Foundation,
  * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
  **/
+#include <limits.h>
 #include <pthread.h>
 #include <string.h>
 #include <sys/time.h>
@@ -33,11 +34,26 @@ typedef struct tag_elem {
     UT_hash_handle hh;
 } tag_elem_t;
 
+typedef struct {
+    tag_elem_t **elems;
+    size_t       len;
+    size_t       cap;
+} tag_vec_t;
+
+// tags whose name or description contains a trigram
+typedef struct {
+    uint32_t       gram;
+    tag_vec_t      tags;
+    UT_hash_handle hh;
+} gram_elem_t;
+
 struct neu_group {
     char *name;
 
-    tag_elem_t *tags;
-    uint32_t    interval;
+    tag_elem_t * tags;
+    tag_vec_t    sorted; // tags in the order of names
+    gram_elem_t *grams;  // substring index over names and descriptions
+    uint32_t     interval;
 
     int64_t         timestamp;
     pthread_mutex_t mtx;
@@ -45,6 +61,13 @@ struct neu_group {
 
 static UT_array *to_array(tag_elem_t *tags);
 static void      update_timestamp(neu_group_t *group);
+static int       index_add(neu_group_t *group, tag_elem_t *el);
+static void      index_del(neu_group_t *group, tag_elem_t *el);
+static int       grams_add(neu_group_t *group, tag_elem_t *el);
+static void      grams_del(neu_group_t *group, tag_elem_t *el);
+static const tag_vec_t *grams_match(neu_group_t *group, const char *str,
+                                    const tag_vec_t *best);
+static int              elem_cmp(const void *a, const void *b);
 
 neu_group_t *neu_group_new(const char *name, uint32_t interval)
 {
@@ -59,9 +82,18 @@ neu_group_t *neu_group_new(const char *name, uint32_t interval)
 
 void neu_group_destroy(neu_group_t *group)
 {
-    tag_elem_t *el = NULL, *tmp = NULL;
+    tag_elem_t * el = NULL, *tmp = NULL;
+    gram_elem_t *g = NULL, *gtmp = NULL;
 
     pthread_mutex_lock(&group->mtx);
+    HASH_ITER(hh, group->grams, g, gtmp)
+    {
+        HASH_DEL(group->grams, g);
+        free(g->tags.elems);
+        free(g);
+    }
+    free(group->sorted.elems);
+
     HASH_ITER(hh, group->tags, el, tmp)
     {
         HASH_DEL(group->tags, el);
@@ -132,6 +164,14 @@ int neu_group_add_tag(neu_group_t *group, const neu_datatag_t *tag)
     el->name = strdup(tag->name);
     el->tag  = neu_tag_dup(tag);
 
+    if (0 != index_add(group, el)) {
+        pthread_mutex_unlock(&group->mtx);
+        free(el->name);
+        neu_tag_free(el->tag);
+        free(el);
+        return NEU_ERR_EINTERNAL;
+    }
+
     HASH_ADD_STR(group->tags, name, el);
     update_timestamp(group);
     pthread_mutex_unlock(&group->mtx);
@@ -147,10 +187,12 @@ int neu_group_update_tag(neu_group_t *group, const neu_datatag_t *tag)
     pthread_mutex_lock(&group->mtx);
     HASH_FIND_STR(group->tags, tag->name, el);
     if (el != NULL) {
+        // the description may change, the name does not
+        grams_del(group, el);
         neu_tag_copy(el->tag, tag);
+        ret = 0 == grams_add(group, el) ? NEU_ERR_SUCCESS : NEU_ERR_EINTERNAL;
 
         update_timestamp(group);
-        ret = NEU_ERR_SUCCESS;
     }
     pthread_mutex_unlock(&group->mtx);
 
@@ -165,6 +207,7 @@ int neu_group_del_tag(neu_group_t *group, const char *tag_name)
     pthread_mutex_lock(&group->mtx);
     HASH_FIND_STR(group->tags, tag_name, el);
     if (el != NULL) {
+        index_del(group, el);
         HASH_DEL(group->tags, el);
         free(el->name);
         neu_tag_free(el->tag);
@@ -207,34 +250,6 @@ filter_tags(tag_elem_t *tags,
     return array;
 }
 
-static inline UT_array *filter_tags_by_page(
-    tag_elem_t *tags, bool (*predicate)(const neu_datatag_t *, void *data),
-    void *data, int current_page, int page_size, int *total_count)
-{
-    tag_elem_t *el = NULL, *tmp = NULL;
-    UT_array *  array       = NULL;
-    int         count       = 0;
-    int         start_index = (current_page - 1) * page_size;
-    int         end_index   = start_index + page_size;
-
-    utarray_new(array, neu_tag_get_icd());
-    HASH_ITER(hh, tags, el, tmp)
-    {
-        if (predicate(el->tag, data)) {
-            if (count >= start_index && count < end_index) {
-                utarray_push_back(array, el->tag);
-            }
-            count++;
-        }
-    }
-
-    if (total_count) {
-        *total_count = count;
-    }
-
-    return array;
-}
-
 static inline bool is_readable(const neu_datatag_t *tag, void *data)
 {
     (void) data;
@@ -260,13 +275,17 @@ struct query {
     char *   desc;
     uint16_t n_tagname;
     char **  tagnames;
+
+    neu_group_tag_filter_fn filter;
+    void *                  filter_data;
 };
 
 static inline bool match_query(const neu_datatag_t *tag, void *data)
 {
     struct query *q      = data;
     bool          filter = (!q->name || name_contains(tag, q->name)) &&
-        (!q->desc || description_contains(tag, q->desc));
+        (!q->desc || description_contains(tag, q->desc)) &&
+        (!q->filter || q->filter(tag, q->filter_data));
     if (filter && q->n_tagname > 0) {
         for (uint16_t i = 0; i < q->n_tagname; i++) {
             if (strcmp(tag->name, q->tagnames[i]) == 0) {
@@ -284,12 +303,73 @@ static inline bool is_readable_and_match_query(const neu_datatag_t *tag,
     return is_readable(tag, NULL) && match_query(tag, data);
 }
 
+// tags matching `predicate` in the order of names, only those from `start` to
+// `end` are copied out. The substring index narrows down the candidates when
+// the query has a name or description
+static UT_array *select_tags(neu_group_t *group,
+                             bool (*predicate)(const neu_datatag_t *, void *),
+                             struct query *q, int start, int end,
+                             int *total_count)
+{
+    const tag_vec_t *cands  = NULL;
+    tag_elem_t **    elems  = group->sorted.elems;
+    tag_elem_t **    sorted = NULL;
+    size_t           n      = group->sorted.len;
+    UT_array *       array  = NULL;
+    int              count  = 0;
+
+    utarray_new(array, neu_tag_get_icd());
+
+    if (NULL == predicate) {
+        // nothing to filter, go to the page directly
+        for (int i = start > 0 ? start : 0; i < end && (size_t) i < n; i++) {
+            utarray_push_back(array, elems[i]->tag);
+        }
+        if (total_count) {
+            *total_count = (int) n;
+        }
+        return array;
+    }
+
+    cands = grams_match(group, q->desc, grams_match(group, q->name, NULL));
+    if (cands != NULL && cands->len < n) {
+        n = cands->len;
+        if (n > 0 && NULL != (sorted = malloc(n * sizeof(*sorted)))) {
+            memcpy(sorted, cands->elems, n * sizeof(*sorted));
+            qsort(sorted, n, sizeof(*sorted), elem_cmp);
+            elems = sorted;
+        } else if (n > 0) {
+            // scan all of them
+            n = group->sorted.len;
+        }
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        if (predicate(elems[i]->tag, q)) {
+            if (count >= start && count < end) {
+                utarray_push_back(array, elems[i]->tag);
+            }
+            count++;
+        }
+    }
+
+    free(sorted);
+    if (total_count) {
+        *total_count = count;
+    }
+
+    return array;
+}
+
 UT_array *neu_group_query_tag(neu_group_t *group, const char *name)
 {
-    UT_array *array = NULL;
+    UT_array *   array = NULL;
+    struct query q     = {
+        .name = (char *) name,
+    };
 
     pthread_mutex_lock(&group->mtx);
-    array = filter_tags(group->tags, name_contains, (void *) name);
+    array = select_tags(group, match_query, &q, 0, INT_MAX, NULL);
     pthread_mutex_unlock(&group->mtx);
 
     return array;
@@ -308,26 +388,36 @@ UT_array *neu_group_query_read_tag(neu_group_t *group, const char *name,
     };
 
     pthread_mutex_lock(&group->mtx);
-    array = filter_tags(group->tags, is_readable_and_match_query, &q);
+    array = select_tags(group, is_readable_and_match_query, &q, 0, INT_MAX,
+                        NULL);
     pthread_mutex_unlock(&group->mtx);
 
     return array;
 }
 
-UT_array *neu_group_query_read_tag_paginate(neu_group_t *group,
-                                            const char *name, const char *desc,
-                                            int current_page, int page_size,
-                                            int *total_count)
+UT_array *neu_group_query_read_tag_paginate(
+    neu_group_t *group, const char *name, const char *desc,
+    neu_group_tag_filter_fn filter, void *filter_data, int current_page,
+    int page_size, int *total_count)
 {
     UT_array *   array = NULL;
+    int          start = 0;
+    int          end   = INT_MAX;
     struct query q     = {
-        .name = (char *) name,
-        .desc = (char *) desc,
+        .name        = (char *) name,
+        .desc        = (char *) desc,
+        .filter      = filter,
+        .filter_data = filter_data,
     };
 
+    if (page_size > 0) {
+        start = (current_page - 1) * page_size;
+        end   = start + page_size;
+    }
+
     pthread_mutex_lock(&group->mtx);
-    array = filter_tags_by_page(group->tags, match_query, &q, current_page,
-                                page_size, total_count);
+    array = select_tags(group, name || desc || filter ? match_query : NULL, &q,
+                        start, end, total_count);
     pthread_mutex_unlock(&group->mtx);
 
     return array;
@@ -404,4 +494,180 @@ static UT_array *to_array(tag_elem_t *tags)
     HASH_ITER(hh, tags, el, tmp) { utarray_push_back(array, el->tag); }
 
     return array;
-}
\ No newline at end of file
+}
+
+static int vec_insert(tag_vec_t *vec, size_t i, tag_elem_t *el)
+{
+    if (vec->len == vec->cap) {
+        size_t       cap   = vec->cap > 0 ? vec->cap * 2 : 8;
+        tag_elem_t **elems = realloc(vec->elems, cap * sizeof(*elems));
+        if (NULL == elems) {
+            return -1;
+        }
+        vec->elems = elems;
+        vec->cap   = cap;
+    }
+
+    memmove(&vec->elems[i + 1], &vec->elems[i],
+            (vec->len - i) * sizeof(*vec->elems));
+    vec->elems[i] = el;
+    vec->len += 1;
+    return 0;
+}
+
+static void vec_remove(tag_vec_t *vec, size_t i)
+{
+    memmove(&vec->elems[i], &vec->elems[i + 1],
+            (vec->len - i - 1) * sizeof(*vec->elems));
+    vec->len -= 1;
+}
+
+static size_t sorted_find(const tag_vec_t *vec, const char *name)
+{
+    size_t lo = 0, hi = vec->len;
+
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (strcmp(vec->elems[mid]->name, name) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+static int elem_cmp(const void *a, const void *b)
+{
+    return strcmp((*(tag_elem_t *const *) a)->name,
+                  (*(tag_elem_t *const *) b)->name);
+}
+
+static inline uint32_t to_gram(const char *s)
+{
+    return (uint32_t)(uint8_t) s[0] << 16 | (uint32_t)(uint8_t) s[1] << 8 |
+        (uint32_t)(uint8_t) s[2];
+}
+
+static int grams_add_str(neu_group_t *group, tag_elem_t *el, const char *str)
+{
+    for (size_t i = 0; str && str[i] && str[i + 1] && str[i + 2]; i++) {
+        uint32_t     gram = to_gram(&str[i]);
+        gram_elem_t *g    = NULL;
+
+        HASH_FIND(hh, group->grams, &gram, sizeof(gram), g);
+        if (NULL == g) {
+            g = calloc(1, sizeof(*g));
+            if (NULL == g) {
+                return -1;
+            }
+            g->gram = gram;
+            HASH_ADD(hh, group->grams, gram, sizeof(gram), g);
+        }
+
+        // a trigram occurring more than once in the same tag
+        if (g->tags.len > 0 && g->tags.elems[g->tags.len - 1] == el) {
+            continue;
+        }
+        if (0 != vec_insert(&g->tags, g->tags.len, el)) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static void grams_del_str(neu_group_t *group, tag_elem_t *el, const char *str)
+{
+    for (size_t i = 0; str && str[i] && str[i + 1] && str[i + 2]; i++) {
+        uint32_t     gram = to_gram(&str[i]);
+        gram_elem_t *g    = NULL;
+
+        HASH_FIND(hh, group->grams, &gram, sizeof(gram), g);
+        if (NULL == g) {
+            continue;
+        }
+
+        // the order of a trigram's tags does not matter
+        for (size_t j = g->tags.len; j-- > 0;) {
+            if (g->tags.elems[j] == el) {
+                g->tags.elems[j] = g->tags.elems[--g->tags.len];
+                break;
+            }
+        }
+
+        if (0 == g->tags.len) {
+            HASH_DEL(group->grams, g);
+            free(g->tags.elems);
+            free(g);
+        }
+    }
+}
+
+static int grams_add(neu_group_t *group, tag_elem_t *el)
+{
+    if (0 != grams_add_str(group, el, el->tag->name) ||
+        0 != grams_add_str(group, el, el->tag->description)) {
+        grams_del(group, el);
+        return -1;
+    }
+
+    return 0;
+}
+
+static void grams_del(neu_group_t *group, tag_elem_t *el)
+{
+    grams_del_str(group, el, el->tag->name);
+    grams_del_str(group, el, el->tag->description);
+}
+
+// the fewest tags that may contain `str`, or `best` if fewer.
+// NULL if neither narrows anything down
+static const tag_vec_t *grams_match(neu_group_t *group, const char *str,
+                                    const tag_vec_t *best)
+{
+    static const tag_vec_t none = { 0 };
+
+    for (size_t i = 0; str && str[i] && str[i + 1] && str[i + 2]; i++) {
+        uint32_t     gram = to_gram(&str[i]);
+        gram_elem_t *g    = NULL;
+
+        HASH_FIND(hh, group->grams, &gram, sizeof(gram), g);
+        if (NULL == g) {
+            return &none;
+        }
+        if (NULL == best || g->tags.len < best->len) {
+            best = &g->tags;
+        }
+    }
+
+    return best;
+}
+
+static int index_add(neu_group_t *group, tag_elem_t *el)
+{
+    size_t i = sorted_find(&group->sorted, el->name);
+
+    if (0 != vec_insert(&group->sorted, i, el)) {
+        return -1;
+    }
+
+    if (0 != grams_add(group, el)) {
+        vec_remove(&group->sorted, i);
+        return -1;
+    }
+
+    return 0;
+}
+
+static void index_del(neu_group_t *group, tag_elem_t *el)
+{
+    size_t i = sorted_find(&group->sorted, el->name);
+
+    if (i < group->sorted.len && group->sorted.elems[i] == el) {
+        vec_remove(&group->sorted, i);
+    }
+
+    grams_del(group, el);
+}
@@ -44,11 +44,17 @@ UT_array *   neu_group_get_read_tag(neu_group_t *group);
 UT_array *   neu_group_query_read_tag(neu_group_t *group, const char *name,
                                       const char *desc, uint16_t n_tagname,
                                       char **tagnames);
-UT_array *   neu_group_query_read_tag_paginate(neu_group_t *group,
-                                               const char *name, const char *desc,
-                                               int current_page, int page_size,
-                                               int *total_count);
-uint16_t     neu_group_tag_size(const neu_group_t *group);
+
+// tags matching `name`, `desc` and `filter` if any, in the order of names.
+// `filter` is called with the group locked. Only the tags in the page are
+// copied out, a `page_size` of 0 returns all of them. `total_count` is the
+// number of matching tags
+typedef bool (*neu_group_tag_filter_fn)(const neu_datatag_t *tag, void *data);
+UT_array *neu_group_query_read_tag_paginate(
+    neu_group_t *group, const char *name, const char *desc,
+    neu_group_tag_filter_fn filter, void *filter_data, int current_page,
+    int page_size, int *total_count);
+uint16_t       neu_group_tag_size(const neu_group_t *group);
 neu_datatag_t *neu_group_find_tag(neu_group_t *group, const char *tag);
 
 typedef void (*neu_group_change_fn)(void *arg, int64_t timestamp,
@@ -27,6 +27,7 @@
 #include <sys/time.h>
 
 #include <fcntl.h>
+#include <poll.h>
 #include <termios.h>
 
 #include "utils/log.h"
@@ -436,6 +437,9 @@ void neu_conn_clear_recv_buffer(neu_conn_t *conn)
             }
         } while (ret > 0);
         break;
+    case NEU_CONN_TTY_CLIENT:
+        tcflush(conn->fd, TCIFLUSH);
+        break;
     default:
         break;
     }
@@ -517,6 +521,60 @@ ssize_t neu_conn_recv(neu_conn_t *conn, uint8_t *buf, ssize_t len)
 
     return ret;
 }
+
+ssize_t neu_conn_recv_wait(neu_conn_t *conn, uint8_t *buf, ssize_t len,
+                           int timeout)
+{
+    ssize_t       ret = 0;
+    struct pollfd pfd = { 0 };
+
+    pthread_mutex_lock(&conn->mtx);
+    if (conn->stop) {
+        pthread_mutex_unlock(&conn->mtx);
+        return ret;
+    }
+
+    if (!conn->is_connected ||
+        (conn->param.type != NEU_CONN_TCP_CLIENT &&
+         conn->param.type != NEU_CONN_TTY_CLIENT)) {
+        pthread_mutex_unlock(&conn->mtx);
+        return -1;
+    }
+
+    pfd.fd     = conn->fd;
+    pfd.events = POLLIN;
+    ret        = poll(&pfd, 1, timeout);
+    if (ret == 0 || (ret < 0 && errno == EINTR)) {
+        pthread_mutex_unlock(&conn->mtx);
+        return 0;
+    }
+
+    if (ret > 0) {
+        if (conn->param.type == NEU_CONN_TTY_CLIENT) {
+            ret = read(conn->fd, buf, len);
+        } else {
+            ret = recv(conn->fd, buf, len, MSG_DONTWAIT);
+        }
+    }
+
+    if (ret > 0) {
+        conn->state.recv_bytes += ret;
+    } else if (ret == 0 || errno != EAGAIN) {
+        zlog_error(conn->param.log,
+                   "conn fd: %d, recv wait buf len %zd, ret: %zd, errno: "
+                   "%s(%d)",
+                   conn->fd, len, ret, strerror(errno), errno);
+        conn_disconnect(conn);
+        ret = -1;
+    } else {
+        ret = 0;
+    }
+
+    pthread_mutex_unlock(&conn->mtx);
+
+    return ret;
+}
+
 ssize_t neu_conn_udp_sendto(neu_conn_t *conn, uint8_t *buf, ssize_t len,
                             void *dst)
 {
@@ -33,6 +33,7 @@
 #include <nng/supplemental/util/platform.h>
 
 #include "connection/mqtt_client.h"
+#include "connection/mqtt_topic_trie.h"
 #include "errcodes.h"
 #include "event/event.h"
 #include "utils/asprintf.h"
@@ -76,18 +77,19 @@ typedef enum {
     TASK_RECV,
 } task_kind_e;
 
-#define TASK_UNION_FIELDS                     \
-    struct {                                  \
-        neu_mqtt_client_publish_cb_t cb;      \
-        neu_mqtt_qos_e               qos;     \
-        char *                       topic;   \
-        uint8_t *                    payload; \
-        uint32_t                     len;     \
-        void *                       data;    \
-    } pub;                                    \
-    subscription_t *sub;                      \
-    struct {                                  \
-        subscription_t *sub;                  \
+#define TASK_UNION_FIELDS                          \
+    struct {                                       \
+        neu_mqtt_client_publish_cb_t      cb;      \
+        neu_mqtt_client_publish_done_cb_t done;    \
+        neu_mqtt_qos_e                    qos;     \
+        char *                            topic;   \
+        uint8_t *                         payload; \
+        uint32_t                          len;     \
+        void *                            data;    \
+    } pub;                                         \
+    subscription_t *sub;                           \
+    struct {                                       \
+        subscription_t *sub;                       \
     } recv
 
 typedef union {
@@ -128,6 +130,7 @@ struct neu_mqtt_client_s {
     bool                            receiving;
     nng_aio *                       recv_aio;
     subscription_t *                subscriptions;
+    neu_mqtt_topic_trie_t *         sub_trie;
     size_t                          suback_count;
     size_t                          task_count;
     size_t                          task_limit;
@@ -160,7 +163,7 @@ static void connect_cb(nng_pipe p, nng_pipe_ev ev, void *arg);
 static inline task_t *client_alloc_task(neu_mqtt_client_t *client);
 static inline void    client_free_task(neu_mqtt_client_t *client, task_t *task);
 static inline size_t  client_task_free_list_len(neu_mqtt_client_t *client);
-static inline void    client_add_subscription(neu_mqtt_client_t *client,
+static inline int     client_add_subscription(neu_mqtt_client_t *client,
                                               subscription_t *   sub);
 static int            client_send_sub_msg(neu_mqtt_client_t *client,
                                           subscription_t *   subscription);
@@ -376,6 +379,9 @@ static void task_handle_pub(task_t *task, neu_mqtt_client_t *client)
     if (task->pub.cb) {
         task->pub.cb(rv, task->pub.qos, task->pub.topic, task->pub.payload,
                      task->pub.len, task->pub.data);
+    } else if (task->pub.done) {
+        task->pub.done(rv, task->pub.qos, task->pub.topic, task->pub.len,
+                       task->pub.data);
     }
     return;
 }
@@ -580,21 +586,15 @@ static inline void subscriptions_free(subscription_t *subscriptions)
 }
 
 static inline subscription_t *
-subscription_find_match(subscription_t *subscriptions, const char *topic_name,
+subscription_find_match(neu_mqtt_client_t *client, const char *topic_name,
                         uint32_t topic_name_len)
 {
-    subscription_t *sub = NULL, *tmp = NULL;
-    HASH_FIND(hh, subscriptions, topic_name, topic_name_len, sub);
+    subscription_t *sub = NULL;
+    HASH_FIND(hh, client->subscriptions, topic_name, topic_name_len, sub);
     if (NULL == sub) {
         // subscription wildcard matching
-        // TODO: linear scanning is enough for current usages,
-        //       but may pose performance issues in the future
-        HASH_ITER(hh, subscriptions, sub, tmp)
-        {
-            if (topic_filter_is_match(sub->topic, topic_name, topic_name_len)) {
-                return sub;
-            }
-        }
+        sub = neu_mqtt_topic_trie_match(client->sub_trie, topic_name,
+                                        topic_name_len);
     }
     return sub;
 }
@@ -717,8 +717,7 @@ static void recv_cb(void *arg)
         topic, (int) qos, payload_len);
 
     nng_mtx_lock(client->mtx);
-    subscription =
-        subscription_find_match(client->subscriptions, topic, topic_len);
+    subscription = subscription_find_match(client, topic, topic_len);
     if (NULL != subscription) {
         task_t *task = client_alloc_task(client);
         if (NULL != task) {
@@ -797,22 +796,28 @@ static inline size_t client_task_free_list_len(neu_mqtt_client_t *client)
     return count;
 }
 
-static inline void client_add_subscription(neu_mqtt_client_t *client,
-                                           subscription_t *   sub)
+static inline int client_add_subscription(neu_mqtt_client_t *client,
+                                          subscription_t *   sub)
 {
     subscription_t *old = NULL;
 
+    if (sub == neu_mqtt_topic_trie_add(client->sub_trie, sub->topic, sub)) {
+        return -1;
+    }
+
     HASH_FIND_STR(client->subscriptions, sub->topic, old);
     if (old) {
         HASH_DEL(client->subscriptions, old);
         subscription_free(old);
     }
     HASH_ADD_STR(client->subscriptions, topic, sub);
+    return 0;
 }
 
 static inline void client_del_subscription(neu_mqtt_client_t *client,
                                            subscription_t *   sub)
 {
+    neu_mqtt_topic_trie_del(client->sub_trie, sub->topic);
     HASH_DEL(client->subscriptions, sub);
     if (sub->ack) {
         client->suback_count -= 1;
@@ -1026,6 +1031,14 @@ neu_mqtt_client_t *neu_mqtt_client_new(neu_mqtt_version_e version)
         return NULL;
     }
 
+    client->sub_trie = neu_mqtt_topic_trie_new();
+    if (NULL == client->sub_trie) {
+        nng_msg_free(client->conn_msg);
+        nng_mtx_free(client->mtx);
+        free(client);
+        return NULL;
+    }
+
     client->version    = version;
     client->retry      = NEU_MQTT_CACHE_SYNC_INTERVAL_DEFAULT;
     client->task_limit = 1024;
@@ -1060,6 +1073,7 @@ void neu_mqtt_client_free(neu_mqtt_client_t *client)
         }
         nng_aio_free(client->recv_aio);
         subscriptions_free(client->subscriptions);
+        neu_mqtt_topic_trie_free(client->sub_trie);
         tasks_free(client->task_free_list);
         nng_msg_free(client->conn_msg);
         free(client->db);
@@ -1611,50 +1625,20 @@ int neu_mqtt_client_close(neu_mqtt_client_t *client)
     return 0;
 }
 
+// one of `cb` and `done` is called on completion, `payload` is only kept to
+// be passed back to `cb`
+static int client_publish(neu_mqtt_client_t *client, neu_mqtt_qos_e qos,
+                          char *topic, uint8_t *payload, uint32_t len,
+                          void *data, neu_mqtt_client_publish_cb_t cb,
+                          neu_mqtt_client_publish_done_cb_t done,
+                          const neu_mqtt_user_prop_t *props, size_t n_prop);
+
 int neu_mqtt_client_publish(neu_mqtt_client_t *client, neu_mqtt_qos_e qos,
                             char *topic, uint8_t *payload, uint32_t len,
                             void *data, neu_mqtt_client_publish_cb_t cb)
 {
-    int      rv      = 0;
-    nng_msg *pub_msg = NULL;
-    task_t * task    = NULL;
-
-    if (0 != (rv = nng_mqtt_msg_alloc(&pub_msg, 0))) {
-        log(error, "nng_mqtt_msg_alloc fail: %s", nng_strerror(rv));
-        return -1;
-    }
-
-    if (0 != (rv = nng_mqtt_msg_set_publish_topic(pub_msg, topic))) {
-        nng_msg_free(pub_msg);
-        log(error, "nng_mqtt_msg_set_publish_topic fail: %s", nng_strerror(rv));
-        return -1;
-    }
-
-    nng_mqtt_msg_set_packet_type(pub_msg, NNG_MQTT_PUBLISH);
-    nng_mqtt_msg_set_publish_payload(pub_msg, (uint8_t *) payload, len);
-    nng_mqtt_msg_set_publish_qos(pub_msg, qos);
-
-    nng_mtx_lock(client->mtx);
-    task = client_alloc_task(client);
-    nng_mtx_unlock(client->mtx);
-
-    if (NULL == task) {
-        nng_msg_free(pub_msg);
-        log(error, "client_alloc_task fail");
-        return -1;
-    }
-
-    task->kind        = TASK_PUB;
-    task->pub.cb      = cb;
-    task->pub.qos     = qos;
-    task->pub.topic   = topic;
-    task->pub.payload = payload;
-    task->pub.len     = len;
-    task->pub.data    = data;
-    nng_aio_set_msg(task->aio, pub_msg);
-    nng_send_aio(client->sock, task->aio);
-
-    return 0;
+    return client_publish(client, qos, topic, payload, len, data, cb, NULL,
+                          NULL, 0);
 }
 
 int neu_mqtt_client_publish_with_trace(neu_mqtt_client_t *client,
@@ -1663,6 +1647,33 @@ int neu_mqtt_client_publish_with_trace(neu_mqtt_client_t *client,
                                        void *                       data,
                                        neu_mqtt_client_publish_cb_t cb,
                                        const char *                 traceparent)
+{
+    neu_mqtt_user_prop_t prop = {
+        .name  = "traceparent",
+        .value = traceparent,
+    };
+
+    return client_publish(client, qos, topic, payload, len, data, cb, NULL,
+                          &prop, 1);
+}
+
+int neu_mqtt_client_publish_with_props(neu_mqtt_client_t *client,
+                                       neu_mqtt_qos_e qos, char *topic,
+                                       uint8_t *payload, uint32_t len,
+                                       void *                            data,
+                                       neu_mqtt_client_publish_done_cb_t cb,
+                                       const neu_mqtt_user_prop_t *      props,
+                                       size_t                            n_prop)
+{
+    return client_publish(client, qos, topic, payload, len, data, NULL, cb,
+                          props, n_prop);
+}
+
+static int client_publish(neu_mqtt_client_t *client, neu_mqtt_qos_e qos,
+                          char *topic, uint8_t *payload, uint32_t len,
+                          void *data, neu_mqtt_client_publish_cb_t cb,
+                          neu_mqtt_client_publish_done_cb_t done,
+                          const neu_mqtt_user_prop_t *props, size_t n_prop)
 {
     int      rv      = 0;
     nng_msg *pub_msg = NULL;
@@ -1680,15 +1691,18 @@ int neu_mqtt_client_publish_with_trace(neu_mqtt_client_t *client,
     }
 
     nng_mqtt_msg_set_packet_type(pub_msg, NNG_MQTT_PUBLISH);
-    nng_mqtt_msg_set_publish_payload(pub_msg, (uint8_t *) payload, len);
+    // NOTE: the payload is copied into the message, which nng owns from now on
+    nng_mqtt_msg_set_publish_payload(pub_msg, payload, len);
     nng_mqtt_msg_set_publish_qos(pub_msg, qos);
 
-    if (client->version == MQTT_PROTOCOL_VERSION_v5) {
+    if (client->version == MQTT_PROTOCOL_VERSION_v5 && n_prop > 0) {
         property *plist = mqtt_property_alloc();
-        property *p     = mqtt_property_set_value_strpair(
-            USER_PROPERTY, "traceparent", strlen("traceparent"), traceparent,
-            strlen(traceparent), true);
-        mqtt_property_append(plist, p);
+        for (size_t i = 0; i < n_prop; ++i) {
+            property *p = mqtt_property_set_value_strpair(
+                USER_PROPERTY, props[i].name, strlen(props[i].name),
+                props[i].value, strlen(props[i].value), true);
+            mqtt_property_append(plist, p);
+        }
         nng_mqtt_msg_set_publish_property(pub_msg, plist);
     }
 
@@ -1704,6 +1718,7 @@ int neu_mqtt_client_publish_with_trace(neu_mqtt_client_t *client,
 
     task->kind        = TASK_PUB;
     task->pub.cb      = cb;
+    task->pub.done    = done;
     task->pub.qos     = qos;
     task->pub.topic   = topic;
     task->pub.payload = payload;
@@ -1752,7 +1767,10 @@ int neu_mqtt_client_subscribe(neu_mqtt_client_t *client, neu_mqtt_qos_e qos,
         }
     }
 
-    client_add_subscription(client, subscription);
+    if (0 != client_add_subscription(client, subscription)) {
+        log(error, "client_add_subscription fail");
+        goto error;
+    }
     nng_mtx_unlock(client->mtx);
 
     return 0;
@@ -0,0 +1,324 @@
+/**
+ * NEURON IIoT System for Industry 4.0
+ * Copyright (C) 2020-2022 EMQ Technologies Co., Ltd All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ **/
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils/uthash.h"
+
+#include "connection/mqtt_topic_trie.h"
+
+typedef struct topic_node_s topic_node_t;
+
+struct topic_node_s {
+    char *         level;    // NULL for the root, `+` and `#` nodes
+    size_t         ref;      // number of filters ending at or under this node
+    void *         data;     // data of the filter ending at this node
+    topic_node_t * children; // literal levels
+    topic_node_t * plus;
+    topic_node_t * hash;
+    UT_hash_handle hh;
+};
+
+struct neu_mqtt_topic_trie_s {
+    topic_node_t root;
+    size_t       count;
+};
+
+typedef struct {
+    topic_node_t *node;
+    const char *  level; // start of the next topic level, NULL if none left
+} match_frame_t;
+
+static inline size_t level_len(const char *s, const char *end)
+{
+    const char *sep = memchr(s, '/', end - s);
+    return (sep ? sep : end) - s;
+}
+
+static inline size_t level_count(const char *s)
+{
+    size_t n = 1;
+    while ((s = strchr(s, '/'))) {
+        ++s;
+        ++n;
+    }
+    return n;
+}
+
+static void node_free(topic_node_t *node);
+
+static void node_clear(topic_node_t *node)
+{
+    topic_node_t *child = NULL, *tmp = NULL;
+
+    HASH_ITER(hh, node->children, child, tmp)
+    {
+        HASH_DEL(node->children, child);
+        node_free(child);
+    }
+    if (node->plus) {
+        node_free(node->plus);
+    }
+    if (node->hash) {
+        node_free(node->hash);
+    }
+}
+
+static void node_free(topic_node_t *node)
+{
+    node_clear(node);
+    free(node->level);
+    free(node);
+}
+
+static topic_node_t *node_child(topic_node_t *node, const char *level,
+                                size_t len, bool create)
+{
+    topic_node_t * child = NULL;
+    topic_node_t **slot  = NULL;
+
+    if (1 == len && '+' == *level) {
+        slot = &node->plus;
+    } else if (1 == len && '#' == *level) {
+        slot = &node->hash;
+    } else {
+        HASH_FIND(hh, node->children, level, len, child);
+        if (NULL != child || !create) {
+            return child;
+        }
+
+        child = calloc(1, sizeof(*child));
+        if (NULL == child) {
+            return NULL;
+        }
+        child->level = strndup(level, len);
+        if (NULL == child->level) {
+            free(child);
+            return NULL;
+        }
+        HASH_ADD_KEYPTR(hh, node->children, child->level, len, child);
+        return child;
+    }
+
+    if (NULL == *slot && create) {
+        *slot = calloc(1, sizeof(**slot));
+    }
+    return *slot;
+}
+
+// NOTE: `child` should not be used by any filter
+static void node_unlink(topic_node_t *node, topic_node_t *child)
+{
+    if (node->plus == child) {
+        node->plus = NULL;
+    } else if (node->hash == child) {
+        node->hash = NULL;
+    } else {
+        HASH_DEL(node->children, child);
+    }
+    node_free(child);
+}
+
+// fill `path` with the nodes of the `n` levels of `filter` after the root
+static bool walk(neu_mqtt_topic_trie_t *trie, const char *filter,
+                 topic_node_t **path, size_t n, bool create)
+{
+    const char *s   = filter;
+    const char *end = filter + strlen(filter);
+
+    path[0] = &trie->root;
+    for (size_t i = 1; i <= n; ++i) {
+        size_t len = level_len(s, end);
+
+        path[i] = node_child(path[i - 1], s, len, create);
+        if (NULL == path[i]) {
+            return false;
+        }
+        s += len + 1;
+    }
+
+    return true;
+}
+
+neu_mqtt_topic_trie_t *neu_mqtt_topic_trie_new(void)
+{
+    return calloc(1, sizeof(neu_mqtt_topic_trie_t));
+}
+
+void neu_mqtt_topic_trie_free(neu_mqtt_topic_trie_t *trie)
+{
+    if (trie) {
+        node_clear(&trie->root);
+        free(trie);
+    }
+}
+
+size_t neu_mqtt_topic_trie_count(neu_mqtt_topic_trie_t *trie)
+{
+    return trie->count;
+}
+
+void *neu_mqtt_topic_trie_add(neu_mqtt_topic_trie_t *trie,
+                              const char *topic_filter, void *data)
+{
+    size_t         n    = level_count(topic_filter);
+    topic_node_t **path = calloc(n + 1, sizeof(*path));
+    void *         old  = NULL;
+
+    if (NULL == path) {
+        return data;
+    }
+
+    if (!walk(trie, topic_filter, path, n, true)) {
+        // release the nodes just created, which no filter uses yet
+        for (size_t i = n; i > 0; --i) {
+            if (path[i] && 0 == path[i]->ref) {
+                node_unlink(path[i - 1], path[i]);
+            }
+        }
+        free(path);
+        return data;
+    }
+
+    old           = path[n]->data;
+    path[n]->data = data;
+    if (NULL == old) {
+        for (size_t i = 1; i <= n; ++i) {
+            path[i]->ref += 1;
+        }
+        trie->count += 1;
+    }
+
+    free(path);
+    return old;
+}
+
+void *neu_mqtt_topic_trie_del(neu_mqtt_topic_trie_t *trie,
+                              const char *           topic_filter)
+{
+    size_t         n    = level_count(topic_filter);
+    topic_node_t **path = calloc(n + 1, sizeof(*path));
+    void *         data = NULL;
+
+    if (NULL == path) {
+        return NULL;
+    }
+
+    if (walk(trie, topic_filter, path, n, false) && path[n]->data) {
+        data          = path[n]->data;
+        path[n]->data = NULL;
+        for (size_t i = n; i > 0; --i) {
+            if (0 == --path[i]->ref) {
+                node_unlink(path[i - 1], path[i]);
+            }
+        }
+        trie->count -= 1;
+    }
+
+    free(path);
+    return data;
+}
+
+void *neu_mqtt_topic_trie_get(neu_mqtt_topic_trie_t *trie,
+                              const char *           topic_filter)
+{
+    topic_node_t *node = &trie->root;
+    const char *  s    = topic_filter;
+    const char *  end  = topic_filter + strlen(topic_filter);
+
+    while (node) {
+        size_t len = level_len(s, end);
+
+        node = node_child(node, s, len, false);
+        if (s + len == end) {
+            break;
+        }
+        s += len + 1;
+    }
+
+    return node ? node->data : NULL;
+}
+
+void *neu_mqtt_topic_trie_match(neu_mqtt_topic_trie_t *trie,
+                                const char *           topic_name,
+                                uint32_t               topic_name_len)
+{
+    match_frame_t  buf[32];
+    match_frame_t *stack = buf;
+    size_t         cap   = sizeof(buf) / sizeof(buf[0]);
+    size_t         top   = 0;
+    const char *   end   = topic_name + topic_name_len;
+    void *         data  = NULL;
+
+    stack[top++] = (match_frame_t) { &trie->root, topic_name };
+
+    while (top > 0 && NULL == data) {
+        match_frame_t frame = stack[--top];
+        topic_node_t *node  = frame.node;
+        const char *  s     = frame.level;
+
+        if (NULL == s) {
+            // no level left, `#` also matches the parent level
+            data = node->data ? node->data
+                              : (node->hash ? node->hash->data : NULL);
+            continue;
+        }
+
+        if (top + 3 > cap) {
+            match_frame_t *p = malloc(2 * cap * sizeof(*p));
+            if (NULL == p) {
+                break;
+            }
+            memcpy(p, stack, top * sizeof(*p));
+            if (stack != buf) {
+                free(stack);
+            }
+            stack = p;
+            cap *= 2;
+        }
+
+        size_t        len     = level_len(s, end);
+        const char *  next    = s + len < end ? s + len + 1 : NULL;
+        topic_node_t *literal = NULL;
+
+        HASH_FIND(hh, node->children, s, len, literal);
+
+        // wildcards of the first level do not match names starting with `$`
+        // [MQTT-4.7.2-1]
+        if (node != &trie->root || '$' != *s) {
+            // pushed in reverse order of preference
+            if (node->hash) {
+                stack[top++] = (match_frame_t) { node->hash, NULL };
+            }
+            if (node->plus) {
+                stack[top++] = (match_frame_t) { node->plus, next };
+            }
+        }
+        if (literal) {
+            stack[top++] = (match_frame_t) { literal, next };
+        }
+    }
+
+    if (stack != buf) {
+        free(stack);
+    }
+    return data;
+}
@@ -38,6 +38,7 @@
 #include "adapter/driver/driver_internal.h"
 #include "adapter/storage.h"
 #include "argparse.h"
+#include "base/config_gen.h"
 #include "base/msg_internal.h"
 #include "errcodes.h"
 #include "otel/otel_manager.h"
@@ -734,6 +735,7 @@ static int manager_loop(enum neu_event_io_type type, int fd, void *usr_data)
             if (cmd->setting) {
                 adapter_storage_setting(cmd->node, cmd->setting);
             }
+            neu_config_gen_bump(cmd->node, NULL);
         }
 
         neu_req_add_node_fini(cmd);
@@ -815,6 +817,7 @@ static int manager_loop(enum neu_event_io_type type, int fd, void *usr_data)
             }
             utarray_free(subscriptions);
         }
+        neu_config_gen_bump(cmd->node, NULL);
 
         neu_reqresp_node_deleted_t resp = { 0 };
         strcpy(resp.node, header->receiver);
@@ -855,6 +858,7 @@ static int manager_loop(enum neu_event_io_type type, int fd, void *usr_data)
         neu_resp_node_uninit_t *cmd = (neu_resp_node_uninit_t *) &header[1];
 
         neu_manager_del_node(manager, cmd->node);
+        neu_config_gen_bump(cmd->node, NULL);
         if (strlen(header->receiver) > 0 &&
             strcmp(header->receiver, "manager") != 0) {
             neu_resp_error_t error = { 0 };
@@ -892,8 +896,12 @@ static int manager_loop(enum neu_event_io_type type, int fd, void *usr_data)
             cmd->port = app_port;
             forward_msg_copy(manager, header, cmd->app);
             forward_msg_copy(manager, header, cmd->driver);
-            manager_storage_subscribe(manager, cmd->app, cmd->driver,
-                                      cmd->group, cmd->params);
+            // the REST streams subscribe as long as they are connected
+            if (0 != strcmp(cmd->app, DEFAULT_DASHBOARD_ADAPTER_NAME)) {
+                manager_storage_subscribe(manager, cmd->app, cmd->driver,
+                                          cmd->group, cmd->params);
+                neu_config_gen_bump(cmd->app, NULL);
+            }
         } else {
             free(cmd->params);
         }
@@ -930,6 +938,7 @@ static int manager_loop(enum neu_event_io_type type, int fd, void *usr_data)
             manager_storage_subscribe(manager, cmd->app, info->driver,
                                       info->group, info->params);
         }
+        neu_config_gen_bump(cmd->app, NULL);
 
         neu_req_subscribe_groups_fini(cmd);
         header->type = NEU_RESP_ERROR;
@@ -950,6 +959,7 @@ static int manager_loop(enum neu_event_io_type type, int fd, void *usr_data)
             forward_msg_copy(manager, header, cmd->app);
             manager_storage_update_subscribe(manager, cmd->app, cmd->driver,
                                              cmd->group, cmd->params);
+            neu_config_gen_bump(cmd->app, NULL);
         } else {
             free(cmd->params);
         }
@@ -970,8 +980,11 @@ static int manager_loop(enum neu_event_io_type type, int fd, void *usr_data)
         if (error.error == NEU_ERR_SUCCESS) {
             forward_msg_copy(manager, header, cmd->app);
             forward_msg_copy(manager, header, cmd->driver);
-            manager_storage_unsubscribe(manager, cmd->app, cmd->driver,
-                                        cmd->group);
+            if (0 != strcmp(cmd->app, DEFAULT_DASHBOARD_ADAPTER_NAME)) {
+                manager_storage_unsubscribe(manager, cmd->app, cmd->driver,
+                                            cmd->group);
+                neu_config_gen_bump(cmd->app, NULL);
+            }
         }
 
         header->type = NEU_RESP_ERROR;
@@ -1154,6 +1167,8 @@ static int manager_loop(enum neu_event_io_type type, int fd, void *usr_data)
         if (0 == resp->error) {
             neu_manager_update_node_name(manager, resp->node, resp->new_name);
             manager_storage_update_node(manager, resp->node, resp->new_name);
+            neu_config_gen_bump(resp->node, NULL);
+            neu_config_gen_bump(resp->new_name, NULL);
 
             if (neu_node_manager_is_driver(manager->node_manager,
                                            resp->new_name)) {
@@ -1243,6 +1258,7 @@ static int manager_loop(enum neu_event_io_type type, int fd, void *usr_data)
             forward_msg(manager, header, header->receiver);
             neu_subscribe_manager_remove(manager->subscribe_manager,
                                          cmd->driver, cmd->group);
+            neu_config_gen_bump(cmd->driver, cmd->group);
 
             if (NULL == apps) {
                 break;
@@ -1348,6 +1364,7 @@ static int manager_loop(enum neu_event_io_type type, int fd, void *usr_data)
     case NEU_RESP_TEST_READ_TAG:
     case NEU_RESP_PRGFILE_PROCESS:
     case NEU_RESP_SCAN_TAGS:
+    case NEU_RESP_WRITE_TAGS:
         forward_msg(manager, header, header->receiver);
         break;
 
@@ -1385,6 +1402,7 @@ static int manager_loop(enum neu_event_io_type type, int fd, void *usr_data)
                         driver->node, driver->groups[j].group,
                         driver->groups[j].tags, driver->groups[j].n_tag);
                 }
+                neu_config_gen_bump(driver->node, NULL);
             }
         }
 
@@ -28,6 +28,7 @@
 #include <unistd.h>
 
 #include "core/manager.h"
+#include "utils/http.h"
 #include "utils/log.h"
 #include "utils/time.h"
 
@@ -40,6 +41,7 @@ static neu_manager_t *g_manager         = NULL;
 zlog_category_t *     neuron            = NULL;
 bool                  disable_jwt       = false;
 bool                  sub_filter_err    = false;
+uint32_t              app_workers       = 1;
 int                   default_log_level = ZLOG_LEVEL_NOTICE;
 char                  host_port[32]     = { 0 };
 char                  g_status[32]      = { 0 };
@@ -172,6 +174,8 @@ int main(int argc, char *argv[])
 
     disable_jwt    = args.disable_auth;
     sub_filter_err = args.sub_filter_err;
+    app_workers    = args.app_workers;
+    neu_http_set_gzip(args.gzip_level, args.gzip_min_size);
     snprintf(host_port, sizeof(host_port), "http://%s:%d", args.ip, args.port);
 
     if (args.daemonized) {
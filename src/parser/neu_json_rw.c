@@ -35,6 +35,45 @@
 
 #include "json/neu_json_rw.h"
 
+// fills in the members of a tag object, returns the number of members
+static int read_resp_tag_elems(neu_json_read_resp_tag_t *p_tag,
+                               neu_json_elem_t *         tag_elems)
+{
+    int if_precision = 0;
+
+    tag_elems[0].name      = "name";
+    tag_elems[0].t         = NEU_JSON_STR;
+    tag_elems[0].v.val_str = p_tag->name;
+
+    if (p_tag->error != 0) {
+        tag_elems[1].name      = "error";
+        tag_elems[1].t         = NEU_JSON_INT;
+        tag_elems[1].v.val_int = p_tag->error;
+    } else {
+        tag_elems[1].name      = "value";
+        tag_elems[1].t         = p_tag->t;
+        tag_elems[1].v         = p_tag->value;
+        tag_elems[1].precision = p_tag->precision;
+        tag_elems[1].bias      = p_tag->datatag.bias;
+
+        if (p_tag->t == NEU_JSON_FLOAT || p_tag->t == NEU_JSON_DOUBLE) {
+            if_precision      = 1;
+            tag_elems[2].name = "transferPrecision";
+            tag_elems[2].t    = NEU_JSON_INT;
+            tag_elems[2].v.val_int =
+                p_tag->precision > 0 ? p_tag->precision : 1;
+        }
+    }
+
+    for (int k = 0; k < p_tag->n_meta; k++) {
+        tag_elems[if_precision + 2 + k].name = p_tag->metas[k].name;
+        tag_elems[if_precision + 2 + k].t    = p_tag->metas[k].t;
+        tag_elems[if_precision + 2 + k].v    = p_tag->metas[k].value;
+    }
+
+    return 2 + if_precision + p_tag->n_meta;
+}
+
 int neu_json_encode_read_resp(void *json_object, void *param)
 {
     int                   ret  = 0;
@@ -43,41 +82,11 @@ int neu_json_encode_read_resp(void *json_object, void *param)
     void *                    tag_array = neu_json_array();
     neu_json_read_resp_tag_t *p_tag     = resp->tags;
     for (int i = 0; i < resp->n_tag; i++) {
-        neu_json_elem_t tag_elems[2 + NEU_TAG_META_SIZE] = { 0 };
-        int             if_precision                     = 0;
-
-        tag_elems[0].name      = "name";
-        tag_elems[0].t         = NEU_JSON_STR;
-        tag_elems[0].v.val_str = p_tag->name;
-
-        if (p_tag->error != 0) {
-            tag_elems[1].name      = "error";
-            tag_elems[1].t         = NEU_JSON_INT;
-            tag_elems[1].v.val_int = p_tag->error;
-        } else {
-            tag_elems[1].name      = "value";
-            tag_elems[1].t         = p_tag->t;
-            tag_elems[1].v         = p_tag->value;
-            tag_elems[1].precision = p_tag->precision;
-            tag_elems[1].bias      = p_tag->datatag.bias;
-
-            if (p_tag->t == NEU_JSON_FLOAT || p_tag->t == NEU_JSON_DOUBLE) {
-                if_precision      = 1;
-                tag_elems[2].name = "transferPrecision";
-                tag_elems[2].t    = NEU_JSON_INT;
-                tag_elems[2].v.val_int =
-                    p_tag->precision > 0 ? p_tag->precision : 1;
-            }
-        }
-
-        for (int k = 0; k < p_tag->n_meta; k++) {
-            tag_elems[if_precision + 2 + k].name = p_tag->metas[k].name;
-            tag_elems[if_precision + 2 + k].t    = p_tag->metas[k].t;
-            tag_elems[if_precision + 2 + k].v    = p_tag->metas[k].value;
-        }
+        neu_json_elem_t tag_elems[3 + NEU_TAG_META_SIZE] = { 0 };
+        int             n                                = 0;
 
-        tag_array = neu_json_encode_array(tag_array, tag_elems,
-                                          2 + if_precision + p_tag->n_meta);
+        n         = read_resp_tag_elems(p_tag, tag_elems);
+        tag_array = neu_json_encode_array(tag_array, tag_elems, n);
         p_tag++;
     }
 
@@ -92,6 +101,15 @@ int neu_json_encode_read_resp(void *json_object, void *param)
     return ret;
 }
 
+int neu_json_encode_read_resp_tag(void *json_object, void *param)
+{
+    neu_json_read_resp_tag_t *tag = (neu_json_read_resp_tag_t *) param;
+    neu_json_elem_t           tag_elems[3 + NEU_TAG_META_SIZE] = { 0 };
+
+    return neu_json_encode_field(json_object, tag_elems,
+                                 read_resp_tag_elems(tag, tag_elems));
+}
+
 int neu_json_encode_read_paginate_resp(void *json_object, void *param)
 {
     int                            ret = 0;
@@ -226,6 +244,38 @@ int neu_json_encode_test_read_tag_resp(void *json_object, void *param)
     return ret;
 }
 
+int neu_json_encode_write_tags_resp(void *json_object, void *param)
+{
+    neu_resp_write_tags_t *resp   = (neu_resp_write_tags_t *) param;
+    void *                 errors = neu_json_encode_new();
+
+    utarray_foreach(resp->tags, neu_resp_write_tag_error_t *, tag)
+    {
+        neu_json_elem_t tag_elem = {
+            .name      = tag->tag,
+            .t         = NEU_JSON_INT,
+            .v.val_int = tag->error,
+        };
+        neu_json_encode_field(errors, &tag_elem, 1);
+    }
+
+    neu_json_elem_t resp_elems[] = {
+        {
+            .name      = "error",
+            .t         = NEU_JSON_INT,
+            .v.val_int = resp->error,
+        },
+        {
+            .name         = "errors",
+            .t            = NEU_JSON_OBJECT,
+            .v.val_object = errors,
+        },
+    };
+
+    return neu_json_encode_field(json_object, resp_elems,
+                                 NEU_JSON_ELEM_SIZE(resp_elems));
+}
+
 int neu_json_encode_read_resp1(void *json_object, void *param)
 {
     int                   ret  = 0;
@@ -361,6 +411,7 @@ int neu_json_encode_read_resp_ecp(void *json_object, void *param)
         tag_elems[0].v.val_str = p_tag->name;
 
         if (p_tag->error != 0) {
+            p_tag++;
             continue;
         } else {
             tag_elems[1].name      = "value";
@@ -752,21 +803,9 @@ void neu_json_decode_write_free(neu_json_write_t *req)
     }
 }
 
-int neu_json_decode_read_req(char *buf, neu_json_read_req_t **result)
+static int decode_read_req_json(void *json_obj, neu_json_read_req_t *req)
 {
-    int   ret      = 0;
-    void *json_obj = NULL;
-
-    json_obj = neu_json_decode_new(buf);
-    if (NULL == json_obj) {
-        return -1;
-    }
-
-    neu_json_read_req_t *req = calloc(1, sizeof(neu_json_read_req_t));
-    if (req == NULL) {
-        neu_json_decode_free(json_obj);
-        return -1;
-    }
+    int ret = 0;
 
     neu_json_elem_t req_elems[] = {
         {
@@ -815,12 +854,6 @@ int neu_json_decode_read_req(char *buf, neu_json_read_req_t **result)
         goto error;
     }
 
-    req->node   = req_elems[0].v.val_str;
-    req->group  = req_elems[1].v.val_str;
-    req->sync   = req_elems[2].v.val_bool;
-    req->n_tags = req_elems[4].v.val_array_str.length;
-    req->tags   = req_elems[4].v.val_array_str.p_strs;
-
     if (req_elems[3].v.val_object) {
         ret = neu_json_decode_by_json(req_elems[3].v.val_object,
                                       NEU_JSON_ELEM_SIZE(query_elems),
@@ -828,12 +861,15 @@ int neu_json_decode_read_req(char *buf, neu_json_read_req_t **result)
         if (ret != 0) {
             goto error;
         }
-        req->name = query_elems[0].v.val_str;
-        req->desc = query_elems[1].v.val_str;
     }
 
-    *result = req;
-    neu_json_decode_free(json_obj);
+    req->node   = req_elems[0].v.val_str;
+    req->group  = req_elems[1].v.val_str;
+    req->sync   = req_elems[2].v.val_bool;
+    req->n_tags = req_elems[4].v.val_array_str.length;
+    req->tags   = req_elems[4].v.val_array_str.p_strs;
+    req->name   = query_elems[0].v.val_str;
+    req->desc   = query_elems[1].v.val_str;
     return ret;
 
 error:
@@ -841,10 +877,37 @@ error:
     free(query_elems[1].v.val_str);
     free(req_elems[0].v.val_str);
     free(req_elems[1].v.val_str);
-    free(req);
-    if (json_obj != NULL) {
+    for (int i = 0; i < req_elems[4].v.val_array_str.length; i++) {
+        free(req_elems[4].v.val_array_str.p_strs[i]);
+    }
+    free(req_elems[4].v.val_array_str.p_strs);
+    return ret;
+}
+
+int neu_json_decode_read_req(char *buf, neu_json_read_req_t **result)
+{
+    int   ret      = 0;
+    void *json_obj = NULL;
+
+    json_obj = neu_json_decode_new(buf);
+    if (NULL == json_obj) {
+        return -1;
+    }
+
+    neu_json_read_req_t *req = calloc(1, sizeof(neu_json_read_req_t));
+    if (req == NULL) {
         neu_json_decode_free(json_obj);
+        return -1;
+    }
+
+    ret = decode_read_req_json(json_obj, req);
+    if (ret != 0) {
+        free(req);
+    } else {
+        *result = req;
     }
+
+    neu_json_decode_free(json_obj);
     return ret;
 }
 
@@ -864,6 +927,126 @@ void neu_json_decode_read_req_free(neu_json_read_req_t *req)
     free(req);
 }
 
+int neu_json_decode_read_groups_req(char *                       buf,
+                                    neu_json_read_groups_req_t **result)
+{
+    int   ret      = 0;
+    void *json_obj = NULL;
+    void *groups   = NULL;
+
+    json_obj = neu_json_decode_new(buf);
+    if (NULL == json_obj) {
+        return -1;
+    }
+
+    neu_json_read_groups_req_t *req =
+        calloc(1, sizeof(neu_json_read_groups_req_t));
+    if (req == NULL) {
+        neu_json_decode_free(json_obj);
+        return -1;
+    }
+
+    neu_json_elem_t req_elems[] = {
+        {
+            .name      = "timeout",
+            .t         = NEU_JSON_INT,
+            .attribute = NEU_JSON_ATTRIBUTE_OPTIONAL,
+        },
+        {
+            .name = "groups",
+            .t    = NEU_JSON_OBJECT,
+        },
+    };
+
+    ret = neu_json_decode_by_json(json_obj, NEU_JSON_ELEM_SIZE(req_elems),
+                                  req_elems);
+    groups = req_elems[1].v.val_object;
+    if (ret != 0 || !json_is_array((json_t *) groups) ||
+        0 == json_array_size(groups)) {
+        ret = -1;
+        goto error;
+    }
+
+    req->timeout = req_elems[0].v.val_int;
+    req->groups =
+        calloc(json_array_size(groups), sizeof(neu_json_read_req_t));
+    if (NULL == req->groups) {
+        ret = -1;
+        goto error;
+    }
+    req->n_group = json_array_size(groups);
+
+    for (int i = 0; i < req->n_group; i++) {
+        ret = decode_read_req_json(json_array_get(groups, i), &req->groups[i]);
+        if (ret != 0) {
+            goto error;
+        }
+    }
+
+    *result = req;
+    neu_json_decode_free(json_obj);
+    return ret;
+
+error:
+    neu_json_decode_read_groups_req_free(req);
+    neu_json_decode_free(json_obj);
+    return ret;
+}
+
+void neu_json_decode_read_groups_req_free(neu_json_read_groups_req_t *req)
+{
+    for (int i = 0; i < req->n_group; i++) {
+        neu_json_read_req_t *group = &req->groups[i];
+
+        free(group->group);
+        free(group->node);
+        free(group->name);
+        free(group->desc);
+        for (int k = 0; k < group->n_tags; k++) {
+            free(group->tags[k]);
+        }
+        free(group->tags);
+    }
+
+    free(req->groups);
+    free(req);
+}
+
+int neu_json_encode_read_groups_resp_group(void *json_object, void *param)
+{
+    neu_json_read_groups_resp_group_t *group =
+        (neu_json_read_groups_resp_group_t *) param;
+
+    neu_json_elem_t group_elems[] = {
+        {
+            .name      = "node",
+            .t         = NEU_JSON_STR,
+            .v.val_str = group->node,
+        },
+        {
+            .name      = "group",
+            .t         = NEU_JSON_STR,
+            .v.val_str = group->group,
+        },
+        {
+            .name      = "error",
+            .t         = NEU_JSON_INT,
+            .v.val_int = group->error,
+        },
+    };
+
+    if (0 !=
+        neu_json_encode_field(json_object, group_elems,
+                              NEU_JSON_ELEM_SIZE(group_elems) -
+                                  (0 == group->error))) {
+        return -1;
+    }
+
+    return 0 == group->error
+        ? neu_json_encode_read_resp(json_object, &group->resp)
+        : 0;
+}
+
 int neu_json_decode_read_paginate_req(char *                         buf,
                                       neu_json_read_paginate_req_t **result)
 {
@@ -1101,6 +1284,21 @@ int neu_json_encode_read_periodic_resp(void *json_object, void *param)
     ret = neu_json_encode_field(json_object, resp_elems,
                                 NEU_JSON_ELEM_SIZE(resp_elems));
 
+    if (0 == ret && resp->seq > 0) {
+        neu_json_elem_t delta_elems[] = { {
+                                              .name      = "seq",
+                                              .t         = NEU_JSON_INT,
+                                              .v.val_int = resp->seq,
+                                          },
+                                          {
+                                              .name       = "keyframe",
+                                              .t          = NEU_JSON_BOOL,
+                                              .v.val_bool = resp->keyframe,
+                                          } };
+        ret = neu_json_encode_field(json_object, delta_elems,
+                                    NEU_JSON_ELEM_SIZE(delta_elems));
+    }
+
     return ret;
 }
 
@@ -0,0 +1,776 @@
+/**
+ * NEURON IIoT System for Industry 4.0
+ * Copyright (C) 2020-2022 EMQ Technologies Co., Ltd All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ **/
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <jansson.h>
+
+#include "define.h"
+#include "msg.h"
+#include "json/json.h"
+
+#include "json/neu_json_stream.h"
+
+/*
+ * The output mirrors json_dumps(root, JSON_REAL_PRECISION(16)) of the object
+ * built by the jansson encoders: ", " and ": " separators, keys in insertion
+ * order, and members whose value jansson refuses (NULL or invalid UTF-8
+ * strings, non finite reals, unsupported types) are left out. Reals are
+ * printed by jansson itself, so the digits are always the same.
+ */
+
+#define STREAM_REAL_MAX 128
+
+typedef struct {
+    json_t *real;                   // array items, json_real
+    json_t *realp[UINT8_MAX + 1];   // tag values, json_realp per precision
+    bool    error;
+} stream_ctx_t;
+
+typedef struct {
+    char *        data;
+    size_t        len;
+    size_t        size;
+    stream_ctx_t *ctx;
+} stream_t;
+
+// keys already written into a tag object
+typedef struct {
+    const char *keys[3 + NEU_TAG_META_SIZE];
+    int         n;
+} stream_keys_t;
+
+static void stream_init(stream_t *s, stream_ctx_t *ctx, size_t size)
+{
+    s->data = malloc(size);
+    s->len  = 0;
+    s->size = size;
+    s->ctx  = ctx;
+
+    if (s->data == NULL) {
+        s->size    = 0;
+        ctx->error = true;
+    }
+}
+
+static int stream_reserve(stream_t *s, size_t n)
+{
+    if (s->ctx->error) {
+        return -1;
+    }
+
+    if (s->len + n + 1 > s->size) {
+        size_t size = s->size * 2;
+        char * data = NULL;
+
+        while (s->len + n + 1 > size) {
+            size *= 2;
+        }
+
+        data = realloc(s->data, size);
+        if (data == NULL) {
+            s->ctx->error = true;
+            return -1;
+        }
+
+        s->data = data;
+        s->size = size;
+    }
+
+    return 0;
+}
+
+static void put_raw(stream_t *s, const void *data, size_t n)
+{
+    if (stream_reserve(s, n) == 0) {
+        memcpy(s->data + s->len, data, n);
+        s->len += n;
+    }
+}
+
+static void put_int(stream_t *s, int64_t value)
+{
+    char     tmp[21];
+    size_t   i = sizeof(tmp);
+    uint64_t v = value < 0 ? -(uint64_t) value : (uint64_t) value;
+
+    do {
+        tmp[--i] = '0' + v % 10;
+        v /= 10;
+    } while (v > 0);
+
+    if (value < 0) {
+        tmp[--i] = '-';
+    }
+
+    put_raw(s, tmp + i, sizeof(tmp) - i);
+}
+
+static void put_bool(stream_t *s, bool value)
+{
+    if (value) {
+        put_raw(s, "true", 4);
+    } else {
+        put_raw(s, "false", 5);
+    }
+}
+
+// size of the UTF-8 sequence at `p`, 0 when jansson would reject it
+static int utf8_size(const uint8_t *p)
+{
+    uint32_t value = 0;
+    int      size  = 0;
+
+    if (p[0] < 0x80) {
+        return 1;
+    } else if (p[0] < 0xC2) {
+        return 0;
+    } else if (p[0] < 0xE0) {
+        size  = 2;
+        value = p[0] & 0x1F;
+    } else if (p[0] < 0xF0) {
+        size  = 3;
+        value = p[0] & 0x0F;
+    } else if (p[0] < 0xF5) {
+        size  = 4;
+        value = p[0] & 0x07;
+    } else {
+        return 0;
+    }
+
+    for (int i = 1; i < size; i++) {
+        if ((p[i] & 0xC0) != 0x80) {
+            return 0;
+        }
+        value = (value << 6) | (p[i] & 0x3F);
+    }
+
+    if (value > 0x10FFFF || (value >= 0xD800 && value <= 0xDFFF) ||
+        (size == 3 && value < 0x800) || (size == 4 && value < 0x10000)) {
+        return 0;
+    }
+
+    return size;
+}
+
+/*
+ * Return 1 and write nothing when jansson would not create the string, so
+ * the member or array item is left out.
+ */
+static int put_string(stream_t *s, const char *str)
+{
+    const uint8_t *p     = (const uint8_t *) str;
+    const uint8_t *begin = p;
+    size_t         mark  = s->len;
+
+    if (str == NULL) {
+        return 1;
+    }
+
+    put_raw(s, "\"", 1);
+    while (*p != 0) {
+        const char *escape  = NULL;
+        char        seq[7]  = { 0 };
+        int         n_utf8  = 0;
+        size_t      n_write = 2;
+
+        if (*p >= 0x80) {
+            n_utf8 = utf8_size(p);
+            if (n_utf8 == 0) {
+                s->len = mark;
+                return 1;
+            }
+
+            p += n_utf8;
+            continue;
+        }
+
+        if (*p >= 0x20 && *p != '"' && *p != '\\') {
+            p++;
+            continue;
+        }
+
+        switch (*p) {
+        case '"':
+            escape = "\\\"";
+            break;
+        case '\\':
+            escape = "\\\\";
+            break;
+        case '\b':
+            escape = "\\b";
+            break;
+        case '\f':
+            escape = "\\f";
+            break;
+        case '\n':
+            escape = "\\n";
+            break;
+        case '\r':
+            escape = "\\r";
+            break;
+        case '\t':
+            escape = "\\t";
+            break;
+        default:
+            snprintf(seq, sizeof(seq), "\\u%04X", (unsigned int) *p);
+            escape  = seq;
+            n_write = 6;
+            break;
+        }
+
+        put_raw(s, begin, p - begin);
+        put_raw(s, escape, n_write);
+        p++;
+        begin = p;
+    }
+
+    put_raw(s, begin, p - begin);
+    put_raw(s, "\"", 1);
+    return 0;
+}
+
+/*
+ * `precision` < 0 selects json_real, as used for array items. Return 1 when
+ * jansson refuses the value (nan or inf).
+ */
+static int put_real(stream_t *s, double value, int precision)
+{
+    json_t **real = precision < 0 ? &s->ctx->real : &s->ctx->realp[precision];
+    size_t   n    = 0;
+
+    if (*real == NULL) {
+        *real = precision < 0 ? json_real(0) : json_realp(0, precision);
+        if (*real == NULL) {
+            s->ctx->error = true;
+            return 1;
+        }
+    }
+
+    if (json_real_set(*real, value) != 0) {
+        return 1;
+    }
+
+    if (stream_reserve(s, STREAM_REAL_MAX) != 0) {
+        return 1;
+    }
+
+    n = json_dumpb(*real, s->data + s->len, STREAM_REAL_MAX,
+                   JSON_ENCODE_ANY | JSON_REAL_PRECISION(16));
+    if (n == 0 || n > STREAM_REAL_MAX) {
+        s->ctx->error = true;
+        return 1;
+    }
+
+    s->len += n;
+    return 0;
+}
+
+#define PUT_INT_ARRAY(s, array, items)               \
+    put_raw(s, "[", 1);                              \
+    for (int i = 0; i < (array).length; i++) {       \
+        if (i > 0) {                                 \
+            put_raw(s, ", ", 2);                     \
+        }                                            \
+        put_int(s, (json_int_t)(array).items[i]);    \
+    }                                                \
+    put_raw(s, "]", 1);
+
+#define PUT_REAL_ARRAY(s, array, items)              \
+    {                                                \
+        bool first = true;                           \
+        put_raw(s, "[", 1);                          \
+        for (int i = 0; i < (array).length; i++) {   \
+            size_t mark = s->len;                    \
+            if (!first) {                            \
+                put_raw(s, ", ", 2);                 \
+            }                                        \
+            if (put_real(s, (array).items[i], -1)) { \
+                s->len = mark;                       \
+            } else {                                 \
+                first = false;                       \
+            }                                        \
+        }                                            \
+        put_raw(s, "]", 1);                          \
+    }
+
+/*
+ * Write one value as encode_object in src/utils/json.c does. Return 0 when
+ * written, 1 when jansson would leave the member out and -1 when only the
+ * jansson encoders can handle it.
+ */
+static int put_value(stream_t *s, neu_json_type_e t,
+                     const union neu_json_value *v, uint8_t precision,
+                     double bias)
+{
+    switch (t) {
+    case NEU_JSON_BIT:
+        put_int(s, v->val_bit);
+        return 0;
+    case NEU_JSON_INT:
+        put_int(s, v->val_int);
+        return 0;
+    case NEU_JSON_STR:
+        return put_string(s, v->val_str);
+    case NEU_JSON_FLOAT: {
+        double value = v->val_float;
+        if (precision == 0 && bias == 0) {
+            value = neu_json_format_float(v->val_float);
+        }
+        return put_real(s, value, precision);
+    }
+    case NEU_JSON_DOUBLE:
+        return put_real(s, v->val_double, precision);
+    case NEU_JSON_BOOL:
+        put_bool(s, v->val_bool);
+        return 0;
+    case NEU_JSON_ARRAY_BOOL:
+        put_raw(s, "[", 1);
+        for (int i = 0; i < v->val_array_bool.length; i++) {
+            if (i > 0) {
+                put_raw(s, ", ", 2);
+            }
+            put_bool(s, v->val_array_bool.bools[i]);
+        }
+        put_raw(s, "]", 1);
+        return 0;
+    case NEU_JSON_ARRAY_INT8:
+        PUT_INT_ARRAY(s, v->val_array_int8, i8s);
+        return 0;
+    case NEU_JSON_ARRAY_UINT8:
+        PUT_INT_ARRAY(s, v->val_array_uint8, u8s);
+        return 0;
+    case NEU_JSON_ARRAY_INT16:
+        PUT_INT_ARRAY(s, v->val_array_int16, i16s);
+        return 0;
+    case NEU_JSON_ARRAY_UINT16:
+        PUT_INT_ARRAY(s, v->val_array_uint16, u16s);
+        return 0;
+    case NEU_JSON_ARRAY_INT32:
+        PUT_INT_ARRAY(s, v->val_array_int32, i32s);
+        return 0;
+    case NEU_JSON_ARRAY_UINT32:
+        PUT_INT_ARRAY(s, v->val_array_uint32, u32s);
+        return 0;
+    case NEU_JSON_ARRAY_INT64:
+        PUT_INT_ARRAY(s, v->val_array_int64, i64s);
+        return 0;
+    case NEU_JSON_ARRAY_UINT64:
+        PUT_INT_ARRAY(s, v->val_array_uint64, u64s);
+        return 0;
+    case NEU_JSON_ARRAY_FLOAT:
+        PUT_REAL_ARRAY(s, v->val_array_float, f32s);
+        return 0;
+    case NEU_JSON_ARRAY_DOUBLE:
+        PUT_REAL_ARRAY(s, v->val_array_double, f64s);
+        return 0;
+    case NEU_JSON_ARRAY_STR: {
+        bool first = true;
+
+        put_raw(s, "[", 1);
+        for (int i = 0; i < v->val_array_str.length; i++) {
+            size_t mark = s->len;
+
+            if (!first) {
+                put_raw(s, ", ", 2);
+            }
+            if (put_string(s, v->val_array_str.p_strs[i]) != 0) {
+                s->len = mark;
+            } else {
+                first = false;
+            }
+        }
+        put_raw(s, "]", 1);
+        return 0;
+    }
+    case NEU_JSON_OBJECT:
+        return -1;
+    default:
+        return 1;
+    }
+}
+
+static int put_member(stream_t *s, bool *first, const char *name,
+                      neu_json_type_e t, const union neu_json_value *v,
+                      uint8_t precision, double bias)
+{
+    size_t mark = s->len;
+    int    ret  = 0;
+
+    if (!*first) {
+        put_raw(s, ", ", 2);
+    }
+
+    if (put_string(s, name) != 0) {
+        s->len = mark;
+        return 1;
+    }
+
+    put_raw(s, ": ", 2);
+    ret = put_value(s, t, v, precision, bias);
+    if (ret != 0) {
+        s->len = mark;
+        return ret;
+    }
+
+    *first = false;
+    return 0;
+}
+
+/*
+ * jansson replaces the value of a repeated key in place, which a stream
+ * can't do, so a meta named like an earlier member falls back to jansson.
+ */
+static int put_tag_member(stream_t *s, stream_keys_t *keys, bool *first,
+                          const char *name, neu_json_type_e t,
+                          const union neu_json_value *v, uint8_t precision)
+{
+    int ret = 0;
+
+    for (int i = 0; name != NULL && i < keys->n; i++) {
+        if (strcmp(keys->keys[i], name) == 0) {
+            return -1;
+        }
+    }
+
+    ret = put_member(s, first, name, t, v, precision, 0);
+    if (ret == 0) {
+        keys->keys[keys->n++] = name;
+    }
+
+    return ret;
+}
+
+static int put_metas(stream_t *s, stream_keys_t *keys, bool *first,
+                     neu_json_read_resp_tag_t *tag)
+{
+    for (int k = 0; k < tag->n_meta; k++) {
+        if (put_tag_member(s, keys, first, tag->metas[k].name,
+                           tag->metas[k].t, &tag->metas[k].value, 0) < 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static void put_header(stream_t *s, neu_json_read_periodic_t *header,
+                       bool *first)
+{
+    union neu_json_value v = { 0 };
+
+    put_raw(s, "{", 1);
+
+    v.val_str = header->node;
+    put_member(s, first, "node", NEU_JSON_STR, &v, 0, 0);
+    v.val_str = header->group;
+    put_member(s, first, "group", NEU_JSON_STR, &v, 0, 0);
+    v.val_int = (int64_t) header->timestamp;
+    put_member(s, first, "timestamp", NEU_JSON_INT, &v, 0, 0);
+    if (header->seq > 0) {
+        v.val_int = (int64_t) header->seq;
+        put_member(s, first, "seq", NEU_JSON_INT, &v, 0, 0);
+        v.val_bool = header->keyframe;
+        put_member(s, first, "keyframe", NEU_JSON_BOOL, &v, 0, 0);
+    }
+
+    if (!*first) {
+        put_raw(s, ", ", 2);
+    }
+}
+
+// one object of the "tags" array, as neu_json_encode_read_resp2 and _ecp
+static int put_tag_object(stream_t *s, neu_json_read_resp_tag_t *tag,
+                          bool ecp)
+{
+    stream_keys_t        keys  = { 0 };
+    bool                 first = true;
+    union neu_json_value v     = { 0 };
+
+    put_raw(s, "{", 1);
+
+    v.val_str = tag->name;
+    put_tag_member(s, &keys, &first, "name", NEU_JSON_STR, &v, 0);
+
+    if (tag->error != 0) {
+        v.val_int = tag->error;
+        put_tag_member(s, &keys, &first, "error", NEU_JSON_INT, &v, 0);
+    } else if (put_tag_member(s, &keys, &first, "value", tag->t, &tag->value,
+                              tag->precision) < 0) {
+        return -1;
+    }
+
+    if (ecp) {
+        v.val_int = neu_json_type_transfer(tag->t);
+        put_tag_member(s, &keys, &first, "type", NEU_JSON_INT, &v, 0);
+    }
+
+    if (put_metas(s, &keys, &first, tag) != 0) {
+        return -1;
+    }
+
+    put_raw(s, "}", 1);
+    return 0;
+}
+
+static void tag_json_free(neu_json_read_resp_tag_t *tag)
+{
+    if (tag->n_meta > 0) {
+        free(tag->metas);
+    }
+}
+
+// scratch buffers larger than this are not kept for the next payload
+#define STREAM_SCRATCH_KEEP (64 * 1024)
+
+// reuse the buffer kept by the thread if any
+static void scratch_init(stream_t *s, stream_ctx_t *ctx)
+{
+    if (NULL == s->data) {
+        stream_init(s, ctx, 256);
+    } else {
+        s->len = 0;
+        s->ctx = ctx;
+    }
+}
+
+static void scratch_release(stream_t *s)
+{
+    if (s->size > STREAM_SCRATCH_KEEP) {
+        free(s->data);
+        s->data = NULL;
+        s->size = 0;
+    }
+    s->ctx = NULL;
+}
+
+// the scratch buffers of a thread, freed when the thread exits
+typedef struct {
+    stream_t errors;
+    stream_t metas;
+} stream_scratch_t;
+
+static pthread_key_t  scratch_key;
+static pthread_once_t scratch_once = PTHREAD_ONCE_INIT;
+
+static void scratch_free(void *arg)
+{
+    stream_scratch_t *scratch = arg;
+
+    free(scratch->errors.data);
+    free(scratch->metas.data);
+    free(scratch);
+}
+
+static void scratch_key_create(void)
+{
+    pthread_key_create(&scratch_key, scratch_free);
+}
+
+// the scratch buffers of the calling thread, NULL if they cannot be kept
+static stream_scratch_t *scratch_get(void)
+{
+    stream_scratch_t *scratch = NULL;
+
+    pthread_once(&scratch_once, scratch_key_create);
+    scratch = pthread_getspecific(scratch_key);
+    if (NULL == scratch) {
+        scratch = calloc(1, sizeof(*scratch));
+        if (NULL != scratch && 0 != pthread_setspecific(scratch_key, scratch)) {
+            free(scratch);
+            scratch = NULL;
+        }
+    }
+
+    return scratch;
+}
+
+static int stream_finish(stream_t *s, char **result)
+{
+    stream_ctx_t *ctx = s->ctx;
+
+    json_decref(ctx->real);
+    for (int i = 0; i <= UINT8_MAX; i++) {
+        json_decref(ctx->realp[i]);
+    }
+
+    if (ctx->error) {
+        free(s->data);
+        return -1;
+    }
+
+    s->data[s->len] = '\0';
+    *result         = s->data;
+    return 0;
+}
+
+static size_t stream_size(UT_array *tags)
+{
+    return utarray_len(tags) * 48 + 128;
+}
+
+/*
+ * Values go straight into the payload, errors and metas are gathered in
+ * scratch buffers of the thread, and appended after all values.
+ */
+int neu_json_stream_encode_values(neu_json_read_periodic_t *header,
+                                  UT_array *tags, char **result)
+{
+    stream_scratch_t  local       = { 0 };
+    stream_scratch_t *scratch     = scratch_get();
+    stream_t *        errors      = NULL;
+    stream_t *        metas       = NULL;
+    stream_ctx_t      ctx         = { 0 };
+    stream_t          out         = { 0 };
+    bool              first       = true;
+    bool              first_value = true;
+    bool              first_error = true;
+    bool              first_meta  = true;
+    int               ret         = 0;
+
+    if (NULL == scratch) {
+        scratch = &local;
+    }
+    errors = &scratch->errors;
+    metas  = &scratch->metas;
+
+    stream_init(&out, &ctx, stream_size(tags));
+    scratch_init(errors, &ctx);
+    scratch_init(metas, &ctx);
+
+    put_header(&out, header, &first);
+    put_raw(&out, "\"values\": {", 11);
+
+    utarray_foreach(tags, neu_resp_tag_value_meta_t *, tag_value)
+    {
+        neu_json_read_resp_tag_t tag = { 0 };
+        union neu_json_value     v   = { 0 };
+
+        neu_tag_value_to_json(tag_value, &tag);
+
+        if (tag.error == 0) {
+            ret = put_member(&out, &first_value, tag.name, tag.t, &tag.value,
+                             tag.precision, tag.datatag.bias);
+        } else {
+            v.val_int = tag.error;
+            ret = put_member(errors, &first_error, tag.name, NEU_JSON_INT, &v,
+                             0, 0);
+        }
+
+        if (ret >= 0 && tag.n_meta > 0) {
+            size_t        mark     = metas->len;
+            stream_keys_t keys     = { 0 };
+            bool          first_kv = true;
+
+            if (!first_meta) {
+                put_raw(metas, ", ", 2);
+            }
+
+            if (put_string(metas, tag.name) != 0) {
+                metas->len = mark;
+            } else {
+                put_raw(metas, ": {", 3);
+                ret = put_metas(metas, &keys, &first_kv, &tag);
+                put_raw(metas, "}", 1);
+                first_meta = false;
+            }
+        }
+
+        tag_json_free(&tag);
+        if (ret < 0) {
+            ctx.error = true;
+            break;
+        }
+    }
+
+    put_raw(&out, "}, \"errors\": {", 14);
+    put_raw(&out, errors->data, errors->len);
+    put_raw(&out, "}, \"metas\": {", 13);
+    put_raw(&out, metas->data, metas->len);
+    put_raw(&out, "}}", 2);
+
+    scratch_release(errors);
+    scratch_release(metas);
+    if (&local == scratch) {
+        free(local.errors.data);
+        free(local.metas.data);
+    }
+
+    return stream_finish(&out, result);
+}
+
+static int encode_tags(neu_json_read_periodic_t *header, UT_array *tags,
+                       bool ecp, char **result)
+{
+    stream_ctx_t ctx       = { 0 };
+    stream_t     out       = { 0 };
+    bool         first     = true;
+    bool         first_tag = true;
+
+    stream_init(&out, &ctx, stream_size(tags));
+    put_header(&out, header, &first);
+    put_raw(&out, "\"tags\": [", 9);
+
+    utarray_foreach(tags, neu_resp_tag_value_meta_t *, tag_value)
+    {
+        neu_json_read_resp_tag_t tag = { 0 };
+        int                      ret = 0;
+
+        neu_tag_value_to_json(tag_value, &tag);
+
+        if (!ecp || tag.error == 0) {
+            if (!first_tag) {
+                put_raw(&out, ", ", 2);
+            }
+            ret       = put_tag_object(&out, &tag, ecp);
+            first_tag = false;
+        }
+
+        tag_json_free(&tag);
+        if (ret < 0) {
+            ctx.error = true;
+            break;
+        }
+    }
+
+    put_raw(&out, "]}", 2);
+
+    if (ecp && first_tag && !ctx.error) {
+        ctx.error = true;
+        stream_finish(&out, result);
+        return -2;
+    }
+
+    return stream_finish(&out, result);
+}
+
+int neu_json_stream_encode_tags(neu_json_read_periodic_t *header,
+                                UT_array *tags, char **result)
+{
+    return encode_tags(header, tags, false, result);
+}
+
+int neu_json_stream_encode_ecp(neu_json_read_periodic_t *header,
+                               UT_array *tags, char **result)
+{
+    return encode_tags(header, tags, true, result);
+}
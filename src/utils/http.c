@@ -17,6 +17,10 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
  **/
 
+#if defined(__GNUC__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE // fopencookie
+#endif
+
 #include <assert.h>
 #include <errno.h>
 #include <inttypes.h>
@@ -24,31 +28,138 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 
 #include <nng/nng.h>
 #include <nng/supplemental/http/http.h>
+#include <nng/supplemental/util/platform.h>
+#include <zlib.h>
 
 #include "define.h"
 #include "errcodes.h"
 #include "otel/otel_manager.h"
 #include "utils/http.h"
+#include "utils/http_handler.h"
 #include "utils/log.h"
+#include "utils/utlist.h"
 
-static int response(nng_aio *aio, char *content, enum nng_http_status status)
+static char *take_etag(nng_aio *aio)
+{
+    char *etag = nng_aio_get_output(aio, NEU_HTTP_ETAG_OUTPUT);
+
+    nng_aio_set_output(aio, NEU_HTTP_ETAG_OUTPUT, NULL);
+    return etag;
+}
+
+static int    g_gzip_level    = NEU_HTTP_GZIP_LEVEL;
+static size_t g_gzip_min_size = NEU_HTTP_GZIP_MIN_SIZE;
+
+void neu_http_set_gzip(int level, size_t min_size)
 {
-    nng_http_res *res = NULL;
+    g_gzip_level    = level;
+    g_gzip_min_size = min_size;
+}
+
+// whether gzip, or any coding, has a nonzero q in Accept-Encoding
+static bool accepts_gzip(nng_aio *aio)
+{
+    const char *list = neu_http_get_header(aio, "Accept-Encoding");
+
+    while (NULL != list && '\0' != *list) {
+        const char *end  = NULL;
+        const char *q    = NULL;
+        size_t      n    = 0;
+        bool        gzip = false;
+
+        list += strspn(list, " \t,");
+        n    = strcspn(list, " \t,;");
+        gzip = (4 == n && 0 == strncasecmp(list, "gzip", 4)) ||
+            (1 == n && '*' == *list);
+        end  = list + strcspn(list, ",");
+        q    = strstr(list, "q=");
+        if (gzip && !(NULL != q && q < end && 0 == strtod(q + 2, NULL))) {
+            return true;
+        }
+        list = end;
+    }
+
+    return false;
+}
+
+// gzip encodes `data`, returns NULL unless that makes it any smaller
+static void *gzip_encode(const void *data, size_t len, size_t *out_len)
+{
+    z_stream z   = { 0 };
+    void *   out = NULL;
+    int      rv  = 0;
+
+    if (Z_OK !=
+        deflateInit2(&z, g_gzip_level, Z_DEFLATED, 15 + 16, 8,
+                     Z_DEFAULT_STRATEGY)) {
+        return NULL;
+    }
+
+    *out_len = deflateBound(&z, len);
+    if (NULL == (out = malloc(*out_len))) {
+        deflateEnd(&z);
+        return NULL;
+    }
+
+    z.next_in   = (Bytef *) data;
+    z.avail_in  = len;
+    z.next_out  = out;
+    z.avail_out = *out_len;
+    rv          = deflate(&z, Z_FINISH);
+    *out_len    = z.total_out;
+    deflateEnd(&z);
+
+    if (Z_STREAM_END != rv || *out_len >= len) {
+        free(out);
+        return NULL;
+    }
+    return out;
+}
+
+static int response_type(nng_aio *aio, const char *type, const void *content,
+                         size_t len, enum nng_http_status status)
+{
+    nng_http_res *res      = NULL;
+    char *        etag     = take_etag(aio);
+    void *        gzip     = NULL;
+    size_t        gzip_len = 0;
+    bool          vary     = false;
+
+    vary = g_gzip_level > 0 && NULL != content && len >= g_gzip_min_size;
+    if (vary && accepts_gzip(aio)) {
+        gzip = gzip_encode(content, len, &gzip_len);
+    }
 
     nng_http_res_alloc(&res);
 
-    nng_http_res_set_header(res, "Content-Type", "application/json");
+    nng_http_res_set_header(res, "Content-Type", type);
+    if (vary) {
+        nng_http_res_set_header(res, "Vary", "Accept-Encoding");
+    }
+    if (NULL != gzip) {
+        nng_http_res_set_header(res, "Content-Encoding", "gzip");
+        content = gzip;
+        len     = gzip_len;
+    }
+    if (NULL != etag &&
+        (NNG_HTTP_STATUS_OK == status ||
+         NNG_HTTP_STATUS_NOT_MODIFIED == status)) {
+        nng_http_res_set_header(res, "ETag", etag);
+    }
+    free(etag);
     nng_http_res_set_header(res, "Access-Control-Allow-Origin", "*");
     nng_http_res_set_header(res, "Access-Control-Allow-Methods",
                             "POST,GET,PUT,DELETE,OPTIONS");
     nng_http_res_set_header(res, "Access-Control-Allow-Headers", "*");
 
-    if (content != NULL && strlen(content) > 0) {
-        nng_http_res_copy_data(res, content, strlen(content));
+    if (content != NULL && len > 0) {
+        nng_http_res_copy_data(res, content, len);
     }
+    free(gzip);
 
     nng_http_res_set_status(res, status);
 
@@ -57,11 +168,61 @@ static int response(nng_aio *aio, char *content, enum nng_http_status status)
                 nng_http_req_get_uri(nng_req), status);
 
     nng_aio_set_output(aio, 0, res);
-    nng_aio_finish(aio, 0);
+    neu_http_finish(aio);
 
     return 0;
 }
 
+static int response(nng_aio *aio, char *content, enum nng_http_status status)
+{
+    return response_type(aio, "application/json", content,
+                         content ? strlen(content) : 0, status);
+}
+
+// weak comparison against each entity tag of an If-None-Match list
+static bool etag_match(const char *list, const char *etag)
+{
+    size_t len = strlen(etag);
+
+    while ('\0' != *list) {
+        size_t n = 0;
+
+        list += strspn(list, " \t,");
+        if ('*' == *list) {
+            return true;
+        }
+        if (0 == strncmp(list, "W/", 2)) {
+            list += 2;
+        }
+        n = strcspn(list, " \t,");
+        if (n == len && 0 == strncmp(list, etag, len)) {
+            return true;
+        }
+        list += n;
+    }
+
+    return false;
+}
+
+bool neu_http_check_etag(nng_aio *aio, const char *etag)
+{
+    const char *match = neu_http_get_header(aio, "If-None-Match");
+
+    free(take_etag(aio));
+    nng_aio_set_output(aio, NEU_HTTP_ETAG_OUTPUT, strdup(etag));
+
+    if (0 == strncmp(etag, "W/", 2)) {
+        etag += 2;
+    }
+    if (NULL != match && etag_match(match, etag)) {
+        response_type(aio, "application/json", NULL, 0,
+                      NNG_HTTP_STATUS_NOT_MODIFIED);
+        return true;
+    }
+
+    return false;
+}
+
 ssize_t neu_url_decode(const char *s, size_t len, char *buf, size_t size)
 {
     size_t       i = 0, j = 0;
@@ -423,6 +584,517 @@ int neu_http_internal_error(nng_aio *aio, char *content)
     return response(aio, content, NNG_HTTP_STATUS_INTERNAL_SERVER_ERROR);
 }
 
+/*
+ * Chunked responses.
+ *
+ * A response that fits in the buffer is sent as a normal response. The first
+ * time the buffer fills up, the connection is taken over from the server, the
+ * head is queued, and from then on every full buffer is queued as one chunk.
+ * The completion of a write on the connection takes the next chunk, and the
+ * last one finishes the request. At most NEU_HTTP_CHUNKED_QUEUE chunks are
+ * queued, the one being written included: the writer of the next one waits
+ * for a write to complete, so the body is produced at the pace of the client.
+ * A write taking longer than HTTP_CHUNKED_TIMEOUT breaks the response, and
+ * so does a writer waiting that long.
+ * For clients accepting gzip, the full buffers go through one deflate stream,
+ * and chunks are cut from its output instead.
+ */
+
+#define HTTP_CHUNKED_BUF_SIZE (64 * 1024)
+#define HTTP_CHUNKED_TIMEOUT 10000
+#define HTTP_CHUNKED_HEAD                                                      \
+    "HTTP/1.1 200 OK\r\n"                                                      \
+    "Content-Type: %s\r\n"                                                     \
+    "%s"                                                                       \
+    "%s"                                                                       \
+    "%s"                                                                       \
+    "%s"                                                                       \
+    "Connection: close\r\n"                                                    \
+    "Access-Control-Allow-Origin: *\r\n"                                       \
+    "Access-Control-Allow-Methods: POST,GET,PUT,DELETE,OPTIONS\r\n"            \
+    "Access-Control-Allow-Headers: *\r\n"                                      \
+    "\r\n"
+
+typedef struct http_chunk {
+    struct http_chunk *next;
+    size_t             len;
+    char               data[];
+} http_chunk_t;
+
+struct neu_http_chunked {
+    nng_aio *      aio;
+    char *         type;
+    nng_aio *      io;
+    nng_mtx *      mtx;
+    nng_cv *       cv;   // woken when a chunk leaves the queue
+    nng_http_conn *conn; // not NULL once the head is queued
+    bool           framed;
+    z_stream *     z; // not NULL if the body is gzip encoded
+    char *         zbuf;
+    http_chunk_t * queue; // the first one is being written
+    unsigned       n_queued;
+    size_t         queued; // bytes in the queue
+    bool           ended;  // nothing more is queued
+    int            error;
+    size_t         len;
+    char           buf[HTTP_CHUNKED_BUF_SIZE + 1];
+};
+
+static size_t g_chunked_peak = 0;
+
+static void chunked_cb(void *arg);
+
+size_t neu_http_chunked_peak(void)
+{
+    return __atomic_load_n(&g_chunked_peak, __ATOMIC_RELAXED);
+}
+
+// with c->mtx held
+static void chunked_peak_update(neu_http_chunked_t *c)
+{
+    size_t peak = __atomic_load_n(&g_chunked_peak, __ATOMIC_RELAXED);
+
+    while (c->queued > peak &&
+           !__atomic_compare_exchange_n(&g_chunked_peak, &peak, c->queued,
+                                        true, __ATOMIC_RELAXED,
+                                        __ATOMIC_RELAXED)) {
+    }
+}
+
+neu_http_chunked_t *neu_http_chunked_new(nng_aio *aio, const char *type)
+{
+    neu_http_chunked_t *c = calloc(1, sizeof(neu_http_chunked_t));
+
+    if (NULL == c) {
+        return NULL;
+    }
+
+    c->aio  = aio;
+    c->type = strdup(type);
+    if (NULL == c->type || 0 != nng_mtx_alloc(&c->mtx)) {
+        free(c->type);
+        free(c);
+        return NULL;
+    }
+    if (0 != nng_cv_alloc(&c->cv, c->mtx)) {
+        nng_mtx_free(c->mtx);
+        free(c->type);
+        free(c);
+        return NULL;
+    }
+
+    return c;
+}
+
+static void chunked_free(neu_http_chunked_t *c)
+{
+    http_chunk_t *chunk = NULL, *tmp = NULL;
+
+    if (c->conn) {
+        nng_http_conn_close(c->conn);
+    }
+    if (c->io) {
+        // the last write callback frees c
+        nng_aio_reap(c->io);
+    }
+    LL_FOREACH_SAFE(c->queue, chunk, tmp)
+    {
+        free(chunk);
+    }
+    if (c->z) {
+        deflateEnd(c->z);
+        free(c->z);
+    }
+    nng_cv_free(c->cv);
+    nng_mtx_free(c->mtx);
+    free(c->zbuf);
+    free(c->type);
+    free(c);
+}
+
+static int chunked_error(neu_http_chunked_t *c)
+{
+    int rv = 0;
+
+    nng_mtx_lock(c->mtx);
+    rv = c->error;
+    nng_mtx_unlock(c->mtx);
+    return rv;
+}
+
+// with c->mtx held, the first error sticks, the chunks not being written
+// are dropped, and the writer waiting is woken
+static void chunked_drop(neu_http_chunked_t *c, int error)
+{
+    http_chunk_t *chunk = NULL, *tmp = NULL;
+
+    if (0 == c->error) {
+        c->error = error;
+    }
+    if (NULL != c->queue) {
+        LL_FOREACH_SAFE(c->queue->next, chunk, tmp)
+        {
+            c->queued -= chunk->len;
+            c->n_queued -= 1;
+            free(chunk);
+        }
+        c->queue->next = NULL;
+    }
+    nng_cv_wake(c->cv);
+}
+
+static void chunked_fail(neu_http_chunked_t *c, int error)
+{
+    nng_mtx_lock(c->mtx);
+    chunked_drop(c, error);
+    nng_mtx_unlock(c->mtx);
+}
+
+// only the one that queues to an empty queue, or the callback of the write
+// before, writes the first chunk
+static void chunked_write(neu_http_chunked_t *c)
+{
+    nng_iov iov = { .iov_buf = c->queue->data, .iov_len = c->queue->len };
+
+    nng_aio_set_timeout(c->io, HTTP_CHUNKED_TIMEOUT);
+    nng_aio_set_iov(c->io, 1, &iov);
+    nng_http_conn_write_all(c->conn, c->io);
+}
+
+// the response is written, or broken
+static void chunked_done(neu_http_chunked_t *c)
+{
+    nng_aio *     aio = c->aio;
+    nng_http_req *req = nng_aio_get_input(aio, 0);
+
+    nlog_notice("<%p> %s %s [%d] chunked%s", aio, nng_http_req_get_method(req),
+                nng_http_req_get_uri(req), NNG_HTTP_STATUS_OK,
+                0 == c->error ? "" : ", broken");
+    chunked_free(c);
+    neu_http_finish(aio);
+}
+
+static void chunked_cb(void *arg)
+{
+    neu_http_chunked_t *c     = arg;
+    http_chunk_t *      chunk = NULL;
+    int                 rv    = nng_aio_result(c->io);
+    bool                next  = false;
+    bool                done  = false;
+
+    nng_mtx_lock(c->mtx);
+    chunk = c->queue;
+    LL_DELETE(c->queue, chunk);
+    c->queued -= chunk->len;
+    c->n_queued -= 1;
+    free(chunk);
+    nng_cv_wake(c->cv);
+    if (0 != rv) {
+        nlog_warn("<%p> chunked write fail: %s", c->aio, nng_strerror(rv));
+        chunked_drop(c, rv);
+    }
+    next = NULL != c->queue;
+    done = !next && c->ended;
+    nng_mtx_unlock(c->mtx);
+
+    if (next) {
+        chunked_write(c);
+    } else if (done) {
+        chunked_done(c);
+    }
+}
+
+// queues the pieces as one chunk, once there is room in the queue
+static int chunked_send(neu_http_chunked_t *c, nng_iov *iov, unsigned n)
+{
+    http_chunk_t *chunk    = NULL;
+    size_t        len      = 0;
+    bool          idle     = false;
+    nng_time      deadline = nng_clock() + HTTP_CHUNKED_TIMEOUT;
+    int           rv       = 0;
+
+    for (unsigned i = 0; i < n; i++) {
+        len += iov[i].iov_len;
+    }
+
+    chunk = malloc(sizeof(http_chunk_t) + len);
+    if (NULL == chunk) {
+        chunked_fail(c, NNG_ENOMEM);
+        return NNG_ENOMEM;
+    }
+    chunk->next = NULL;
+    chunk->len  = 0;
+    for (unsigned i = 0; i < n; i++) {
+        memcpy(chunk->data + chunk->len, iov[i].iov_buf, iov[i].iov_len);
+        chunk->len += iov[i].iov_len;
+    }
+
+    nng_mtx_lock(c->mtx);
+    while (0 == c->error && c->n_queued >= NEU_HTTP_CHUNKED_QUEUE) {
+        if (NNG_ETIMEDOUT == nng_cv_until(c->cv, deadline)) {
+            nlog_warn("<%p> chunked write stalled", c->aio);
+            chunked_drop(c, NNG_ETIMEDOUT);
+        }
+    }
+    if (0 == c->error) {
+        idle = NULL == c->queue;
+        LL_APPEND(c->queue, chunk);
+        c->queued += chunk->len;
+        c->n_queued += 1;
+        chunked_peak_update(c);
+        chunk = NULL;
+    }
+    rv = c->error;
+    nng_mtx_unlock(c->mtx);
+
+    free(chunk);
+    if (idle) {
+        chunked_write(c);
+    }
+    return rv;
+}
+
+static void chunked_gzip_init(neu_http_chunked_t *c)
+{
+    c->z    = calloc(1, sizeof(z_stream));
+    c->zbuf = malloc(HTTP_CHUNKED_BUF_SIZE);
+
+    if (NULL == c->z || NULL == c->zbuf ||
+        Z_OK !=
+            deflateInit2(c->z, g_gzip_level, Z_DEFLATED, 15 + 16, 8,
+                         Z_DEFAULT_STRATEGY)) {
+        // sent as it is
+        free(c->z);
+        free(c->zbuf);
+        c->z    = NULL;
+        c->zbuf = NULL;
+    }
+}
+
+static int chunked_start(neu_http_chunked_t *c)
+{
+    nng_http_req * req            = nng_aio_get_input(c->aio, 0);
+    nng_http_conn *conn           = nng_aio_get_input(c->aio, 2);
+    const char *   ver            = nng_http_req_get_version(req);
+    char *         etag           = take_etag(c->aio);
+    char           etag_line[128] = { 0 };
+    char *         head           = NULL;
+    int            rv             = 0;
+
+    if (NULL != etag) {
+        snprintf(etag_line, sizeof(etag_line), "ETag: %s\r\n", etag);
+        free(etag);
+    }
+
+    if (0 != (rv = nng_aio_alloc(&c->io, chunked_cb, c))) {
+        chunked_fail(c, rv);
+        return rv;
+    }
+
+    // HTTP/1.0 clients read the body until the connection is closed
+    c->framed = NULL == ver || 0 != strcmp(ver, "HTTP/1.0");
+    if (g_gzip_level > 0 && accepts_gzip(c->aio)) {
+        chunked_gzip_init(c);
+    }
+
+    rv = asprintf(&head, HTTP_CHUNKED_HEAD, c->type,
+                  c->framed ? "Transfer-Encoding: chunked\r\n" : "",
+                  g_gzip_level > 0 ? "Vary: Accept-Encoding\r\n" : "",
+                  c->z ? "Content-Encoding: gzip\r\n" : "", etag_line);
+    if (rv < 0) {
+        chunked_fail(c, NNG_ENOMEM);
+        return NNG_ENOMEM;
+    }
+
+    nng_http_hijack(conn);
+    c->conn = conn;
+
+    nng_iov iov = { .iov_buf = head, .iov_len = (size_t) rv };
+    rv          = chunked_send(c, &iov, 1);
+    free(head);
+    return rv;
+}
+
+static int chunked_send_data(neu_http_chunked_t *c, void *data, size_t len)
+{
+    char    size[24] = { 0 };
+    nng_iov iov[3]   = { 0 };
+
+    if (!c->framed) {
+        iov[0].iov_buf = data;
+        iov[0].iov_len = len;
+        return chunked_send(c, iov, 1);
+    }
+
+    iov[0].iov_buf = size;
+    iov[0].iov_len = snprintf(size, sizeof(size), "%zx\r\n", len);
+    iov[1].iov_buf = data;
+    iov[1].iov_len = len;
+    iov[2].iov_buf = "\r\n";
+    iov[2].iov_len = 2;
+    return chunked_send(c, iov, 3);
+}
+
+// feeds the buffer to the deflate stream, sending every full output buffer,
+// and everything that is left with Z_FINISH
+static int chunked_deflate(neu_http_chunked_t *c, int flush)
+{
+    int rv = Z_OK;
+
+    c->z->next_in  = (Bytef *) c->buf;
+    c->z->avail_in = c->len;
+    do {
+        size_t n = 0;
+
+        c->z->next_out  = (Bytef *) c->zbuf;
+        c->z->avail_out = HTTP_CHUNKED_BUF_SIZE;
+        rv              = deflate(c->z, flush);
+        if (Z_STREAM_ERROR == rv) {
+            nlog_warn("<%p> chunked deflate fail", c->aio);
+            chunked_fail(c, NNG_EINTERNAL);
+            break;
+        }
+
+        n = HTTP_CHUNKED_BUF_SIZE - c->z->avail_out;
+        if (n > 0 && 0 != chunked_send_data(c, c->zbuf, n)) {
+            break;
+        }
+    } while (0 == c->z->avail_out || (Z_FINISH == flush && Z_STREAM_END != rv));
+
+    return chunked_error(c);
+}
+
+static int chunked_flush(neu_http_chunked_t *c)
+{
+    if (0 == c->len) {
+        return chunked_error(c);
+    }
+    if (NULL == c->conn && 0 != chunked_start(c)) {
+        return chunked_error(c);
+    }
+
+    if (NULL != c->z) {
+        chunked_deflate(c, Z_NO_FLUSH);
+    } else {
+        chunked_send_data(c, c->buf, c->len);
+    }
+
+    c->len = 0;
+    return chunked_error(c);
+}
+
+int neu_http_chunked_write(neu_http_chunked_t *c, const void *data, size_t len)
+{
+    const char *p  = data;
+    int         rv = chunked_error(c);
+
+    while (len > 0 && 0 == rv) {
+        size_t n = HTTP_CHUNKED_BUF_SIZE - c->len;
+
+        n = n < len ? n : len;
+        memcpy(c->buf + c->len, p, n);
+        c->len += n;
+        p += n;
+        len -= n;
+
+        if (HTTP_CHUNKED_BUF_SIZE == c->len) {
+            rv = chunked_flush(c);
+        }
+    }
+
+    return 0 == rv ? 0 : -1;
+}
+
+int neu_http_chunked_puts(neu_http_chunked_t *c, const char *str)
+{
+    return neu_http_chunked_write(c, str, strlen(str));
+}
+
+static ssize_t chunked_cookie_write(void *cookie, const char *buf, size_t size)
+{
+    if (0 != neu_http_chunked_write(cookie, buf, size)) {
+        return -1;
+    }
+    return size;
+}
+
+FILE *neu_http_chunked_stream(neu_http_chunked_t *c)
+{
+    cookie_io_functions_t fns = {
+        .write = chunked_cookie_write,
+    };
+
+    return fopencookie(c, "w", fns);
+}
+
+int neu_http_chunked_end(neu_http_chunked_t *c)
+{
+    nng_aio *aio  = c->aio;
+    bool     done = false;
+    int      rv   = 0;
+
+    if (NULL == c->conn) {
+        // it all fits in the buffer, or the connection is not taken over
+        if (0 == c->error) {
+            c->buf[c->len] = '\0';
+            rv = response_type(aio, c->type, c->buf, c->len,
+                               NNG_HTTP_STATUS_OK);
+        } else {
+            rv = response_type(aio, c->type, NULL, 0,
+                               NNG_HTTP_STATUS_INTERNAL_SERVER_ERROR);
+        }
+        chunked_free(c);
+        return rv;
+    }
+
+    if (0 == chunked_flush(c) &&
+        (NULL == c->z || 0 == chunked_deflate(c, Z_FINISH)) && c->framed) {
+        nng_iov iov = { .iov_buf = "0\r\n\r\n", .iov_len = 5 };
+        chunked_send(c, &iov, 1);
+    }
+
+    nng_mtx_lock(c->mtx);
+    c->ended = true;
+    done     = NULL == c->queue;
+    rv       = 0 == c->error ? 0 : -1;
+    nng_mtx_unlock(c->mtx);
+
+    // or the callback of the last write is
+    if (done) {
+        chunked_done(c);
+    }
+    return rv;
+}
+
+bool neu_http_chunked_abort(neu_http_chunked_t *c)
+{
+    bool done = false;
+
+    if (NULL == c) {
+        return false;
+    }
+    if (NULL == c->conn) {
+        chunked_free(c);
+        return false;
+    }
+
+    // closing in the middle of the body tells the client
+    nlog_warn("<%p> chunked response aborted", c->aio);
+    nng_mtx_lock(c->mtx);
+    chunked_drop(c, NNG_ECANCELED);
+    c->ended = true;
+    done     = NULL == c->queue;
+    if (!done) {
+        nng_aio_cancel(c->io);
+    }
+    nng_mtx_unlock(c->mtx);
+
+    if (done) {
+        chunked_done(c);
+    }
+    return true;
+}
+
 int neu_http_post_otel_trace(uint8_t *data, int len)
 {
     nng_url *        url    = NULL;
@@ -17,6 +17,8 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
  **/
 #include <assert.h>
+#include <inttypes.h>
+#include <pthread.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
@@ -24,8 +26,370 @@
 #include <nng/nng.h>
 #include <nng/supplemental/http/http.h>
 
+#include "errcodes.h"
+#include "utils/http.h"
 #include "utils/http_handler.h"
 #include "utils/log.h"
+#include "utils/time.h"
+#include "utils/utlist.h"
+
+typedef struct http_class http_class_t;
+
+// the data of a function handler
+typedef struct {
+    http_class_t *cls;
+    void (*handler)(nng_aio *aio);
+} http_route_t;
+
+// a request admitted or queued, output NEU_HTTP_ADMIT_OUTPUT of its aio
+typedef struct http_ticket {
+    http_route_t *      route;
+    nng_aio *           aio;
+    nng_aio *           timer; // dispatches it, then times it out
+    int64_t             arrival;
+    int                 refs; // the request and the timer
+    bool                running;
+    bool                reclaimed; // its place is given to another one
+    bool                finished;
+    struct http_ticket *next;
+} http_ticket_t;
+
+// upper bounds of the latency buckets in milliseconds
+static const int64_t latency_buckets[] = { 5,   10,  25,   50,   100,
+                                           250, 500, 1000, 2500, 5000 };
+
+#define N_BUCKET (sizeof(latency_buckets) / sizeof(latency_buckets[0]))
+
+struct http_class {
+    const char *   name;
+    int            limit;      // requests handled at a time
+    int            queue_size; // requests waiting for them
+    int            running;
+    int            n_queued;
+    http_ticket_t *queue; // waiting for a place
+    uint64_t       n_rejected;
+    uint64_t       n_reclaimed;
+    uint64_t       n_done;
+    uint64_t       latency_sum; // milliseconds
+    uint64_t       latency[N_BUCKET];
+};
+
+static nng_duration http_run_timeout = NEU_HTTP_RUN_TIMEOUT_MS;
+
+static pthread_mutex_t http_class_mtx = PTHREAD_MUTEX_INITIALIZER;
+static http_class_t    http_classes[NEU_HTTP_CLASS_MAX] = {
+    [NEU_HTTP_CLASS_NORMAL] = {
+        .name       = "normal",
+        .limit      = NEU_HTTP_NORMAL_LIMIT,
+        .queue_size = NEU_HTTP_NORMAL_QUEUE,
+    },
+    [NEU_HTTP_CLASS_LIGHT] = {
+        .name       = "light",
+        .limit      = NEU_HTTP_LIGHT_LIMIT,
+        .queue_size = NEU_HTTP_LIGHT_QUEUE,
+    },
+    [NEU_HTTP_CLASS_HEAVY] = {
+        .name       = "heavy",
+        .limit      = NEU_HTTP_HEAVY_LIMIT,
+        .queue_size = NEU_HTTP_HEAVY_QUEUE,
+    },
+};
+
+static void ticket_free(http_ticket_t *ticket)
+{
+    // the last reference may be dropped by the timer callback
+    nng_aio_reap(ticket->timer);
+    free(ticket);
+}
+
+// the lock is held, the place goes to the first one waiting, which is returned
+static http_ticket_t *class_release(http_class_t *cls)
+{
+    http_ticket_t *next = cls->queue;
+
+    if (NULL != next) {
+        LL_DELETE(cls->queue, next);
+        cls->n_queued -= 1;
+    } else {
+        cls->running -= 1;
+    }
+
+    return next;
+}
+
+// the next one is handled on an nng thread, not by the one that finished
+static void ticket_dispatch(http_ticket_t *next)
+{
+    if (NULL != next) {
+        nng_sleep_aio(0, next->timer);
+    }
+}
+
+// the ticket is given a place, or runs for too long, or is finished
+static void ticket_cb(void *arg)
+{
+    http_ticket_t *ticket    = arg;
+    nng_aio *      aio       = ticket->aio;
+    http_class_t * cls       = ticket->route->cls;
+    http_ticket_t *next      = NULL;
+    bool           dispatch  = false;
+    bool           reclaimed = false;
+    bool           release   = false;
+    int            rv        = nng_aio_result(ticket->timer);
+
+    pthread_mutex_lock(&http_class_mtx);
+    if (!ticket->running) {
+        ticket->running = true;
+        dispatch        = true;
+    } else if (0 == rv && !ticket->finished) {
+        ticket->reclaimed = true;
+        reclaimed         = true;
+        cls->n_reclaimed += 1;
+        next = class_release(cls);
+    }
+    if (!dispatch) {
+        release = 0 == --ticket->refs;
+    }
+    pthread_mutex_unlock(&http_class_mtx);
+
+    if (dispatch) {
+        // finishing the request cancels the timeout
+        nng_sleep_aio(http_run_timeout, ticket->timer);
+        ticket->route->handler(aio);
+        return;
+    }
+
+    if (reclaimed) {
+        nlog_warn("<%p> %s request not answered in %" PRId32
+                  "ms, its place is reclaimed",
+                  aio, cls->name, http_run_timeout);
+    }
+    ticket_dispatch(next);
+    if (release) {
+        ticket_free(ticket);
+    }
+}
+
+// seconds until the requests ahead are handled at the mean latency, the lock
+// is held
+static uint64_t retry_after(http_class_t *cls)
+{
+    uint64_t mean = cls->n_done > 0 ? cls->latency_sum / cls->n_done : 0;
+
+    return 1 + mean * (cls->n_queued + cls->running) / cls->limit / 1000;
+}
+
+static void reject(nng_aio *aio, uint64_t retry)
+{
+    nng_http_res *res       = NULL;
+    nng_http_req *nng_req   = nng_aio_get_input(aio, 0);
+    char          value[32] = { 0 };
+    char          content[32];
+
+    snprintf(value, sizeof(value), "%" PRIu64, retry);
+    snprintf(content, sizeof(content), "{\"error\": %d}",
+             NEU_ERR_TOO_MANY_REQUESTS);
+
+    nng_http_res_alloc(&res);
+    nng_http_res_set_header(res, "Content-Type", "application/json");
+    nng_http_res_set_header(res, "Retry-After", value);
+    nng_http_res_set_header(res, "Access-Control-Allow-Origin", "*");
+    nng_http_res_set_header(res, "Access-Control-Allow-Methods",
+                            "POST,GET,PUT,DELETE,OPTIONS");
+    nng_http_res_set_header(res, "Access-Control-Allow-Headers", "*");
+    nng_http_res_copy_data(res, content, strlen(content));
+    nng_http_res_set_status(res, NNG_HTTP_STATUS_TOO_MANY_REQUESTS);
+
+    nlog_warn("%s %s [429], retry after %" PRIu64 "s",
+              nng_http_req_get_method(nng_req), nng_http_req_get_uri(nng_req),
+              retry);
+
+    nng_aio_set_output(aio, 0, res);
+    nng_aio_finish(aio, 0);
+}
+
+static void admit_cb(nng_aio *aio)
+{
+    nng_http_handler *h      = nng_aio_get_input(aio, 1);
+    http_route_t *    route  = nng_http_handler_get_data(h);
+    http_class_t *    cls    = route->cls;
+    http_ticket_t *   ticket = calloc(1, sizeof(http_ticket_t));
+    bool              run    = false;
+    uint64_t          retry  = 0;
+
+    if (NULL == ticket ||
+        0 != nng_aio_alloc(&ticket->timer, ticket_cb, ticket)) {
+        free(ticket);
+        route->handler(aio);
+        return;
+    }
+
+    ticket->route   = route;
+    ticket->aio     = aio;
+    ticket->arrival = neu_time_ms();
+    ticket->refs    = 2;
+    nng_aio_set_output(aio, NEU_HTTP_ADMIT_OUTPUT, ticket);
+
+    pthread_mutex_lock(&http_class_mtx);
+    if (cls->running < cls->limit) {
+        cls->running += 1;
+        ticket->running = true;
+        run             = true;
+    } else if (cls->n_queued < cls->queue_size) {
+        cls->n_queued += 1;
+        LL_APPEND(cls->queue, ticket);
+    } else {
+        cls->n_rejected += 1;
+        retry = retry_after(cls);
+    }
+    pthread_mutex_unlock(&http_class_mtx);
+
+    if (run) {
+        nng_sleep_aio(http_run_timeout, ticket->timer);
+        route->handler(aio);
+    } else if (0 != retry) {
+        nng_aio_set_output(aio, NEU_HTTP_ADMIT_OUTPUT, NULL);
+        nng_aio_free(ticket->timer);
+        free(ticket);
+        reject(aio, retry);
+    }
+}
+
+void neu_http_finish(nng_aio *aio)
+{
+    http_ticket_t *ticket  = nng_aio_get_output(aio, NEU_HTTP_ADMIT_OUTPUT);
+    http_ticket_t *next    = NULL;
+    http_class_t * cls     = NULL;
+    bool           release = false;
+    int64_t        latency = 0;
+
+    if (NULL == ticket) {
+        nng_aio_finish(aio, 0);
+        return;
+    }
+
+    nng_aio_set_output(aio, NEU_HTTP_ADMIT_OUTPUT, NULL);
+    cls     = ticket->route->cls;
+    latency = neu_time_ms() - ticket->arrival;
+
+    pthread_mutex_lock(&http_class_mtx);
+    cls->n_done += 1;
+    cls->latency_sum += latency;
+    for (size_t i = 0; i < N_BUCKET; i++) {
+        if (latency <= latency_buckets[i]) {
+            cls->latency[i] += 1;
+        }
+    }
+
+    ticket->finished = true;
+    if (!ticket->reclaimed) {
+        next = class_release(cls);
+    }
+    // the callback runs on the nng task threads, never inline
+    nng_aio_cancel(ticket->timer);
+    release = 0 == --ticket->refs;
+    pthread_mutex_unlock(&http_class_mtx);
+
+    nng_aio_finish(aio, 0);
+    ticket_dispatch(next);
+    if (release) {
+        ticket_free(ticket);
+    }
+}
+
+void neu_http_set_run_timeout(nng_duration ms)
+{
+    http_run_timeout = ms;
+}
+
+void neu_http_class_metrics(FILE *stream)
+{
+    http_class_t classes[NEU_HTTP_CLASS_MAX];
+
+    pthread_mutex_lock(&http_class_mtx);
+    memcpy(classes, http_classes, sizeof(classes));
+    pthread_mutex_unlock(&http_class_mtx);
+
+    fprintf(stream,
+            "# HELP rest_requests_running REST requests being handled\n"
+            "# TYPE rest_requests_running gauge\n");
+    for (int i = 0; i < NEU_HTTP_CLASS_MAX; i++) {
+        fprintf(stream, "rest_requests_running{class=\"%s\"} %d\n",
+                classes[i].name, classes[i].running);
+    }
+
+    fprintf(stream,
+            "# HELP rest_requests_queued REST requests waiting to be handled\n"
+            "# TYPE rest_requests_queued gauge\n");
+    for (int i = 0; i < NEU_HTTP_CLASS_MAX; i++) {
+        fprintf(stream, "rest_requests_queued{class=\"%s\"} %d\n",
+                classes[i].name, classes[i].n_queued);
+    }
+
+    fprintf(stream,
+            "# HELP rest_requests_rejected_total REST requests answered 429\n"
+            "# TYPE rest_requests_rejected_total counter\n");
+    for (int i = 0; i < NEU_HTTP_CLASS_MAX; i++) {
+        fprintf(stream,
+                "rest_requests_rejected_total{class=\"%s\"} %" PRIu64 "\n",
+                classes[i].name, classes[i].n_rejected);
+    }
+
+    fprintf(stream,
+            "# HELP rest_requests_reclaimed_total REST requests that gave up "
+            "their place unanswered after the run timeout\n"
+            "# TYPE rest_requests_reclaimed_total counter\n");
+    for (int i = 0; i < NEU_HTTP_CLASS_MAX; i++) {
+        fprintf(stream,
+                "rest_requests_reclaimed_total{class=\"%s\"} %" PRIu64 "\n",
+                classes[i].name, classes[i].n_reclaimed);
+    }
+
+    fprintf(stream,
+            "# HELP rest_request_duration_ms REST request latency in "
+            "milliseconds, queueing included\n"
+            "# TYPE rest_request_duration_ms histogram\n");
+    for (int i = 0; i < NEU_HTTP_CLASS_MAX; i++) {
+        const http_class_t *c = &classes[i];
+
+        for (size_t k = 0; k < N_BUCKET; k++) {
+            fprintf(stream,
+                    "rest_request_duration_ms_bucket{class=\"%s\",le=\"%" PRId64
+                    "\"} %" PRIu64 "\n",
+                    c->name, latency_buckets[k], c->latency[k]);
+        }
+        fprintf(stream,
+                "rest_request_duration_ms_bucket{class=\"%s\",le=\"+Inf\"} "
+                "%" PRIu64 "\n"
+                "rest_request_duration_ms_sum{class=\"%s\"} %" PRIu64 "\n"
+                "rest_request_duration_ms_count{class=\"%s\"} %" PRIu64 "\n",
+                c->name, c->n_done, c->name, c->latency_sum, c->name,
+                c->n_done);
+    }
+}
+
+static int alloc_function_handler(nng_http_handler **             handler,
+                                  const struct neu_http_handler *http_handler)
+{
+    http_class_t *cls   = &http_classes[http_handler->cls];
+    http_route_t *route = calloc(1, sizeof(http_route_t));
+    int           ret   = -1;
+
+    if (NULL == route) {
+        return -1;
+    }
+
+    route->cls     = cls;
+    route->handler = http_handler->value.handler;
+
+    ret = nng_http_handler_alloc(handler, http_handler->url, admit_cb);
+    if (0 != ret) {
+        free(route);
+        return ret;
+    }
+
+    return nng_http_handler_set_data(*handler, route, free);
+}
 
 int neu_http_add_handler(nng_http_server *              server,
                          const struct neu_http_handler *http_handler)
@@ -36,8 +400,7 @@ int neu_http_add_handler(nng_http_server *              server,
 
     switch (http_handler->type) {
     case NEU_HTTP_HANDLER_FUNCTION:
-        ret = nng_http_handler_alloc(&handler, http_handler->url,
-                                     http_handler->value.handler);
+        ret = alloc_function_handler(&handler, http_handler);
         break;
     case NEU_HTTP_HANDLER_DIRECTORY:
         ret = nng_http_handler_alloc_directory(&handler, http_handler->url,
@@ -101,5 +464,5 @@ void neu_http_handle_cors(nng_aio *aio)
     nng_http_res_set_status(res, NNG_HTTP_STATUS_OK);
 
     nng_aio_set_output(aio, 0, res);
-    nng_aio_finish(aio, 0);
+    neu_http_finish(aio);
 }
@@ -64,6 +64,11 @@ static double format_tag_value(float ele_value)
     return value * negative;
 }
 
+double neu_json_format_float(float value)
+{
+    return format_tag_value(value);
+}
+
 void neu_json_elem_free(neu_json_elem_t *elem)
 {
     if (elem == NULL) {
@@ -20,26 +20,60 @@
 #include <assert.h>
 #include <dirent.h>
 #include <errno.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
 #include <sys/time.h>
 
 #include <jwt.h>
+#include <openssl/sha.h>
 
 #include "errcodes.h"
 #include "utils/log.h"
 #include "utils/neu_jwt.h"
+#include "utils/uthash.h"
+
+// validated tokens kept, and the seconds one is trusted without verification
+#define JWT_CACHE_SIZE 64
+#define JWT_CACHE_TTL 300
+// the key files are checked for changes at most once in this many seconds
+#define JWT_KEY_CHECK_INTERVAL 1
+#define JWT_KEY_DIR "certs"
 
 struct public_key_store {
     struct {
-        char name[257];
-        char key[1024];
+        char        name[257];
+        char        key[1024];
+        struct stat st;
     } key[16];
-    int size;
+    int         size;
+    struct stat dir; // zeroed if the directory is missing
 };
 
 static struct public_key_store key_store;
+
+static struct {
+    pthread_mutex_t mtx;
+    time_t          checked;
+} key_check = {
+    .mtx = PTHREAD_MUTEX_INITIALIZER,
+};
+
+// a validated token, by the SHA-256 digest of it
+typedef struct {
+    unsigned char  digest[SHA256_DIGEST_LENGTH];
+    time_t         expire; // the exp grant, or the TTL if it is earlier
+    UT_hash_handle hh;
+} jwt_cache_entry_t;
+
+static struct {
+    pthread_mutex_t    mtx;
+    jwt_cache_entry_t *entries; // in the order of insertion
+} jwt_cache = {
+    .mtx = PTHREAD_MUTEX_INITIALIZER,
+};
 static char                    neuron_private_key[2048] = { 0 };
 static char                    neuron_public_key[2048]  = { 0 };
 
@@ -83,6 +117,69 @@ const char *public_key_content =
     "TQIDAQAB\n"
     "-----END PUBLIC KEY-----\n";
 
+static bool cache_find(const unsigned char *digest, time_t now)
+{
+    jwt_cache_entry_t *entry = NULL;
+    bool               found = false;
+
+    pthread_mutex_lock(&jwt_cache.mtx);
+    HASH_FIND(hh, jwt_cache.entries, digest, SHA256_DIGEST_LENGTH, entry);
+    if (NULL != entry) {
+        if (now < entry->expire) {
+            found = true;
+        } else {
+            HASH_DEL(jwt_cache.entries, entry);
+            free(entry);
+        }
+    }
+    pthread_mutex_unlock(&jwt_cache.mtx);
+
+    return found;
+}
+
+static void cache_add(const unsigned char *digest, time_t expire)
+{
+    jwt_cache_entry_t *entry = NULL;
+    jwt_cache_entry_t *old   = NULL;
+
+    pthread_mutex_lock(&jwt_cache.mtx);
+    HASH_FIND(hh, jwt_cache.entries, digest, SHA256_DIGEST_LENGTH, entry);
+    if (NULL != entry) {
+        entry->expire = expire;
+        pthread_mutex_unlock(&jwt_cache.mtx);
+        return;
+    }
+
+    entry = calloc(1, sizeof(jwt_cache_entry_t));
+    if (NULL != entry) {
+        // the oldest one makes room
+        if (HASH_COUNT(jwt_cache.entries) >= JWT_CACHE_SIZE) {
+            old = jwt_cache.entries;
+            HASH_DEL(jwt_cache.entries, old);
+        }
+
+        memcpy(entry->digest, digest, SHA256_DIGEST_LENGTH);
+        entry->expire = expire;
+        HASH_ADD(hh, jwt_cache.entries, digest, SHA256_DIGEST_LENGTH, entry);
+    }
+    pthread_mutex_unlock(&jwt_cache.mtx);
+
+    free(old);
+}
+
+void neu_jwt_cache_clear()
+{
+    jwt_cache_entry_t *entry = NULL, *tmp = NULL;
+
+    pthread_mutex_lock(&jwt_cache.mtx);
+    HASH_ITER(hh, jwt_cache.entries, entry, tmp)
+    {
+        HASH_DEL(jwt_cache.entries, entry);
+        free(entry);
+    }
+    pthread_mutex_unlock(&jwt_cache.mtx);
+}
+
 static int find_key(const char *name)
 {
     for (int i = 0; i < key_store.size; i++) {
@@ -94,7 +191,7 @@ static int find_key(const char *name)
     return -1;
 }
 
-static void add_key(char *name, char *value)
+static void add_key(char *name, char *value, const struct stat *st)
 {
     key_store.size += 1;
     assert(key_store.size <= 8);
@@ -103,6 +200,46 @@ static void add_key(char *name, char *value)
             sizeof(key_store.key[key_store.size - 1].name) - 1);
     strncpy(key_store.key[key_store.size - 1].key, value,
             sizeof(key_store.key[key_store.size - 1].key) - 1);
+    key_store.key[key_store.size - 1].st = *st;
+}
+
+static void stat_key(const char *dir, const char *name, struct stat *st)
+{
+    char path[256] = { 0 };
+
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    if (0 != stat(path, st)) {
+        memset(st, 0, sizeof(*st));
+    }
+}
+
+static bool stat_changed(const struct stat *old, const struct stat *now)
+{
+    return old->st_ino != now->st_ino || old->st_size != now->st_size ||
+        old->st_mtim.tv_sec != now->st_mtim.tv_sec ||
+        old->st_mtim.tv_nsec != now->st_mtim.tv_nsec;
+}
+
+// a key file is added, removed, replaced or written since the scan
+static bool keys_changed(const char *dir_path)
+{
+    struct stat st = { 0 };
+
+    if (0 != stat(dir_path, &st)) {
+        memset(&st, 0, sizeof(st));
+    }
+    if (stat_changed(&key_store.dir, &st)) {
+        return true;
+    }
+
+    for (int i = 0; i < key_store.size; i++) {
+        stat_key(dir_path, key_store.key[i].name, &st);
+        if (stat_changed(&key_store.key[i].st, &st)) {
+            return true;
+        }
+    }
+
+    return false;
 }
 
 static char *load_key(const char *dir, char *name)
@@ -149,7 +286,12 @@ static void scanf_key(const char *dir_path)
     DIR *          dir = NULL;
     struct dirent *ptr = NULL;
 
+    // the keys may have changed, tokens are verified again
+    neu_jwt_cache_clear();
     memset(&key_store, 0, sizeof(key_store));
+    if (0 != stat(dir_path, &key_store.dir)) {
+        memset(&key_store.dir, 0, sizeof(key_store.dir));
+    }
 
     dir = opendir(dir_path);
     if (dir == NULL) {
@@ -158,7 +300,8 @@ static void scanf_key(const char *dir_path)
     }
 
     while (NULL != (ptr = readdir(dir))) {
-        char *content = NULL;
+        char *      content = NULL;
+        struct stat st      = { 0 };
 
         if (!strcmp((char *) ptr->d_name, ".") ||
             !strcmp((char *) ptr->d_name, "..")) {
@@ -167,19 +310,42 @@ static void scanf_key(const char *dir_path)
 
         if (strstr((char *) ptr->d_name, ".pem") != NULL ||
             strstr((char *) ptr->d_name, ".pub") != NULL) {
+            stat_key(dir_path, ptr->d_name, &st);
             content = load_key(dir_path, (char *) ptr->d_name);
             assert(content != NULL);
-            add_key((char *) ptr->d_name, content);
+            add_key((char *) ptr->d_name, content, &st);
         }
     }
 
     closedir(dir);
 }
 
+static void rescan_keys()
+{
+    pthread_mutex_lock(&key_check.mtx);
+    scanf_key(JWT_KEY_DIR);
+    pthread_mutex_unlock(&key_check.mtx);
+}
+
+// rescans the key files if they changed, which drops the cached tokens
+static void check_keys(time_t now)
+{
+    pthread_mutex_lock(&key_check.mtx);
+    if (now < key_check.checked ||
+        now >= key_check.checked + JWT_KEY_CHECK_INTERVAL) {
+        key_check.checked = now;
+        if (keys_changed(JWT_KEY_DIR)) {
+            zlog_notice(neuron, "jwt key files changed, scan again");
+            scanf_key(JWT_KEY_DIR);
+        }
+    }
+    pthread_mutex_unlock(&key_check.mtx);
+}
+
 int neu_jwt_init(const char *dir_path)
 {
     load_neuron_key(dir_path);
-    scanf_key("certs");
+    scanf_key(JWT_KEY_DIR);
     return 0;
 }
 
@@ -304,7 +470,7 @@ static void *neu_jwt_decode(char *token)
         zlog_error(neuron, "Don't find public key file: %s", name);
         jwt_free(jwt_test);
         jwt_free(jwt);
-        scanf_key("certs");
+        rescan_keys();
         return NULL;
     }
 
@@ -321,9 +487,12 @@ static void *neu_jwt_decode(char *token)
 
 int neu_jwt_validate(char *b_token)
 {
-    jwt_valid_t *jwt_valid = NULL;
-    jwt_alg_t    opt_alg   = JWT_ALG_RS256;
-    char *       token     = NULL;
+    jwt_valid_t * jwt_valid = NULL;
+    jwt_alg_t     opt_alg   = JWT_ALG_RS256;
+    char *        token     = NULL;
+    time_t        now       = time(NULL);
+    time_t        expire    = 0;
+    unsigned char digest[SHA256_DIGEST_LENGTH];
 
     if (b_token == NULL || strlen(b_token) <= strlen("Bearar ")) {
         return NEU_ERR_NEED_TOKEN;
@@ -331,6 +500,13 @@ int neu_jwt_validate(char *b_token)
 
     token = &b_token[strlen("Bearar ")];
 
+    // repeated tokens skip the signature verification, until a key changes
+    check_keys(now);
+    SHA256((const unsigned char *) token, strlen(token), digest);
+    if (cache_find(digest, now)) {
+        return NEU_ERR_SUCCESS;
+    }
+
     jwt_t *jwt = (jwt_t *) neu_jwt_decode(token);
 
     if (jwt == NULL) {
@@ -353,7 +529,7 @@ int neu_jwt_validate(char *b_token)
         return NEU_ERR_EINTERNAL;
     }
 
-    ret = jwt_valid_set_now(jwt_valid, time(NULL));
+    ret = jwt_valid_set_now(jwt_valid, now);
     if (ret != 0 || jwt_valid == NULL) {
         zlog_error(neuron, "Failed to set time: %d", ret);
         jwt_valid_free(jwt_valid);
@@ -373,6 +549,12 @@ int neu_jwt_validate(char *b_token)
         }
     }
 
+    expire = jwt_get_grant_int(jwt, "exp");
+    if (expire <= 0 || expire > now + JWT_CACHE_TTL) {
+        expire = now + JWT_CACHE_TTL;
+    }
+    cache_add(digest, expire);
+
     jwt_valid_free(jwt_valid);
     jwt_free(jwt);
 
@@ -402,4 +584,5 @@ void neu_jwt_decode_user_after_valid(char *bearer, char *user)
 void neu_jwt_destroy()
 {
     // memset(token_local, 0, sizeof(token_local));
+    neu_jwt_cache_clear();
 }
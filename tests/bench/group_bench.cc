@@ -0,0 +1,144 @@
+#include <chrono>
+#include <stdio.h>
+#include <string>
+
+#include "utils/log.h"
+
+extern "C" {
+#include "base/group.h"
+}
+
+zlog_category_t *neuron = NULL;
+
+// tags are added out of the order of names
+static neu_group_t *new_group(int n_tag)
+{
+    neu_group_t *group = neu_group_new("group", 1000);
+
+    for (int i = 0; i < n_tag; i++) {
+        int           k        = (int) ((i * 7919L) % n_tag);
+        char          name[16] = { 0 };
+        std::string   address  = "1!4" + std::to_string(k);
+        neu_datatag_t tag      = {};
+
+        snprintf(name, sizeof(name), "tag%05d", k);
+        tag.name        = name;
+        tag.address     = (char *) address.c_str();
+        tag.description = (char *) (k % 2 ? "odd" : "even");
+        tag.attribute   = NEU_ATTRIBUTE_READ;
+        tag.type        = NEU_TYPE_INT16;
+        neu_group_add_tag(group, &tag);
+    }
+
+    return group;
+}
+
+// every tenth tag stands for a tag with an error value
+static bool is_error(const neu_datatag_t *tag, void *data)
+{
+    (void) data;
+    return atoi(tag->name + strlen("tag")) % 10 == 0;
+}
+
+static double since(std::chrono::steady_clock::time_point start, int rounds)
+{
+    return std::chrono::duration<double, std::micro>(
+               std::chrono::steady_clock::now() - start)
+               .count() /
+        rounds;
+}
+
+// a page of error tags, sliced from a copy of the whole group against
+// filtered and paged in the group
+static void paginate(void)
+{
+    const int    n_tag     = 20000;
+    const int    page_size = 100;
+    const int    rounds    = 20;
+    neu_group_t *group     = new_group(n_tag);
+    int          total     = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        UT_array *all  = neu_group_query_read_tag(group, NULL, NULL, 0, NULL);
+        UT_array *errs = NULL;
+
+        utarray_new(errs, neu_tag_get_icd());
+        utarray_foreach(all, neu_datatag_t *, tag)
+        {
+            if (is_error(tag, NULL)) {
+                utarray_push_back(errs, tag);
+            }
+        }
+        total = utarray_len(errs);
+        utarray_free(all);
+        utarray_free(errs);
+    }
+    double copy_us = since(start, rounds);
+
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        UT_array *tags = neu_group_query_read_tag_paginate(
+            group, NULL, NULL, is_error, NULL, 1, page_size, &total);
+        utarray_free(tags);
+    }
+    double page_us = since(start, rounds);
+
+    printf("%d tags, %d errors: copy and slice %.0f us, paginate %.0f us per "
+           "page, %.0fx\n",
+           n_tag, total, copy_us, page_us, copy_us / page_us);
+
+    neu_group_destroy(group);
+}
+
+// a name search and a deep page, against filtering a copy of the group
+static void search(void)
+{
+    const int    n_tag  = 50000;
+    const int    rounds = 100;
+    neu_group_t *group  = new_group(n_tag);
+    int          total  = 0;
+    int          hits   = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds / 10; r++) {
+        UT_array *all = neu_group_get_tag(group);
+
+        hits = 0;
+        utarray_foreach(all, neu_datatag_t *, tag)
+        {
+            hits += NULL != strstr(tag->name, "g0123");
+        }
+        utarray_free(all);
+    }
+    double copy_us = since(start, rounds / 10);
+
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        UT_array *tags = neu_group_query_read_tag_paginate(
+            group, "g0123", NULL, NULL, NULL, 1, 100, &total);
+        utarray_free(tags);
+    }
+    double search_us = since(start, rounds);
+
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        UT_array *tags = neu_group_query_read_tag_paginate(
+            group, NULL, NULL, NULL, NULL, 400, 100, &total);
+        utarray_free(tags);
+    }
+    double page_us = since(start, rounds);
+
+    printf("%d tags, %d hits: copy and filter %.0f us, search %.1f us, page "
+           "%.1f us\n",
+           n_tag, hits, copy_us, search_us, page_us);
+
+    neu_group_destroy(group);
+}
+
+int main()
+{
+    paginate();
+    search();
+    return 0;
+}
@@ -0,0 +1,211 @@
+#include <arpa/inet.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+#include <nng/nng.h>
+#include <nng/supplemental/http/http.h>
+
+#include "parser/neu_json_tag.h"
+#include "utils/http.h"
+#include "utils/log.h"
+#include "json/neu_json_fn.h"
+
+#define BENCH_PORT 17073
+#define BENCH_URL "http://127.0.0.1:17073"
+// the logs go to stdout, the server reports to the client on this one
+#define BENCH_REPORT_FD 3
+
+zlog_category_t *neuron = NULL;
+
+static std::vector<neu_json_tag_t> tags;
+static std::vector<std::string>    names;
+static bool                        stream = false;
+
+// GET /tags encodes the tags as a whole, or one tag at a time
+static void tags_handler(nng_aio *aio)
+{
+    if (stream) {
+        neu_http_chunked_t *chunked =
+            neu_http_chunked_new(aio, "application/json");
+
+        neu_http_chunked_puts(chunked, "{\"tags\": [");
+        for (size_t i = 0; i < tags.size(); i++) {
+            char *result = NULL;
+            neu_json_encode_by_fn(&tags[i], neu_json_encode_tag, &result);
+            neu_http_chunked_puts(chunked, i > 0 ? ", " : "");
+            neu_http_chunked_puts(chunked, result);
+            free(result);
+        }
+        neu_http_chunked_puts(chunked, "]}");
+        neu_http_chunked_end(chunked);
+    } else {
+        neu_json_get_tags_resp_t resp   = { 0 };
+        char *                   result = NULL;
+
+        resp.n_tag = tags.size();
+        resp.tags  = tags.data();
+        neu_json_encode_by_fn(&resp, neu_json_encode_get_tags_resp, &result);
+        neu_http_ok(aio, result);
+        free(result);
+    }
+}
+
+static long max_rss_kb()
+{
+    struct rusage usage = {};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/*
+ * The server of one mode, in a process of its own, as the peak RSS only
+ * grows. It tells the client it is ready, and reports the growth of its
+ * peak RSS once the client closes stdin.
+ */
+static int serve(int n_tag)
+{
+    nng_url *         url     = NULL;
+    nng_http_server * server  = NULL;
+    nng_http_handler *handler = NULL;
+    char              c       = 0;
+
+    names.reserve(n_tag);
+    for (int i = 0; i < n_tag; i++) {
+        neu_json_tag_t tag = {};
+
+        names.push_back("tag-" + std::to_string(i));
+        tag.name        = (char *) names.back().c_str();
+        tag.address     = (char *) "1!400001";
+        tag.description = (char *) "pump station pressure sensor";
+        tag.type        = NEU_TYPE_INT16;
+        tag.attribute   = NEU_ATTRIBUTE_READ;
+        tag.t           = NEU_JSON_UNDEFINE;
+        tags.push_back(tag);
+    }
+
+    nng_url_parse(&url, BENCH_URL);
+    if (0 != nng_http_server_hold(&server, url)) {
+        return 1;
+    }
+    nng_url_free(url);
+    nng_http_handler_alloc(&handler, "/tags", tags_handler);
+    nng_http_server_add_handler(server, handler);
+    if (0 != nng_http_server_start(server)) {
+        return 1;
+    }
+
+    long base = max_rss_kb();
+    dprintf(BENCH_REPORT_FD, "ready\n");
+    while (read(STDIN_FILENO, &c, 1) > 0) {
+    }
+    dprintf(BENCH_REPORT_FD, "%ld %zu\n", max_rss_kb() - base,
+            neu_http_chunked_peak());
+
+    nng_http_server_stop(server);
+    nng_http_server_release(server);
+    return 0;
+}
+
+// the body is counted, not kept
+static size_t get_tags()
+{
+    int         fd   = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr = {};
+    std::string req  = "GET /tags HTTP/1.1\r\nHost: 127.0.0.1\r\n"
+                      "Connection: close\r\n\r\n";
+    char        buf[4096];
+    ssize_t     n    = 0;
+    size_t      size = 0;
+
+    addr.sin_family      = AF_INET;
+    addr.sin_port        = htons(BENCH_PORT);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (0 != connect(fd, (sockaddr *) &addr, sizeof(addr)) ||
+        (ssize_t) req.size() != send(fd, req.data(), req.size(), 0)) {
+        close(fd);
+        return 0;
+    }
+    while ((n = recv(fd, buf, sizeof(buf), 0)) > 0) {
+        size += n;
+    }
+    close(fd);
+    return size;
+}
+
+// runs the server of a mode, and gets the tags from it
+static int run(const char *mode, const char *n_tag)
+{
+    int    to_server[2]   = { 0 };
+    int    from_server[2] = { 0 };
+    char   line[64]       = { 0 };
+    long   rss_kb         = 0;
+    size_t peak           = 0;
+    size_t size           = 0;
+    pid_t  pid            = 0;
+    FILE * out            = NULL;
+
+    if (0 != pipe(to_server) || 0 != pipe(from_server)) {
+        return 1;
+    }
+
+    pid = fork();
+    if (0 == pid) {
+        dup2(to_server[0], STDIN_FILENO);
+        dup2(from_server[1], BENCH_REPORT_FD);
+        close(to_server[1]);
+        close(from_server[0]);
+        execl("/proc/self/exe", "http_chunked_bench", mode, n_tag,
+              (char *) NULL);
+        _exit(1);
+    }
+    close(to_server[0]);
+    close(from_server[1]);
+
+    out = fdopen(from_server[0], "r");
+    if (NULL == fgets(line, sizeof(line), out)) {
+        fprintf(stderr, "%s server fail\n", mode);
+        return 1;
+    }
+
+    size = get_tags();
+    close(to_server[1]);
+
+    if (NULL == fgets(line, sizeof(line), out) ||
+        2 != sscanf(line, "%ld %zu", &rss_kb, &peak)) {
+        fprintf(stderr, "%s server fail\n", mode);
+        return 1;
+    }
+    fclose(out);
+    waitpid(pid, NULL, 0);
+
+    printf("%s, %s tags: %zu bytes, server peak RSS +%ld KiB, chunks queued "
+           "%zu bytes at most\n",
+           mode, n_tag, size, rss_kb, peak);
+    return 0;
+}
+
+// GET /tags of 100000 tags, from a JSON tree or chunked
+int main(int argc, char **argv)
+{
+    const char *n_tag = "100000";
+
+    zlog_init("./config/dev.conf");
+    neuron = zlog_get_category("neuron");
+
+    if (argc == 3) {
+        stream = 0 == strcmp(argv[1], "stream");
+        return serve(atoi(argv[2]));
+    }
+
+    if (0 != run("tree", n_tag) || 0 != run("stream", n_tag)) {
+        return 1;
+    }
+    return 0;
+}
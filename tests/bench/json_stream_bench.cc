@@ -0,0 +1,132 @@
+#include <chrono>
+#include <stdio.h>
+
+#include "msg.h"
+#include "utils/log.h"
+#include "json/json.h"
+#include "json/neu_json_fn.h"
+#include "json/neu_json_rw.h"
+#include "json/neu_json_stream.h"
+
+zlog_category_t *neuron = NULL;
+
+enum format { VALUES, TAGS, ECP };
+
+static neu_json_read_periodic_t header = { .group     = (char *) "group",
+                                          .node      = (char *) "node",
+                                          .timestamp = 1700000000123 };
+
+// the jansson path of generate_upload_json in plugins/mqtt
+static int encode_jansson(enum format format, UT_array *tags, char **result)
+{
+    neu_json_read_resp_t json = {};
+    int                  ret  = 0;
+
+    json.n_tag = utarray_len(tags);
+    json.tags  = (neu_json_read_resp_tag_t *) calloc(
+        json.n_tag + 1, sizeof(neu_json_read_resp_tag_t));
+    for (int i = 0; i < json.n_tag; i++) {
+        neu_tag_value_to_json(
+            (neu_resp_tag_value_meta_t *) utarray_eltptr(tags, i),
+            &json.tags[i]);
+    }
+
+    switch (format) {
+    case VALUES:
+        ret = neu_json_encode_with_mqtt(&json, neu_json_encode_read_resp1,
+                                        &header,
+                                        neu_json_encode_read_periodic_resp,
+                                        result);
+        break;
+    case TAGS:
+        ret = neu_json_encode_with_mqtt(&json, neu_json_encode_read_resp2,
+                                        &header,
+                                        neu_json_encode_read_periodic_resp,
+                                        result);
+        break;
+    case ECP:
+        ret = neu_json_encode_with_mqtt_ecp(
+            &json, neu_json_encode_read_resp_ecp, &header,
+            neu_json_encode_read_periodic_resp, result);
+        break;
+    }
+
+    for (int i = 0; i < json.n_tag; i++) {
+        if (json.tags[i].n_meta > 0) {
+            free(json.tags[i].metas);
+        }
+    }
+    free(json.tags);
+    return ret;
+}
+
+static int encode_stream(enum format format, UT_array *tags, char **result)
+{
+    switch (format) {
+    case VALUES:
+        return neu_json_stream_encode_values(&header, tags, result);
+    case TAGS:
+        return neu_json_stream_encode_tags(&header, tags, result);
+    case ECP:
+        return neu_json_stream_encode_ecp(&header, tags, result);
+    }
+
+    return -1;
+}
+
+// MQTT upload payloads of 5000 tags, built through a jansson tree and
+// streamed
+int main()
+{
+    const int n_tag  = 5000;
+    const int rounds = 50;
+    UT_array *tags   = NULL;
+
+    utarray_new(tags, neu_resp_tag_value_meta_icd());
+    for (int i = 0; i < n_tag; i++) {
+        neu_resp_tag_value_meta_t tag = {};
+
+        snprintf(tag.tag, sizeof(tag.tag), "tag-%d", i);
+        if (i % 2 == 0) {
+            tag.value.type      = NEU_TYPE_FLOAT;
+            tag.value.value.f32 = i * 0.37f;
+        } else {
+            tag.value.type      = NEU_TYPE_INT32;
+            tag.value.value.i32 = i * 13;
+        }
+        utarray_push_back(tags, &tag);
+    }
+
+    enum format formats[] = { VALUES, TAGS, ECP };
+    const char *names[]   = { "values", "tags", "ecp" };
+
+    for (int f = 0; f < 3; f++) {
+        double us[2] = { 0 };
+
+        for (int path = 0; path < 2; path++) {
+            auto start = std::chrono::steady_clock::now();
+
+            for (int r = 0; r < rounds; r++) {
+                char *result = NULL;
+
+                if (path == 0) {
+                    encode_jansson(formats[f], tags, &result);
+                } else {
+                    encode_stream(formats[f], tags, &result);
+                }
+                free(result);
+            }
+
+            us[path] = std::chrono::duration<double, std::micro>(
+                           std::chrono::steady_clock::now() - start)
+                           .count() /
+                rounds;
+        }
+
+        printf("%s, %d tags: jansson %.0f us, stream %.0f us, %.1fx\n",
+               names[f], n_tag, us[0], us[1], us[0] / us[1]);
+    }
+
+    utarray_free(tags);
+    return 0;
+}
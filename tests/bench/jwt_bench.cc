@@ -0,0 +1,54 @@
+#include <chrono>
+#include <stdio.h>
+
+#include "jwt.h"
+#include "utils/neu_jwt.h"
+
+#include "utils/log.h"
+
+zlog_category_t *neuron = NULL;
+
+static double since(std::chrono::steady_clock::time_point start, int rounds)
+{
+    return std::chrono::duration<double, std::micro>(
+               std::chrono::steady_clock::now() - start)
+               .count() /
+        rounds;
+}
+
+// a token verified on every request against a cached verification
+int main()
+{
+    const int rounds        = 200;
+    char *    token         = NULL;
+    char      b_token[1024] = { 0 };
+
+    zlog_init("./config/dev.conf");
+    neuron = zlog_get_category("neuron");
+
+    if (neu_jwt_init((char *) "./config") != 0 ||
+        neu_jwt_new(&token, "admin") != 0) {
+        fprintf(stderr, "jwt init fail, run in the build directory\n");
+        return 1;
+    }
+    snprintf(b_token, sizeof(b_token), "Bearer %s", token);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        neu_jwt_cache_clear();
+        neu_jwt_validate(b_token);
+    }
+    double verify_us = since(start, rounds);
+
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        neu_jwt_validate(b_token);
+    }
+    double cached_us = since(start, rounds);
+
+    printf("jwt validate: verify %.1f us, cached %.2f us, %.0fx\n", verify_us,
+           cached_us, verify_us / cached_us);
+
+    jwt_free_str(token);
+    return 0;
+}
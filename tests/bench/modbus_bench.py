@@ -0,0 +1,201 @@
+#!/usr/bin/env python3
+"""
+Drive Neuron against modbus_bench_simulator and report read throughput.
+
+Every modbus-tcp node polls its own simulator port. The tags of a node are
+spread over the simulator unit ids and over the node groups. After a warm-up
+the metrics endpoint and the neuron process are sampled, and the script
+reports tags/sec, poll-cycle latency percentiles (group_last_timer_ms) and
+neuron CPU time per 1k tag reads.
+
+Run it from the build directory, or through `make modbus_bench`:
+
+    python3 ../tests/bench/modbus_bench.py --nodes 16 --tags 2000
+"""
+
+import argparse
+import os
+import re
+import signal
+import subprocess
+import sys
+import time
+
+import requests
+
+BASE_URL = "http://127.0.0.1:7000"
+METRIC_RE = re.compile(r'^(\w+)\{([^}]*)\} (\d+)$')
+
+
+def check(response):
+    if response.status_code != 200:
+        sys.exit(f"{response.request.method} {response.request.url} "
+                 f"fail: {response.status_code} {response.text}")
+    return response
+
+
+def setup_node(args, index):
+    node = f"bench-{index}"
+    check(requests.post(BASE_URL + "/api/v2/node",
+                        json={"name": node, "plugin": "Modbus TCP"}))
+    check(requests.post(BASE_URL + "/api/v2/node/setting",
+                        json={"node": node, "params": {
+                            "connection_mode": 0, "transport_mode": 0,
+                            "interval": 0, "host": "127.0.0.1",
+                            "port": args.port + index,
+                            "timeout": args.timeout, "max_retries": 0,
+                            "retry_interval": 1,
+                            "connection_pool": args.pool,
+                            "max_inflight": args.inflight}}))
+
+    per_group = (args.tags + args.groups - 1) // args.groups
+    for g in range(args.groups):
+        group = f"group-{g}"
+        check(requests.post(BASE_URL + "/api/v2/group",
+                            json={"node": node, "group": group,
+                                  "interval": args.interval}))
+
+        tags = []
+        for t in range(g * per_group, min(args.tags, (g + 1) * per_group)):
+            unit = t % args.units + 1
+            address = t // args.units % 10000 + 400001
+            tags.append({"name": f"tag-{t}", "address": f"{unit}!{address}",
+                         "attribute": 1, "type": 3})
+
+        # keep the requests small enough for the rest server
+        for i in range(0, len(tags), 500):
+            check(requests.post(BASE_URL + "/api/v2/tags",
+                                json={"node": node, "group": group,
+                                      "tags": tags[i:i + 500]}))
+
+    check(requests.post(BASE_URL + "/api/v2/node/ctl",
+                        json={"node": node, "cmd": 0}))
+
+
+def sample_metrics():
+    reads = 0
+    timers = []
+    text = check(requests.get(BASE_URL + "/api/v2/metrics",
+                              params={"category": "driver"})).text
+    for line in text.splitlines():
+        m = METRIC_RE.match(line)
+        if m is None or 'node="bench-' not in m.group(2):
+            continue
+        if m.group(1) == "tag_reads_total":
+            reads += int(m.group(3))
+        elif m.group(1) == "group_last_timer_ms":
+            timers.append(int(m.group(3)))
+    return reads, timers
+
+
+def cpu_seconds(pid):
+    with open(f"/proc/{pid}/stat") as f:
+        fields = f.read().rsplit(")", 1)[1].split()
+    # utime and stime, fields 14 and 15 of proc(5)
+    return (int(fields[11]) + int(fields[12])) / os.sysconf("SC_CLK_TCK")
+
+
+def percentile(values, p):
+    if not values:
+        return 0
+    values = sorted(values)
+    return values[min(len(values) - 1, int(len(values) * p / 100))]
+
+
+def wait_ready():
+    for _ in range(50):
+        try:
+            requests.post(BASE_URL + "/api/v2/ping", timeout=1)
+            return
+        except requests.exceptions.ConnectionError:
+            time.sleep(0.2)
+    sys.exit("neuron does not start")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[1])
+    parser.add_argument("--build", default=".",
+                        help="neuron build directory")
+    parser.add_argument("--simulator", default=None,
+                        help="modbus_bench_simulator executable")
+    parser.add_argument("--port", type=int, default=5020)
+    parser.add_argument("--nodes", type=int, default=8)
+    parser.add_argument("--groups", type=int, default=4,
+                        help="groups per node")
+    parser.add_argument("--tags", type=int, default=1000,
+                        help="tags per node")
+    parser.add_argument("--units", type=int, default=16,
+                        help="unit ids used per node")
+    parser.add_argument("--interval", type=int, default=1000,
+                        help="group interval in ms")
+    parser.add_argument("--timeout", type=int, default=3000)
+    parser.add_argument("--pool", type=int, default=1,
+                        help="modbus connection_pool")
+    parser.add_argument("--inflight", type=int, default=1,
+                        help="modbus max_inflight")
+    parser.add_argument("--latency", type=int, default=0)
+    parser.add_argument("--jitter", type=int, default=0)
+    parser.add_argument("--drop", type=float, default=0)
+    parser.add_argument("--exception", type=float, default=0)
+    parser.add_argument("--warmup", type=int, default=10,
+                        help="seconds before sampling")
+    parser.add_argument("--duration", type=int, default=30,
+                        help="seconds of sampling")
+    args = parser.parse_args()
+
+    build = os.path.abspath(args.build)
+    simulator = args.simulator or os.path.join(
+        build, "simulator", "modbus_bench_simulator")
+
+    sim = subprocess.Popen([simulator, "--port", str(args.port),
+                            "--ports", str(args.nodes),
+                            "--units", str(args.units),
+                            "--latency", str(args.latency),
+                            "--jitter", str(args.jitter),
+                            "--drop", str(args.drop),
+                            "--exception", str(args.exception),
+                            "--stats", str(args.duration)])
+    subprocess.run(["rm", "-rf", os.path.join(build, "persistence")])
+    os.makedirs(os.path.join(build, "persistence"))
+    neuron = subprocess.Popen(["./neuron", "--disable_auth"], cwd=build,
+                              stdout=subprocess.DEVNULL,
+                              stderr=subprocess.DEVNULL)
+
+    try:
+        wait_ready()
+        for i in range(args.nodes):
+            setup_node(args, i)
+
+        time.sleep(args.warmup)
+
+        timers = []
+        reads_start, _ = sample_metrics()
+        cpu_start = cpu_seconds(neuron.pid)
+        start = time.monotonic()
+        while time.monotonic() - start < args.duration:
+            time.sleep(0.5)
+            timers.extend(sample_metrics()[1])
+        elapsed = time.monotonic() - start
+        reads_end, _ = sample_metrics()
+        cpu = cpu_seconds(neuron.pid) - cpu_start
+
+        reads = reads_end - reads_start
+        total = args.nodes * args.tags
+        print(f"nodes: {args.nodes}, tags: {total}, "
+              f"interval: {args.interval} ms, duration: {elapsed:.1f} s")
+        print(f"tags/sec: {reads / elapsed:.1f}")
+        print(f"poll cycle ms: p50 {percentile(timers, 50)}, "
+              f"p90 {percentile(timers, 90)}, p99 {percentile(timers, 99)}, "
+              f"max {max(timers, default=0)}")
+        print(f"cpu: {cpu / elapsed * 100:.1f}%, "
+              f"{cpu / elapsed * 100 * 1000 / total:.2f}% per 1k tags, "
+              f"{cpu * 1000 / max(reads / 1000, 1):.2f} ms per 1k tag reads")
+    finally:
+        neuron.send_signal(signal.SIGINT)
+        neuron.wait()
+        sim.send_signal(signal.SIGINT)
+        sim.wait()
+
+
+if __name__ == "__main__":
+    main()
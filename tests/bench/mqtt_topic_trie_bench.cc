@@ -0,0 +1,67 @@
+#include <chrono>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "connection/mqtt_client.h"
+#include "connection/mqtt_topic_trie.h"
+#include "utils/log.h"
+
+zlog_category_t *neuron = NULL;
+
+// write request dispatch of 10000 per driver wildcard filters, trie lookup
+// against scanning the filters linearly
+int main()
+{
+    const int                n_filter = 10000;
+    const int                rounds   = 10000;
+    neu_mqtt_topic_trie_t *  trie     = neu_mqtt_topic_trie_new();
+    std::vector<std::string> filters;
+    std::vector<std::string> topics;
+    size_t                   n_found = 0;
+
+    filters.reserve(n_filter);
+    for (int i = 0; i < n_filter; i++) {
+        filters.push_back("/neuron/app/driver-" + std::to_string(i) +
+                          (i % 2 ? "/+/write" : "/write/#"));
+        neu_mqtt_topic_trie_add(trie, filters.back().c_str(),
+                                (void *) filters.back().c_str());
+    }
+    for (int i = 0; i < rounds; i++) {
+        int d = (i * 7919) % n_filter;
+        topics.push_back("/neuron/app/driver-" + std::to_string(d) +
+                         (d % 2 ? "/group/write" : "/write/group"));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (const std::string &topic : topics) {
+        n_found += NULL !=
+            neu_mqtt_topic_trie_match(trie, topic.c_str(), topic.size());
+    }
+    double trie_us = std::chrono::duration<double, std::micro>(
+                         std::chrono::steady_clock::now() - start)
+                         .count() /
+        rounds;
+
+    // linear scanning over a tenth of the messages is enough to compare
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds / 10; i++) {
+        const char *topic = topics[i].c_str();
+        bool        found = false;
+        for (int f = 0; f < n_filter && !found; f++) {
+            found = neu_mqtt_topic_filter_is_match(filters[f].c_str(), topic);
+        }
+        n_found += found;
+    }
+    double linear_us = std::chrono::duration<double, std::micro>(
+                           std::chrono::steady_clock::now() - start)
+                           .count() /
+        (rounds / 10);
+
+    printf("%d filters: linear %.2f us, trie %.2f us per message, %.0fx, "
+           "%zu matched\n",
+           n_filter, linear_us, trie_us, linear_us / trie_us, n_found);
+
+    neu_mqtt_topic_trie_free(trie);
+    return 0;
+}
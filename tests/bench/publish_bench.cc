@@ -0,0 +1,246 @@
+#include <atomic>
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <nng/mqtt/mqtt_client.h>
+#include <nng/nng.h>
+
+#include "msg.h"
+#include "utils/log.h"
+#include "json/json.h"
+#include "json/neu_json_fn.h"
+#include "json/neu_json_rw.h"
+#include "json/neu_json_stream.h"
+
+zlog_category_t *neuron = NULL;
+
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t n, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void  __libc_free(void *ptr);
+}
+
+// every allocation of the process goes through these counters
+static std::atomic<long long> n_alloc(0);
+static std::atomic<long long> alloc_bytes(0);
+static std::atomic<long long> moved_bytes(0);
+static std::atomic<long long> live_bytes(0);
+static std::atomic<long long> peak_bytes(0);
+
+static void account(void *ptr)
+{
+    long long live = live_bytes += malloc_usable_size(ptr);
+    long long peak = peak_bytes.load();
+
+    while (live > peak && !peak_bytes.compare_exchange_weak(peak, live)) {
+    }
+    n_alloc += 1;
+    alloc_bytes += malloc_usable_size(ptr);
+}
+
+extern "C" void *malloc(size_t size)
+{
+    void *ptr = __libc_malloc(size);
+
+    if (ptr != NULL) {
+        account(ptr);
+    }
+    return ptr;
+}
+
+extern "C" void *calloc(size_t n, size_t size)
+{
+    void *ptr = __libc_calloc(n, size);
+
+    if (ptr != NULL) {
+        account(ptr);
+    }
+    return ptr;
+}
+
+// a realloc that moves the block counts as an allocation and a copy
+extern "C" void *realloc(void *ptr, size_t size)
+{
+    size_t old = ptr != NULL ? malloc_usable_size(ptr) : 0;
+    void * p   = __libc_realloc(ptr, size);
+
+    if (p == NULL) {
+        return p;
+    }
+    live_bytes -= old;
+    if (p != ptr) {
+        moved_bytes += old < size ? old : size;
+    }
+    account(p);
+    if (p == ptr) {
+        n_alloc -= 1;
+        alloc_bytes -= old;
+    }
+    return p;
+}
+
+extern "C" void free(void *ptr)
+{
+    if (ptr != NULL) {
+        live_bytes -= malloc_usable_size(ptr);
+        __libc_free(ptr);
+    }
+}
+
+static neu_json_read_periodic_t header = { .group     = (char *) "group",
+                                          .node      = (char *) "node",
+                                          .timestamp = 1700000000123 };
+
+// the jansson path the values format was uploaded with before the stream
+// encoder
+static int encode_jansson(UT_array *tags, char **result)
+{
+    neu_json_read_resp_t json = {};
+    int                  ret  = 0;
+
+    json.n_tag = utarray_len(tags);
+    json.tags  = (neu_json_read_resp_tag_t *) calloc(
+        json.n_tag + 1, sizeof(neu_json_read_resp_tag_t));
+    for (int i = 0; i < json.n_tag; i++) {
+        neu_tag_value_to_json(
+            (neu_resp_tag_value_meta_t *) utarray_eltptr(tags, i),
+            &json.tags[i]);
+    }
+
+    ret = neu_json_encode_with_mqtt(&json, neu_json_encode_read_resp1, &header,
+                                    neu_json_encode_read_periodic_resp,
+                                    result);
+
+    for (int i = 0; i < json.n_tag; i++) {
+        if (json.tags[i].n_meta > 0) {
+            free(json.tags[i].metas);
+        }
+    }
+    free(json.tags);
+    return ret;
+}
+
+// an in-flight message, with the payload the plugin keeps until the PUBACK
+struct flight {
+    nng_msg *msg;
+    char *   payload;
+};
+
+/*
+ * One upload of the values format, from the tags to the message handed to
+ * nng. The plugin payload used to be freed in the publish callback, so it
+ * lived as long as the message (`keep`), it is now freed once copied.
+ */
+static long long upload(bool stream, bool keep, UT_array *tags, flight *f)
+{
+    char *   payload = NULL;
+    nng_msg *msg     = NULL;
+    uint32_t len     = 0;
+
+    if (stream) {
+        neu_json_stream_encode_values(&header, tags, &payload);
+    } else {
+        encode_jansson(tags, &payload);
+    }
+
+    len = strlen(payload);
+    nng_mqtt_msg_alloc(&msg, 0);
+    nng_mqtt_msg_set_packet_type(msg, NNG_MQTT_PUBLISH);
+    nng_mqtt_msg_set_publish_topic(msg, "/neuron/upload");
+    nng_mqtt_msg_set_publish_payload(msg, (uint8_t *) payload, len);
+
+    f->msg = msg;
+    if (keep) {
+        f->payload = payload;
+    } else {
+        free(payload);
+        f->payload = NULL;
+    }
+    return len;
+}
+
+// the PUBACK of the message
+static void ack(flight *f)
+{
+    nng_msg_free(f->msg);
+    free(f->payload);
+    f->msg     = NULL;
+    f->payload = NULL;
+}
+
+/*
+ * QoS 1 uploads of 1000 tags, 32 messages in flight. Allocations and bytes
+ * are counted by the malloc wrappers above, copies are the realloc moves
+ * plus the copy of the payload into the message. The memcpy calls within
+ * the encoders are not seen.
+ */
+int main()
+{
+    const int n_tag  = 1000;
+    const int window = 32;
+    const int rounds = 256;
+    UT_array *tags   = NULL;
+    flight    flights[window];
+
+    utarray_new(tags, neu_resp_tag_value_meta_icd());
+    for (int i = 0; i < n_tag; i++) {
+        neu_resp_tag_value_meta_t tag = {};
+
+        snprintf(tag.tag, sizeof(tag.tag), "tag-%d", i);
+        if (i % 10 == 0) {
+            tag.value.type      = NEU_TYPE_ERROR;
+            tag.value.value.i32 = NEU_ERR_PLUGIN_TAG_NOT_READY;
+        } else {
+            tag.value.type      = NEU_TYPE_FLOAT;
+            tag.value.value.f32 = i * 0.37f;
+        }
+        utarray_push_back(tags, &tag);
+    }
+
+    for (int p = 0; p < 4; p++) {
+        bool      stream  = p >= 2;
+        bool      keep    = p % 2 == 0;
+        long long payload = 0;
+        long long base    = 0;
+
+        memset(flights, 0, sizeof(flights));
+        // warm up the encoder and nng, which keep buffers between calls
+        upload(stream, keep, tags, &flights[0]);
+        ack(&flights[0]);
+
+        base        = live_bytes.load();
+        n_alloc     = 0;
+        alloc_bytes = 0;
+        moved_bytes = 0;
+        peak_bytes  = base;
+
+        for (int r = 0; r < rounds; r++) {
+            flight *f = &flights[r % window];
+
+            if (f->msg != NULL) {
+                ack(f);
+            }
+            payload = upload(stream, keep, tags, f);
+        }
+        for (int i = 0; i < window; i++) {
+            if (flights[i].msg != NULL) {
+                ack(&flights[i]);
+            }
+        }
+
+        printf("%s, payload %s: %lld bytes payload, per upload %.1f allocs, "
+               "%.0f bytes allocated, %.0f bytes copied, peak in flight %lld "
+               "KiB\n",
+               stream ? "stream" : "jansson",
+               keep ? "kept until PUBACK" : "freed at hand-off", payload,
+               (double) n_alloc / rounds, (double) alloc_bytes / rounds,
+               (double) (moved_bytes + payload * rounds) / rounds,
+               (peak_bytes - base) / 1024);
+    }
+
+    utarray_free(tags);
+    return 0;
+}
@@ -1564,6 +1564,26 @@ class TestModbus:
         assert 200 == response.status_code
         assert error.NEU_ERR_SUCCESS == response.json()['error']
 
+    @description(given="created modbus node", when="set modbus tcp_server mode with multiple clients", then="set success with valid max_clients only")
+    def test_set_modbus_tcp_server_clients(self, param):
+        if param[0] != 'modbus-tcp':
+            pytest.skip("modbus tcp only")
+
+        response = api.modbus_tcp_node_setting_clients(
+            node=param[0]+"_3002", port=29997, max_clients=100, client_identify=1)
+        assert 200 == response.status_code
+        assert error.NEU_ERR_SUCCESS == response.json()['error']
+
+        response = api.modbus_tcp_node_setting_clients(
+            node=param[0]+"_3002", port=29997, max_clients=0)
+        assert 400 == response.status_code
+        assert error.NEU_ERR_NODE_SETTING_INVALID == response.json()['error']
+
+        response = api.modbus_tcp_node_setting_clients(
+            node=param[0]+"_3002", port=29997, max_clients=1)
+        assert 200 == response.status_code
+        assert error.NEU_ERR_SUCCESS == response.json()['error']
+
     @description(given="created modbus node with degradation", when="trigger degradation, read tags", then="success")
     def test_modbus_degradation(self, param):
         response = api.add_node(node=param[0]+"_degradation", plugin=param[1])
@@ -1731,4 +1751,33 @@ class TestModbus:
             assert 0 == api.read_tag(node=param[0], group='group', tag=hold_int16[0]['name'])
             process.stop_simulator(p_2)
         else:
-            pytest.skip()
\ No newline at end of file
+            pytest.skip()
+
+    @description(given="configed modbus node with a connection pool of 3",
+                 when="write and read tags of slave 1, 2 and 3",
+                 then="write/read success")
+    def test_modbus_connection_pool(self, param):
+        if param[0] == 'modbus-tcp':
+            api.del_node(node=param[0])
+            p_1 = process.start_simulator(['./modbus_simulator', 'tcp', f'{tcp_port_2}', 'ip_v4'])
+
+            tags = [{"name": f"pool_hold_int16_{i}", "address": f"{i}!400101",
+                     "attribute": config.NEU_TAG_ATTRIBUTE_RW, "type": config.NEU_TYPE_INT16} for i in range(1, 4)]
+
+            api.add_node(node=param[0], plugin=param[1])
+            api.modbus_tcp_node_setting_pool(node=param[0], port=tcp_port_2, connection_pool=3, interval=1)
+            api.add_group(node=param[0], group='group')
+            api.add_tags_check(node=param[0], group='group', tags=tags)
+            time.sleep(3)
+            for i, tag in enumerate(tags):
+                api.write_tag(node=param[0], group='group', tag=tag['name'], value=100 + i)
+            time.sleep(1)
+            for i, tag in enumerate(tags):
+                assert 100 + i == api.read_tag(node=param[0], group='group', tag=tag['name'])
+
+            response = api.modbus_tcp_node_setting_pool(node=param[0], port=tcp_port_2, connection_pool=17)
+            assert 400 == response.status_code
+            assert error.NEU_ERR_NODE_SETTING_INVALID == response.json()['error']
+            process.stop_simulator(p_1)
+        else:
+            pytest.skip()
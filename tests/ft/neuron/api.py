@@ -383,6 +383,18 @@ def modbus_tcp_node_setting_backup(node, port, backup_port, connection_mode=0, t
                                     "host": host, "port": port, "timeout": timeout, "max_retries": max_retries, "retry_interval": retry_interval, "backup_host": "127.0.0.1", "backup_port": backup_port})
 
 
+def modbus_tcp_node_setting_pool(node, port, connection_pool, max_inflight=1, connection_mode=0, transport_mode=0, interval=0, host='127.0.0.1', timeout=3000, max_retries=2, retry_interval=1):
+    return node_setting(node, json={"connection_mode": connection_mode, "transport_mode": transport_mode, "interval": interval,
+                                    "host": host, "port": port, "timeout": timeout, "max_retries": max_retries, "retry_interval": retry_interval,
+                                    "connection_pool": connection_pool, "max_inflight": max_inflight})
+
+
+def modbus_tcp_node_setting_clients(node, port, max_clients, client_identify=0, connection_mode=1, transport_mode=0, interval=0, host='0.0.0.0', timeout=3000, max_retries=2, retry_interval=1):
+    return node_setting(node, json={"connection_mode": connection_mode, "transport_mode": transport_mode, "interval": interval,
+                                    "host": host, "port": port, "timeout": timeout, "max_retries": max_retries, "retry_interval": retry_interval,
+                                    "max_clients": max_clients, "client_identify": client_identify})
+
+
 def mqtt_node_setting(node, client_id="neuron_aBcDeF", host="broker.emqx.io", port=1883):
     return node_setting(node, json={"client-id": client_id, "qos": 0, "format": 0,
                                     "write-req-topic": f"/neuron/{node}/write/req", "write-resp-topic": f"/neuron/{node}/write/resp",
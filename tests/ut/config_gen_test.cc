@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+
+#include "utils/log.h"
+
+extern "C" {
+#include "base/config_gen.h"
+}
+
+zlog_category_t *neuron = NULL;
+
+TEST(ConfigGenTest, Bump)
+{
+    uint64_t global = neu_config_gen(NULL, NULL);
+
+    EXPECT_EQ(0, neu_config_gen("node", NULL));
+    EXPECT_EQ(0, neu_config_gen("node", "group"));
+
+    neu_config_gen_bump("node", "group");
+    uint64_t group = neu_config_gen("node", "group");
+    EXPECT_LT(global, group);
+    EXPECT_EQ(group, neu_config_gen(NULL, NULL));
+    EXPECT_EQ(group, neu_config_gen("node", NULL));
+
+    // the other groups and nodes are not touched
+    neu_config_gen_bump("node", "other");
+    EXPECT_EQ(group, neu_config_gen("node", "group"));
+    EXPECT_LT(group, neu_config_gen("node", NULL));
+    EXPECT_EQ(0, neu_config_gen("app", NULL));
+
+    // a change to the node as a whole covers all its groups
+    neu_config_gen_bump("node", NULL);
+    uint64_t node = neu_config_gen("node", NULL);
+    EXPECT_EQ(node, neu_config_gen("node", "group"));
+    EXPECT_EQ(node, neu_config_gen("node", "missing"));
+    EXPECT_EQ(node, neu_config_gen(NULL, NULL));
+
+    neu_config_gen_bump(NULL, NULL);
+    EXPECT_LT(node, neu_config_gen(NULL, NULL));
+    EXPECT_EQ(node, neu_config_gen("node", NULL));
+}
+
+TEST(ConfigGenTest, Epoch)
+{
+    uint64_t epoch = neu_config_gen_epoch();
+
+    EXPECT_NE(0, epoch);
+    EXPECT_EQ(epoch, neu_config_gen_epoch());
+}
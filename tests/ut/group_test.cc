@@ -0,0 +1,264 @@
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "errcodes.h"
+#include "utils/log.h"
+
+extern "C" {
+#include "base/group.h"
+}
+
+zlog_category_t *neuron = NULL;
+
+static std::string name_of(int i)
+{
+    char name[16] = { 0 };
+    snprintf(name, sizeof(name), "tag%05d", i);
+    return name;
+}
+
+static void add_tag(neu_group_t *group, int i, const char *description)
+{
+    std::string   name    = name_of(i);
+    std::string   address = "1!4" + std::to_string(i);
+    neu_datatag_t tag     = {};
+
+    tag.name        = (char *) name.c_str();
+    tag.address     = (char *) address.c_str();
+    tag.description = (char *) description;
+    tag.attribute   = NEU_ATTRIBUTE_READ;
+    tag.type        = NEU_TYPE_INT16;
+    EXPECT_EQ(0, neu_group_add_tag(group, &tag));
+}
+
+// tags are added out of the order of names
+static neu_group_t *new_group(int n_tag)
+{
+    neu_group_t *group = neu_group_new("group", 1000);
+
+    for (int i = 0; i < n_tag; i++) {
+        int k = (int) ((i * 7919L) % n_tag);
+        add_tag(group, k, k % 2 ? "odd" : "even");
+    }
+
+    return group;
+}
+
+// every tenth tag stands for a tag with an error value
+static bool is_error(const neu_datatag_t *tag, void *data)
+{
+    (void) data;
+    return atoi(tag->name + strlen("tag")) % 10 == 0;
+}
+
+static std::string tag_name(UT_array *tags, unsigned int i)
+{
+    return ((neu_datatag_t *) utarray_eltptr(tags, i))->name;
+}
+
+TEST(GroupTest, Paginate)
+{
+    neu_group_t *group = new_group(100);
+    int          total = 0;
+    UT_array *   tags  = NULL;
+
+    tags = neu_group_query_read_tag_paginate(group, NULL, NULL, NULL, NULL, 2,
+                                             30, &total);
+    EXPECT_EQ(100, total);
+    ASSERT_EQ(30, utarray_len(tags));
+    EXPECT_EQ("tag00030", tag_name(tags, 0));
+    EXPECT_EQ("tag00059", tag_name(tags, 29));
+    utarray_free(tags);
+
+    tags = neu_group_query_read_tag_paginate(group, NULL, NULL, NULL, NULL, 4,
+                                             30, &total);
+    EXPECT_EQ(100, total);
+    EXPECT_EQ(10, utarray_len(tags));
+    utarray_free(tags);
+
+    tags = neu_group_query_read_tag_paginate(group, NULL, NULL, NULL, NULL, 5,
+                                             30, &total);
+    EXPECT_EQ(100, total);
+    EXPECT_EQ(0, utarray_len(tags));
+    utarray_free(tags);
+
+    // no page window
+    tags = neu_group_query_read_tag_paginate(group, NULL, NULL, NULL, NULL, 0,
+                                             0, &total);
+    EXPECT_EQ(100, total);
+    EXPECT_EQ(100, utarray_len(tags));
+    utarray_free(tags);
+
+    neu_group_destroy(group);
+}
+
+TEST(GroupTest, PaginateFilter)
+{
+    neu_group_t *group = new_group(100);
+    int          total = 0;
+    UT_array *   tags  = NULL;
+
+    tags = neu_group_query_read_tag_paginate(group, NULL, NULL, is_error, NULL,
+                                             2, 3, &total);
+    EXPECT_EQ(10, total);
+    ASSERT_EQ(3, utarray_len(tags));
+    EXPECT_EQ("tag00030", tag_name(tags, 0));
+    EXPECT_EQ("tag00050", tag_name(tags, 2));
+    utarray_free(tags);
+
+    // along with the name and description filters
+    tags = neu_group_query_read_tag_paginate(group, "g0005", "even",
+                                             is_error, NULL, 1, 10, &total);
+    EXPECT_EQ(1, total);
+    ASSERT_EQ(1, utarray_len(tags));
+    EXPECT_EQ("tag00050", tag_name(tags, 0));
+    utarray_free(tags);
+
+    tags = neu_group_query_read_tag_paginate(group, NULL, "odd", is_error, NULL,
+                                             0, 0, &total);
+    EXPECT_EQ(0, total);
+    EXPECT_EQ(0, utarray_len(tags));
+    utarray_free(tags);
+
+    neu_group_destroy(group);
+}
+
+TEST(GroupTest, PaginateLarge)
+{
+    const int    n_tag     = 20000;
+    const int    page_size = 100;
+    neu_group_t *group     = new_group(n_tag);
+    int          total     = 0;
+    UT_array *   tags      = NULL;
+
+    tags = neu_group_query_read_tag_paginate(group, NULL, NULL, is_error, NULL,
+                                             1, page_size, &total);
+    EXPECT_EQ(n_tag / 10, total);
+    ASSERT_EQ(page_size, utarray_len(tags));
+    EXPECT_EQ("tag00000", tag_name(tags, 0));
+    EXPECT_EQ("tag00990", tag_name(tags, page_size - 1));
+    utarray_free(tags);
+
+    tags = neu_group_query_read_tag_paginate(group, NULL, NULL, is_error, NULL,
+                                             total / page_size, page_size,
+                                             &total);
+    EXPECT_EQ(n_tag / 10, total);
+    ASSERT_EQ(page_size, utarray_len(tags));
+    EXPECT_EQ("tag19000", tag_name(tags, 0));
+    EXPECT_EQ("tag19990", tag_name(tags, page_size - 1));
+    utarray_free(tags);
+
+    neu_group_destroy(group);
+}
+
+static std::vector<std::string> names(UT_array *tags)
+{
+    std::vector<std::string> v;
+    utarray_foreach(tags, neu_datatag_t *, tag) { v.push_back(tag->name); }
+    utarray_free(tags);
+    return v;
+}
+
+TEST(GroupTest, Index)
+{
+    neu_group_t *            group = neu_group_new("group", 1000);
+    std::vector<std::string> expect;
+
+    add_tag(group, 3, "pump speed");
+    add_tag(group, 1, "pump pressure");
+    add_tag(group, 2, "valve");
+    neu_datatag_t *tag = neu_group_find_tag(group, "tag00002");
+    ASSERT_NE(nullptr, tag);
+    EXPECT_EQ(NEU_ERR_TAG_NAME_CONFLICT, neu_group_add_tag(group, tag));
+
+    expect = { "tag00001", "tag00003" };
+    EXPECT_EQ(expect, names(neu_group_query_tag(group, "pump")));
+    expect = { "tag00002" };
+    EXPECT_EQ(expect, names(neu_group_query_tag(group, "g00002")));
+    EXPECT_EQ(expect, names(neu_group_query_tag(group, "al")));
+    EXPECT_TRUE(names(neu_group_query_tag(group, "pumps")).empty());
+
+    // the description is searchable after an update
+    free(tag->description);
+    tag->description = strdup("pump valve");
+    EXPECT_EQ(0, neu_group_update_tag(group, tag));
+    neu_tag_free(tag);
+    expect = { "tag00001", "tag00002", "tag00003" };
+    EXPECT_EQ(expect, names(neu_group_query_tag(group, "pump")));
+    expect = { "tag00002" };
+    EXPECT_EQ(expect,
+              names(neu_group_query_read_tag(group, NULL, "valve", 0, NULL)));
+    EXPECT_TRUE(names(neu_group_query_tag(group, "valve valve")).empty());
+
+    EXPECT_EQ(0, neu_group_del_tag(group, "tag00001"));
+    EXPECT_EQ(NEU_ERR_TAG_NOT_EXIST, neu_group_del_tag(group, "tag00001"));
+    expect = { "tag00002", "tag00003" };
+    EXPECT_EQ(expect, names(neu_group_query_tag(group, "pump")));
+    EXPECT_TRUE(names(neu_group_query_tag(group, "pressure")).empty());
+
+    neu_group_destroy(group);
+}
+
+TEST(GroupTest, IndexSameAsLinear)
+{
+    const char *             words[] = { "ab", "ba", "abc", "cab", "" };
+    neu_group_t *            group   = neu_group_new("group", 1000);
+    std::vector<std::string> descs(500);
+
+    srand(1);
+    for (int i = 0; i < 500; i++) {
+        descs[i] = std::string(words[rand() % 5]) + words[rand() % 5];
+        add_tag(group, i, descs[i].c_str());
+    }
+    for (int i = 0; i < 500; i += 3) {
+        EXPECT_EQ(0, neu_group_del_tag(group, name_of(i).c_str()));
+        descs[i].clear();
+    }
+
+    for (int i = 0; i < 100; i++) {
+        std::string              str = std::string(words[rand() % 4]) +
+            (i % 2 ? words[rand() % 5] : "") + (i % 5 ? "" : "0");
+        std::vector<std::string> expect;
+
+        for (int t = 0; t < 500; t++) {
+            if (t % 3 != 0 &&
+                (name_of(t).find(str) != std::string::npos ||
+                 descs[t].find(str) != std::string::npos)) {
+                expect.push_back(name_of(t));
+            }
+        }
+        EXPECT_EQ(expect, names(neu_group_query_tag(group, str.c_str())))
+            << str;
+    }
+
+    neu_group_destroy(group);
+}
+
+TEST(GroupTest, SearchLarge)
+{
+    const int    n_tag = 50000;
+    neu_group_t *group = new_group(n_tag);
+    int          total = 0;
+    UT_array *   tags  = NULL;
+
+    tags = neu_group_query_read_tag_paginate(group, "g0123", NULL, NULL, NULL,
+                                             1, 100, &total);
+    EXPECT_EQ(10, total);
+    ASSERT_EQ(10, utarray_len(tags));
+    EXPECT_EQ("tag01230", tag_name(tags, 0));
+    EXPECT_EQ("tag01239", tag_name(tags, 9));
+    utarray_free(tags);
+
+    tags = neu_group_query_read_tag_paginate(group, NULL, NULL, NULL, NULL,
+                                             400, 100, &total);
+    EXPECT_EQ(n_tag, total);
+    ASSERT_EQ(100, utarray_len(tags));
+    EXPECT_EQ("tag39900", tag_name(tags, 0));
+    EXPECT_EQ("tag39999", tag_name(tags, 99));
+    utarray_free(tags);
+
+    neu_group_destroy(group);
+}
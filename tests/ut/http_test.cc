@@ -1,7 +1,17 @@
+#include <algorithm>
+#include <arpa/inet.h>
+#include <mutex>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+#include <zlib.h>
+
 #include <gtest/gtest.h>
 
 #include "adapter.h"
 #include "utils/http.h"
+#include "utils/http_handler.h"
 #include <nng/nng.h>
 #include <nng/supplemental/http/http.h>
 
@@ -123,6 +133,493 @@ TEST(HTTPTest, http_get_param_str)
     nng_url_free(url);
 }
 
+#define SERVER_PORT 17071
+#define SERVER_URL "http://127.0.0.1:17071"
+
+static std::string body_of(size_t size)
+{
+    std::string body(size, ' ');
+    for (size_t i = 0; i < size; i++) {
+        body[i] = 'a' + i % 26;
+    }
+    return body;
+}
+
+// GET /body?size= writes the body in small pieces
+static void body_handler(nng_aio *aio)
+{
+    uintmax_t           size    = 0;
+    neu_http_chunked_t *chunked = neu_http_chunked_new(aio, "text/plain");
+    std::string         body;
+
+    neu_http_get_param_uintmax(aio, "size", &size);
+    body = body_of(size);
+    for (size_t i = 0; i < body.size(); i += 1000) {
+        neu_http_chunked_write(chunked, body.data() + i,
+                               std::min((size_t) 1000, body.size() - i));
+    }
+    neu_http_chunked_end(chunked);
+}
+
+// GET /etag?size= is /body tagged "v1"
+static void etag_handler(nng_aio *aio)
+{
+    if (!neu_http_check_etag(aio, "\"v1\"")) {
+        body_handler(aio);
+    }
+}
+
+// a server on SERVER_URL, with the handlers of the test group
+class HTTPServerTest : public testing::Test {
+protected:
+    void SetUp() override
+    {
+        nng_url *url = NULL;
+
+        nng_url_parse(&url, SERVER_URL);
+        ASSERT_EQ(0, nng_http_server_hold(&server, url));
+        nng_url_free(url);
+
+        add_handlers();
+        ASSERT_EQ(0, nng_http_server_start(server));
+    }
+
+    void TearDown() override
+    {
+        nng_http_server_stop(server);
+        nng_http_server_release(server);
+    }
+
+    virtual void add_handlers() = 0;
+
+    void add_handler(const char *uri, void (*cb)(nng_aio *))
+    {
+        nng_http_handler *handler = NULL;
+
+        nng_http_handler_alloc(&handler, uri, cb);
+        nng_http_server_add_handler(server, handler);
+    }
+
+    nng_http_server *server = NULL;
+};
+
+class HTTPChunkedTest : public HTTPServerTest {
+protected:
+    void add_handlers() override { add_handler("/body", body_handler); }
+};
+
+// sends the request, the response is left to be read from the socket
+static int send_get(const std::string &uri, const char *version,
+                    const std::string &headers = "", int rcvbuf = 0)
+{
+    int         fd   = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr = {};
+    std::string req  = "GET " + uri + " " + version +
+        "\r\nHost: 127.0.0.1\r\nConnection: close\r\n" + headers + "\r\n";
+
+    if (rcvbuf > 0) {
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    }
+    addr.sin_family      = AF_INET;
+    addr.sin_port        = htons(SERVER_PORT);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    EXPECT_EQ(0, connect(fd, (sockaddr *) &addr, sizeof(addr)));
+    EXPECT_EQ((ssize_t) req.size(), send(fd, req.data(), req.size(), 0));
+
+    return fd;
+}
+
+// the response head in `head`, the body returned
+static std::string get(const std::string &uri, const char *version,
+                       std::string *head, const std::string &headers = "")
+{
+    int         fd = send_get(uri, version, headers);
+    std::string resp;
+    char        buf[4096];
+    ssize_t     n = 0;
+
+    while ((n = recv(fd, buf, sizeof(buf), 0)) > 0) {
+        resp.append(buf, n);
+    }
+    close(fd);
+
+    size_t end = resp.find("\r\n\r\n");
+    if (std::string::npos == end) {
+        *head = resp;
+        return "";
+    }
+    *head = resp.substr(0, end + 2);
+    return resp.substr(end + 4);
+}
+
+static std::string dechunk(const std::string &body)
+{
+    std::string out;
+    size_t      pos = 0;
+
+    while (pos < body.size()) {
+        size_t eol = body.find("\r\n", pos);
+        size_t len = strtoul(body.c_str() + pos, NULL, 16);
+
+        if (std::string::npos == eol || eol + 2 + len + 2 > body.size()) {
+            break;
+        }
+        if (0 == len) {
+            return out;
+        }
+        out.append(body, eol + 2, len);
+        pos = eol + 2 + len + 2;
+    }
+
+    return "truncated";
+}
+
+TEST_F(HTTPChunkedTest, Small)
+{
+    std::string head;
+    std::string body = get("/body?size=1000", "HTTP/1.1", &head);
+
+    EXPECT_NE(std::string::npos, head.find("200"));
+    EXPECT_NE(std::string::npos, head.find("Content-Length: 1000\r\n"));
+    EXPECT_EQ(std::string::npos, head.find("Transfer-Encoding"));
+    EXPECT_EQ(body_of(1000), body);
+
+    body = get("/body?size=0", "HTTP/1.1", &head);
+    EXPECT_NE(std::string::npos, head.find("200"));
+    EXPECT_EQ("", body);
+}
+
+TEST_F(HTTPChunkedTest, Large)
+{
+    std::string head;
+    std::string body = get("/body?size=1000000", "HTTP/1.1", &head);
+
+    EXPECT_NE(std::string::npos, head.find("200 OK"));
+    EXPECT_NE(std::string::npos,
+              head.find("Transfer-Encoding: chunked\r\n"));
+    EXPECT_NE(std::string::npos, head.find("Content-Type: text/plain\r\n"));
+    EXPECT_EQ(body_of(1000000), dechunk(body));
+}
+
+TEST_F(HTTPChunkedTest, Http10)
+{
+    std::string head;
+    std::string body = get("/body?size=1000000", "HTTP/1.0", &head);
+
+    // read until the connection is closed
+    EXPECT_NE(std::string::npos, head.find("200 OK"));
+    EXPECT_EQ(std::string::npos, head.find("Transfer-Encoding"));
+    EXPECT_EQ(body_of(1000000), body);
+}
+
+#define CHUNKED_QUEUE_MAX (NEU_HTTP_CHUNKED_QUEUE * (64 * 1024 + 16))
+
+// a client that does not read holds back the writes, not the whole body
+TEST_F(HTTPChunkedTest, SlowClient)
+{
+    const size_t size = 16 * 1024 * 1024;
+    std::string  resp;
+    char         buf[4096];
+    ssize_t      n    = 0;
+    std::string  uri  = "/body?size=" + std::to_string(size);
+    int          fd   = send_get(uri, "HTTP/1.1", "", 4096);
+
+    usleep(500 * 1000);
+    EXPECT_GT(neu_http_chunked_peak(), (size_t) 0);
+    EXPECT_LE(neu_http_chunked_peak(), CHUNKED_QUEUE_MAX);
+
+    while ((n = recv(fd, buf, sizeof(buf), 0)) > 0) {
+        resp.append(buf, n);
+    }
+    close(fd);
+    EXPECT_LE(neu_http_chunked_peak(), CHUNKED_QUEUE_MAX);
+
+    size_t end = resp.find("\r\n\r\n");
+    ASSERT_NE(std::string::npos, end);
+    EXPECT_EQ(body_of(size), dechunk(resp.substr(end + 4)));
+}
+
+static std::string gunzip(const std::string &data)
+{
+    z_stream    z = {};
+    std::string out;
+    char        buf[4096];
+    int         rv = Z_OK;
+
+    inflateInit2(&z, 15 + 16);
+    z.next_in  = (Bytef *) data.data();
+    z.avail_in = data.size();
+    while (Z_OK == rv) {
+        z.next_out  = (Bytef *) buf;
+        z.avail_out = sizeof(buf);
+        rv          = inflate(&z, Z_NO_FLUSH);
+        out.append(buf, sizeof(buf) - z.avail_out);
+    }
+    inflateEnd(&z);
+
+    return Z_STREAM_END == rv ? out : "corrupt";
+}
+
+class HTTPGzipTest : public HTTPServerTest {
+protected:
+    void add_handlers() override { add_handler("/body", body_handler); }
+};
+
+TEST_F(HTTPGzipTest, Gzip)
+{
+    std::string head;
+    std::string body;
+
+    // below the size threshold
+    body = get("/body?size=1000", "HTTP/1.1", &head,
+               "Accept-Encoding: gzip\r\n");
+    EXPECT_EQ(std::string::npos, head.find("Content-Encoding"));
+    EXPECT_EQ(body_of(1000), body);
+
+    body = get("/body?size=50000", "HTTP/1.1", &head,
+               "Accept-Encoding: deflate, gzip\r\n");
+    EXPECT_NE(std::string::npos, head.find("Content-Encoding: gzip\r\n"));
+    EXPECT_NE(std::string::npos, head.find("Vary: Accept-Encoding\r\n"));
+    EXPECT_LT(body.size(), 50000);
+    EXPECT_EQ(body_of(50000), gunzip(body));
+
+    body = get("/body?size=1000000", "HTTP/1.1", &head,
+               "Accept-Encoding: gzip\r\n");
+    EXPECT_NE(std::string::npos,
+              head.find("Transfer-Encoding: chunked\r\n"));
+    EXPECT_NE(std::string::npos, head.find("Content-Encoding: gzip\r\n"));
+    EXPECT_EQ(body_of(1000000), gunzip(dechunk(body)));
+
+    body = get("/body?size=1000000", "HTTP/1.0", &head,
+               "Accept-Encoding: gzip\r\n");
+    EXPECT_EQ(body_of(1000000), gunzip(body));
+
+    // refused, or not asked for
+    body = get("/body?size=1000000", "HTTP/1.1", &head,
+               "Accept-Encoding: gzip;q=0\r\n");
+    EXPECT_EQ(std::string::npos, head.find("Content-Encoding"));
+    EXPECT_EQ(body_of(1000000), dechunk(body));
+
+    neu_http_set_gzip(0, NEU_HTTP_GZIP_MIN_SIZE);
+    body = get("/body?size=50000", "HTTP/1.1", &head,
+               "Accept-Encoding: gzip\r\n");
+    EXPECT_EQ(std::string::npos, head.find("Content-Encoding"));
+    EXPECT_EQ(body_of(50000), body);
+    neu_http_set_gzip(NEU_HTTP_GZIP_LEVEL, NEU_HTTP_GZIP_MIN_SIZE);
+}
+
+class HTTPETagTest : public HTTPServerTest {
+protected:
+    void add_handlers() override
+    {
+        add_handler("/body", body_handler);
+        add_handler("/etag", etag_handler);
+    }
+};
+
+TEST_F(HTTPETagTest, ETag)
+{
+    std::string head;
+    std::string body;
+
+    body = get("/etag?size=1000", "HTTP/1.1", &head);
+    EXPECT_NE(std::string::npos, head.find("200 OK"));
+    EXPECT_NE(std::string::npos, head.find("ETag: \"v1\"\r\n"));
+    EXPECT_EQ(body_of(1000), body);
+
+    body = get("/etag?size=1000000", "HTTP/1.1", &head);
+    EXPECT_NE(std::string::npos,
+              head.find("Transfer-Encoding: chunked\r\n"));
+    EXPECT_NE(std::string::npos, head.find("ETag: \"v1\"\r\n"));
+    EXPECT_EQ(body_of(1000000), dechunk(body));
+
+    // weak comparison, against every tag of the list
+    const char *matches[] = {
+        "If-None-Match: \"v1\"\r\n",
+        "If-None-Match: W/\"v1\"\r\n",
+        "If-None-Match: \"v0\", W/\"v1\"\r\n",
+        "If-None-Match: \"v0\",\"v1\"\r\n",
+        "If-None-Match: *\r\n",
+    };
+    for (const char *match : matches) {
+        body = get("/etag?size=1000000", "HTTP/1.1", &head, match);
+        EXPECT_NE(std::string::npos, head.find("304 Not Modified")) << match;
+        EXPECT_NE(std::string::npos, head.find("ETag: \"v1\"\r\n")) << match;
+        EXPECT_EQ("", body) << match;
+    }
+
+    const char *misses[] = {
+        "If-None-Match: \"v2\"\r\n",
+        "If-None-Match: \"v10\", \"v\"\r\n",
+        "If-None-Match: v1\r\n",
+    };
+    for (const char *miss : misses) {
+        body = get("/etag?size=1000", "HTTP/1.1", &head, miss);
+        EXPECT_NE(std::string::npos, head.find("200 OK")) << miss;
+        EXPECT_NE(std::string::npos, head.find("ETag: \"v1\"\r\n")) << miss;
+        EXPECT_EQ(body_of(1000), body) << miss;
+    }
+
+    // untagged responses carry none
+    body = get("/body?size=1000", "HTTP/1.1", &head);
+    EXPECT_EQ(std::string::npos, head.find("ETag"));
+}
+
+static std::mutex             held_mtx;
+static std::vector<nng_aio *> held_aios;
+
+// GET /held answers nothing until release_held()
+static void held_handler(nng_aio *aio)
+{
+    std::lock_guard<std::mutex> lock(held_mtx);
+    held_aios.push_back(aio);
+}
+
+static size_t release_held()
+{
+    std::vector<nng_aio *> aios;
+
+    held_mtx.lock();
+    aios.swap(held_aios);
+    held_mtx.unlock();
+    for (nng_aio *aio : aios) {
+        neu_http_ok(aio, (char *) "{}");
+    }
+    return aios.size();
+}
+
+static std::string class_metrics()
+{
+    char *      buf    = NULL;
+    size_t      len    = 0;
+    FILE *      stream = open_memstream(&buf, &len);
+    std::string out;
+
+    neu_http_class_metrics(stream);
+    fclose(stream);
+    out = std::string(buf, len);
+    free(buf);
+    return out;
+}
+
+static bool wait_metric(const std::string &line)
+{
+    for (int i = 0; i < 200; i++) {
+        if (std::string::npos != class_metrics().find(line + "\n")) {
+            return true;
+        }
+        usleep(10 * 1000);
+    }
+    return false;
+}
+
+// GET /held is a heavy request, admitted by utils/http_handler.c
+class HTTPAdmissionTest : public HTTPServerTest {
+protected:
+    void add_handlers() override
+    {
+        struct neu_http_handler handler = {};
+
+        handler.method        = NEU_HTTP_METHOD_GET;
+        handler.type          = NEU_HTTP_HANDLER_FUNCTION;
+        handler.url           = (char *) "/held";
+        handler.value.handler = (void *) held_handler;
+        handler.cls           = NEU_HTTP_CLASS_HEAVY;
+        ASSERT_EQ(0, neu_http_add_handler(server, &handler));
+    }
+};
+
+TEST_F(HTTPAdmissionTest, Admission)
+{
+    std::vector<int> fds;
+    std::string      head;
+    std::string      body;
+    size_t           n_done = 0;
+
+    // fill the running places, then the queue
+    for (int i = 0; i < NEU_HTTP_HEAVY_LIMIT + NEU_HTTP_HEAVY_QUEUE; i++) {
+        fds.push_back(send_get("/held", "HTTP/1.1"));
+    }
+    ASSERT_TRUE(wait_metric("rest_requests_running{class=\"heavy\"} " +
+                            std::to_string(NEU_HTTP_HEAVY_LIMIT)));
+    ASSERT_TRUE(wait_metric("rest_requests_queued{class=\"heavy\"} " +
+                            std::to_string(NEU_HTTP_HEAVY_QUEUE)));
+
+    body = get("/held", "HTTP/1.1", &head);
+    EXPECT_NE(std::string::npos, head.find("429"));
+    EXPECT_NE(std::string::npos, head.find("Retry-After: "));
+    EXPECT_EQ("{\"error\": 1024}", body);
+
+    // each answer lets a queued request in
+    for (int i = 0; i < 200 && n_done < fds.size(); i++) {
+        n_done += release_held();
+        usleep(10 * 1000);
+    }
+    EXPECT_EQ(fds.size(), n_done);
+
+    for (int fd : fds) {
+        char    buf[4096];
+        ssize_t n = 0;
+
+        head.clear();
+        while ((n = recv(fd, buf, sizeof(buf), 0)) > 0) {
+            head.append(buf, n);
+        }
+        close(fd);
+        EXPECT_NE(std::string::npos, head.find("200 OK"));
+    }
+
+    EXPECT_TRUE(wait_metric("rest_requests_running{class=\"heavy\"} 0"));
+    EXPECT_TRUE(wait_metric("rest_requests_queued{class=\"heavy\"} 0"));
+    EXPECT_TRUE(wait_metric("rest_requests_rejected_total{class=\"heavy\"} 1"));
+    EXPECT_TRUE(wait_metric("rest_request_duration_ms_count{class=\"heavy\"} " +
+                            std::to_string(fds.size())));
+}
+
+TEST_F(HTTPAdmissionTest, Reclaim)
+{
+    std::vector<int> fds;
+    size_t           n_held = 0;
+
+    // the running ones are not answered in time, the queued one gets in
+    neu_http_set_run_timeout(500);
+    for (int i = 0; i < NEU_HTTP_HEAVY_LIMIT; i++) {
+        fds.push_back(send_get("/held", "HTTP/1.1"));
+    }
+    ASSERT_TRUE(wait_metric("rest_requests_running{class=\"heavy\"} " +
+                            std::to_string(NEU_HTTP_HEAVY_LIMIT)));
+    fds.push_back(send_get("/held", "HTTP/1.1"));
+    ASSERT_TRUE(wait_metric("rest_requests_queued{class=\"heavy\"} 1"));
+    neu_http_set_run_timeout(NEU_HTTP_RUN_TIMEOUT_MS);
+
+    for (int i = 0; i < 200 && n_held < fds.size(); i++) {
+        held_mtx.lock();
+        n_held = held_aios.size();
+        held_mtx.unlock();
+        usleep(10 * 1000);
+    }
+    EXPECT_EQ(fds.size(), n_held);
+    EXPECT_TRUE(wait_metric("rest_requests_queued{class=\"heavy\"} 0"));
+    EXPECT_TRUE(
+        wait_metric("rest_requests_reclaimed_total{class=\"heavy\"} " +
+                    std::to_string(NEU_HTTP_HEAVY_LIMIT)));
+
+    // answered late, without giving back the places twice
+    EXPECT_EQ(fds.size(), release_held());
+    for (int fd : fds) {
+        char        buf[4096];
+        ssize_t     n = 0;
+        std::string head;
+
+        while ((n = recv(fd, buf, sizeof(buf), 0)) > 0) {
+            head.append(buf, n);
+        }
+        close(fd);
+        EXPECT_NE(std::string::npos, head.find("200 OK"));
+    }
+    EXPECT_TRUE(wait_metric("rest_requests_running{class=\"heavy\"} 0"));
+}
+
 int main(int argc, char **argv)
 {
     zlog_init("./config/dev.conf");
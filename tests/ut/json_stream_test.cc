@@ -0,0 +1,327 @@
+#include <math.h>
+#include <stdio.h>
+
+#include <gtest/gtest.h>
+
+#include "msg.h"
+#include "utils/log.h"
+#include "json/json.h"
+#include "json/neu_json_fn.h"
+#include "json/neu_json_rw.h"
+#include "json/neu_json_stream.h"
+
+#include "tag_value_helper.h"
+
+zlog_category_t *neuron = NULL;
+
+enum format { VALUES, TAGS, ECP };
+
+static neu_json_read_periodic_t header = { .group     = (char *) "group",
+                                          .node      = (char *) "node",
+                                          .timestamp = 1700000000123 };
+
+// the jansson path of generate_upload_json in plugins/mqtt
+static int encode_jansson(enum format format, UT_array *tags, char **result)
+{
+    neu_json_read_resp_t json = {};
+    int                  ret  = 0;
+
+    json.n_tag = utarray_len(tags);
+    json.tags  = (neu_json_read_resp_tag_t *) calloc(
+        json.n_tag + 1, sizeof(neu_json_read_resp_tag_t));
+    for (int i = 0; i < json.n_tag; i++) {
+        neu_tag_value_to_json(
+            (neu_resp_tag_value_meta_t *) utarray_eltptr(tags, i),
+            &json.tags[i]);
+    }
+
+    switch (format) {
+    case VALUES:
+        ret = neu_json_encode_with_mqtt(&json, neu_json_encode_read_resp1,
+                                        &header,
+                                        neu_json_encode_read_periodic_resp,
+                                        result);
+        break;
+    case TAGS:
+        ret = neu_json_encode_with_mqtt(&json, neu_json_encode_read_resp2,
+                                        &header,
+                                        neu_json_encode_read_periodic_resp,
+                                        result);
+        break;
+    case ECP:
+        ret = neu_json_encode_with_mqtt_ecp(
+            &json, neu_json_encode_read_resp_ecp, &header,
+            neu_json_encode_read_periodic_resp, result);
+        break;
+    }
+
+    for (int i = 0; i < json.n_tag; i++) {
+        if (json.tags[i].n_meta > 0) {
+            free(json.tags[i].metas);
+        }
+    }
+    free(json.tags);
+    return ret;
+}
+
+static int encode_stream(enum format format, UT_array *tags, char **result)
+{
+    switch (format) {
+    case VALUES:
+        return neu_json_stream_encode_values(&header, tags, result);
+    case TAGS:
+        return neu_json_stream_encode_tags(&header, tags, result);
+    case ECP:
+        return neu_json_stream_encode_ecp(&header, tags, result);
+    }
+
+    return -1;
+}
+
+static void expect_same(UT_array *tags)
+{
+    enum format formats[] = { VALUES, TAGS, ECP };
+
+    for (enum format format : formats) {
+        char *expect = NULL;
+        char *actual = NULL;
+
+        EXPECT_EQ(encode_jansson(format, tags, &expect),
+                  encode_stream(format, tags, &actual));
+        ASSERT_NE(nullptr, expect);
+        ASSERT_NE(nullptr, actual);
+        EXPECT_STREQ(expect, actual);
+
+        free(expect);
+        free(actual);
+    }
+}
+
+TEST(JsonStreamTest, Scalar)
+{
+    UT_array *                 tags = NULL;
+    neu_resp_tag_value_meta_t *tag  = NULL;
+
+    utarray_new(tags, neu_resp_tag_value_meta_icd());
+
+    push_tag(tags, "int8", NEU_TYPE_INT8)->value.value.i8        = -128;
+    push_tag(tags, "uint16", NEU_TYPE_UINT16)->value.value.u16    = 65535;
+    push_tag(tags, "int64", NEU_TYPE_INT64)->value.value.i64      = INT64_MIN;
+    push_tag(tags, "uint64", NEU_TYPE_UINT64)->value.value.u64    = UINT64_MAX;
+    push_tag(tags, "bit", NEU_TYPE_BIT)->value.value.u8           = 1;
+    push_tag(tags, "bool", NEU_TYPE_BOOL)->value.value.boolean    = true;
+    push_tag(tags, "float", NEU_TYPE_FLOAT)->value.value.f32      = 1.1f;
+    push_tag(tags, "float_neg", NEU_TYPE_FLOAT)->value.value.f32 = -25.999f;
+    push_tag(tags, "double", NEU_TYPE_DOUBLE)->value.value.d64    = 0.1 + 0.2;
+
+    tag                  = push_tag(tags, "float_p", NEU_TYPE_FLOAT);
+    tag->value.value.f32 = 3.14159f;
+    tag->value.precision = 2;
+
+    tag                  = push_tag(tags, "double_p", NEU_TYPE_DOUBLE);
+    tag->value.value.d64 = 2.0 / 3;
+    tag->value.precision = 3;
+
+    tag                  = push_tag(tags, "float_bias", NEU_TYPE_FLOAT);
+    tag->value.value.f32 = 12.3f;
+    tag->datatag.bias    = 0.5;
+
+    expect_same(tags);
+    utarray_free(tags);
+}
+
+TEST(JsonStreamTest, String)
+{
+    UT_array *tags = NULL;
+
+    utarray_new(tags, neu_resp_tag_value_meta_icd());
+
+    strcpy(push_tag(tags, "plain", NEU_TYPE_STRING)->value.value.str,
+           "hello world");
+    strcpy(push_tag(tags, "escape", NEU_TYPE_STRING)->value.value.str,
+           "a\"b\\c/d\b\f\n\r\t\x01\x1f\x7f");
+    strcpy(push_tag(tags, "utf8", NEU_TYPE_STRING)->value.value.str,
+           "\xe6\xb8\xa9\xe5\xba\xa6 \xf0\x9f\x94\xa5");
+    strcpy(push_tag(tags, "invalid", NEU_TYPE_STRING)->value.value.str,
+           "\xc0\xaf");
+    strcpy(push_tag(tags, "surrogate", NEU_TYPE_STRING)->value.value.str,
+           "\xed\xa0\x80");
+    strcpy(push_tag(tags, "truncated", NEU_TYPE_STRING)->value.value.str,
+           "ab\xe6\xb8");
+    push_tag(tags, "name\"\n\xe2\x82\xac", NEU_TYPE_INT32)->value.value.i32 =
+        1;
+    push_tag(tags, "bad\xff", NEU_TYPE_INT32)->value.value.i32 = 2;
+
+    expect_same(tags);
+    utarray_free(tags);
+}
+
+TEST(JsonStreamTest, Array)
+{
+    UT_array *                 tags = NULL;
+    neu_resp_tag_value_meta_t *tag  = NULL;
+    char                       s0[] = "x";
+    char                       s1[] = "y\tz";
+    char                       s2[] = "\xff";
+
+    utarray_new(tags, neu_resp_tag_value_meta_icd());
+
+    tag                             = push_tag(tags, "bytes", NEU_TYPE_BYTES);
+    tag->value.value.bytes.length   = 3;
+    tag->value.value.bytes.bytes[0] = 0;
+    tag->value.value.bytes.bytes[1] = 127;
+    tag->value.value.bytes.bytes[2] = 255;
+
+    tag = push_tag(tags, "empty", NEU_TYPE_ARRAY_INT16);
+
+    tag = push_tag(tags, "int16s", NEU_TYPE_ARRAY_INT16);
+    tag->value.value.i16s.length  = 2;
+    tag->value.value.i16s.i16s[0] = -32768;
+    tag->value.value.i16s.i16s[1] = 32767;
+
+    tag = push_tag(tags, "uint64s", NEU_TYPE_ARRAY_UINT64);
+    tag->value.value.u64s.length  = 2;
+    tag->value.value.u64s.u64s[0] = 1;
+    tag->value.value.u64s.u64s[1] = UINT64_MAX;
+
+    tag = push_tag(tags, "floats", NEU_TYPE_ARRAY_FLOAT);
+    tag->value.value.f32s.length  = 4;
+    tag->value.value.f32s.f32s[0] = NAN;
+    tag->value.value.f32s.f32s[1] = 1.1f;
+    tag->value.value.f32s.f32s[2] = INFINITY;
+    tag->value.value.f32s.f32s[3] = -0.5f;
+
+    tag = push_tag(tags, "doubles", NEU_TYPE_ARRAY_DOUBLE);
+    tag->value.value.f64s.length  = 2;
+    tag->value.value.f64s.f64s[0] = 1e300;
+    tag->value.value.f64s.f64s[1] = 100;
+
+    tag = push_tag(tags, "bools", NEU_TYPE_ARRAY_BOOL);
+    tag->value.value.bools.length   = 2;
+    tag->value.value.bools.bools[0] = true;
+    tag->value.value.bools.bools[1] = false;
+
+    tag = push_tag(tags, "strs", NEU_TYPE_ARRAY_STRING);
+    tag->value.value.strs.length  = 4;
+    tag->value.value.strs.strs[0] = s2;
+    tag->value.value.strs.strs[1] = s0;
+    tag->value.value.strs.strs[2] = NULL;
+    tag->value.value.strs.strs[3] = s1;
+
+    expect_same(tags);
+    utarray_free(tags);
+}
+
+TEST(JsonStreamTest, ErrorAndMeta)
+{
+    UT_array *                 tags = NULL;
+    neu_resp_tag_value_meta_t *tag  = NULL;
+
+    utarray_new(tags, neu_resp_tag_value_meta_icd());
+
+    push_tag(tags, "error", NEU_TYPE_ERROR)->value.value.i32 = 3008;
+    push_tag(tags, "nan", NEU_TYPE_FLOAT)->value.value.f32   = NAN;
+
+    tag                      = push_tag(tags, "meta", NEU_TYPE_INT16);
+    tag->value.value.i16     = 42;
+    tag->metas[0].value.type = NEU_TYPE_STRING;
+    strcpy(tag->metas[0].name, "unit");
+    strcpy(tag->metas[0].value.value.str, "\xe2\x84\x83");
+    tag->metas[1].value.type      = NEU_TYPE_FLOAT;
+    tag->metas[1].value.value.f32 = 0.3f;
+    strcpy(tag->metas[1].name, "scale");
+
+    tag                      = push_tag(tags, "error_meta", NEU_TYPE_ERROR);
+    tag->value.value.i32     = 2014;
+    tag->metas[0].value.type = NEU_TYPE_BOOL;
+    tag->metas[0].value.value.boolean = false;
+    strcpy(tag->metas[0].name, "quality");
+
+    push_tag(tags, "last", NEU_TYPE_UINT32)->value.value.u32 = 7;
+
+    expect_same(tags);
+    utarray_free(tags);
+}
+
+TEST(JsonStreamTest, Delta)
+{
+    UT_array *tags   = NULL;
+    char *    result = NULL;
+
+    utarray_new(tags, neu_resp_tag_value_meta_icd());
+    push_tag(tags, "int8", NEU_TYPE_INT8)->value.value.i8 = 1;
+
+    header.seq      = 42;
+    header.keyframe = true;
+    expect_same(tags);
+
+    EXPECT_EQ(0, encode_stream(VALUES, tags, &result));
+    EXPECT_NE(nullptr, strstr(result, "\"seq\": 42, \"keyframe\": true"));
+    free(result);
+
+    header.seq      = 0;
+    header.keyframe = false;
+    utarray_free(tags);
+}
+
+TEST(JsonStreamTest, EcpNoValidTag)
+{
+    UT_array *tags   = NULL;
+    char *    result = NULL;
+
+    utarray_new(tags, neu_resp_tag_value_meta_icd());
+    push_tag(tags, "error", NEU_TYPE_ERROR)->value.value.i32 = 3008;
+
+    EXPECT_EQ(-2, encode_jansson(ECP, tags, &result));
+    EXPECT_EQ(-2, encode_stream(ECP, tags, &result));
+
+    utarray_free(tags);
+}
+
+TEST(JsonStreamTest, Fallback)
+{
+    UT_array *                 tags   = NULL;
+    neu_resp_tag_value_meta_t *tag    = NULL;
+    char *                     result = NULL;
+
+    utarray_new(tags, neu_resp_tag_value_meta_icd());
+    tag                   = push_tag(tags, "custom", NEU_TYPE_CUSTOM);
+    tag->value.value.json = json_object();
+
+    EXPECT_EQ(-1, encode_stream(VALUES, tags, &result));
+    EXPECT_EQ(-1, encode_stream(TAGS, tags, &result));
+
+    json_decref(tag->value.value.json);
+    utarray_clear(tags);
+
+    // a meta that repeats a member of the tag object
+    tag                      = push_tag(tags, "meta", NEU_TYPE_INT8);
+    tag->metas[0].value.type = NEU_TYPE_INT8;
+    strcpy(tag->metas[0].name, "value");
+
+    EXPECT_EQ(-1, encode_stream(TAGS, tags, &result));
+    EXPECT_EQ(-1, encode_stream(ECP, tags, &result));
+
+    utarray_free(tags);
+}
+
+TEST(JsonStreamTest, Large)
+{
+    const int n_tag = 5000;
+    UT_array *tags  = NULL;
+
+    utarray_new(tags, neu_resp_tag_value_meta_icd());
+    for (int i = 0; i < n_tag; i++) {
+        char name[32] = { 0 };
+
+        snprintf(name, sizeof(name), "tag-%d", i);
+        if (i % 2 == 0) {
+            push_tag(tags, name, NEU_TYPE_FLOAT)->value.value.f32 = i * 0.37f;
+        } else {
+            push_tag(tags, name, NEU_TYPE_INT32)->value.value.i32 = i * 13;
+        }
+    }
+
+    expect_same(tags);
+    utarray_free(tags);
+}
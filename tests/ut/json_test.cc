@@ -2,9 +2,12 @@
 
 #include "json/json.h"
 
+#include "msg.h"
 #include "utils/log.h"
 
 #include "parser/neu_json_system.h"
+#include "json/neu_json_fn.h"
+#include "json/neu_json_rw.h"
 
 zlog_category_t *neuron = NULL;
 TEST(JsonTest, DecodeField)
@@ -342,6 +345,85 @@ TEST(JsonTest, System_ctl)
     free(req);
 }
 
+TEST(JsonTest, ReadGroups)
+{
+    char *buf = (char *) "{\"timeout\": 500, \"groups\": ["
+                         "{\"node\": \"n1\", \"group\": \"g1\"}, "
+                         "{\"node\": \"n2\", \"group\": \"g2\", "
+                         "\"sync\": true, \"query\": {\"name\": \"t\"}, "
+                         "\"tags\": [\"t1\", \"t2\"]}]}";
+    neu_json_read_groups_req_t *req = NULL;
+
+    EXPECT_EQ(0, neu_json_decode_read_groups_req(buf, &req));
+    EXPECT_EQ(500, req->timeout);
+    ASSERT_EQ(2, req->n_group);
+    EXPECT_STREQ("n1", req->groups[0].node);
+    EXPECT_STREQ("g1", req->groups[0].group);
+    EXPECT_FALSE(req->groups[0].sync);
+    EXPECT_EQ(0, req->groups[0].n_tags);
+    EXPECT_STREQ("n2", req->groups[1].node);
+    EXPECT_TRUE(req->groups[1].sync);
+    EXPECT_STREQ("t", req->groups[1].name);
+    ASSERT_EQ(2, req->groups[1].n_tags);
+    EXPECT_STREQ("t2", req->groups[1].tags[1]);
+    neu_json_decode_read_groups_req_free(req);
+
+    req = NULL;
+    EXPECT_NE(0,
+              neu_json_decode_read_groups_req((char *) "{\"groups\": []}",
+                                              &req));
+    EXPECT_NE(0,
+              neu_json_decode_read_groups_req(
+                  (char *) "{\"groups\": [{\"node\": \"n1\"}]}", &req));
+    EXPECT_EQ(nullptr, req);
+}
+
+TEST(JsonTest, ReadGroupsRespGroup)
+{
+    neu_json_read_groups_resp_group_t group = {
+        .node  = (char *) "n1",
+        .group = (char *) "g1",
+        .error = 1023,
+    };
+    char *result = NULL;
+
+    EXPECT_EQ(0,
+              neu_json_encode_by_fn(
+                  &group, neu_json_encode_read_groups_resp_group, &result));
+    EXPECT_STREQ("{\"node\": \"n1\", \"group\": \"g1\", \"error\": 1023}",
+                 result);
+    free(result);
+
+    group.error = 0;
+    EXPECT_EQ(0,
+              neu_json_encode_by_fn(
+                  &group, neu_json_encode_read_groups_resp_group, &result));
+    EXPECT_STREQ("{\"node\": \"n1\", \"group\": \"g1\", \"tags\": []}",
+                 result);
+    free(result);
+}
+
+TEST(JsonTest, WriteTagsResp)
+{
+    neu_resp_write_tags_t      resp = { .error = NEU_ERR_PLUGIN_WRITE_FAILURE };
+    neu_resp_write_tag_error_t tag  = { .error = NEU_ERR_PLUGIN_WRITE_FAILURE };
+    char *                     result = NULL;
+
+    utarray_new(resp.tags, neu_resp_write_tag_error_icd());
+    strcpy(tag.tag, "tag2");
+    utarray_push_back(resp.tags, &tag);
+
+    EXPECT_EQ(0,
+              neu_json_encode_by_fn(&resp, neu_json_encode_write_tags_resp,
+                                    &result));
+    EXPECT_EQ("{\"error\": " + std::to_string(NEU_ERR_PLUGIN_WRITE_FAILURE) +
+                  ", \"errors\": {\"tag2\": " +
+                  std::to_string(NEU_ERR_PLUGIN_WRITE_FAILURE) + "}}",
+              std::string(result));
+    free(result);
+    neu_resp_write_tags_fini(&resp);
+}
+
 int main(int argc, char **argv)
 {
     zlog_init("./config/dev.conf");
@@ -1,4 +1,6 @@
+#include <sys/stat.h>
 #include <sys/time.h>
+#include <unistd.h>
 
 #include <gtest/gtest.h>
 
@@ -34,6 +36,62 @@ TEST(JwtTest, JwtValidate)
 
     jwt_free_str(token);
 }
+
+TEST(JwtTest, JwtValidateCache)
+{
+    char * token         = NULL;
+    char   b_token[1024] = { 0 };
+    size_t len           = 0;
+
+    EXPECT_EQ(0, neu_jwt_init((char *) "./config"));
+    EXPECT_EQ(0, neu_jwt_new(&token, "admin"));
+
+    snprintf(b_token, sizeof(b_token), "Bearer %s", token);
+    EXPECT_EQ(0, neu_jwt_validate(b_token));
+    EXPECT_EQ(0, neu_jwt_validate(b_token));
+
+    // a token that differs from the cached one is verified
+    len              = strlen(b_token);
+    b_token[len - 2] = b_token[len - 2] == 'A' ? 'B' : 'A';
+    EXPECT_NE(0, neu_jwt_validate(b_token));
+
+    neu_jwt_cache_clear();
+    snprintf(b_token, sizeof(b_token), "Bearer %s", token);
+    EXPECT_EQ(0, neu_jwt_validate(b_token));
+
+    jwt_free_str(token);
+}
+
+TEST(JwtTest, JwtValidateKeyChange)
+{
+    char *token         = NULL;
+    char  b_token[1024] = { 0 };
+    bool  made          = 0 == mkdir("certs", 0755);
+    FILE *f             = NULL;
+
+    EXPECT_EQ(0, neu_jwt_init((char *) "./config"));
+    EXPECT_EQ(0, neu_jwt_new(&token, "admin"));
+    snprintf(b_token, sizeof(b_token), "Bearer %s", token);
+    EXPECT_EQ(0, neu_jwt_validate(b_token));
+
+    // the cached token is verified again, against the new key of the issuer
+    f = fopen("certs/neuron.pub", "w");
+    ASSERT_NE(nullptr, f);
+    fputs("not a key\n", f);
+    fclose(f);
+    usleep(1100 * 1000);
+    EXPECT_NE(0, neu_jwt_validate(b_token));
+
+    unlink("certs/neuron.pub");
+    usleep(1100 * 1000);
+    EXPECT_EQ(0, neu_jwt_validate(b_token));
+
+    if (made) {
+        rmdir("certs");
+    }
+    jwt_free_str(token);
+}
+
 int main(int argc, char **argv)
 {
     zlog_init("./config/dev.conf");
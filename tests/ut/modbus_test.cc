@@ -154,6 +154,144 @@ TEST(test_modbus_data_unwrap, should_return_right_data_value)
     EXPECT_EQ(0x44, *(bytes + 3));
 }
 
+TEST(test_modbus_rtu_frame_check, should_return_frame_size)
+{
+    uint8_t read[] = { 0x01, 0x03, 0x04, 0x00, 0x01, 0x00, 0x02, 0x2a, 0x32 };
+    uint8_t exception[] = { 0x01, 0x83, 0x02, 0xc0, 0xf1 };
+    uint8_t write[]     = { 0x01, 0x06, 0x00, 0x01, 0x00, 0x03, 0x98, 0x0b };
+
+    EXPECT_EQ(9, modbus_rtu_frame_check(read, sizeof(read)));
+    EXPECT_EQ(5, modbus_rtu_frame_check(exception, sizeof(exception)));
+    EXPECT_EQ(8, modbus_rtu_frame_check(write, sizeof(write)));
+}
+
+TEST(test_modbus_rtu_frame_check, should_wait_for_more_bytes)
+{
+    uint8_t read[] = { 0x01, 0x03, 0x04, 0x00, 0x01, 0x00, 0x02, 0x2a, 0x32 };
+
+    EXPECT_EQ(0, modbus_rtu_frame_check(read, 2));
+    EXPECT_EQ(0, modbus_rtu_frame_check(read, sizeof(read) - 1));
+}
+
+TEST(test_modbus_rtu_frame_check, should_reject_invalid_frame)
+{
+    uint8_t bad_crc[]      = { 0x01, 0x03, 0x04, 0x00, 0x01,
+                          0x00, 0x02, 0x2a, 0x33 };
+    uint8_t bad_function[] = { 0x01, 0x2b, 0x00, 0x00, 0x00 };
+
+    EXPECT_EQ(-1, modbus_rtu_frame_check(bad_crc, sizeof(bad_crc)));
+    EXPECT_EQ(-1, modbus_rtu_frame_check(bad_function, sizeof(bad_function)));
+}
+
+static void write_cmd_sort_free(modbus_write_cmd_sort_t *cs)
+{
+    for (uint16_t i = 0; i < cs->n_cmd; i++) {
+        utarray_free(cs->cmd[i].tags);
+        free(cs->cmd[i].bytes);
+    }
+    free(cs->cmd);
+    free(cs);
+}
+
+TEST(test_modbus_write_tags_sort, should_merge_contiguous_registers)
+{
+    modbus_point_write_t points[3] = { 0 };
+    UT_array *           tags      = NULL;
+
+    utarray_new(tags, &ut_ptr_icd);
+    for (int i = 0; i < 3; i++) {
+        modbus_point_write_t *p = &points[i];
+
+        p->point.slave_id      = 1;
+        p->point.area          = MODBUS_AREA_HOLD_REGISTER;
+        p->point.type          = NEU_TYPE_UINT16;
+        p->point.n_register    = 1;
+        p->point.start_address = 2 - i;
+        p->value.u16           = 0x0100 + i;
+        utarray_push_back(tags, &p);
+    }
+    points[0].point.type       = NEU_TYPE_UINT32;
+    points[0].point.n_register = 2;
+    points[0].value.u32        = 0x11223344;
+
+    modbus_write_cmd_sort_t *cs = modbus_write_tags_sort(tags, MODBUS_ABCD);
+
+    EXPECT_EQ(1, cs->n_cmd);
+    EXPECT_EQ(0, cs->cmd[0].start_address);
+    EXPECT_EQ(4, cs->cmd[0].n_register);
+    EXPECT_EQ(8, cs->cmd[0].n_byte);
+    EXPECT_EQ(0x01, cs->cmd[0].bytes[0]);
+    EXPECT_EQ(0x02, cs->cmd[0].bytes[1]);
+    EXPECT_EQ(0x01, cs->cmd[0].bytes[2]);
+    EXPECT_EQ(0x01, cs->cmd[0].bytes[3]);
+    EXPECT_EQ(0x11, cs->cmd[0].bytes[4]);
+    EXPECT_EQ(0x44, cs->cmd[0].bytes[7]);
+
+    write_cmd_sort_free(cs);
+    utarray_free(tags);
+}
+
+TEST(test_modbus_write_tags_sort, should_split_at_gap_and_pdu_limit)
+{
+    modbus_point_write_t points[MODBUS_MAX_WRITE_REGISTERS + 3] = { 0 };
+    UT_array *           tags                                   = NULL;
+
+    utarray_new(tags, &ut_ptr_icd);
+    for (int i = 0; i < MODBUS_MAX_WRITE_REGISTERS + 3; i++) {
+        modbus_point_write_t *p = &points[i];
+
+        p->point.slave_id      = 1;
+        p->point.area          = MODBUS_AREA_HOLD_REGISTER;
+        p->point.type          = NEU_TYPE_UINT16;
+        p->point.n_register    = 1;
+        p->point.start_address = i;
+        utarray_push_back(tags, &p);
+    }
+    // a single tag after a gap
+    points[MODBUS_MAX_WRITE_REGISTERS + 2].point.start_address = 1000;
+
+    modbus_write_cmd_sort_t *cs = modbus_write_tags_sort(tags, MODBUS_ABCD);
+
+    EXPECT_EQ(3, cs->n_cmd);
+    EXPECT_EQ(MODBUS_MAX_WRITE_REGISTERS, cs->cmd[0].n_register);
+    EXPECT_EQ(2, cs->cmd[1].n_register);
+    EXPECT_EQ(1000, cs->cmd[2].start_address);
+    EXPECT_EQ(1, cs->cmd[2].n_register);
+
+    write_cmd_sort_free(cs);
+    utarray_free(tags);
+}
+
+TEST(test_modbus_write_tags_sort, should_pack_coils_by_address)
+{
+    modbus_point_write_t points[3] = { 0 };
+    UT_array *           tags      = NULL;
+
+    utarray_new(tags, &ut_ptr_icd);
+    for (int i = 0; i < 3; i++) {
+        modbus_point_write_t *p = &points[i];
+
+        p->point.slave_id      = 1;
+        p->point.area          = MODBUS_AREA_COIL;
+        p->point.type          = NEU_TYPE_BIT;
+        p->point.n_register    = 1;
+        p->point.start_address = 8 + i;
+        p->value.i8            = i != 1;
+        utarray_push_back(tags, &p);
+    }
+
+    modbus_write_cmd_sort_t *cs = modbus_write_tags_sort(tags, MODBUS_ABCD);
+
+    EXPECT_EQ(1, cs->n_cmd);
+    EXPECT_EQ(8, cs->cmd[0].start_address);
+    EXPECT_EQ(3, cs->cmd[0].n_register);
+    EXPECT_EQ(1, cs->cmd[0].n_byte);
+    EXPECT_EQ(0x05, cs->cmd[0].bytes[0]);
+
+    write_cmd_sort_free(cs);
+    utarray_free(tags);
+}
+
 int main(int argc, char **argv)
 {
     zlog_init("./config/dev.conf");
@@ -0,0 +1,122 @@
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "utils/log.h"
+
+#include "mqtt_batch.h"
+
+zlog_category_t *neuron = NULL;
+
+#define BYTES(s) std::string(s, sizeof(s) - 1)
+
+static std::string take(mqtt_batch_t *batch)
+{
+    size_t len  = 0;
+    size_t size = mqtt_batch_size(batch);
+    char * buf  = mqtt_batch_take(batch, &len);
+
+    EXPECT_NE(nullptr, buf);
+    EXPECT_EQ(size, len);
+    std::string envelope(buf, len);
+    free(buf);
+    return envelope;
+}
+
+static void add(mqtt_batch_t *batch, mqtt_upload_format_e format,
+                const std::string &report, int64_t now)
+{
+    size_t size = 0;
+
+    if (batch->count > 0) {
+        size = mqtt_batch_size_with(batch, report.size());
+    }
+
+    EXPECT_EQ(0,
+              mqtt_batch_add(batch, format, report.data(), report.size(), now));
+    if (size > 0) {
+        EXPECT_EQ(size, mqtt_batch_size(batch));
+    }
+}
+
+TEST(MqttBatchTest, Get)
+{
+    mqtt_batch_t *tbl = NULL;
+    mqtt_batch_t *a   = mqtt_batch_get(&tbl, "/a");
+    mqtt_batch_t *b   = mqtt_batch_get(&tbl, "/b");
+
+    ASSERT_NE(nullptr, a);
+    ASSERT_NE(nullptr, b);
+    EXPECT_NE(a, b);
+    EXPECT_EQ(a, mqtt_batch_get(&tbl, "/a"));
+    EXPECT_STREQ("/b", b->topic);
+    EXPECT_EQ(0, b->count);
+
+    mqtt_batch_tbl_free(tbl);
+}
+
+TEST(MqttBatchTest, Json)
+{
+    mqtt_batch_t *tbl   = NULL;
+    mqtt_batch_t *batch = mqtt_batch_get(&tbl, "/t");
+    size_t        len   = 0;
+
+    EXPECT_EQ(nullptr, mqtt_batch_take(batch, &len));
+
+    add(batch, MQTT_UPLOAD_FORMAT_VALUES, "{\"timestamp\":1}", 10);
+    add(batch, MQTT_UPLOAD_FORMAT_VALUES, "{\"timestamp\":2}", 20);
+    EXPECT_EQ(2, batch->count);
+    EXPECT_EQ(10, batch->ts);
+    EXPECT_EQ("[{\"timestamp\":1},{\"timestamp\":2}]", take(batch));
+
+    EXPECT_EQ(0, batch->count);
+    add(batch, MQTT_UPLOAD_FORMAT_TAGS, "{}", 30);
+    EXPECT_EQ(30, batch->ts);
+    EXPECT_EQ("[{}]", take(batch));
+
+    mqtt_batch_tbl_free(tbl);
+}
+
+TEST(MqttBatchTest, Msgpack)
+{
+    mqtt_batch_t *tbl   = NULL;
+    mqtt_batch_t *batch = mqtt_batch_get(&tbl, "/t");
+
+    add(batch, MQTT_UPLOAD_FORMAT_MSGPACK, BYTES("\x80"), 0);
+    add(batch, MQTT_UPLOAD_FORMAT_MSGPACK, BYTES("\x81\xa1k\x01"), 0);
+    EXPECT_EQ(BYTES("\xdd\x00\x00\x00\x02\x80\x81\xa1k\x01"), take(batch));
+
+    mqtt_batch_tbl_free(tbl);
+}
+
+TEST(MqttBatchTest, Protobuf)
+{
+    mqtt_batch_t *tbl   = NULL;
+    mqtt_batch_t *batch = mqtt_batch_get(&tbl, "/t");
+    std::string   large(200, 'x');
+
+    add(batch, MQTT_UPLOAD_FORMAT_PROTOBUF, BYTES("\x0a\x01n"), 0);
+    add(batch, MQTT_UPLOAD_FORMAT_PROTOBUF, large, 0);
+    EXPECT_EQ(BYTES("\x0a\x03\x0a\x01n\x0a\xc8\x01") + large, take(batch));
+
+    mqtt_batch_tbl_free(tbl);
+}
+
+TEST(MqttBatchTest, Grow)
+{
+    mqtt_batch_t *tbl   = NULL;
+    mqtt_batch_t *batch = mqtt_batch_get(&tbl, "/t");
+    std::string   expect("[");
+
+    for (int i = 0; i < 1000; i++) {
+        std::string report = "{\"timestamp\":" + std::to_string(i) + "}";
+        add(batch, MQTT_UPLOAD_FORMAT_VALUES, report, i);
+        expect += (i > 0 ? "," : "") + report;
+    }
+    expect += "]";
+
+    EXPECT_EQ(1000, batch->count);
+    EXPECT_EQ(expect, take(batch));
+
+    mqtt_batch_tbl_free(tbl);
+}
@@ -0,0 +1,218 @@
+#include <math.h>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "msg.h"
+#include "utils/log.h"
+
+#include "mqtt_binary.h"
+#include "neuron_upload.pb-c.h"
+#include "tag_value_helper.h"
+
+zlog_category_t *neuron = NULL;
+
+#define BYTES(s) std::string(s, sizeof(s) - 1)
+
+// {"node": "n", "group": "g", "timestamp": 1000, "tags": ...
+#define MSGPACK_HEADER \
+    "\x84\xa4node\xa1n\xa5group\xa1g\xa9timestamp\xcd\x03\xe8\xa4tags"
+
+static std::string encode(bool msgpack, UT_array *tags, uint64_t seq = 0,
+                          bool keyframe = false)
+{
+    neu_json_read_periodic_t header = {};
+    size_t                   len    = 0;
+
+    header.node      = (char *) "n";
+    header.group     = (char *) "g";
+    header.timestamp = 1000;
+    header.seq       = seq;
+    header.keyframe  = keyframe;
+
+    char *buf = msgpack ? mqtt_encode_msgpack(&header, tags, &len)
+                        : mqtt_encode_protobuf(&header, tags, &len);
+
+    EXPECT_NE(nullptr, buf);
+    std::string payload(buf, len);
+    free(buf);
+    return payload;
+}
+
+TEST(MqttBinaryTest, MsgpackHeader)
+{
+    UT_array *tags = NULL;
+
+    utarray_new(tags, neu_resp_tag_value_meta_icd());
+    push_tag(tags, "t", NEU_TYPE_INT16)->value.value.i16 = -5;
+
+    EXPECT_EQ(BYTES(MSGPACK_HEADER "\x91\x93\xa1t\x03\xfb"),
+              encode(true, tags));
+
+    utarray_free(tags);
+}
+
+TEST(MqttBinaryTest, MsgpackDelta)
+{
+    UT_array *tags = NULL;
+
+    utarray_new(tags, neu_resp_tag_value_meta_icd());
+
+    EXPECT_EQ(BYTES("\x86\xa4node\xa1n\xa5group\xa1g\xa9timestamp\xcd\x03\xe8"
+                    "\xa4tags\x90\xa3seq\x07\xa8keyframe\xc3"),
+              encode(true, tags, 7, true));
+
+    utarray_free(tags);
+}
+
+TEST(MqttBinaryTest, MsgpackValue)
+{
+    UT_array *                 tags = NULL;
+    neu_resp_tag_value_meta_t *tag  = NULL;
+
+    utarray_new(tags, neu_resp_tag_value_meta_icd());
+
+    push_tag(tags, "a", NEU_TYPE_UINT64)->value.value.u64 = UINT64_MAX;
+    push_tag(tags, "b", NEU_TYPE_INT32)->value.value.i32  = -1000;
+    push_tag(tags, "c", NEU_TYPE_FLOAT)->value.value.f32  = 1.5f;
+    push_tag(tags, "d", NEU_TYPE_FLOAT)->value.value.f32  = NAN;
+
+    tag                             = push_tag(tags, "e", NEU_TYPE_BYTES);
+    tag->value.value.bytes.length   = 2;
+    tag->value.value.bytes.bytes[0] = 0;
+    tag->value.value.bytes.bytes[1] = 0xff;
+
+    tag = push_tag(tags, "f", NEU_TYPE_ARRAY_BOOL);
+    tag->value.value.bools.length   = 2;
+    tag->value.value.bools.bools[0] = true;
+
+    tag                      = push_tag(tags, "g", NEU_TYPE_ERROR);
+    tag->value.value.i32     = 3001;
+    tag->metas[0].value.type = NEU_TYPE_BOOL;
+    strcpy(tag->metas[0].name, "q");
+
+    EXPECT_EQ(BYTES(MSGPACK_HEADER "\x97"
+                    "\x93\xa1"
+                    "a\x08\xcf\xff\xff\xff\xff\xff\xff\xff\xff"
+                    "\x93\xa1"
+                    "b\x05\xd1\xfc\x18"
+                    "\x93\xa1"
+                    "c\x09\xca\x3f\xc0\x00\x00"
+                    "\x93\xa1"
+                    "d\x0f\xcd\x0b\xc0"
+                    "\x93\xa1"
+                    "e\x0e\xc4\x02\x00\xff"
+                    "\x93\xa1"
+                    "f\x21\x92\xc3\xc2"
+                    "\x94\xa1"
+                    "g\x0f\xcd\x0b\xb9\x81\xa1q\x92\x0c\xc2"),
+              encode(true, tags));
+
+    utarray_free(tags);
+}
+
+TEST(MqttBinaryTest, ProtobufHeader)
+{
+    UT_array *tags = NULL;
+
+    utarray_new(tags, neu_resp_tag_value_meta_icd());
+    push_tag(tags, "t", NEU_TYPE_INT16)->value.value.i16 = -5;
+
+    EXPECT_EQ(BYTES("\x0a\x01n\x12\x01g\x18\xe8\x07"
+                    "\x22\x09\x0a\x01t\x10\x03\x1a\x02\x08\x09"),
+              encode(false, tags));
+
+    utarray_free(tags);
+}
+
+TEST(MqttBinaryTest, ProtobufDelta)
+{
+    UT_array *tags = NULL;
+
+    utarray_new(tags, neu_resp_tag_value_meta_icd());
+
+    EXPECT_EQ(BYTES("\x0a\x01n\x12\x01g\x18\xe8\x07\x28\x96\x01"),
+              encode(false, tags, 150, false));
+    EXPECT_EQ(BYTES("\x0a\x01n\x12\x01g\x18\xe8\x07\x28\x01\x30\x01"),
+              encode(false, tags, 1, true));
+
+    utarray_free(tags);
+}
+
+TEST(MqttBinaryTest, ProtobufLongTag)
+{
+    UT_array *                 tags = NULL;
+    neu_resp_tag_value_meta_t *tag  = NULL;
+    std::string                payload;
+
+    utarray_new(tags, neu_resp_tag_value_meta_icd());
+    tag                          = push_tag(tags, "t", NEU_TYPE_ARRAY_UINT16);
+    tag->value.value.u16s.length = 100;
+    for (int i = 0; i < 100; i++) {
+        tag->value.value.u16s.u16s[i] = 1000;
+    }
+    push_tag(tags, "e", NEU_TYPE_ERROR)->value.value.i32 = 3001;
+
+    payload = encode(false, tags);
+
+    // tag, value, uint_array and packed values all need a two bytes length
+    ASSERT_EQ(9 + 3 + 214 + 10, payload.size());
+    EXPECT_EQ(BYTES("\x22\xd6\x01\x0a\x01t\x10\x1a\x1a\xce\x01"
+                    "\x4a\xcb\x01\x0a\xc8\x01\xe8\x07"),
+              payload.substr(9, 19));
+    EXPECT_EQ(BYTES("\x22\x08\x0a\x01"
+                    "e\x10\x0f\x20\xb9\x17"),
+              payload.substr(226));
+
+    utarray_free(tags);
+}
+
+TEST(MqttBinaryTest, ProtobufUnpack)
+{
+    UT_array *                 tags = NULL;
+    neu_resp_tag_value_meta_t *tag  = NULL;
+    std::string                payload;
+
+    utarray_new(tags, neu_resp_tag_value_meta_icd());
+    tag                           = push_tag(tags, "a", NEU_TYPE_ARRAY_INT16);
+    tag->value.value.i16s.length  = 2;
+    tag->value.value.i16s.i16s[0] = -2;
+    tag->value.value.i16s.i16s[1] = 300;
+    strcpy(tag->metas[0].name, "unit");
+    tag->metas[0].value.type = NEU_TYPE_STRING;
+    strcpy(tag->metas[0].value.value.str, "kPa");
+    push_tag(tags, "e", NEU_TYPE_ERROR)->value.value.i32 = 3001;
+
+    payload = encode(false, tags, 2, true);
+
+    Neuron__Upload__Upload *upload = neuron__upload__upload__unpack(
+        NULL, payload.size(), (const uint8_t *) payload.data());
+    ASSERT_NE(nullptr, upload);
+    EXPECT_STREQ("n", upload->node);
+    EXPECT_STREQ("g", upload->group);
+    EXPECT_EQ(1000, upload->timestamp);
+    EXPECT_EQ(2, upload->seq);
+    EXPECT_TRUE(upload->keyframe);
+    ASSERT_EQ(2, upload->n_tags);
+
+    Neuron__Upload__Tag *a = upload->tags[0];
+    EXPECT_STREQ("a", a->name);
+    EXPECT_EQ(NEU_TYPE_ARRAY_INT16, a->type);
+    ASSERT_NE(nullptr, a->value);
+    ASSERT_EQ(NEURON__UPLOAD__VALUE__VALUE_INT_ARRAY, a->value->value_case);
+    ASSERT_EQ(2, a->value->int_array->n_values);
+    EXPECT_EQ(-2, a->value->int_array->values[0]);
+    EXPECT_EQ(300, a->value->int_array->values[1]);
+    ASSERT_EQ(1, a->n_metas);
+    EXPECT_STREQ("unit", a->metas[0]->name);
+    EXPECT_EQ(NEU_TYPE_STRING, a->metas[0]->type);
+    EXPECT_STREQ("kPa", a->metas[0]->value->string_value);
+
+    Neuron__Upload__Tag *e = upload->tags[1];
+    EXPECT_EQ(NEU_TYPE_ERROR, e->type);
+    EXPECT_EQ(nullptr, e->value);
+    EXPECT_EQ(3001, e->error);
+
+    neuron__upload__upload__free_unpacked(upload, NULL);
+    utarray_free(tags);
+}
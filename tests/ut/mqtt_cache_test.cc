@@ -0,0 +1,208 @@
+#include <dirent.h>
+#include <string>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "utils/log.h"
+
+#include "mqtt_cache.h"
+
+zlog_category_t *neuron = NULL;
+
+#define CACHE_DIR "mqtt-cache-test/node"
+
+class MqttCacheTest : public testing::Test {
+protected:
+    void SetUp() override { mqtt_cache_remove(CACHE_DIR); }
+    void TearDown() override { mqtt_cache_remove(CACHE_DIR); }
+};
+
+static int n_segment()
+{
+    int            n   = 0;
+    DIR *          d   = opendir(CACHE_DIR);
+    struct dirent *ent = NULL;
+
+    while (d && NULL != (ent = readdir(d))) {
+        n += NULL != strstr(ent->d_name, ".seg");
+    }
+    if (d) {
+        closedir(d);
+    }
+    return n;
+}
+
+static void append(mqtt_cache_t *cache, const std::string &payload)
+{
+    EXPECT_EQ(0,
+              mqtt_cache_append(cache, "/t", MQTT_COMPRESS_NONE,
+                                payload.data(), payload.size()));
+}
+
+static std::string next(mqtt_cache_t *cache, uint64_t *seq = NULL)
+{
+    mqtt_cache_record_t rec = {};
+
+    if (0 != mqtt_cache_next(cache, &rec)) {
+        return "";
+    }
+    if (seq) {
+        *seq = rec.seq;
+    }
+    return std::string(rec.payload, rec.len);
+}
+
+TEST_F(MqttCacheTest, Replay)
+{
+    mqtt_cache_t *      cache = mqtt_cache_open(CACHE_DIR, 4096, 1024 * 1024);
+    mqtt_cache_record_t rec   = {};
+
+    ASSERT_NE(nullptr, cache);
+    EXPECT_EQ(-1, mqtt_cache_next(cache, &rec));
+
+    EXPECT_EQ(0,
+              mqtt_cache_append(cache, "/neuron/upload", MQTT_COMPRESS_LZ4,
+                                "abc", 3));
+    append(cache, "d");
+    EXPECT_EQ(2, mqtt_cache_count(cache));
+
+    ASSERT_EQ(0, mqtt_cache_next(cache, &rec));
+    EXPECT_EQ(0, rec.seq);
+    EXPECT_STREQ("/neuron/upload", rec.topic);
+    EXPECT_EQ(MQTT_COMPRESS_LZ4, rec.encoding);
+    EXPECT_EQ("abc", std::string(rec.payload, rec.len));
+    mqtt_cache_ack(cache, rec.seq);
+
+    ASSERT_EQ(0, mqtt_cache_next(cache, &rec));
+    EXPECT_EQ(1, rec.seq);
+    EXPECT_STREQ("/t", rec.topic);
+    EXPECT_EQ(MQTT_COMPRESS_NONE, rec.encoding);
+    EXPECT_EQ(-1, mqtt_cache_next(cache, &rec));
+
+    // appended while replaying
+    append(cache, "e");
+    EXPECT_EQ("e", next(cache));
+
+    mqtt_cache_ack(cache, 1);
+    mqtt_cache_ack(cache, 1);
+    mqtt_cache_ack(cache, 2);
+    EXPECT_EQ(0, mqtt_cache_count(cache));
+
+    mqtt_cache_close(cache);
+}
+
+TEST_F(MqttCacheTest, Rewind)
+{
+    mqtt_cache_t *cache = mqtt_cache_open(CACHE_DIR, 4096, 1024 * 1024);
+
+    ASSERT_NE(nullptr, cache);
+    for (int i = 0; i < 5; i++) {
+        append(cache, std::to_string(i));
+    }
+    for (int i = 0; i < 5; i++) {
+        EXPECT_EQ(std::to_string(i), next(cache));
+    }
+
+    // only the unacknowledged ones are replayed again
+    mqtt_cache_ack(cache, 0);
+    mqtt_cache_ack(cache, 2);
+    mqtt_cache_ack(cache, 4);
+    mqtt_cache_rewind(cache);
+    EXPECT_EQ("1", next(cache));
+    EXPECT_EQ("3", next(cache));
+    EXPECT_EQ("", next(cache));
+
+    mqtt_cache_close(cache);
+}
+
+TEST_F(MqttCacheTest, Restart)
+{
+    mqtt_cache_t *cache = mqtt_cache_open(CACHE_DIR, 4096, 1024 * 1024);
+    uint64_t      seq   = 0;
+
+    ASSERT_NE(nullptr, cache);
+    for (int i = 0; i < 5; i++) {
+        append(cache, std::to_string(i));
+    }
+    mqtt_cache_ack(cache, 0);
+    mqtt_cache_ack(cache, 1);
+    mqtt_cache_ack(cache, 3);
+    ASSERT_EQ(0, mqtt_cache_sync(cache));
+
+    // not in the index
+    append(cache, "5");
+    mqtt_cache_close(cache);
+
+    cache = mqtt_cache_open(CACHE_DIR, 4096, 1024 * 1024);
+    ASSERT_NE(nullptr, cache);
+    EXPECT_EQ(3, mqtt_cache_count(cache));
+    EXPECT_EQ("2", next(cache));
+    EXPECT_EQ("4", next(cache));
+    EXPECT_EQ("5", next(cache));
+
+    append(cache, "6");
+    EXPECT_EQ("6", next(cache, &seq));
+    EXPECT_EQ(6, seq);
+    mqtt_cache_close(cache);
+
+    // everything is replayed without the index
+    unlink(CACHE_DIR "/index");
+    cache = mqtt_cache_open(CACHE_DIR, 4096, 1024 * 1024);
+    ASSERT_NE(nullptr, cache);
+    EXPECT_EQ(7, mqtt_cache_count(cache));
+    EXPECT_EQ("0", next(cache));
+    mqtt_cache_close(cache);
+}
+
+TEST_F(MqttCacheTest, Segments)
+{
+    mqtt_cache_t *cache = mqtt_cache_open(CACHE_DIR, 4096, 1024 * 1024);
+    std::string   payload(1000, 'x');
+
+    ASSERT_NE(nullptr, cache);
+    EXPECT_EQ(-1,
+              mqtt_cache_append(cache, "/t", MQTT_COMPRESS_NONE,
+                                payload.data(), 4096));
+
+    // three records per segment
+    for (int i = 0; i < 10; i++) {
+        append(cache, payload);
+    }
+    EXPECT_EQ(4, n_segment());
+
+    for (int i = 0; i < 10; i++) {
+        uint64_t seq = 0;
+        EXPECT_EQ(payload, next(cache, &seq));
+        mqtt_cache_ack(cache, seq);
+    }
+    EXPECT_EQ(0, mqtt_cache_count(cache));
+    EXPECT_EQ(1, n_segment());
+
+    mqtt_cache_close(cache);
+}
+
+TEST_F(MqttCacheTest, Evict)
+{
+    mqtt_cache_t *cache   = mqtt_cache_open(CACHE_DIR, 4096, 3 * 4096);
+    std::string   payload = std::string(1000, 'x');
+    int           evicted = 0;
+
+    ASSERT_NE(nullptr, cache);
+    for (int i = 0; i < 10; i++) {
+        int rv = mqtt_cache_append(cache, "/t", MQTT_COMPRESS_NONE,
+                                   payload.data(), payload.size());
+        ASSERT_LE(0, rv);
+        evicted += rv;
+    }
+
+    EXPECT_EQ(3, n_segment());
+    EXPECT_EQ(3, evicted);
+    EXPECT_EQ(7, mqtt_cache_count(cache));
+
+    uint64_t seq = 0;
+    next(cache, &seq);
+    EXPECT_EQ(3, seq);
+
+    mqtt_cache_close(cache);
+}
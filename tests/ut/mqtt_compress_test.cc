@@ -0,0 +1,84 @@
+#include <string>
+
+#include <gtest/gtest.h>
+#include <lz4frame.h>
+#include <zlib.h>
+
+#include "utils/log.h"
+
+#include "mqtt_compress.h"
+
+zlog_category_t *neuron = NULL;
+
+static std::string upload(int n)
+{
+    std::string json = "{\"node\":\"modbus\",\"group\":\"grp\","
+                       "\"timestamp\":1700000000000,\"values\":{";
+
+    for (int i = 0; i < n; i++) {
+        json += (i > 0 ? ",\"tag" : "\"tag") + std::to_string(i) +
+            "\":" + std::to_string(i % 7);
+    }
+    return json + "},\"errors\":{}}";
+}
+
+TEST(MqttCompressTest, Encoding)
+{
+    EXPECT_STREQ("deflate", mqtt_compress_encoding(MQTT_COMPRESS_ZLIB));
+    EXPECT_STREQ("lz4", mqtt_compress_encoding(MQTT_COMPRESS_LZ4));
+    EXPECT_EQ(nullptr, mqtt_compress_encoding(MQTT_COMPRESS_NONE));
+}
+
+TEST(MqttCompressTest, Zlib)
+{
+    std::string json = upload(500);
+    size_t      len  = 0;
+    char *      buf =
+        mqtt_compress(MQTT_COMPRESS_ZLIB, json.data(), json.size(), &len);
+
+    ASSERT_NE(nullptr, buf);
+    EXPECT_LT(len * 2, json.size());
+
+    std::string out(json.size(), '\0');
+    uLongf      out_len = out.size();
+    EXPECT_EQ(Z_OK,
+              uncompress((Bytef *) &out[0], &out_len, (Bytef *) buf, len));
+    EXPECT_EQ(json, out.substr(0, out_len));
+
+    free(buf);
+}
+
+TEST(MqttCompressTest, Lz4)
+{
+    std::string json = upload(500);
+    size_t      len  = 0;
+    char *      buf =
+        mqtt_compress(MQTT_COMPRESS_LZ4, json.data(), json.size(), &len);
+
+    ASSERT_NE(nullptr, buf);
+    EXPECT_LT(len, json.size());
+
+    LZ4F_dctx *ctx = NULL;
+    ASSERT_FALSE(LZ4F_isError(LZ4F_createDecompressionContext(&ctx, 100)));
+
+    std::string out(json.size() + 1, '\0');
+    size_t      out_len = out.size();
+    size_t      in_len  = len;
+    EXPECT_EQ(0,
+              LZ4F_decompress(ctx, &out[0], &out_len, buf, &in_len, NULL));
+    EXPECT_EQ(len, in_len);
+    EXPECT_EQ(json, out.substr(0, out_len));
+
+    LZ4F_freeDecompressionContext(ctx);
+    free(buf);
+}
+
+TEST(MqttCompressTest, NotSmaller)
+{
+    const char *payload = "{}";
+    size_t      len     = 0;
+
+    EXPECT_EQ(nullptr, mqtt_compress(MQTT_COMPRESS_ZLIB, payload, 2, &len));
+    EXPECT_EQ(nullptr, mqtt_compress(MQTT_COMPRESS_LZ4, payload, 2, &len));
+    EXPECT_EQ(nullptr, mqtt_compress(MQTT_COMPRESS_NONE, payload, 2, &len));
+}
@@ -0,0 +1,194 @@
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "msg.h"
+#include "utils/log.h"
+
+#include "mqtt_delta.h"
+#include "tag_value_helper.h"
+
+zlog_category_t *neuron = NULL;
+
+static neu_resp_tag_value_meta_t *tag_at(UT_array *tags, unsigned i)
+{
+    return (neu_resp_tag_value_meta_t *) utarray_eltptr(tags, i);
+}
+
+// names of the tags to upload, empty if nothing is uploaded
+static std::vector<std::string> filter(mqtt_delta_t *delta, UT_array *tags,
+                                       uint64_t *seq, bool *keyframe,
+                                       bool skip_error = false)
+{
+    std::vector<std::string> names;
+    UT_array *out = mqtt_delta_filter(delta, tags, skip_error, seq, keyframe);
+
+    EXPECT_NE(nullptr, out);
+    utarray_foreach(out, neu_resp_tag_value_meta_t *, tag)
+    {
+        names.push_back(tag->tag);
+    }
+    utarray_free(out);
+    return names;
+}
+
+using names = std::vector<std::string>;
+
+TEST(MqttDeltaTest, Changed)
+{
+    mqtt_delta_t *delta    = mqtt_delta_new(100);
+    UT_array *    tags     = NULL;
+    uint64_t      seq      = 0;
+    bool          keyframe = false;
+
+    utarray_new(tags, neu_resp_tag_value_meta_icd());
+    push_tag(tags, "a", NEU_TYPE_INT16)->value.value.i16 = 1;
+    strcpy(push_tag(tags, "b", NEU_TYPE_STRING)->value.value.str, "x");
+    push_tag(tags, "c", NEU_TYPE_DOUBLE)->value.value.d64 = 0.5;
+
+    // the first upload is a keyframe
+    EXPECT_EQ(names({ "a", "b", "c" }), filter(delta, tags, &seq, &keyframe));
+    EXPECT_EQ(1, seq);
+    EXPECT_TRUE(keyframe);
+
+    // nothing changed, nothing uploaded and no sequence number taken
+    seq = 0;
+    EXPECT_EQ(names(), filter(delta, tags, &seq, &keyframe));
+    EXPECT_EQ(0, seq);
+
+    tag_at(tags, 1)->value.value.str[0] = 'y';
+    EXPECT_EQ(names({ "b" }), filter(delta, tags, &seq, &keyframe));
+    EXPECT_EQ(2, seq);
+    EXPECT_FALSE(keyframe);
+
+    // same bytes, another type
+    tag_at(tags, 0)->value.type = NEU_TYPE_UINT16;
+    // a meta change is a change
+    strcpy(tag_at(tags, 2)->metas[0].name, "unit");
+    tag_at(tags, 2)->metas[0].value.type = NEU_TYPE_INT8;
+    EXPECT_EQ(names({ "a", "c" }), filter(delta, tags, &seq, &keyframe));
+    EXPECT_EQ(3, seq);
+
+    // a tag coming back from an error
+    tag_at(tags, 0)->value.type      = NEU_TYPE_ERROR;
+    tag_at(tags, 0)->value.value.i32 = 3008;
+    EXPECT_EQ(names({ "a" }), filter(delta, tags, &seq, &keyframe));
+    tag_at(tags, 0)->value.type      = NEU_TYPE_UINT16;
+    tag_at(tags, 0)->value.value.u16 = 1;
+    EXPECT_EQ(names({ "a" }), filter(delta, tags, &seq, &keyframe));
+    EXPECT_EQ(5, seq);
+
+    utarray_free(tags);
+    mqtt_delta_free(delta);
+}
+
+TEST(MqttDeltaTest, Keyframe)
+{
+    mqtt_delta_t *delta    = mqtt_delta_new(3);
+    UT_array *    tags     = NULL;
+    uint64_t      seq      = 0;
+    bool          keyframe = false;
+
+    utarray_new(tags, neu_resp_tag_value_meta_icd());
+    push_tag(tags, "a", NEU_TYPE_INT32)->value.value.i32 = 1;
+    push_tag(tags, "b", NEU_TYPE_INT32)->value.value.i32 = 2;
+
+    EXPECT_EQ(names({ "a", "b" }), filter(delta, tags, &seq, &keyframe));
+    EXPECT_TRUE(keyframe);
+
+    // reports without changes count towards the next keyframe
+    EXPECT_EQ(names(), filter(delta, tags, &seq, &keyframe));
+    tag_at(tags, 0)->value.value.i32 = 10;
+    EXPECT_EQ(names({ "a" }), filter(delta, tags, &seq, &keyframe));
+    EXPECT_FALSE(keyframe);
+    EXPECT_EQ(names({ "a", "b" }), filter(delta, tags, &seq, &keyframe));
+    EXPECT_TRUE(keyframe);
+    EXPECT_EQ(3, seq);
+
+    // a lost upload
+    tag_at(tags, 1)->value.value.i32 = 20;
+    EXPECT_EQ(names({ "b" }), filter(delta, tags, &seq, &keyframe));
+    mqtt_delta_resync(delta);
+    EXPECT_EQ(names({ "a", "b" }), filter(delta, tags, &seq, &keyframe));
+    EXPECT_TRUE(keyframe);
+    EXPECT_EQ(5, seq);
+
+    utarray_free(tags);
+    mqtt_delta_free(delta);
+}
+
+TEST(MqttDeltaTest, Values)
+{
+    mqtt_delta_t *delta    = mqtt_delta_new(100);
+    UT_array *    tags     = NULL;
+    uint64_t      seq      = 0;
+    bool          keyframe = false;
+    char          a[]      = "a";
+    char          bc[]     = "bc";
+
+    utarray_new(tags, neu_resp_tag_value_meta_icd());
+    neu_resp_tag_value_meta_t *arr = push_tag(tags, "arr", NEU_TYPE_ARRAY_INT8);
+    arr->value.value.i8s.length    = 2;
+    arr->value.value.i8s.i8s[0]    = 1;
+    arr->value.value.i8s.i8s[1]    = 2;
+    neu_resp_tag_value_meta_t *strs =
+        push_tag(tags, "strs", NEU_TYPE_ARRAY_STRING);
+    strs->value.value.strs.length  = 2;
+    strs->value.value.strs.strs[0] = a;
+    strs->value.value.strs.strs[1] = bc;
+
+    EXPECT_EQ(names({ "arr", "strs" }), filter(delta, tags, &seq, &keyframe));
+
+    // bytes past the length are not part of the value
+    tag_at(tags, 0)->value.value.i8s.i8s[5] = 9;
+    EXPECT_EQ(names(), filter(delta, tags, &seq, &keyframe));
+
+    tag_at(tags, 0)->value.value.i8s.length = 3;
+    EXPECT_EQ(names({ "arr" }), filter(delta, tags, &seq, &keyframe));
+
+    // ["a", "bc"] to ["ab", "c"]
+    char ab[] = "ab";
+    char c[]  = "c";
+    tag_at(tags, 1)->value.value.strs.strs[0] = ab;
+    tag_at(tags, 1)->value.value.strs.strs[1] = c;
+    EXPECT_EQ(names({ "strs" }), filter(delta, tags, &seq, &keyframe));
+
+    utarray_free(tags);
+    mqtt_delta_free(delta);
+}
+
+TEST(MqttDeltaTest, SkipError)
+{
+    mqtt_delta_t *delta    = mqtt_delta_new(100);
+    UT_array *    tags     = NULL;
+    uint64_t      seq      = 0;
+    bool          keyframe = false;
+
+    utarray_new(tags, neu_resp_tag_value_meta_icd());
+    push_tag(tags, "a", NEU_TYPE_INT16)->value.value.i16 = 1;
+    push_tag(tags, "b", NEU_TYPE_ERROR)->value.value.i32 = 5;
+
+    // the shared tags are left as they are
+    EXPECT_EQ(names({ "a" }), filter(delta, tags, &seq, &keyframe, true));
+    EXPECT_EQ(2, utarray_len(tags));
+    EXPECT_EQ(NEU_TYPE_ERROR, tag_at(tags, 1)->value.type);
+
+    tag_at(tags, 1)->value.type      = NEU_TYPE_INT16;
+    tag_at(tags, 1)->value.value.i16 = 7;
+    EXPECT_EQ(names({ "b" }), filter(delta, tags, &seq, &keyframe, true));
+
+    // an error in between keeps the value uploaded before
+    seq                         = 0;
+    tag_at(tags, 1)->value.type = NEU_TYPE_ERROR;
+    EXPECT_EQ(names(), filter(delta, tags, &seq, &keyframe, true));
+    EXPECT_EQ(0, seq);
+    tag_at(tags, 1)->value.type = NEU_TYPE_INT16;
+    EXPECT_EQ(names(), filter(delta, tags, &seq, &keyframe, true));
+
+    tag_at(tags, 1)->value.type = NEU_TYPE_ERROR;
+    EXPECT_EQ(names({ "b" }), filter(delta, tags, &seq, &keyframe));
+
+    utarray_free(tags);
+    mqtt_delta_free(delta);
+}
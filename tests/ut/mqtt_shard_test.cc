@@ -0,0 +1,69 @@
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "utils/log.h"
+
+#include "mqtt_shard.h"
+
+zlog_category_t *neuron = NULL;
+
+TEST(MqttShardTest, JumpHashRange)
+{
+    for (uint64_t key = 0; key < 1000; key++) {
+        EXPECT_EQ(0, mqtt_jump_hash(key, 1));
+        for (int32_t n = 2; n <= 16; n++) {
+            int32_t b = mqtt_jump_hash(key * 0x9e3779b97f4a7c15ULL, n);
+            EXPECT_LE(0, b);
+            EXPECT_GT(n, b);
+        }
+    }
+}
+
+TEST(MqttShardTest, JumpHashStable)
+{
+    const int n_key = 10000;
+
+    for (int32_t n = 1; n < 16; n++) {
+        int n_moved = 0;
+
+        for (uint64_t key = 0; key < n_key; key++) {
+            uint64_t k    = key * 0x9e3779b97f4a7c15ULL;
+            int32_t  from = mqtt_jump_hash(k, n);
+            int32_t  to   = mqtt_jump_hash(k, n + 1);
+
+            // a key stays, or moves to the added bucket
+            EXPECT_EQ(from, mqtt_jump_hash(k, n));
+            if (from != to) {
+                EXPECT_EQ(n, to);
+                n_moved += 1;
+            }
+        }
+
+        // about 1/(n + 1) of the keys move
+        EXPECT_NEAR(n_key / (n + 1), n_moved, n_key / (n + 1) / 5) << n;
+    }
+}
+
+TEST(MqttShardTest, TopicDistribution)
+{
+    const int32_t    n_shard = 8;
+    const int        n_topic = 80000;
+    std::vector<int> count(n_shard, 0);
+
+    for (int i = 0; i < n_topic; i++) {
+        std::string topic = "/neuron/driver-" + std::to_string(i % 500) +
+            "/group-" + std::to_string(i / 500);
+        int32_t     shard = mqtt_shard_of(topic.c_str(), n_shard);
+
+        ASSERT_LE(0, shard);
+        ASSERT_GT(n_shard, shard);
+        EXPECT_EQ(shard, mqtt_shard_of(topic.c_str(), n_shard));
+        count[shard] += 1;
+    }
+
+    for (int32_t s = 0; s < n_shard; s++) {
+        EXPECT_NEAR(n_topic / n_shard, count[s], n_topic / n_shard / 10) << s;
+    }
+}
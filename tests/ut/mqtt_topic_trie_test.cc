@@ -0,0 +1,185 @@
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "connection/mqtt_client.h"
+#include "connection/mqtt_topic_trie.h"
+#include "utils/log.h"
+
+zlog_category_t *neuron = NULL;
+
+static const char *match(neu_mqtt_topic_trie_t *trie, const char *topic)
+{
+    return (const char *) neu_mqtt_topic_trie_match(trie, topic,
+                                                    strlen(topic));
+}
+
+static void add(neu_mqtt_topic_trie_t *trie, const char *filter)
+{
+    EXPECT_EQ(nullptr,
+              neu_mqtt_topic_trie_add(trie, filter, (void *) filter));
+}
+
+TEST(MqttTopicTrieTest, Match)
+{
+    neu_mqtt_topic_trie_t *trie = neu_mqtt_topic_trie_new();
+
+    add(trie, "sport/tennis/player/#");
+    EXPECT_EQ(nullptr, match(trie, "sport/tennis"));
+    EXPECT_EQ(nullptr, match(trie, "sport/tennis/play"));
+    EXPECT_STREQ("sport/tennis/player/#", match(trie, "sport/tennis/player"));
+    EXPECT_STREQ("sport/tennis/player/#",
+                 match(trie, "sport/tennis/player/"));
+    EXPECT_STREQ("sport/tennis/player/#",
+                 match(trie, "sport/tennis/player/ranking/score"));
+
+    add(trie, "sport/+");
+    EXPECT_EQ(nullptr, match(trie, "sport"));
+    EXPECT_STREQ("sport/+", match(trie, "sport/"));
+    EXPECT_STREQ("sport/+", match(trie, "sport/tennis"));
+    EXPECT_EQ(nullptr, match(trie, "sport/tennis/"));
+
+    add(trie, "+/+/+");
+    EXPECT_STREQ("+/+/+", match(trie, "a/b/c"));
+    EXPECT_STREQ("+/+/+", match(trie, "//"));
+    EXPECT_EQ(nullptr, match(trie, "$SYS/b/c"));
+
+    add(trie, "#");
+    EXPECT_STREQ("#", match(trie, "a"));
+    EXPECT_STREQ("#", match(trie, "a/b/c/d"));
+    EXPECT_EQ(nullptr, match(trie, "$SYS"));
+
+    add(trie, "$SYS/#");
+    EXPECT_STREQ("$SYS/#", match(trie, "$SYS"));
+    EXPECT_STREQ("$SYS/#", match(trie, "$SYS/broker/uptime"));
+
+    neu_mqtt_topic_trie_free(trie);
+}
+
+TEST(MqttTopicTrieTest, Preference)
+{
+    neu_mqtt_topic_trie_t *trie = neu_mqtt_topic_trie_new();
+
+    add(trie, "#");
+    add(trie, "a/#");
+    add(trie, "a/+");
+    add(trie, "a/b");
+
+    EXPECT_STREQ("a/b", match(trie, "a/b"));
+    EXPECT_STREQ("a/+", match(trie, "a/c"));
+    EXPECT_STREQ("a/#", match(trie, "a/c/d"));
+    EXPECT_STREQ("a/#", match(trie, "a"));
+    EXPECT_STREQ("#", match(trie, "b"));
+
+    neu_mqtt_topic_trie_free(trie);
+}
+
+TEST(MqttTopicTrieTest, AddDel)
+{
+    neu_mqtt_topic_trie_t *trie = neu_mqtt_topic_trie_new();
+    int                    a = 0, b = 0;
+
+    EXPECT_EQ(nullptr, neu_mqtt_topic_trie_add(trie, "a/+/c", &a));
+    EXPECT_EQ(nullptr, neu_mqtt_topic_trie_add(trie, "a/+", &a));
+    EXPECT_EQ(&a, neu_mqtt_topic_trie_add(trie, "a/+/c", &b));
+    EXPECT_EQ(2, neu_mqtt_topic_trie_count(trie));
+
+    EXPECT_EQ(&b, neu_mqtt_topic_trie_get(trie, "a/+/c"));
+    EXPECT_EQ(&a, neu_mqtt_topic_trie_get(trie, "a/+"));
+    EXPECT_EQ(nullptr, neu_mqtt_topic_trie_get(trie, "a"));
+    EXPECT_EQ(nullptr, neu_mqtt_topic_trie_get(trie, "a/+/c/d"));
+
+    // the shared path is kept until its last filter is removed
+    EXPECT_EQ(&a, neu_mqtt_topic_trie_del(trie, "a/+"));
+    EXPECT_EQ(nullptr, neu_mqtt_topic_trie_del(trie, "a/+"));
+    EXPECT_EQ(nullptr, neu_mqtt_topic_trie_del(trie, "a"));
+    EXPECT_EQ((void *) &b, (void *) match(trie, "a/b/c"));
+    EXPECT_EQ(nullptr, match(trie, "a/b"));
+
+    EXPECT_EQ(&b, neu_mqtt_topic_trie_del(trie, "a/+/c"));
+    EXPECT_EQ(0, neu_mqtt_topic_trie_count(trie));
+    EXPECT_EQ(nullptr, match(trie, "a/b/c"));
+
+    neu_mqtt_topic_trie_free(trie);
+}
+
+TEST(MqttTopicTrieTest, SameAsLinear)
+{
+    neu_mqtt_topic_trie_t *  trie = neu_mqtt_topic_trie_new();
+    std::vector<std::string> filters;
+    const char *             levels[] = { "a", "b", "+", "#", "" };
+
+    // the trie keeps pointers to the filter strings
+    filters.reserve(200);
+    srand(1);
+    for (int i = 0; i < 200; i++) {
+        std::string filter;
+        int         n = 1 + rand() % 4;
+        for (int l = 0; l < n; l++) {
+            const char *level = levels[rand() % 5];
+            filter += (l > 0 ? "/" : "") + std::string(level);
+            if ('#' == level[0]) {
+                break;
+            }
+        }
+        if (NULL == neu_mqtt_topic_trie_get(trie, filter.c_str())) {
+            filters.push_back(filter);
+            neu_mqtt_topic_trie_add(trie, filters.back().c_str(),
+                                    (void *) filters.back().c_str());
+        }
+    }
+
+    for (int i = 0; i < 1000; i++) {
+        std::string topic;
+        int         n = 1 + rand() % 5;
+        for (int l = 0; l < n; l++) {
+            topic += (l > 0 ? "/" : "") + std::string(levels[rand() % 2]);
+        }
+
+        const char *found = match(trie, topic.c_str());
+        bool        any   = false;
+        for (const std::string &filter : filters) {
+            any = any ||
+                neu_mqtt_topic_filter_is_match(filter.c_str(), topic.c_str());
+        }
+
+        EXPECT_EQ(any, NULL != found) << topic;
+        if (found) {
+            EXPECT_TRUE(neu_mqtt_topic_filter_is_match(found, topic.c_str()))
+                << found << " " << topic;
+        }
+    }
+
+    neu_mqtt_topic_trie_free(trie);
+}
+
+TEST(MqttTopicTrieTest, Large)
+{
+    const int                n_filter = 10000;
+    const int                rounds   = 10000;
+    neu_mqtt_topic_trie_t *  trie     = neu_mqtt_topic_trie_new();
+    std::vector<std::string> filters;
+    std::vector<std::string> topics;
+
+    // per driver write request topics with wildcards
+    filters.reserve(n_filter);
+    for (int i = 0; i < n_filter; i++) {
+        filters.push_back("/neuron/app/driver-" + std::to_string(i) +
+                          (i % 2 ? "/+/write" : "/write/#"));
+        add(trie, filters.back().c_str());
+    }
+    for (int i = 0; i < rounds; i++) {
+        int d = (i * 7919) % n_filter;
+        topics.push_back("/neuron/app/driver-" + std::to_string(d) +
+                         (d % 2 ? "/group/write" : "/write/group"));
+    }
+
+    // every topic matches exactly the filter of its driver
+    for (int i = 0; i < rounds; i++) {
+        int d = (i * 7919) % n_filter;
+        EXPECT_STREQ(filters[d].c_str(), match(trie, topics[i].c_str()));
+    }
+
+    neu_mqtt_topic_trie_free(trie);
+}
@@ -0,0 +1,303 @@
+#include <arpa/inet.h>
+#include <mutex>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <nng/nng.h>
+#include <nng/supplemental/http/http.h>
+
+#include "plugin.h"
+#include "utils/log.h"
+extern "C" {
+#include "stream_handle.h"
+}
+
+#define STREAM_PORT 17072
+#define STREAM_URL "http://127.0.0.1:17072"
+
+zlog_category_t *neuron      = NULL;
+bool             disable_jwt = true;
+
+// a subscribe or unsubscribe request sent by the streams
+struct sub_req {
+    neu_reqresp_type_e type;
+    void *             ctx;
+    std::string        driver;
+    std::string        group;
+};
+
+static std::mutex           reqs_mtx;
+static std::vector<sub_req> reqs;
+
+// the requests of the streams are recorded instead of sent to the manager
+int neu_plugin_op(neu_plugin_t *plugin, neu_reqresp_head_t head, void *data)
+{
+    std::lock_guard<std::mutex> lock(reqs_mtx);
+
+    (void) plugin;
+    if (NEU_REQ_SUBSCRIBE_GROUP == head.type) {
+        neu_req_subscribe_t *cmd = (neu_req_subscribe_t *) data;
+        reqs.push_back({ head.type, head.ctx, cmd->driver, cmd->group });
+    } else {
+        neu_req_unsubscribe_t *cmd = (neu_req_unsubscribe_t *) data;
+        reqs.push_back({ head.type, head.ctx, cmd->driver, cmd->group });
+    }
+
+    return 0;
+}
+
+static std::vector<sub_req> sent(neu_reqresp_type_e type)
+{
+    std::lock_guard<std::mutex> lock(reqs_mtx);
+    std::vector<sub_req>        out;
+
+    for (auto &req : reqs) {
+        if (req.type == type) {
+            out.push_back(req);
+        }
+    }
+    return out;
+}
+
+static bool reply(void *ctx, int error)
+{
+    neu_resp_error_t resp = {};
+
+    resp.error = error;
+    return handle_stream_sub_resp(ctx, &resp);
+}
+
+static void push(const char *driver, const char *group, const char *tag)
+{
+    neu_reqresp_trans_data_t  data  = {};
+    neu_resp_tag_value_meta_t value = {};
+
+    data.driver = (char *) driver;
+    data.group  = (char *) group;
+    utarray_new(data.tags, neu_resp_tag_value_meta_icd());
+    strcpy(value.tag, tag);
+    value.value.type      = NEU_TYPE_INT32;
+    value.value.value.i32 = 1;
+    utarray_push_back(data.tags, &value);
+
+    handle_stream_trans_data(&data);
+    utarray_free(data.tags);
+}
+
+// a stream connection, with what it received so far
+struct client {
+    int         fd = -1;
+    std::string buf;
+
+    // true once `needle` is received, false on timeout or close
+    bool wait(const std::string &needle)
+    {
+        char    tmp[1024];
+        ssize_t n = 0;
+
+        while (std::string::npos == buf.find(needle)) {
+            n = recv(fd, tmp, sizeof(tmp), 0);
+            if (n <= 0) {
+                return false;
+            }
+            buf.append(tmp, n);
+        }
+        return true;
+    }
+
+    // true if the server closed the connection
+    bool closed()
+    {
+        char    tmp[1024];
+        ssize_t n = 0;
+
+        while ((n = recv(fd, tmp, sizeof(tmp), 0)) > 0) {
+            buf.append(tmp, n);
+        }
+        return 0 == n;
+    }
+
+    ~client()
+    {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+};
+
+static bool open_stream(client &c, const char *driver, const char *group)
+{
+    sockaddr_in addr    = {};
+    timeval     timeout = { 2, 0 };
+    std::string req     = std::string("GET /stream?node=") + driver +
+        "&group=" + group + " HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n";
+
+    addr.sin_family      = AF_INET;
+    addr.sin_port        = htons(STREAM_PORT);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    c.fd = socket(AF_INET, SOCK_STREAM, 0);
+    setsockopt(c.fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    if (0 != connect(c.fd, (sockaddr *) &addr, sizeof(addr)) ||
+        (ssize_t) req.size() != send(c.fd, req.data(), req.size(), 0)) {
+        return false;
+    }
+
+    return c.wait("text/event-stream") && c.wait("\r\n\r\n");
+}
+
+static std::string error_event(int error)
+{
+    return "event: error\ndata: {\"error\": " + std::to_string(error) + "}";
+}
+
+class StreamTest : public testing::Test {
+protected:
+    void SetUp() override
+    {
+        nng_url *         url     = NULL;
+        nng_http_handler *handler = NULL;
+
+        strcpy(common.name, "rest");
+        ASSERT_EQ(0, handle_stream_init((neu_plugin_t *) &common));
+
+        nng_url_parse(&url, STREAM_URL);
+        ASSERT_EQ(0, nng_http_server_hold(&server, url));
+        nng_url_free(url);
+
+        nng_http_handler_alloc(&handler, "/stream", handle_read_stream);
+        nng_http_server_add_handler(server, handler);
+        ASSERT_EQ(0, nng_http_server_start(server));
+    }
+
+    void TearDown() override
+    {
+        nng_http_server_stop(server);
+        nng_http_server_release(server);
+        handle_stream_uninit();
+
+        std::lock_guard<std::mutex> lock(reqs_mtx);
+        reqs.clear();
+    }
+
+    neu_plugin_common_t common = {};
+    nng_http_server *   server = NULL;
+};
+
+TEST_F(StreamTest, GroupShared)
+{
+    client c1, c2, c3;
+
+    ASSERT_TRUE(open_stream(c1, "modbus", "grp"));
+    ASSERT_TRUE(open_stream(c2, "modbus", "grp"));
+
+    // one subscription for the clients of a group
+    auto subs = sent(NEU_REQ_SUBSCRIBE_GROUP);
+    ASSERT_EQ(1, (int) subs.size());
+    EXPECT_EQ("modbus", subs[0].driver);
+    EXPECT_EQ("grp", subs[0].group);
+    EXPECT_NE(nullptr, subs[0].ctx);
+    EXPECT_TRUE(reply(subs[0].ctx, 0));
+
+    push("modbus", "grp", "tag1");
+    EXPECT_TRUE(c1.wait("\"tag1\""));
+    EXPECT_TRUE(c2.wait("\"tag1\""));
+
+    // deleting the group closes its clients without unsubscribing it
+    neu_req_del_group_t del = {};
+    strcpy(del.driver, "modbus");
+    strcpy(del.group, "grp");
+    handle_stream_del_group(&del);
+    EXPECT_TRUE(c1.wait(error_event(NEU_ERR_GROUP_NOT_EXIST)));
+    EXPECT_TRUE(c2.wait(error_event(NEU_ERR_GROUP_NOT_EXIST)));
+    EXPECT_TRUE(c1.closed());
+    EXPECT_TRUE(c2.closed());
+    EXPECT_EQ(0, (int) sent(NEU_REQ_UNSUBSCRIBE_GROUP).size());
+
+    // the next client subscribes it again
+    ASSERT_TRUE(open_stream(c3, "modbus", "grp"));
+    EXPECT_EQ(2, (int) sent(NEU_REQ_SUBSCRIBE_GROUP).size());
+}
+
+TEST_F(StreamTest, SubscribeFail)
+{
+    client c1, c2;
+
+    ASSERT_TRUE(open_stream(c1, "modbus", "grp1"));
+    ASSERT_TRUE(open_stream(c2, "modbus", "grp2"));
+
+    auto subs = sent(NEU_REQ_SUBSCRIBE_GROUP);
+    ASSERT_EQ(2, (int) subs.size());
+
+    // not a request of the streams
+    EXPECT_FALSE(reply(NULL, 0));
+    EXPECT_FALSE(reply(&subs, 0));
+
+    // replies are paired by ctx, whatever their order
+    EXPECT_TRUE(reply(subs[1].ctx, NEU_ERR_GROUP_NOT_EXIST));
+    EXPECT_TRUE(reply(subs[0].ctx, NEU_ERR_GROUP_ALREADY_SUBSCRIBED));
+    EXPECT_FALSE(reply(subs[1].ctx, 0));
+
+    EXPECT_TRUE(c2.wait(error_event(NEU_ERR_GROUP_NOT_EXIST)));
+    EXPECT_TRUE(c2.closed());
+
+    push("modbus", "grp1", "tag1");
+    EXPECT_TRUE(c1.wait("\"tag1\""));
+}
+
+TEST_F(StreamTest, LastClientUnsubscribe)
+{
+    client c1, c2;
+
+    ASSERT_TRUE(open_stream(c1, "modbus", "grp"));
+    auto subs = sent(NEU_REQ_SUBSCRIBE_GROUP);
+    ASSERT_EQ(1, (int) subs.size());
+    EXPECT_TRUE(reply(subs[0].ctx, 0));
+
+    // the write failing after the client is gone closes it
+    close(c1.fd);
+    c1.fd = -1;
+    for (int i = 0; i < 200 && sent(NEU_REQ_UNSUBSCRIBE_GROUP).empty(); i++) {
+        push("modbus", "grp", ("tag" + std::to_string(i)).c_str());
+        usleep(10 * 1000);
+    }
+    auto unsubs = sent(NEU_REQ_UNSUBSCRIBE_GROUP);
+    ASSERT_EQ(1, (int) unsubs.size());
+    EXPECT_EQ("modbus", unsubs[0].driver);
+    EXPECT_EQ("grp", unsubs[0].group);
+
+    // a client opens the group again before the unsubscribe is handled
+    ASSERT_TRUE(open_stream(c2, "modbus", "grp"));
+    subs = sent(NEU_REQ_SUBSCRIBE_GROUP);
+    ASSERT_EQ(2, (int) subs.size());
+
+    // the copy of the unsubscribe forwarded back leaves the new group open
+    neu_req_unsubscribe_t unsub = {};
+    strcpy(unsub.app, "rest");
+    strcpy(unsub.driver, "modbus");
+    strcpy(unsub.group, "grp");
+    handle_stream_unsubscribe(unsubs[0].ctx, &unsub);
+    EXPECT_TRUE(reply(unsubs[0].ctx, 0));
+    EXPECT_TRUE(reply(subs[1].ctx, 0));
+
+    push("modbus", "grp", "new");
+    EXPECT_TRUE(c2.wait("\"new\""));
+
+    // unsubscribed through the api
+    handle_stream_unsubscribe(NULL, &unsub);
+    EXPECT_TRUE(c2.wait(error_event(NEU_ERR_GROUP_NOT_SUBSCRIBE)));
+    EXPECT_TRUE(c2.closed());
+    EXPECT_EQ(1, (int) sent(NEU_REQ_UNSUBSCRIBE_GROUP).size());
+}
+
+int main(int argc, char **argv)
+{
+    zlog_init("./config/dev.conf");
+    neuron = zlog_get_category("neuron");
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
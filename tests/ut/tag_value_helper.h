@@ -0,0 +1,21 @@
+#ifndef NEU_TEST_TAG_VALUE_HELPER_H
+#define NEU_TEST_TAG_VALUE_HELPER_H
+
+#include <string.h>
+
+#include "msg.h"
+
+// appends a tag of `type` to an array of neu_resp_tag_value_meta_t, and
+// returns it for the test to set its value
+static inline neu_resp_tag_value_meta_t *
+push_tag(UT_array *tags, const char *name, neu_type_e type)
+{
+    neu_resp_tag_value_meta_t tag = {};
+
+    strncpy(tag.tag, name, sizeof(tag.tag) - 1);
+    tag.value.type = type;
+    utarray_push_back(tags, &tag);
+    return (neu_resp_tag_value_meta_t *) utarray_back(tags);
+}
+
+#endif